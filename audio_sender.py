@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""
+PC端语音发送工具
+把 WAV 文件编码后按实时速率发往设备的音频端口（包格式见 main/audio_stream.h，编码见 main/audio_codec.h）:
+
+    python audio_sender.py 192.168.5.10 hello.wav                    # IMA-ADPCM, 64 kbit/s
+    python audio_sender.py 192.168.5.10 hello.wav --codec mulaw      # G.711 mu-law, 128 kbit/s
+    python audio_sender.py 192.168.5.10 hello.wav --codec pcm8 --frame-ms 40
+    python audio_sender.py 192.168.5.10 hello.wav --codec opus --kbps 16   # 需要设备启用 CONFIG_AUDIO_OPUS
+
+输入为 16-bit PCM WAV，多声道取平均，采样率不是 16 kHz 时线性插值重采样。除 Opus 外每个包单独可解码，丢包不影响后续的包；
+Opus 编码器打开带内 FEC，设备用后一个包恢复丢失的帧。Opus 需要 opuslib (pip install opuslib) 与系统的 libopus。
+"""
+
+import argparse
+import array
+import socket
+import struct
+import sys
+import time
+import wave
+
+SAMPLE_RATE = 16000
+MAX_SAMPLES = 1400                          # 设备端一个包解码后的最大样本数
+AUDIO_HEADER = struct.Struct('!HBBBBHII')   # magic "AU", version, codec, flags, reserved, samples, seq, timestamp
+AUDIO_MAGIC = 0x4155
+AUDIO_VERSION = 1
+FLAG_LAST = 0x01
+
+# 与 audio_codec_t 的取值一致
+CODECS = {'pcm8': 0, 'mulaw': 1, 'adpcm': 2, 'opus': 3}
+OPUS_FRAME_MS = (5, 10, 20, 40, 60)        # 设备端一个包不超过 1400 个样本，2.5 ms 帧不常用
+
+ADPCM_STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209,
+    230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749,
+    3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623,
+    27086, 29794, 32767,
+]
+ADPCM_INDEX = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def encode_pcm8(samples):
+    return bytes(((s >> 8) + 128) & 0xFF for s in samples)
+
+
+def mulaw_byte(sample):
+    sign = 0x80 if sample < 0 else 0
+    magnitude = min(-sample if sample < 0 else sample, 32635) + 0x84
+    exponent = max(magnitude.bit_length() - 8, 0)
+    mantissa = (magnitude >> (exponent + 3)) & 0x0F
+    return ~(sign | (exponent << 4) | mantissa) & 0xFF
+
+
+def encode_mulaw(samples):
+    return bytes(mulaw_byte(s) for s in samples)
+
+
+class AdpcmEncoder:
+    """IMA-ADPCM 编码器，状态跨包延续；每个包的开头写入当前的预测值与步长索引，设备端从包头恢复状态"""
+
+    def __init__(self):
+        self.predictor = 0
+        self.index = 0
+
+    def encode(self, samples):
+        if len(samples) % 2:
+            samples = list(samples) + [samples[-1]]
+        out = bytearray(struct.pack('!hBB', self.predictor, self.index, 0))
+        nibbles = [self.encode_sample(s) for s in samples]
+        for i in range(0, len(nibbles), 2):
+            out.append(nibbles[i] | (nibbles[i + 1] << 4))
+        return bytes(out)
+
+    def encode_sample(self, sample):
+        # 与解码器相同的重建过程，保证编码端与设备端的预测值一致
+        step = ADPCM_STEPS[self.index]
+        diff = sample - self.predictor
+        nibble = 0
+        if diff < 0:
+            nibble = 8
+            diff = -diff
+        if diff >= step:
+            nibble |= 4
+            diff -= step
+        if diff >= step >> 1:
+            nibble |= 2
+            diff -= step >> 1
+        if diff >= step >> 2:
+            nibble |= 1
+
+        delta = step >> 3
+        if nibble & 4:
+            delta += step
+        if nibble & 2:
+            delta += step >> 1
+        if nibble & 1:
+            delta += step >> 2
+        self.predictor += -delta if nibble & 8 else delta
+        self.predictor = max(-32768, min(32767, self.predictor))
+        self.index = max(0, min(88, self.index + ADPCM_INDEX[nibble]))
+        return nibble
+
+
+class OpusEncoder:
+    """Opus 语音编码器，每包一帧"""
+
+    def __init__(self, kbps, loss_percent):
+        try:
+            import opuslib
+        except ImportError:
+            raise SystemExit("Opus 编码需要 opuslib: pip install opuslib")
+        self.encoder = opuslib.Encoder(SAMPLE_RATE, 1, opuslib.APPLICATION_VOIP)
+        self.encoder.bitrate = kbps * 1000
+        self.encoder.inband_fec = 1
+        self.encoder.packet_loss_perc = loss_percent
+
+    def encode(self, samples, frame_samples):
+        if len(samples) < frame_samples:
+            samples = list(samples) + [0] * (frame_samples - len(samples))
+        return self.encoder.encode(array.array('h', samples).tobytes(), frame_samples)
+
+
+def read_wav(path):
+    with wave.open(path, 'rb') as wav:
+        if wav.getsampwidth() != 2:
+            raise ValueError("只支持 16-bit PCM WAV")
+        channels = wav.getnchannels()
+        rate = wav.getframerate()
+        data = array.array('h', wav.readframes(wav.getnframes()))
+    if sys.byteorder == 'big':
+        data.byteswap()
+    if channels > 1:
+        data = [sum(data[i:i + channels]) // channels for i in range(0, len(data), channels)]
+    if rate != SAMPLE_RATE:
+        data = resample(data, rate)
+    return list(data)
+
+
+def resample(samples, rate):
+    if not samples:
+        return []
+    count = len(samples) * SAMPLE_RATE // rate
+    out = []
+    for i in range(count):
+        pos = i * rate / SAMPLE_RATE
+        j = int(pos)
+        frac = pos - j
+        nxt = samples[j + 1] if j + 1 < len(samples) else samples[j]
+        out.append(int(samples[j] * (1 - frac) + nxt * frac))
+    return out
+
+
+def packetize(samples, codec, frame_samples, seq=0, timestamp=0, kbps=16, loss_percent=10):
+    """把一段语音编码为数据报列表，seq 与 timestamp 从给定值开始连续递增"""
+    encoder = OpusEncoder(kbps, loss_percent) if codec == 'opus' else AdpcmEncoder()
+    packets = []
+    for offset in range(0, len(samples), frame_samples):
+        chunk = samples[offset:offset + frame_samples]
+        if codec == 'opus':
+            payload = encoder.encode(chunk, frame_samples)
+            count = frame_samples
+        elif codec == 'adpcm':
+            payload = encoder.encode(chunk)
+            count = (len(payload) - 4) * 2
+        elif codec == 'mulaw':
+            payload = encode_mulaw(chunk)
+            count = len(chunk)
+        else:
+            payload = encode_pcm8(chunk)
+            count = len(chunk)
+        flags = FLAG_LAST if offset + frame_samples >= len(samples) else 0
+        header = AUDIO_HEADER.pack(AUDIO_MAGIC, AUDIO_VERSION, CODECS[codec], flags, 0, count, seq & 0xFFFFFFFF, timestamp & 0xFFFFFFFF)
+        packets.append(header + payload)
+        seq += 1
+        timestamp += count
+    return packets
+
+
+def send(device, port, packets, frame_samples):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    interval = frame_samples / SAMPLE_RATE
+    start = time.monotonic()
+    try:
+        for i, packet in enumerate(packets):
+            delay = start + i * interval - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+            sock.sendto(packet, (device, port))
+    finally:
+        sock.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="语音发送工具：把 WAV 编码后按实时速率发往设备")
+    parser.add_argument("device", help="设备IP")
+    parser.add_argument("wav", help="16-bit PCM WAV 文件")
+    parser.add_argument("--port", type=int, default=8081, help="设备的音频端口")
+    parser.add_argument("--codec", choices=sorted(CODECS), default="adpcm", help="载荷编码")
+    parser.add_argument("--frame-ms", type=int, default=20, help="每个包的时长 (毫秒)")
+    parser.add_argument("--seq", type=int, default=0, help="第一个包的序号（连续发送多段时接着上一段）")
+    parser.add_argument("--kbps", type=int, default=16, help="Opus 码率 (kbit/s)")
+    parser.add_argument("--loss", type=int, default=10, help="Opus FEC 按该丢包率 (%%) 分配冗余")
+    args = parser.parse_args()
+
+    if args.codec == 'opus' and args.frame_ms not in OPUS_FRAME_MS:
+        parser.error("Opus 的 --frame-ms 只能是 %s" % ', '.join(str(ms) for ms in OPUS_FRAME_MS))
+
+    frame_samples = SAMPLE_RATE * args.frame_ms // 1000
+    if frame_samples < 2 or frame_samples > MAX_SAMPLES:
+        parser.error("--frame-ms 需要在 1-%d 之间" % (MAX_SAMPLES * 1000 // SAMPLE_RATE))
+    frame_samples -= frame_samples % 2
+
+    samples = read_wav(args.wav)
+    if not samples:
+        print("WAV 文件没有音频数据")
+        return 1
+    packets = packetize(samples, args.codec, frame_samples, seq=args.seq, kbps=args.kbps, loss_percent=args.loss)
+    payload = sum(len(p) for p in packets)
+    seconds = len(samples) / SAMPLE_RATE
+    print("%s: %.2f 秒, %d 个包, %.1f kbit/s (含包头)" % (args.codec, seconds, len(packets), payload * 8 / seconds / 1000))
+    send(args.device, args.port, packets, frame_samples)
+    print("发送完成，下一段可使用 --seq %d" % (args.seq + len(packets)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""
+PC端相机参数工具
+不重启修改设备的相机参数（格式见 main/camera_ctrl.h 与 main/image_proto.h），修改过的参数由设备合并保存到 NVS:
+
+    python camera_control.py 192.168.5.10 framesize=8 quality=12 brightness=1
+    python camera_control.py 192.168.5.10 --udp aec=0 aec_value=300
+    python camera_control.py 192.168.5.10                # 只显示当前参数
+    python camera_control.py 192.168.5.10 --reset        # 清除保存的参数，恢复默认
+
+默认通过 HTTP /api/camera 修改并打印设备返回的当前值；--udp 向 UDP 控制端口发送参数报文（不返回结果）。
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+import urllib.error
+import urllib.request
+
+CTRL_HEADER = struct.Struct('!HBBBB')   # magic "EK", version, type, count, reserved
+CTRL_PARAM = struct.Struct('!Hi')       # param, value
+CTRL_MAGIC = 0x454B
+CTRL_VERSION = 2
+CTRL_TYPE_CAMERA = 0x05
+CTRL_MAX_PARAMS = 16
+
+# 与 camera_ctrl_param_t 的顺序一致，只追加
+PARAMS = ['framesize', 'quality', 'brightness', 'contrast', 'saturation', 'aec', 'ae_level', 'aec_value', 'agc', 'agc_gain', 'gainceiling',
+          'awb', 'hmirror', 'vflip', 'window_x', 'window_y', 'window_w', 'window_h', 'xclk_hz', 'fb_count', 'grab_mode']
+
+
+def parse_settings(items):
+    settings = []
+    for item in items:
+        name, sep, value = item.partition('=')
+        if not sep or name not in PARAMS:
+            raise ValueError("无效参数 %r，可用: %s" % (item, ', '.join(PARAMS)))
+        settings.append((name, int(value, 0)))
+    return settings
+
+
+def send_udp(device, control_port, settings):
+    if not settings or len(settings) > CTRL_MAX_PARAMS:
+        raise ValueError("UDP 报文需要 1-%d 个参数" % CTRL_MAX_PARAMS)
+    packet = CTRL_HEADER.pack(CTRL_MAGIC, CTRL_VERSION, CTRL_TYPE_CAMERA, len(settings), 0)
+    for name, value in settings:
+        packet += CTRL_PARAM.pack(PARAMS.index(name), value)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.sendto(packet, (device, control_port))
+    sock.close()
+    print("已向 %s:%d 发送 %d 个参数" % (device, control_port, len(settings)))
+
+
+def http_request(device, port, body=None, timeout=10.0):
+    url = "http://%s:%d/api/camera" % (device, port)
+    data = json.dumps(body).encode() if body is not None else None
+    request = urllib.request.Request(url, data=data, headers={'Content-Type': 'application/json'} if data else {})
+    try:
+        with urllib.request.urlopen(request, timeout=timeout) as response:
+            return json.loads(response.read())
+    except urllib.error.HTTPError as e:
+        return json.loads(e.read() or b'{}')
+
+
+def print_state(state):
+    if not state.get('success'):
+        print("设备返回错误: %s" % state.get('message', state))
+        return False
+    persisted = set(state.get('persisted', []))
+    print("传感器: %s, 最大分辨率 %s, 帧缓冲按分辨率 %s 分配" % (state.get('sensor'), state.get('max_framesize'), state.get('buffer_framesize')))
+    for name, value in state.get('settings', {}).items():
+        print("  %-12s %10d%s" % (name, value, "  (已保存)" if name in persisted else ""))
+    stats = state.get('stats', {})
+    print("修改 %d 次 (拒绝 %d), 重新初始化 %d 次 (失败 %d), NVS 提交 %d 次%s" %
+          (stats.get('applied', 0), stats.get('rejected', 0), stats.get('reinits', 0), stats.get('reinit_failures', 0), stats.get('commits', 0),
+           ", 有待提交的修改" if state.get('commit_pending') else ""))
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="相机参数工具：不重启修改设备的传感器与驱动参数")
+    parser.add_argument("device", help="设备IP")
+    parser.add_argument("settings", nargs="*", help="参数=值，例如 framesize=8 quality=12")
+    parser.add_argument("--udp", action="store_true", help="通过 UDP 控制报文修改（不等待结果）")
+    parser.add_argument("--control-port", type=int, default=8082, help="设备的 UDP 控制端口")
+    parser.add_argument("--http-port", type=int, default=80, help="设备的 HTTP 端口")
+    parser.add_argument("--reset", action="store_true", help="清除保存的参数，恢复默认配置")
+    parser.add_argument("--commit", action="store_true", help="立即写入 NVS，不等待合并提交")
+    args = parser.parse_args()
+
+    try:
+        settings = parse_settings(args.settings)
+        if args.udp:
+            send_udp(args.device, args.control_port, settings)
+            return 0
+        body = dict(settings)
+        if args.reset:
+            body['reset'] = True
+        if args.commit:
+            body['commit'] = True
+        state = http_request(args.device, args.http_port, body if body else None)
+    except (ValueError, OSError) as e:
+        print("失败: %s" % e)
+        return 1
+    return 0 if print_state(state) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
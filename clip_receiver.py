@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""
+PC端事件片段接收工具
+监听 TCP 端口接收设备导出的事件片段（格式见 main/event_clip.h），校验索引与片段尾，
+保存为 .clip 文件并把每帧解出为 JPEG，报告帧数、预录时长与接收吞吐:
+
+    python clip_receiver.py --port 8090 --out-dir clips
+    python clip_receiver.py --port 8090 --trigger 192.168.5.10 --post-seconds 3 --once
+
+--trigger 向设备的 UDP 控制端口发送事件片段触发报文，片段发往本机的 --port。
+"""
+
+import argparse
+import os
+import socket
+import struct
+import sys
+import time
+
+CLIP_HEADER = struct.Struct('!IBBHIQIII')     # magic, version, source, reserved, clip_id, trigger_us, pre_ms, post_ms, reserved
+FRAME_HEADER = struct.Struct('!IIQII')        # magic, seq, timestamp_us, len, flags
+INDEX_ENTRY = struct.Struct('!IIQ')           # offset, len, timestamp_us
+TRAILER = struct.Struct('!II')                # index_offset, magic
+CTRL_CLIP = struct.Struct('!HBBHH')           # magic "EK", version, type, port, post_seconds
+
+CLIP_MAGIC = 0x45434C50   # "ECLP"
+FRAME_MAGIC = 0x46524D45  # "FRME"
+INDEX_MAGIC = 0x43494458  # "CIDX"
+END_MAGIC = 0x43454E44    # "CEND"
+FRAME_PRE = 0x01
+
+CTRL_MAGIC = 0x454B
+CTRL_VERSION = 2
+CTRL_TYPE_CLIP = 0x04
+SOURCES = {0: 'udp', 1: 'http', 2: 'button'}
+
+
+def recv_exact(conn, n):
+    data = bytearray()
+    while len(data) < n:
+        chunk = conn.recv(n - len(data))
+        if not chunk:
+            raise RuntimeError('connection closed after %d bytes' % len(data))
+        data += chunk
+    return bytes(data)
+
+
+def receive_clip(conn):
+    """按顺序读取片段头、帧记录、索引与片段尾，返回 (原始字节, 片段头, 帧列表)"""
+    raw = bytearray()
+
+    def read(n):
+        data = recv_exact(conn, n)
+        raw.extend(data)
+        return data
+
+    header = CLIP_HEADER.unpack(read(CLIP_HEADER.size))
+    if header[0] != CLIP_MAGIC:
+        raise RuntimeError('bad clip magic 0x%08x' % header[0])
+
+    frames = []
+    while True:
+        offset = len(raw)
+        magic = struct.unpack('!I', read(4))[0]
+        if magic == INDEX_MAGIC:
+            break
+        if magic != FRAME_MAGIC:
+            raise RuntimeError('bad frame magic 0x%08x at offset %d' % (magic, offset))
+        _, seq, timestamp_us, length, flags = FRAME_HEADER.unpack(struct.pack('!I', magic) + read(FRAME_HEADER.size - 4))
+        jpeg = read(length)
+        frames.append({'offset': offset, 'seq': seq, 'timestamp_us': timestamp_us, 'flags': flags, 'jpeg': jpeg})
+
+    index_offset = len(raw) - 4
+    count = struct.unpack('!I', read(4))[0]
+    if count != len(frames):
+        raise RuntimeError('index has %d entries, received %d frames' % (count, len(frames)))
+    for i in range(count):
+        entry_offset, length, timestamp_us = INDEX_ENTRY.unpack(read(INDEX_ENTRY.size))
+        frame = frames[i]
+        if entry_offset != frame['offset'] or length != len(frame['jpeg']) or timestamp_us != frame['timestamp_us']:
+            raise RuntimeError('index entry %d does not match frame record' % i)
+
+    trailer_offset, end_magic = TRAILER.unpack(read(TRAILER.size))
+    if end_magic != END_MAGIC or trailer_offset != index_offset:
+        raise RuntimeError('bad clip trailer')
+    return bytes(raw), header, frames
+
+
+def send_trigger(device, control_port, port, post_seconds):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.sendto(CTRL_CLIP.pack(CTRL_MAGIC, CTRL_VERSION, CTRL_TYPE_CLIP, port, post_seconds), (device, control_port))
+    sock.close()
+    print("已向 %s:%d 发送触发报文" % (device, control_port))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="事件片段接收工具：接收、校验并解出设备导出的片段")
+    parser.add_argument("--port", type=int, default=8090, help="监听的 TCP 端口")
+    parser.add_argument("--out-dir", default="clips", help="保存片段与 JPEG 帧的目录")
+    parser.add_argument("--trigger", metavar="DEVICE", help="启动后向设备发送事件片段触发报文")
+    parser.add_argument("--control-port", type=int, default=8082, help="设备的 UDP 控制端口")
+    parser.add_argument("--post-seconds", type=int, default=0, help="触发后继续录制的秒数 (0 为设备默认值)")
+    parser.add_argument("--once", action="store_true", help="收到一个片段后退出")
+    parser.add_argument("--timeout", type=float, default=30.0, help="接收超时 (秒)")
+    args = parser.parse_args()
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(("0.0.0.0", args.port))
+    server.listen(1)
+    print("等待事件片段，端口: %d" % args.port)
+
+    if args.trigger:
+        send_trigger(args.trigger, args.control_port, args.port, args.post_seconds)
+
+    failed = False
+    while True:
+        conn, peer = server.accept()
+        conn.settimeout(args.timeout)
+        start = time.monotonic()
+        try:
+            raw, header, frames = receive_clip(conn)
+        except (RuntimeError, socket.timeout, OSError) as e:
+            print("来自 %s 的片段无效: %s" % (peer[0], e))
+            failed = True
+            conn.close()
+            if args.once:
+                break
+            continue
+        elapsed = time.monotonic() - start
+        conn.close()
+
+        clip_id, trigger_us = header[4], header[5]
+        name = "clip_%s_%d" % (time.strftime("%Y%m%d_%H%M%S"), clip_id)
+        with open(os.path.join(args.out_dir, name + ".clip"), "wb") as f:
+            f.write(raw)
+        frame_dir = os.path.join(args.out_dir, name)
+        os.makedirs(frame_dir, exist_ok=True)
+        for i, frame in enumerate(frames):
+            with open(os.path.join(frame_dir, "%04d_%d.jpg" % (i, frame['seq'])), "wb") as f:
+                f.write(frame['jpeg'])
+
+        pre = [f for f in frames if f['flags'] & FRAME_PRE]
+        pre_ms = (trigger_us - pre[0]['timestamp_us']) / 1000 if pre else 0.0
+        span_ms = (frames[-1]['timestamp_us'] - frames[0]['timestamp_us']) / 1000 if frames else 0.0
+        bad = sum(1 for f in frames if not f['jpeg'].startswith(b'\xff\xd8'))
+        print("片段 #%d (来源 %s) 来自 %s: %d 帧 (预录 %d 帧 / %.0f ms), 跨度 %.0f ms, %d bytes, 接收 %.2f s, %.0f kbps%s" % (
+            clip_id, SOURCES.get(header[2], header[2]), peer[0], len(frames), len(pre), pre_ms, span_ms, len(raw),
+            elapsed, len(raw) * 8 / 1000 / elapsed if elapsed > 0 else 0.0,
+            (", %d 帧不是 JPEG" % bad) if bad else ""))
+        print("已保存: %s" % os.path.join(args.out_dir, name + ".clip"))
+        if bad:
+            failed = True
+        if args.once:
+            break
+
+    server.close()
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
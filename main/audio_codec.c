@@ -0,0 +1,104 @@
+/*
+ * audio_codec.c
+ * 语音下行载荷解码实现
+ */
+
+#include "audio_codec.h"
+#include "pcm_convert.h"
+
+// G.711 mu-law：取反后 1 位符号、3 位指数、4 位尾数，偏置 0x84
+#define MULAW_MAG(u) (((((u) & 0x0F) << 3) + 0x84) << (((u) & 0x70) >> 4))
+#define MULAW_S16(x) ((int16_t)((~(x) & 0x80) ? 0x84 - MULAW_MAG(~(x)) : MULAW_MAG(~(x)) - 0x84))
+#define MULAW_LUT4(i) MULAW_S16(i), MULAW_S16((i) + 1), MULAW_S16((i) + 2), MULAW_S16((i) + 3)
+#define MULAW_LUT16(i) MULAW_LUT4(i), MULAW_LUT4((i) + 4), MULAW_LUT4((i) + 8), MULAW_LUT4((i) + 12)
+#define MULAW_LUT64(i) MULAW_LUT16(i), MULAW_LUT16((i) + 16), MULAW_LUT16((i) + 32), MULAW_LUT16((i) + 48)
+
+static const int16_t s_mulaw[256] = {MULAW_LUT64(0), MULAW_LUT64(64), MULAW_LUT64(128), MULAW_LUT64(192)};
+
+static const int16_t s_adpcm_step[89] = {
+    7,    8,    9,    10,   11,   12,   13,   14,   16,   17,   19,   21,    23,    25,    28,    31,    34,    37,    41,    45,    50,    55,    60,
+    66,   73,   80,   88,   97,   107,  118,  130,  143,  157,  173,  190,   209,   230,   253,   279,   307,   337,   371,   408,   449,   494,   544,
+    598,  658,  724,  796,  876,  963,  1060, 1166, 1282, 1411, 1552, 1707,  1878,  2066,  2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,
+    5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+static const int8_t s_adpcm_index[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+static const char* const s_names[AUDIO_CODEC_COUNT] = {"pcm8", "mulaw", "adpcm", "opus"};
+
+uint32_t audio_codec_samples(uint8_t codec, size_t len)
+{
+    switch (codec) {
+        case AUDIO_CODEC_PCM8:
+        case AUDIO_CODEC_MULAW:
+            return (uint32_t)len;
+        case AUDIO_CODEC_ADPCM:
+            return len > AUDIO_ADPCM_HEADER ? (uint32_t)(len - AUDIO_ADPCM_HEADER) * 2 : 0;
+        default:
+            return 0;
+    }
+}
+
+uint32_t audio_codec_decode(uint8_t codec, const uint8_t* in, size_t len, int16_t* out)
+{
+    switch (codec) {
+        case AUDIO_CODEC_PCM8:
+            pcm_u8_to_s16(in, out, len);
+            return (uint32_t)len;
+        case AUDIO_CODEC_MULAW:
+            audio_mulaw_decode(in, out, len);
+            return (uint32_t)len;
+        case AUDIO_CODEC_ADPCM:
+            return audio_adpcm_decode(in, len, out);
+        default:
+            return 0;
+    }
+}
+
+const char* audio_codec_name(uint8_t codec)
+{
+    return codec < AUDIO_CODEC_COUNT ? s_names[codec] : "unknown";
+}
+
+void audio_mulaw_decode(const uint8_t* in, int16_t* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        out[i] = s_mulaw[in[i]];
+    }
+}
+
+uint32_t audio_adpcm_decode(const uint8_t* in, size_t len, int16_t* out)
+{
+    if (len <= AUDIO_ADPCM_HEADER || in[2] > 88) {
+        return 0;
+    }
+
+    int32_t predictor = (int16_t)(((uint16_t)in[0] << 8) | in[1]);
+    int32_t index = in[2];
+    int32_t step = s_adpcm_step[index];
+    int16_t* p = out;
+
+    for (size_t i = AUDIO_ADPCM_HEADER; i < len; i++) {
+        uint8_t byte = in[i];
+        for (int half = 0; half < 2; half++) {
+            uint8_t nibble = half ? byte >> 4 : byte & 0x0F;
+            int32_t diff = step >> 3;
+            if (nibble & 4) {
+                diff += step;
+            }
+            if (nibble & 2) {
+                diff += step >> 1;
+            }
+            if (nibble & 1) {
+                diff += step >> 2;
+            }
+            predictor += (nibble & 8) ? -diff : diff;
+            predictor = predictor > 32767 ? 32767 : (predictor < -32768 ? -32768 : predictor);
+            index += s_adpcm_index[nibble];
+            index = index < 0 ? 0 : (index > 88 ? 88 : index);
+            step = s_adpcm_step[index];
+            *p++ = (int16_t)predictor;
+        }
+    }
+    return (uint32_t)(p - out);
+}
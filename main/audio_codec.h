@@ -0,0 +1,70 @@
+/*
+ * audio_codec.h
+ * 语音下行的载荷解码：8-bit 无符号 PCM、G.711 mu-law 与 IMA-ADPCM，输出 16-bit 有符号 PCM（Opus 有解码状态，见 audio_opus.h）
+ *
+ * 每个包单独解码、不保存跨包状态（IMA-ADPCM 的预测值与步长索引放在每个包的开头），丢包后的下一个包可以直接解码；
+ * 解码写入调用方提供的缓冲区，不分配内存。本模块不依赖 FreeRTOS 与音频驱动，可在 Linux 主机上单独编译。
+ */
+
+#ifndef AUDIO_CODEC_H
+#define AUDIO_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 载荷编码，取值与 audio_sender.py 的 --codec 一致，只追加
+ */
+typedef enum {
+    AUDIO_CODEC_PCM8 = 0,   // 8-bit 无符号 PCM，每字节一个样本 (128 kbit/s @ 16 kHz)
+    AUDIO_CODEC_MULAW = 1,  // G.711 mu-law，每字节一个样本，动态范围约 14 bit (128 kbit/s @ 16 kHz)
+    AUDIO_CODEC_ADPCM = 2,  // IMA-ADPCM，每字节两个样本 (64 kbit/s @ 16 kHz)
+    AUDIO_CODEC_OPUS = 3,   // Opus，每包一帧 (16-24 kbit/s)，由 audio_opus.h 解码
+    AUDIO_CODEC_COUNT,
+} audio_codec_t;
+
+#define AUDIO_ADPCM_HEADER 4  // IMA-ADPCM 包头：预测值 i16（网络字节序）、步长索引 u8、保留 u8
+
+/**
+ * @brief 载荷解码后的样本数
+ * @param codec 编码
+ * @param len 载荷字节数
+ * @return 样本数，编码未知、长度无效或是 Opus（样本数由包内容决定）时返回 0
+ */
+uint32_t audio_codec_samples(uint8_t codec, size_t len);
+
+/**
+ * @brief 解码一个包的载荷
+ * @param codec 编码
+ * @param in 载荷
+ * @param len 载荷字节数
+ * @param out 输出，至少 audio_codec_samples(codec, len) 个样本，不能与 in 重叠
+ * @return 输出的样本数，编码未知、载荷无效或是 Opus 时返回 0
+ */
+uint32_t audio_codec_decode(uint8_t codec, const uint8_t* in, size_t len, int16_t* out);
+
+/**
+ * @brief 编码名称（用于日志与统计）
+ */
+const char* audio_codec_name(uint8_t codec);
+
+/**
+ * @brief G.711 mu-law 解码（256 项查表）
+ */
+void audio_mulaw_decode(const uint8_t* in, int16_t* out, size_t count);
+
+/**
+ * @brief IMA-ADPCM 解码：包头之后每字节两个样本，先低 4 位后高 4 位
+ * @return 输出的样本数，步长索引无效或长度不足时返回 0
+ */
+uint32_t audio_adpcm_decode(const uint8_t* in, size_t len, int16_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_CODEC_H */
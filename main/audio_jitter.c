@@ -0,0 +1,457 @@
+/*
+ * audio_jitter.c
+ * 音频抖动缓冲与丢包隐藏实现
+ */
+
+#include <string.h>
+
+#include "audio_jitter.h"
+
+#define JITTER_RESET_SPAN 4      // 序号跳变超过 capacity 的该倍数时认为发送端重新开始
+#define JITTER_DROP_RUN 8        // 连续超过目标深度该次数后丢弃一个包
+#define JITTER_BOOST_DECAY 64    // 每收到一个包，增加的目标深度衰减 1/64
+
+static int64_t samples_to_us(const audio_jitter_t* jb, int64_t samples)
+{
+    return samples * 1000000 / jb->config.sample_rate;
+}
+
+static int64_t target_us(const audio_jitter_t* jb)
+{
+    // 一个包的时长 + 4 倍平滑抖动 + 迟到/欠载增加的余量
+    int64_t target = samples_to_us(jb, jb->last_samples) + 4 * (int64_t)jb->jitter_us + jb->boost_us;
+    int64_t lo = (int64_t)jb->config.min_depth_ms * 1000;
+    int64_t hi = (int64_t)jb->config.max_depth_ms * 1000;
+    return target < lo ? lo : (target > hi ? hi : target);
+}
+
+static void add_boost(audio_jitter_t* jb, int64_t us)
+{
+    int64_t boost = jb->boost_us + us;
+    int64_t hi = (int64_t)jb->config.max_depth_ms * 1000;
+    jb->boost_us = (uint32_t)(boost > hi ? hi : boost);
+}
+
+static audio_jitter_slot_t* slot_of(audio_jitter_t* jb, uint32_t seq)
+{
+    return &jb->slots[seq % jb->config.capacity];
+}
+
+static uint8_t* payload_of(audio_jitter_t* jb, uint32_t seq)
+{
+    return jb->storage + (size_t)(seq % jb->config.capacity) * jb->config.max_payload;
+}
+
+static void release(audio_jitter_t* jb, audio_jitter_slot_t* slot)
+{
+    slot->used = false;
+    jb->count--;
+    jb->buffered_samples -= slot->samples;
+}
+
+static void copy_out(audio_jitter_t* jb, const audio_jitter_slot_t* slot, audio_jitter_packet_t* packet)
+{
+    packet->seq = slot->seq;
+    packet->timestamp = slot->timestamp;
+    packet->samples = slot->samples;
+    packet->len = slot->len;
+    packet->last = slot->last;
+    packet->format = slot->format;
+    packet->data = payload_of(jb, slot->seq);
+}
+
+static void flush(audio_jitter_t* jb)
+{
+    for (uint8_t i = 0; i < jb->config.capacity; i++) {
+        jb->slots[i].used = false;
+    }
+    jb->count = 0;
+    jb->buffered_samples = 0;
+}
+
+static void start_stream(audio_jitter_t* jb, const audio_jitter_packet_t* packet, int64_t now_us)
+{
+    // 抖动估计是链路的属性，跨流保留；传输时间的基准随时间戳重新开始
+    flush(jb);
+    jb->active = true;
+    jb->playing = false;
+    jb->have_seq = true;
+    jb->next_seq = packet->seq;
+    jb->next_ts = packet->timestamp;
+    jb->base_ts = packet->timestamp;
+    jb->prebuffer_start_us = now_us;
+    jb->have_transit = false;
+    jb->over_target_run = 0;
+    jb->stats.streams++;
+}
+
+static void stream_ended(audio_jitter_t* jb)
+{
+    jb->active = false;
+    jb->playing = false;
+}
+
+/**
+ * @brief 跳过下一个序号（缓冲中有该包则释放）
+ * @return 被跳过的包是否在缓冲中
+ */
+static bool skip_next(audio_jitter_t* jb)
+{
+    audio_jitter_slot_t* slot = slot_of(jb, jb->next_seq);
+    bool present = slot->used && slot->seq == jb->next_seq;
+    if (present) {
+        jb->next_ts = slot->timestamp + slot->samples;
+        release(jb, slot);
+    }
+    else {
+        jb->next_ts += jb->last_samples;
+    }
+    jb->next_seq++;
+    return present;
+}
+
+/**
+ * @brief 缓冲为空且长时间没有收到包：流已结束（最后一个包可能丢失）
+ */
+static void expire(audio_jitter_t* jb, int64_t now_us)
+{
+    if (jb->active && jb->count == 0 && now_us - jb->last_arrival_us > (int64_t)jb->config.idle_ms * 1000) {
+        stream_ended(jb);
+    }
+}
+
+esp_err_t audio_jitter_init(audio_jitter_t* jb, const audio_jitter_config_t* config, uint8_t* storage)
+{
+    if (jb == NULL || config == NULL || storage == NULL || config->capacity < 2 || config->capacity > AUDIO_JITTER_MAX_SLOTS || config->max_payload == 0 ||
+        config->sample_rate == 0 || config->min_depth_ms > config->max_depth_ms) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(jb, 0, sizeof(*jb));
+    jb->config = *config;
+    jb->storage = storage;
+    return ESP_OK;
+}
+
+void audio_jitter_reset(audio_jitter_t* jb)
+{
+    flush(jb);
+    stream_ended(jb);
+    jb->have_seq = false;
+}
+
+bool audio_jitter_put(audio_jitter_t* jb, const audio_jitter_packet_t* packet, int64_t now_us)
+{
+    if (packet->data == NULL || packet->len == 0 || packet->len > jb->config.max_payload || packet->samples == 0) {
+        return false;
+    }
+
+    expire(jb, now_us);
+
+    const int32_t capacity = jb->config.capacity;
+    const int32_t reset_span = capacity * JITTER_RESET_SPAN;
+    int32_t diff = (int32_t)(packet->seq - jb->next_seq);
+
+    if (!jb->active) {
+        // 刚结束的流的迟到包不能开始新的流
+        if (jb->have_seq && diff < 0 && diff > -reset_span && now_us - jb->last_arrival_us <= (int64_t)jb->config.idle_ms * 1000) {
+            jb->stats.late++;
+            return false;
+        }
+        start_stream(jb, packet, now_us);
+    }
+    else if (diff >= reset_span || diff <= -reset_span) {
+        start_stream(jb, packet, now_us);
+    }
+    else if (diff < 0) {
+        if (jb->playing) {
+            jb->stats.late++;
+            add_boost(jb, samples_to_us(jb, jb->last_samples) / 2);
+            return false;
+        }
+        // 预缓冲期间可以接收更早的包，前提是缓存的包仍在窗口内
+        for (int32_t i = 0; i < capacity; i++) {
+            const audio_jitter_slot_t* slot = &jb->slots[i];
+            if (slot->used && (int32_t)(slot->seq - packet->seq) >= capacity) {
+                jb->stats.late++;
+                return false;
+            }
+        }
+        jb->next_seq = packet->seq;
+        jb->next_ts = packet->timestamp;
+    }
+
+    // 超出窗口：挤出最早的包
+    while ((int32_t)(packet->seq - jb->next_seq) >= capacity) {
+        if (skip_next(jb)) {
+            jb->stats.overflow++;
+        }
+        else {
+            jb->stats.lost++;
+        }
+    }
+
+    audio_jitter_slot_t* slot = slot_of(jb, packet->seq);
+    if (slot->used) {
+        jb->stats.duplicate++;
+        return false;
+    }
+    memcpy(payload_of(jb, packet->seq), packet->data, packet->len);
+    slot->used = true;
+    slot->last = packet->last;
+    slot->format = packet->format;
+    slot->seq = packet->seq;
+    slot->timestamp = packet->timestamp;
+    slot->samples = packet->samples;
+    slot->len = packet->len;
+    jb->count++;
+    jb->buffered_samples += packet->samples;
+    if (!packet->last || jb->last_samples == 0) {
+        jb->last_samples = packet->samples;
+    }
+    jb->stats.received++;
+
+    // RFC 3550 到达间隔抖动：J += (|D| - J) / 16，D 为相邻两个包传输时间之差
+    int64_t transit = now_us - samples_to_us(jb, (int32_t)(packet->timestamp - jb->base_ts));
+    if (jb->have_transit) {
+        int64_t d = transit - jb->last_transit_us;
+        if (d < 0) {
+            d = -d;
+        }
+        jb->jitter_us = (uint32_t)((int64_t)jb->jitter_us + (d - (int64_t)jb->jitter_us) / 16);
+    }
+    jb->last_transit_us = transit;
+    jb->have_transit = true;
+    jb->last_arrival_us = now_us;
+    jb->boost_us -= jb->boost_us / JITTER_BOOST_DECAY;
+    return true;
+}
+
+audio_jitter_result_t audio_jitter_get(audio_jitter_t* jb, int64_t now_us, audio_jitter_packet_t* packet)
+{
+    expire(jb, now_us);
+    if (!jb->active || (!jb->playing && jb->count == 0)) {
+        return AUDIO_JITTER_EMPTY;
+    }
+
+    if (!jb->playing) {
+        int64_t target = target_us(jb);
+        bool ready = samples_to_us(jb, jb->buffered_samples) >= target || now_us - jb->prebuffer_start_us >= target || jb->count >= jb->config.capacity;
+        for (uint8_t i = 0; i < jb->config.capacity && !ready; i++) {
+            ready = jb->slots[i].used && jb->slots[i].last;  // 整段语音已经收齐
+        }
+        if (!ready) {
+            return AUDIO_JITTER_EMPTY;
+        }
+        jb->playing = true;
+        jb->over_target_run = 0;
+    }
+
+    audio_jitter_slot_t* slot = slot_of(jb, jb->next_seq);
+    if (slot->used && slot->seq == jb->next_seq) {
+        copy_out(jb, slot, packet);
+        release(jb, slot);
+        jb->next_seq++;
+        jb->next_ts = slot->timestamp + slot->samples;
+
+        if (slot->last && jb->count == 0) {
+            stream_ended(jb);
+            return AUDIO_JITTER_PACKET;
+        }
+
+        // 持续超过目标深度（例如发送端突发或时钟偏快）时丢弃一个包以降低延迟
+        int64_t target = target_us(jb);
+        int64_t margin = samples_to_us(jb, jb->last_samples);
+        if (margin < target / 2) {
+            margin = target / 2;
+        }
+        if (samples_to_us(jb, jb->buffered_samples) > target + margin) {
+            if (++jb->over_target_run >= JITTER_DROP_RUN) {
+                audio_jitter_slot_t* next = slot_of(jb, jb->next_seq);
+                if (next->used && next->seq == jb->next_seq && !next->last) {
+                    skip_next(jb);
+                    jb->stats.dropped++;
+                }
+                jb->over_target_run = 0;
+            }
+        }
+        else {
+            jb->over_target_run = 0;
+        }
+        return AUDIO_JITTER_PACKET;
+    }
+
+    if (jb->count > 0) {
+        // 下一个包缺失而后面的包已经到达：按最早到达的后续包的时间戳把间隔平均分给缺失的包
+        uint32_t missing = UINT32_MAX;
+        uint32_t gap = 0;
+        for (uint8_t i = 0; i < jb->config.capacity; i++) {
+            const audio_jitter_slot_t* s = &jb->slots[i];
+            if (s->used && s->seq - jb->next_seq < missing) {
+                missing = s->seq - jb->next_seq;
+                gap = s->timestamp - jb->next_ts;
+            }
+        }
+        uint32_t samples = ((int32_t)gap > 0) ? gap / missing : jb->last_samples;
+        if (samples == 0) {
+            samples = jb->last_samples;
+        }
+        packet->seq = jb->next_seq;
+        packet->timestamp = jb->next_ts;
+        packet->samples = samples > UINT16_MAX ? UINT16_MAX : (uint16_t)samples;
+        packet->len = 0;
+        packet->last = false;
+        packet->data = NULL;
+        jb->next_seq++;
+        jb->next_ts += packet->samples;
+        jb->stats.lost++;
+        return AUDIO_JITTER_LOST;
+    }
+
+    // 播放中缓冲耗尽：重新预缓冲并加大目标深度
+    jb->playing = false;
+    jb->prebuffer_start_us = now_us;
+    jb->stats.underruns++;
+    add_boost(jb, samples_to_us(jb, jb->last_samples));
+    return AUDIO_JITTER_UNDERRUN;
+}
+
+bool audio_jitter_peek(audio_jitter_t* jb, uint32_t seq, audio_jitter_packet_t* packet)
+{
+    const audio_jitter_slot_t* slot = slot_of(jb, seq);
+    if (!slot->used || slot->seq != seq) {
+        return false;
+    }
+    copy_out(jb, slot, packet);
+    return true;
+}
+
+void audio_jitter_get_stats(const audio_jitter_t* jb, audio_jitter_stats_t* stats)
+{
+    *stats = jb->stats;
+    stats->depth = jb->count;
+    stats->depth_ms = (uint32_t)(samples_to_us(jb, jb->buffered_samples) / 1000);
+    stats->target_ms = (uint32_t)(target_us(jb) / 1000);
+    stats->jitter_ms = jb->jitter_us / 1000;
+    stats->playing = jb->playing;
+}
+
+void audio_plc_init(audio_plc_t* plc, uint32_t sample_rate)
+{
+    memset(plc, 0, sizeof(*plc));
+    plc->window = sample_rate / 100;  // 10 ms
+    if (plc->window > AUDIO_PLC_HISTORY / 3) {
+        plc->window = AUDIO_PLC_HISTORY / 3;
+    }
+    plc->min_lag = sample_rate / 400;  // 基音 66 - 400 Hz
+    plc->max_lag = sample_rate / 66;
+    if (plc->max_lag > AUDIO_PLC_HISTORY - plc->window) {
+        plc->max_lag = AUDIO_PLC_HISTORY - plc->window;
+    }
+    if (plc->min_lag < 2) {
+        plc->min_lag = 2;
+    }
+    if (plc->min_lag > plc->max_lag) {
+        plc->min_lag = plc->max_lag;
+    }
+    plc->hold = sample_rate / 100;  // 10 ms
+    plc->fade = sample_rate / 20;   // 50 ms
+    plc->overlap = sample_rate / 500 > 0 ? sample_rate / 500 : 1;  // 2 ms
+}
+
+void audio_plc_reset(audio_plc_t* plc)
+{
+    memset(plc->history, 0, sizeof(plc->history));
+    plc->filled = 0;
+    plc->concealing = false;
+}
+
+/**
+ * @brief 在历史末尾的窗口上按归一化自相关搜索基音周期
+ * @return 周期样本数，历史不足时返回 0（输出静音）
+ */
+static uint16_t find_period(const audio_plc_t* plc)
+{
+    if (plc->filled < plc->window + plc->min_lag) {
+        return 0;
+    }
+    uint16_t max_lag = plc->max_lag;
+    if (max_lag > plc->filled - plc->window) {
+        max_lag = plc->filled - plc->window;
+    }
+
+    const int16_t* x = plc->history + AUDIO_PLC_HISTORY - plc->window;
+    uint16_t best = max_lag;
+    float best_score = 0.0f;
+    for (uint16_t lag = plc->min_lag; lag <= max_lag; lag++) {
+        int64_t corr = 0;
+        int64_t energy = 0;
+        for (uint16_t i = 0; i < plc->window; i++) {
+            int32_t y = x[i - lag];
+            corr += (int32_t)x[i] * y;
+            energy += y * y;
+        }
+        if (corr > 0 && energy > 0) {
+            float score = (float)corr * (float)corr / (float)energy;
+            if (score > best_score) {
+                best_score = score;
+                best = lag;
+            }
+        }
+    }
+    return best;
+}
+
+static int16_t next_concealed(audio_plc_t* plc)
+{
+    uint32_t run = plc->run++;
+    if (plc->period == 0 || run >= (uint32_t)plc->hold + plc->fade) {
+        return 0;
+    }
+    int32_t sample = plc->history[AUDIO_PLC_HISTORY - plc->period + run % plc->period];
+    if (run >= plc->hold) {
+        sample = sample * (int32_t)(plc->hold + plc->fade - run) / plc->fade;
+    }
+    return (int16_t)sample;
+}
+
+void audio_plc_good(audio_plc_t* plc, int16_t* pcm, size_t count)
+{
+    if (count == 0) {
+        return;
+    }
+
+    if (plc->concealing) {
+        // 从隐藏波形交叉淡化到正常样本，避免恢复时的跳变
+        size_t n = count < plc->overlap ? count : plc->overlap;
+        for (size_t i = 0; i < n; i++) {
+            int32_t concealed = next_concealed(plc);
+            pcm[i] = (int16_t)(((int32_t)pcm[i] * (int32_t)(i + 1) + concealed * (int32_t)(n - i - 1)) / (int32_t)n);
+        }
+        plc->concealing = false;
+    }
+
+    if (count >= AUDIO_PLC_HISTORY) {
+        memcpy(plc->history, pcm + count - AUDIO_PLC_HISTORY, sizeof(plc->history));
+        plc->filled = AUDIO_PLC_HISTORY;
+    }
+    else {
+        memmove(plc->history, plc->history + count, (AUDIO_PLC_HISTORY - count) * sizeof(int16_t));
+        memcpy(plc->history + AUDIO_PLC_HISTORY - count, pcm, count * sizeof(int16_t));
+        plc->filled = plc->filled + count > AUDIO_PLC_HISTORY ? AUDIO_PLC_HISTORY : (uint16_t)(plc->filled + count);
+    }
+}
+
+void audio_plc_conceal(audio_plc_t* plc, int16_t* out, size_t count)
+{
+    if (!plc->concealing) {
+        plc->period = find_period(plc);
+        plc->run = 0;
+        plc->concealing = true;
+        plc->events++;
+    }
+    for (size_t i = 0; i < count; i++) {
+        out[i] = next_concealed(plc);
+    }
+    plc->concealed_samples += count;
+}
@@ -0,0 +1,229 @@
+/*
+ * audio_jitter.h
+ * 音频抖动缓冲与丢包隐藏：按序号重排接收到的音频包，按网络抖动自适应调整缓冲深度，
+ * 丢弃迟到的包；丢失的包用最近一个基音周期的波形重复并逐渐衰减来填补
+ *
+ * 抖动缓冲只保存编码后的数据，由播放方按序取出后解码；丢包隐藏工作在解码后的 16-bit PCM 上。
+ * 本模块不依赖 FreeRTOS 与音频驱动，可在 Linux 主机上单独编译。
+ */
+
+#ifndef AUDIO_JITTER_H
+#define AUDIO_JITTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_JITTER_MAX_SLOTS 32  // 最多缓存的包数
+#define AUDIO_PLC_HISTORY 480      // 丢包隐藏保存的历史样本数（16 kHz 下 30 ms）
+
+/**
+ * @brief 抖动缓冲配置
+ */
+typedef struct
+{
+    uint8_t capacity;       // 槽位数 2 - AUDIO_JITTER_MAX_SLOTS，序号超前超过该数时最早的包被挤出
+    uint16_t max_payload;   // 每个包的最大字节数
+    uint32_t sample_rate;   // 采样率，用于把时间戳（样本数）换算为时间
+    uint16_t min_depth_ms;  // 自适应目标深度的下限
+    uint16_t max_depth_ms;  // 自适应目标深度的上限
+    uint16_t idle_ms;       // 缓冲为空且超过该时间没有收到包时认为流已结束，下一个包开始新的流
+} audio_jitter_config_t;
+
+/**
+ * @brief 一个音频包
+ */
+typedef struct
+{
+    uint32_t seq;        // 序号，连续递增（可回绕）
+    uint32_t timestamp;  // 第一个样本的时间戳（样本数）
+    uint16_t samples;    // 解码后的样本数；取出丢失的包时为需要隐藏的样本数
+    uint16_t len;        // 数据字节数
+    bool last;           // 一段语音的最后一个包，播完后不计为欠载
+    uint8_t format;      // 载荷格式，原样保存，由调用方解释
+    const uint8_t* data;  // 数据，取出时指向缓冲内部，在下一次放入或取出前有效；丢失的包为 NULL
+} audio_jitter_packet_t;
+
+/**
+ * @brief 取包结果
+ */
+typedef enum {
+    AUDIO_JITTER_EMPTY = 0,  // 没有可播放的内容（空闲或正在预缓冲）
+    AUDIO_JITTER_PACKET,     // 取出下一个包
+    AUDIO_JITTER_LOST,       // 下一个包丢失，需要隐藏 samples 个样本
+    AUDIO_JITTER_UNDERRUN,   // 播放中缓冲耗尽，重新预缓冲；调用方应淡出
+} audio_jitter_result_t;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct
+{
+    uint32_t received;    // 放入的包数
+    uint32_t late;        // 已播放（或已隐藏）后才到达而丢弃的包数
+    uint32_t duplicate;   // 重复的包数
+    uint32_t lost;        // 播放时缺失、被隐藏的包数
+    uint32_t overflow;    // 缓冲满时被挤出的包数
+    uint32_t dropped;     // 为降低延迟主动丢弃的包数
+    uint32_t underruns;   // 播放中缓冲耗尽的次数
+    uint32_t streams;     // 开始的流（语音段）数
+    uint8_t depth;        // 当前缓存的包数
+    uint32_t depth_ms;    // 当前缓存的时长
+    uint32_t target_ms;   // 当前目标深度
+    uint32_t jitter_ms;   // 到达时间抖动估计
+    bool playing;         // 是否正在播放（预缓冲完成）
+} audio_jitter_stats_t;
+
+/**
+ * @brief 槽位
+ */
+typedef struct
+{
+    bool used;
+    bool last;
+    uint8_t format;
+    uint16_t samples;
+    uint16_t len;
+    uint32_t seq;
+    uint32_t timestamp;
+} audio_jitter_slot_t;
+
+/**
+ * @brief 抖动缓冲实例
+ */
+typedef struct
+{
+    audio_jitter_config_t config;
+    audio_jitter_slot_t slots[AUDIO_JITTER_MAX_SLOTS];
+    uint8_t* storage;             // capacity * max_payload 字节
+    bool active;                  // 是否有流（active 为 false 时 next_seq 仍用于判断迟到的包）
+    bool playing;                 // 预缓冲完成，按序取出
+    bool have_seq;                // next_seq 是否有效
+    uint32_t next_seq;            // 下一个要播放的序号
+    uint32_t next_ts;             // 下一个要播放的时间戳
+    uint8_t count;                // 缓存的包数
+    uint32_t buffered_samples;    // 缓存的总样本数
+    uint16_t last_samples;        // 最近一个包的样本数，用于估计丢失包的时长
+    int64_t last_arrival_us;      // 最近一次放入的时间
+    int64_t prebuffer_start_us;   // 开始预缓冲的时间
+    uint32_t base_ts;             // 流开始时的时间戳，传输时间相对于它计算
+    bool have_transit;
+    int64_t last_transit_us;      // 上一个包的传输时间（到达时间 - 时间戳），只有差值有意义
+    uint32_t jitter_us;           // RFC 3550 平滑抖动估计
+    uint32_t boost_us;            // 迟到与欠载时增加的目标深度，随后逐渐衰减
+    uint8_t over_target_run;      // 连续超过目标深度的取包次数
+    audio_jitter_stats_t stats;
+} audio_jitter_t;
+
+/**
+ * @brief 初始化抖动缓冲
+ * @param jb 实例
+ * @param config 配置
+ * @param storage 数据存储，至少 capacity * max_payload 字节
+ * @return esp_err_t
+ */
+esp_err_t audio_jitter_init(audio_jitter_t* jb, const audio_jitter_config_t* config, uint8_t* storage);
+
+/**
+ * @brief 清空缓冲，下一个包开始新的流（统计保留）
+ * @param jb 实例
+ */
+void audio_jitter_reset(audio_jitter_t* jb);
+
+/**
+ * @brief 放入一个收到的包（复制数据）
+ * @param jb 实例
+ * @param packet 包，data 指向 len 字节数据
+ * @param now_us 到达时间
+ * @return 保存返回 true；迟到、重复或无效的包返回 false
+ */
+bool audio_jitter_put(audio_jitter_t* jb, const audio_jitter_packet_t* packet, int64_t now_us);
+
+/**
+ * @brief 取下一段要播放的内容，应在上一段即将播完时调用
+ *
+ * 预缓冲达到目标深度（或等待超过目标深度的时间）后开始播放；下一个序号缺失而缓冲中有后续的包时返回丢失，
+ * 缓冲完全耗尽时返回欠载并重新预缓冲。持续超过目标深度时丢弃一个包以降低延迟。
+ *
+ * @param jb 实例
+ * @param now_us 当前时间
+ * @param packet 输出包
+ * @return 取包结果
+ */
+audio_jitter_result_t audio_jitter_get(audio_jitter_t* jb, int64_t now_us, audio_jitter_packet_t* packet);
+
+/**
+ * @brief 查看一个已缓存的包而不取出（例如用后一个包的前向纠错数据恢复丢失的包）
+ * @param jb 实例
+ * @param seq 序号
+ * @param packet 输出包，data 在下一次放入或取出前有效
+ * @return 包已缓存返回 true
+ */
+bool audio_jitter_peek(audio_jitter_t* jb, uint32_t seq, audio_jitter_packet_t* packet);
+
+/**
+ * @brief 获取统计信息
+ * @param jb 实例
+ * @param stats 输出统计信息
+ */
+void audio_jitter_get_stats(const audio_jitter_t* jb, audio_jitter_stats_t* stats);
+
+/**
+ * @brief 丢包隐藏实例
+ */
+typedef struct
+{
+    int16_t history[AUDIO_PLC_HISTORY];  // 最近正常播放的样本
+    uint16_t filled;                     // history 中有效的样本数（末尾对齐）
+    uint16_t min_lag;                    // 基音周期搜索范围
+    uint16_t max_lag;
+    uint16_t window;                     // 计算相关的窗口长度
+    uint16_t hold;                       // 开始衰减前保持原幅度的样本数
+    uint16_t fade;                       // 衰减到静音的样本数
+    uint16_t overlap;                    // 恢复时交叉淡化的样本数
+    bool concealing;                     // 正在隐藏
+    uint16_t period;                     // 当前重复的周期
+    uint32_t run;                        // 本次隐藏已输出的样本数
+    uint32_t events;                     // 隐藏次数
+    uint64_t concealed_samples;          // 隐藏的总样本数
+} audio_plc_t;
+
+/**
+ * @brief 初始化丢包隐藏
+ * @param plc 实例
+ * @param sample_rate 采样率
+ */
+void audio_plc_init(audio_plc_t* plc, uint32_t sample_rate);
+
+/**
+ * @brief 清除历史（新的流开始时调用，避免把上一段语音的波形延续到新的流）
+ * @param plc 实例
+ */
+void audio_plc_reset(audio_plc_t* plc);
+
+/**
+ * @brief 处理正常解码的样本：隐藏之后的第一段与隐藏波形交叉淡化，并记入历史
+ * @param plc 实例
+ * @param pcm 样本，原地修改
+ * @param count 样本数
+ */
+void audio_plc_good(audio_plc_t* plc, int16_t* pcm, size_t count);
+
+/**
+ * @brief 生成隐藏样本：重复最近一个基音周期的波形，保持 10 ms 后在 50 ms 内衰减到静音
+ * @param plc 实例
+ * @param out 输出样本
+ * @param count 样本数
+ */
+void audio_plc_conceal(audio_plc_t* plc, int16_t* out, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_JITTER_H */
@@ -0,0 +1,160 @@
+/*
+ * audio_opus.c
+ * 语音下行 Opus 解码实现
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+
+#include "audio_opus.h"
+
+#if CONFIG_AUDIO_OPUS
+#include "opus.h"
+
+static const char* TAG = "AUDIO_OPUS";
+
+#define OPUS_MIN_FRAME_DIV 400  // 最短帧 2.5 ms (1/400 s)，FEC/PLC 的样本数必须是它的整数倍
+
+static OpusDecoder* s_decoder = NULL;
+static uint32_t s_sample_rate = 0;
+static audio_opus_stats_t s_stats;
+
+esp_err_t audio_opus_init(uint32_t sample_rate)
+{
+    if (s_decoder != NULL) {
+        return ESP_OK;
+    }
+
+    int size = opus_decoder_get_size(1);
+    s_decoder = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (s_decoder == NULL) {
+        s_decoder = malloc(size);
+    }
+    if (s_decoder == NULL) {
+        ESP_LOGE(TAG, "无法分配Opus解码器 (%d 字节)", size);
+        return ESP_ERR_NO_MEM;
+    }
+
+    int err = opus_decoder_init(s_decoder, (opus_int32)sample_rate, 1);
+    if (err != OPUS_OK) {
+        ESP_LOGE(TAG, "Opus解码器初始化失败: %s", opus_strerror(err));
+        heap_caps_free(s_decoder);
+        s_decoder = NULL;
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_sample_rate = sample_rate;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.enabled = true;
+    s_stats.state_bytes = size;
+    ESP_LOGI(TAG, "Opus解码器已创建：%lu Hz，状态 %d 字节", (unsigned long)sample_rate, size);
+    return ESP_OK;
+}
+
+bool audio_opus_available(void)
+{
+    return s_decoder != NULL;
+}
+
+uint32_t audio_opus_samples(const uint8_t* data, size_t len)
+{
+    if (s_decoder == NULL || data == NULL || len == 0) {
+        return 0;
+    }
+    int n = opus_packet_get_nb_samples(data, (opus_int32)len, (opus_int32)s_sample_rate);
+    return n > 0 ? (uint32_t)n : 0;
+}
+
+uint32_t audio_opus_decode(const uint8_t* data, size_t len, int16_t* out, uint32_t max_samples)
+{
+    if (s_decoder == NULL) {
+        return 0;
+    }
+    int n = opus_decode(s_decoder, data, (opus_int32)len, out, (int)max_samples, 0);
+    if (n <= 0) {
+        s_stats.errors++;
+        return 0;
+    }
+    s_stats.frames++;
+    return (uint32_t)n;
+}
+
+uint32_t audio_opus_conceal(const uint8_t* next, size_t next_len, int16_t* out, uint32_t samples, uint32_t max_samples)
+{
+    if (s_decoder == NULL) {
+        return 0;
+    }
+
+    uint32_t unit = s_sample_rate / OPUS_MIN_FRAME_DIV;
+    uint32_t frame = (samples + unit - 1) / unit * unit;
+    uint32_t limit = max_samples / unit * unit;
+    if (frame > limit) {
+        frame = limit;
+    }
+
+    int n = opus_decode(s_decoder, next, next != NULL ? (opus_int32)next_len : 0, out, (int)frame, next != NULL ? 1 : 0);
+    if (n <= 0) {
+        s_stats.errors++;
+        return 0;
+    }
+    if (next != NULL) {
+        s_stats.fec++;
+    }
+    else {
+        s_stats.plc++;
+    }
+    return (uint32_t)n;
+}
+
+void audio_opus_reset(void)
+{
+    if (s_decoder != NULL) {
+        opus_decoder_ctl(s_decoder, OPUS_RESET_STATE);
+    }
+}
+
+void audio_opus_get_stats(audio_opus_stats_t* stats)
+{
+    *stats = s_stats;
+}
+
+#else
+
+esp_err_t audio_opus_init(uint32_t sample_rate)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+bool audio_opus_available(void)
+{
+    return false;
+}
+
+uint32_t audio_opus_samples(const uint8_t* data, size_t len)
+{
+    return 0;
+}
+
+uint32_t audio_opus_decode(const uint8_t* data, size_t len, int16_t* out, uint32_t max_samples)
+{
+    return 0;
+}
+
+uint32_t audio_opus_conceal(const uint8_t* next, size_t next_len, int16_t* out, uint32_t samples, uint32_t max_samples)
+{
+    return 0;
+}
+
+void audio_opus_reset(void)
+{
+}
+
+void audio_opus_get_stats(audio_opus_stats_t* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif
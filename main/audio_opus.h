@@ -0,0 +1,89 @@
+/*
+ * audio_opus.h
+ * 语音下行的 Opus 解码（CONFIG_AUDIO_OPUS，libopus 来自 IDF 组件 78/esp-opus）
+ *
+ * 单声道 16 kHz，解码器状态放在 PSRAM。丢包时若后一个包已经到达，用它携带的带内前向纠错 (FEC) 数据恢复丢失的帧，
+ * 否则由解码器自己做丢包隐藏 (PLC)；两者都延续解码器内部状态，比在解码后的 PCM 上隐藏更自然。
+ * 未启用时所有函数返回失败，Opus 包在解析时被当作无效包丢弃。解码器只在接收任务中使用，不加锁。
+ */
+
+#ifndef AUDIO_OPUS_H
+#define AUDIO_OPUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 统计信息
+ */
+typedef struct
+{
+    bool enabled;          // 编译时启用且解码器已创建
+    uint32_t state_bytes;  // 解码器状态大小
+    uint32_t frames;       // 正常解码的帧数
+    uint32_t fec;          // 用后一个包的 FEC 数据恢复的帧数
+    uint32_t plc;          // 解码器丢包隐藏的帧数
+    uint32_t errors;       // 解码失败的包数
+} audio_opus_stats_t;
+
+/**
+ * @brief 创建解码器（状态优先放在 PSRAM；已创建时直接返回）
+ * @param sample_rate 输出采样率
+ * @return esp_err_t 未启用时返回 ESP_ERR_NOT_SUPPORTED
+ */
+esp_err_t audio_opus_init(uint32_t sample_rate);
+
+/**
+ * @brief 解码器是否可用
+ */
+bool audio_opus_available(void);
+
+/**
+ * @brief 一个 Opus 包解码后的样本数
+ * @return 样本数，包无效或解码器不可用时返回 0
+ */
+uint32_t audio_opus_samples(const uint8_t* data, size_t len);
+
+/**
+ * @brief 解码一个包
+ * @param data 包
+ * @param len 长度
+ * @param out 输出
+ * @param max_samples out 的容量
+ * @return 输出的样本数，失败返回 0
+ */
+uint32_t audio_opus_decode(const uint8_t* data, size_t len, int16_t* out, uint32_t max_samples);
+
+/**
+ * @brief 生成丢失帧的样本：next 不为 NULL 时用其中的 FEC 数据恢复，否则由解码器隐藏
+ * @param next 丢失帧之后的一个包，没有时为 NULL
+ * @param next_len 长度
+ * @param out 输出
+ * @param samples 丢失的样本数，向上取整到 2.5 ms 的整数倍（不超过 max_samples）
+ * @param max_samples out 的容量
+ * @return 输出的样本数，失败返回 0
+ */
+uint32_t audio_opus_conceal(const uint8_t* next, size_t next_len, int16_t* out, uint32_t samples, uint32_t max_samples);
+
+/**
+ * @brief 重置解码器状态（新的流开始时调用）
+ */
+void audio_opus_reset(void);
+
+/**
+ * @brief 获取统计信息
+ * @param stats 输出统计信息
+ */
+void audio_opus_get_stats(audio_opus_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_OPUS_H */
@@ -1,16 +1,21 @@
 /*
  * audio_player.c
  * 音频播放器实现 - 使用 I2S 驱动 MAX98357 DAC
+ *
+ * 转换缓冲区与静音缓冲区在初始化时一次性分配（DMA 可访问的内部 RAM），播放路径上没有堆分配。
  */
 
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "driver/i2s_std.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_heap_caps.h"
 #include "audio_player.h"
+#include "pcm_convert.h"
 
 #include "wifi_connect.h"
 #include "wifi_beak.h"
@@ -26,9 +31,51 @@ static const char* TAG = "AUDIO_PLAYER";
 #define I2S_DOUT_IO 47
 #define I2S_MCLK_IO -1
 
+#define CONVERT_SAMPLES 1024  // 转换缓冲区的样本数，8-bit 数据按该大小分块转换后写入
+#define SILENCE_SAMPLES 512   // 静音缓冲区的样本数
+#define STOP_SILENCE_BYTES 4096  // 停止时写入的静音，覆盖 DMA 缓冲区中的旧数据
+
 static i2s_chan_handle_t tx_chan = NULL;
 static bool i2s_initialized = false;
 
+// 预分配的缓冲区；s_write_lock 保证转换缓冲区与 I2S 写入不被多个任务交错使用
+static int16_t* s_convert_buf = NULL;
+static int16_t* s_silence_buf = NULL;
+static SemaphoreHandle_t s_write_lock = NULL;
+
+static void free_buffers(void)
+{
+    heap_caps_free(s_convert_buf);
+    heap_caps_free(s_silence_buf);
+    s_convert_buf = NULL;
+    s_silence_buf = NULL;
+    if (s_write_lock != NULL) {
+        vSemaphoreDelete(s_write_lock);
+        s_write_lock = NULL;
+    }
+}
+
+/**
+ * @brief 8-bit 数据分块转换到预分配的缓冲区并写入 I2S
+ */
+static esp_err_t write_u8(const uint8_t* data, size_t size)
+{
+    size_t bytes_written;
+    size_t offset = 0;
+    while (offset < size) {
+        size_t n = (size - offset > CONVERT_SAMPLES) ? CONVERT_SAMPLES : (size - offset);
+        xSemaphoreTake(s_write_lock, portMAX_DELAY);
+        pcm_u8_to_s16(data + offset, s_convert_buf, n);
+        esp_err_t ret = i2s_channel_write(tx_chan, s_convert_buf, n * sizeof(int16_t), &bytes_written, portMAX_DELAY);
+        xSemaphoreGive(s_write_lock);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        offset += n;
+    }
+    return ESP_OK;
+}
+
 // 音频数据数组 - 定义在 res/wifi_connect_audio.c, res/wifi_beak_audio.c, res/wifi_reset_audio.c
 extern const uint8_t wifi_connect_audio[];
 extern const uint8_t wifi_beak_audio[];
@@ -43,11 +90,22 @@ esp_err_t audio_player_init(void)
 
     esp_err_t ret;
 
+    // Step 0: 分配转换与静音缓冲区（之后的播放不再分配内存）
+    s_convert_buf = heap_caps_malloc(CONVERT_SAMPLES * sizeof(int16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    s_silence_buf = heap_caps_calloc(SILENCE_SAMPLES, sizeof(int16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    s_write_lock = xSemaphoreCreateMutex();
+    if (s_convert_buf == NULL || s_silence_buf == NULL || s_write_lock == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate audio buffers");
+        free_buffers();
+        return ESP_ERR_NO_MEM;
+    }
+
     // Step 1: 创建 I2S 通道
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM, I2S_ROLE_MASTER);
     ret = i2s_new_channel(&chan_cfg, &tx_chan, NULL);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create I2S channel: %s", esp_err_to_name(ret));
+        free_buffers();
         return ret;
     }
 
@@ -75,6 +133,7 @@ esp_err_t audio_player_init(void)
     ret = i2s_channel_init_std_mode(tx_chan, &std_cfg);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize I2S std mode: %s", esp_err_to_name(ret));
+        free_buffers();
         return ret;
     }
 
@@ -82,6 +141,7 @@ esp_err_t audio_player_init(void)
     ret = i2s_channel_enable(tx_chan);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to enable I2S channel: %s", esp_err_to_name(ret));
+        free_buffers();
         return ret;
     }
 
@@ -114,6 +174,7 @@ esp_err_t audio_player_deinit(void)
     }
 
     tx_chan = NULL;
+    free_buffers();
     i2s_initialized = false;
     ESP_LOGI(TAG, "Audio player deinitialized successfully");
     return ESP_OK;
@@ -131,29 +192,13 @@ esp_err_t audio_player_play(uint8_t* audio_data, size_t data_size)
         return ESP_ERR_INVALID_STATE;
     }
 
-    // 将 8-bit PCM 转换为 16-bit PCM
-    uint16_t* buffer = malloc(data_size * 2);
-    if (buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate audio buffer");
-        return ESP_ERR_NO_MEM;
-    }
-
-    for (size_t i = 0; i < data_size; i++) {
-        // 将 8-bit unsigned 转换为 16-bit signed
-        int16_t sample = ((int16_t)audio_data[i] - 128) * 256;
-        buffer[i] = (uint16_t)sample;
-    }
-
-    // 播放转换后的数据
-    size_t bytes_written;
-    esp_err_t ret = i2s_channel_write(tx_chan, buffer, data_size * 2, &bytes_written, portMAX_DELAY);
+    // 分块转换为 16-bit PCM 并播放
+    esp_err_t ret = write_u8(audio_data, data_size);
     if (ret != ESP_OK) {
-        free(buffer);
         ESP_LOGE(TAG, "Failed to write audio data: %s", esp_err_to_name(ret));
         return ret;
     }
 
-    free(buffer);
     return ESP_OK;
 }
 
@@ -172,15 +217,13 @@ esp_err_t audio_player_stop()
     //     vTaskDelay(pdMS_TO_TICKS(audio_duration_ms));
     // }
 
-    // 发送静音数据覆盖 DMA 缓冲区
-    size_t silence_size = 4096;  // 4KB 静音数据
-    uint16_t* silence_buffer = malloc(silence_size);
-    if (silence_buffer != NULL) {
-        memset(silence_buffer, 0, silence_size);  // 全0表示静音
-        size_t bytes_written;
-        i2s_channel_write(tx_chan, silence_buffer, silence_size, &bytes_written, portMAX_DELAY);
-        free(silence_buffer);
+    // 发送静音数据覆盖 DMA 缓冲区（复用初始化时分配的全 0 缓冲区）
+    size_t bytes_written;
+    xSemaphoreTake(s_write_lock, portMAX_DELAY);
+    for (size_t sent = 0; sent < STOP_SILENCE_BYTES; sent += SILENCE_SAMPLES * sizeof(int16_t)) {
+        i2s_channel_write(tx_chan, s_silence_buf, SILENCE_SAMPLES * sizeof(int16_t), &bytes_written, portMAX_DELAY);
     }
+    xSemaphoreGive(s_write_lock);
     return ESP_OK;
 }
 
@@ -195,44 +238,34 @@ esp_err_t audio_player_play_stream(uint8_t* audio_data, size_t data_size)
         return ESP_ERR_INVALID_STATE;
     }
 
-    // 将音频数据流式发送到I2S接口
-    // 使用更大的块大小以提高性能
-    size_t bytes_written;
-    size_t offset = 0;
-    const size_t chunk_size = 2048;  // 使用2KB的块大小
-
-    while (offset < data_size) {
-        size_t current_chunk = (data_size - offset > chunk_size) ? chunk_size : (data_size - offset);
-
-        // 将 8-bit PCM 转换为 16-bit PCM
-        uint16_t* buffer = malloc(current_chunk * 2);
-        if (buffer == NULL) {
-            ESP_LOGE(TAG, "Failed to allocate audio buffer");
-            return ESP_ERR_NO_MEM;
-        }
+    // 将音频数据流式发送到I2S接口（分块转换，不分配内存）
+    esp_err_t ret = write_u8(audio_data, data_size);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write audio data: %s", esp_err_to_name(ret));
+        return ret;
+    }
 
-        for (size_t i = 0; i < current_chunk; i++) {
-            // 将 8-bit unsigned 转换为 16-bit signed
-            int16_t sample = ((int16_t)audio_data[offset + i] - 128) * 256;
-            buffer[i] = (uint16_t)sample;
-        }
+    // 播放完成后停止并发送静音
+    audio_player_stop();
 
-        // 播放扩展后的数据
-        esp_err_t ret = i2s_channel_write(tx_chan, buffer, current_chunk * 2, &bytes_written, portMAX_DELAY);
-        if (ret != ESP_OK) {
-            free(buffer);
-            ESP_LOGE(TAG, "Failed to write audio data: %s", esp_err_to_name(ret));
-            return ret;
-        }
+    return ESP_OK;
+}
 
-        offset += current_chunk;
-        free(buffer);
+esp_err_t audio_player_write_pcm16(const int16_t* samples, size_t count, uint32_t timeout_ms)
+{
+    if (samples == NULL || count == 0) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    // 播放完成后停止并发送静音
-    audio_player_stop(data_size);
+    if (!i2s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
 
-    return ESP_OK;
+    size_t bytes_written;
+    xSemaphoreTake(s_write_lock, portMAX_DELAY);
+    esp_err_t ret = i2s_channel_write(tx_chan, samples, count * sizeof(int16_t), &bytes_written, pdMS_TO_TICKS(timeout_ms));
+    xSemaphoreGive(s_write_lock);
+    return ret;
 }
 
 esp_err_t audio_player_play_wifi_status(int status)
@@ -38,6 +38,15 @@ esp_err_t audio_player_stop();
  */
 esp_err_t audio_player_play_stream(uint8_t* audio_data, size_t data_size);
 
+/**
+ * @brief 写入 16-bit PCM 样本（不追加静音，供连续播放的任务使用）
+ * @param samples 样本
+ * @param count 样本数
+ * @param timeout_ms 等待 DMA 缓冲区空闲的最长时间
+ * @return esp_err_t 未初始化时返回 ESP_ERR_INVALID_STATE
+ */
+esp_err_t audio_player_write_pcm16(const int16_t* samples, size_t count, uint32_t timeout_ms);
+
 /**
  * @brief 去初始化音频播放功能
  * @return esp_err_t
@@ -0,0 +1,86 @@
+/*
+ * audio_ring.c
+ * 单生产者/单消费者无锁字节环形缓冲实现
+ */
+
+#include <string.h>
+
+#include "audio_ring.h"
+
+esp_err_t audio_ring_init(audio_ring_t* ring, uint8_t* storage, uint32_t size, uint32_t low_water, uint32_t high_water)
+{
+    if (ring == NULL || storage == NULL || size == 0 || (size & (size - 1)) != 0 || low_water >= high_water || high_water > size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    ring->buf = storage;
+    ring->size = size;
+    ring->low_water = low_water;
+    ring->high_water = high_water;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return ESP_OK;
+}
+
+bool audio_ring_write(audio_ring_t* ring, const void* data, uint32_t len)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (len > ring->size - (head - tail)) {
+        atomic_fetch_add_explicit(&ring->overruns, 1, memory_order_relaxed);
+        return false;
+    }
+
+    uint32_t pos = head & (ring->size - 1);
+    uint32_t first = ring->size - pos < len ? ring->size - pos : len;
+    memcpy(ring->buf + pos, data, first);
+    memcpy(ring->buf, (const uint8_t*)data + first, len - first);
+    atomic_store_explicit(&ring->head, head + len, memory_order_release);
+
+    uint32_t level = head + len - tail;
+    if (level > atomic_load_explicit(&ring->peak, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->peak, level, memory_order_relaxed);
+    }
+    return true;
+}
+
+uint32_t audio_ring_read(audio_ring_t* ring, void* out, uint32_t len)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t level = head - tail;
+    if (len > level) {
+        len = level;
+    }
+
+    uint32_t pos = tail & (ring->size - 1);
+    uint32_t first = ring->size - pos < len ? ring->size - pos : len;
+    memcpy(out, ring->buf + pos, first);
+    memcpy((uint8_t*)out + first, ring->buf, len - first);
+    atomic_store_explicit(&ring->tail, tail + len, memory_order_release);
+    return len;
+}
+
+uint32_t audio_ring_level(audio_ring_t* ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return head - tail;
+}
+
+void audio_ring_count_underrun(audio_ring_t* ring)
+{
+    atomic_fetch_add_explicit(&ring->underruns, 1, memory_order_relaxed);
+}
+
+void audio_ring_get_stats(audio_ring_t* ring, audio_ring_stats_t* stats)
+{
+    stats->size = ring->size;
+    stats->level = audio_ring_level(ring);
+    stats->peak = atomic_load_explicit(&ring->peak, memory_order_relaxed);
+    stats->low_water = ring->low_water;
+    stats->high_water = ring->high_water;
+    stats->overruns = atomic_load_explicit(&ring->overruns, memory_order_relaxed);
+    stats->underruns = atomic_load_explicit(&ring->underruns, memory_order_relaxed);
+}
@@ -0,0 +1,105 @@
+/*
+ * audio_ring.h
+ * 单生产者/单消费者无锁字节环形缓冲，带高/低水位与欠载/溢出计数
+ *
+ * 生产者只推进 head，消费者只推进 tail，二者都是累计字节数，容量为 2 的幂时回绕后取模仍然正确。
+ * 水位由使用方解释（audio_stream.c：低于低水位开始补充、补充到高水位为止，播放在达到高水位后开始）。
+ * 本模块不依赖 FreeRTOS，可在 Linux 主机上单独编译；唤醒由使用方负责。
+ */
+
+#ifndef AUDIO_RING_H
+#define AUDIO_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 统计信息（字节）
+ */
+typedef struct
+{
+    uint32_t size;        // 容量
+    uint32_t level;       // 当前数据量
+    uint32_t peak;        // 历史最大数据量
+    uint32_t low_water;
+    uint32_t high_water;
+    uint32_t overruns;    // 空间不足而丢弃的写入次数
+    uint32_t underruns;   // 输出中读空的次数
+} audio_ring_stats_t;
+
+/**
+ * @brief 环形缓冲
+ */
+typedef struct
+{
+    uint8_t* buf;
+    uint32_t size;          // 容量，2 的幂
+    uint32_t low_water;
+    uint32_t high_water;
+    _Atomic uint32_t head;  // 累计写入字节数（仅生产者修改）
+    _Atomic uint32_t tail;  // 累计读出字节数（仅消费者修改）
+    _Atomic uint32_t peak;
+    _Atomic uint32_t overruns;
+    _Atomic uint32_t underruns;
+} audio_ring_t;
+
+/**
+ * @brief 初始化
+ * @param ring 环形缓冲
+ * @param storage 预先分配的存储
+ * @param size 容量，须为 2 的幂
+ * @param low_water 低水位
+ * @param high_water 高水位，须大于低水位且不超过容量
+ * @return esp_err_t
+ */
+esp_err_t audio_ring_init(audio_ring_t* ring, uint8_t* storage, uint32_t size, uint32_t low_water, uint32_t high_water);
+
+/**
+ * @brief 写入（仅生产者调用），空间不足时整块丢弃并计入溢出
+ * @param ring 环形缓冲
+ * @param data 数据
+ * @param len 字节数
+ * @return 写入返回 true
+ */
+bool audio_ring_write(audio_ring_t* ring, const void* data, uint32_t len);
+
+/**
+ * @brief 读出（仅消费者调用）
+ * @param ring 环形缓冲
+ * @param out 输出
+ * @param len 最多读出的字节数
+ * @return 读出的字节数
+ */
+uint32_t audio_ring_read(audio_ring_t* ring, void* out, uint32_t len);
+
+/**
+ * @brief 当前数据量（任一方均可调用，结果是调用时刻的快照）
+ * @param ring 环形缓冲
+ * @return 字节数
+ */
+uint32_t audio_ring_level(audio_ring_t* ring);
+
+/**
+ * @brief 记一次欠载（消费者在输出中读空时调用）
+ * @param ring 环形缓冲
+ */
+void audio_ring_count_underrun(audio_ring_t* ring);
+
+/**
+ * @brief 获取统计信息
+ * @param ring 环形缓冲
+ * @param stats 输出统计信息
+ */
+void audio_ring_get_stats(audio_ring_t* ring, audio_ring_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_RING_H */
@@ -0,0 +1,528 @@
+/*
+ * audio_stream.c
+ * PC 语音下行实现
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+#include "audio_stream.h"
+#include "audio_player.h"
+#include "audio_codec.h"
+#include "audio_opus.h"
+
+static const char* TAG = "AUDIO_STREAM";
+
+#define AUDIO_SAMPLE_RATE 16000       // 与 audio_player.c 的 I2S 采样率一致
+#define AUDIO_MAX_DATAGRAM 1400       // PC 端的分包大小
+#define AUDIO_HEADER_SIZE 12          // packet_id, total_packets, audio_size
+#define AUDIO_MAX_PAYLOAD (AUDIO_MAX_DATAGRAM - AUDIO_HEADER_SIZE)
+#define AUDIO_MAX_SAMPLES AUDIO_MAX_DATAGRAM  // 一个包解码后的最大样本数，决定解码缓冲与环形缓冲的容量
+#define AUDIO_V2_MAGIC 0x4155         // "AU"
+#define AUDIO_V2_VERSION 1
+#define AUDIO_V2_HEADER_SIZE 16       // magic, version, codec, flags, reserved, samples, seq, timestamp
+#define AUDIO_V2_FLAG_LAST 0x01       // 一段语音的最后一个包
+#define AUDIO_IDLE_MS 1000            // 缓冲为空且超过该时间没有收到包时认为一段语音结束
+#define AUDIO_WRITE_TIMEOUT_MS 1000   // 等待 I2S DMA 缓冲区的最长时间
+#define AUDIO_SILENCE_SAMPLES 2048    // 停止播放时写入的静音，覆盖 DMA 缓冲区中的旧数据
+#define AUDIO_OUT_SAMPLES 256         // 播放任务每次从环形缓冲读出的样本数 (16 ms)
+#define AUDIO_BYTES_PER_MS (AUDIO_SAMPLE_RATE / 1000 * sizeof(int16_t))
+
+/**
+ * @brief 一段语音在连续序号空间中的位置
+ */
+typedef struct
+{
+    bool valid;
+    bool raw;           // 没有包头的数据报组成的段
+    uint32_t total;     // 段的包数（raw 段为已收到的包数）
+    uint32_t size;      // 段的字节数（raw 段为已收到的字节数）
+    uint32_t base_seq;  // 段的第一个包映射到的序号
+    uint32_t base_ts;   // 段的第一个样本的时间戳
+} audio_clip_t;
+
+static TaskHandle_t s_task = NULL;
+static uint8_t* s_storage = NULL;
+static uint8_t* s_ring_buf = NULL;
+
+// 接收任务与播放任务之间只通过环形缓冲与以下原子量通信
+static audio_ring_t s_ring;
+static atomic_bool s_producing;           // 抖动缓冲正在输出，环形缓冲读空算作欠载
+static _Atomic uint32_t s_write_errors;  // 写入 I2S 失败的次数（播放任务）
+
+// 以下只由接收任务访问
+static audio_jitter_t s_jitter;
+static audio_clip_t s_clips[2];  // 当前段与上一段（上一段的迟到包仍映射到原来的序号）
+static audio_plc_t s_plc;
+static int16_t s_pcm[AUDIO_MAX_SAMPLES] __attribute__((aligned(4)));
+static uint32_t s_conceal_left = 0;  // 尚未写入环形缓冲的隐藏样本数
+static bool s_filling = false;       // 低于低水位后补充到高水位
+static uint32_t s_streams = 0;
+static uint32_t s_datagrams = 0;
+static uint32_t s_raw = 0;
+static uint32_t s_invalid = 0;
+static uint32_t s_codec_packets[AUDIO_CODEC_COUNT] = {0};
+static uint64_t s_played_samples = 0;
+static uint8_t s_last_format = AUDIO_CODEC_PCM8;  // 最近播放的包的编码，决定丢包时用哪种隐藏
+static uint64_t s_decode_us = 0;
+static uint32_t s_decode_count = 0;
+static uint32_t s_decode_max_us = 0;
+static uint64_t s_core_us[AUDIO_STREAM_MAX_CORES] = {0};      // 各核上的累计解码耗时
+static uint64_t s_core_window_us[AUDIO_STREAM_MAX_CORES] = {0};  // 统计窗口开始时的累计值
+static uint16_t s_core_load[AUDIO_STREAM_MAX_CORES] = {0};
+static int64_t s_window_start_us = 0;
+
+// 以下只由播放任务访问
+static int16_t s_out[AUDIO_OUT_SAMPLES];
+
+// 接收任务发布的统计快照
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static audio_stream_stats_t s_stats;
+
+static uint32_t read_be32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint16_t read_be16(const uint8_t* p)
+{
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+/**
+ * @brief magic 与版本吻合的数据报只按编码包解析
+ */
+static bool is_v2_packet(const uint8_t* data, size_t len)
+{
+    return len > 2 && read_be16(data) == AUDIO_V2_MAGIC && data[2] == AUDIO_V2_VERSION;
+}
+
+/**
+ * @brief 解析编码包头：保留字段为 0，样本数与编码、载荷长度吻合（避免把原始 PCM 或旧包头误当作编码包头）
+ */
+static bool parse_v2_header(const uint8_t* data, size_t len, audio_jitter_packet_t* packet)
+{
+    if (len <= AUDIO_V2_HEADER_SIZE || len > AUDIO_MAX_DATAGRAM) {
+        return false;
+    }
+    if (read_be16(data) != AUDIO_V2_MAGIC || data[2] != AUDIO_V2_VERSION || (data[4] & ~AUDIO_V2_FLAG_LAST) != 0 || data[5] != 0) {
+        return false;
+    }
+
+    uint8_t codec = data[3];
+    uint16_t samples = read_be16(data + 6);
+    const uint8_t* payload = data + AUDIO_V2_HEADER_SIZE;
+    uint32_t expected = codec == AUDIO_CODEC_OPUS ? audio_opus_samples(payload, len - AUDIO_V2_HEADER_SIZE) : audio_codec_samples(codec, len - AUDIO_V2_HEADER_SIZE);
+    if (samples == 0 || samples > AUDIO_MAX_SAMPLES || samples != expected) {
+        return false;
+    }
+
+    packet->format = codec;
+    packet->samples = samples;
+    packet->last = (data[4] & AUDIO_V2_FLAG_LAST) != 0;
+    packet->seq = read_be32(data + 8);
+    packet->timestamp = read_be32(data + 12);
+    packet->data = payload;
+    packet->len = len - AUDIO_V2_HEADER_SIZE;
+    return true;
+}
+
+/**
+ * @brief 解析包头并检查与按固定长度分包是否吻合（避免把原始 PCM 误当作包头）
+ *
+ * 除最后一个包外每个包的数据长度相同：非最后的包满足 payload * (total - 1) < audio_size <= payload * total，
+ * 最后一个包之前的字节数是前面每个包长度的整数倍。
+ */
+static bool parse_header(const uint8_t* data, size_t len, uint32_t* id, uint32_t* total, uint32_t* size)
+{
+    if (len <= AUDIO_HEADER_SIZE || len > AUDIO_MAX_DATAGRAM) {
+        return false;
+    }
+    *id = read_be32(data);
+    *total = read_be32(data + 4);
+    *size = read_be32(data + 8);
+
+    uint32_t payload = len - AUDIO_HEADER_SIZE;
+    if (*total == 0 || *id >= *total || *size < payload) {
+        return false;
+    }
+    if (*id < *total - 1) {
+        return (uint64_t)payload * (*total - 1) < *size && *size <= (uint64_t)payload * *total;
+    }
+    uint32_t before = *size - payload;
+    if (*id == 0) {
+        return before == 0;
+    }
+    return before % *id == 0 && before / *id >= payload && before / *id <= AUDIO_MAX_PAYLOAD;
+}
+
+/**
+ * @brief 查找数据报所属的段，新的段接在当前段之后
+ */
+static audio_clip_t* clip_for(bool raw, uint32_t total, uint32_t size)
+{
+    for (int i = 0; i < (raw ? 1 : 2); i++) {
+        audio_clip_t* clip = &s_clips[i];
+        if (clip->valid && clip->raw == raw && (raw || (clip->total == total && clip->size == size))) {
+            return clip;
+        }
+    }
+
+    audio_clip_t next = {.valid = true, .raw = raw, .total = raw ? 0 : total, .size = raw ? 0 : size};
+    if (s_clips[0].valid) {
+        next.base_seq = s_clips[0].base_seq + s_clips[0].total;
+        next.base_ts = s_clips[0].base_ts + s_clips[0].size;
+    }
+    s_clips[1] = s_clips[0];
+    s_clips[0] = next;
+    return &s_clips[0];
+}
+
+/**
+ * @brief 记录一次解码（或 Opus 丢包恢复）的耗时，按所在的核累计
+ */
+static void account_decode(int64_t start_us)
+{
+    uint32_t us = (uint32_t)(esp_timer_get_time() - start_us);
+    s_decode_us += us;
+    s_decode_count++;
+    if (us > s_decode_max_us) {
+        s_decode_max_us = us;
+    }
+    int core = xPortGetCoreID();
+    if (core < AUDIO_STREAM_MAX_CORES) {
+        s_core_us[core] += us;
+    }
+}
+
+static void publish_stats(void)
+{
+    // 每秒更新一次各核上解码占用的比例
+    int64_t now_us = esp_timer_get_time();
+    if (now_us - s_window_start_us >= 1000000) {
+        for (int i = 0; i < AUDIO_STREAM_MAX_CORES; i++) {
+            s_core_load[i] = (uint16_t)((s_core_us[i] - s_core_window_us[i]) * 1000 / (uint64_t)(now_us - s_window_start_us));
+            s_core_window_us[i] = s_core_us[i];
+        }
+        s_window_start_us = now_us;
+    }
+
+    audio_stream_stats_t stats = {0};
+    audio_jitter_get_stats(&s_jitter, &stats.jitter);
+    stats.datagrams = s_datagrams;
+    stats.raw = s_raw;
+    stats.invalid = s_invalid;
+    memcpy(stats.codec_packets, s_codec_packets, sizeof(stats.codec_packets));
+    stats.played_ms = (uint32_t)(s_played_samples * 1000 / AUDIO_SAMPLE_RATE);
+    stats.concealed_ms = (uint32_t)(s_plc.concealed_samples * 1000 / AUDIO_SAMPLE_RATE);
+    stats.plc_events = s_plc.events;
+    stats.decode_us_per_s = s_played_samples > 0 ? (uint32_t)(s_decode_us * AUDIO_SAMPLE_RATE / s_played_samples) : 0;
+    stats.decode_avg_us = s_decode_count > 0 ? (uint32_t)(s_decode_us / s_decode_count) : 0;
+    stats.decode_max_us = s_decode_max_us;
+    memcpy(stats.decode_load_permille, s_core_load, sizeof(stats.decode_load_permille));
+    audio_opus_get_stats(&stats.opus);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats = stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+/**
+ * @brief 解码一个包到 s_pcm
+ * @return 样本数，失败返回 0
+ */
+static uint32_t decode(const audio_jitter_packet_t* packet)
+{
+    int64_t start_us = esp_timer_get_time();
+    uint32_t n;
+    if (packet->format == AUDIO_CODEC_OPUS) {
+        n = audio_opus_decode(packet->data, packet->len, s_pcm, AUDIO_MAX_SAMPLES);
+    }
+    else {
+        n = audio_codec_decode(packet->format, packet->data, packet->len, s_pcm);
+    }
+    account_decode(start_us);
+    return n;
+}
+
+/**
+ * @brief 用 Opus 解码器生成丢失帧到 s_pcm：后一个包已经缓存时用它的 FEC 数据恢复，否则由解码器隐藏
+ * @return 样本数，失败返回 0
+ */
+static uint32_t conceal_opus(uint32_t seq, uint32_t samples)
+{
+    audio_jitter_packet_t next;
+    bool have_next = audio_jitter_peek(&s_jitter, seq + 1, &next) && next.format == AUDIO_CODEC_OPUS;
+    int64_t start_us = esp_timer_get_time();
+    uint32_t n = audio_opus_conceal(have_next ? next.data : NULL, have_next ? next.len : 0, s_pcm, samples, AUDIO_MAX_SAMPLES);
+    account_decode(start_us);
+    return n;
+}
+
+/**
+ * @brief 低于低水位时按序从抖动缓冲取包（或生成隐藏样本）写入环形缓冲，直到高水位
+ *
+ * 每次只在环形缓冲低于高水位时写入不超过一个包的样本，容量按高水位加一个最大包分配，因此不会溢出。
+ */
+static void fill_ring(void)
+{
+    if (audio_ring_level(&s_ring) < s_ring.low_water) {
+        s_filling = true;
+    }
+
+    bool wrote = false;
+    int64_t now_us = esp_timer_get_time();
+    while (s_filling) {
+        if (audio_ring_level(&s_ring) >= s_ring.high_water) {
+            s_filling = false;
+            break;
+        }
+
+        if (s_conceal_left > 0) {
+            uint32_t n = s_conceal_left < AUDIO_MAX_SAMPLES ? s_conceal_left : AUDIO_MAX_SAMPLES;
+            audio_plc_conceal(&s_plc, s_pcm, n);
+            wrote |= audio_ring_write(&s_ring, s_pcm, n * sizeof(int16_t));
+            s_conceal_left -= n;
+            continue;
+        }
+
+        audio_jitter_packet_t packet;
+        audio_jitter_result_t result = audio_jitter_get(&s_jitter, now_us, &packet);
+        if (result == AUDIO_JITTER_PACKET) {
+            if (s_jitter.stats.streams != s_streams) {
+                s_streams = s_jitter.stats.streams;
+                audio_plc_reset(&s_plc);
+                audio_opus_reset();
+            }
+            s_last_format = packet.format;
+            uint32_t n = decode(&packet);
+            if (n == 0) {
+                // 放入时已检查过长度，只有包头被篡改或 Opus 数据损坏时才会发生：按丢包隐藏
+                s_conceal_left = packet.samples;
+                continue;
+            }
+            audio_plc_good(&s_plc, s_pcm, n);
+            wrote |= audio_ring_write(&s_ring, s_pcm, n * sizeof(int16_t));
+            s_played_samples += n;
+            atomic_store(&s_producing, true);
+        }
+        else if (result == AUDIO_JITTER_LOST) {
+            atomic_store(&s_producing, true);
+            uint32_t n = s_last_format == AUDIO_CODEC_OPUS ? conceal_opus(packet.seq, packet.samples) : 0;
+            if (n == 0) {
+                s_conceal_left = packet.samples;
+                continue;
+            }
+            // 解码器输出的隐藏样本同样记入历史，之后欠载时从这里淡出
+            audio_plc_good(&s_plc, s_pcm, n);
+            wrote |= audio_ring_write(&s_ring, s_pcm, n * sizeof(int16_t));
+        }
+        else if (result == AUDIO_JITTER_UNDERRUN) {
+            // 淡出到静音，播放任务播完环形缓冲中的剩余数据后停止，抖动缓冲重新预缓冲
+            s_conceal_left = s_plc.hold + s_plc.fade;
+            atomic_store(&s_producing, false);
+        }
+        else {
+            atomic_store(&s_producing, false);
+            break;
+        }
+    }
+
+    if (wrote) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+void audio_stream_receive(const uint8_t* data, size_t len)
+{
+    if (s_task == NULL || data == NULL || len == 0) {
+        return;
+    }
+
+    s_datagrams++;
+    audio_jitter_packet_t packet = {0};
+    uint32_t id, total, size;
+    if (is_v2_packet(data, len)) {
+        // 未启用 Opus 时的 Opus 包、未知编码或样本数不符：丢弃，不退回旧格式或原始 PCM 当作噪声播放
+        if (!parse_v2_header(data, len, &packet)) {
+            s_invalid++;
+            publish_stats();
+            return;
+        }
+        s_codec_packets[packet.format]++;
+    }
+    else if (parse_header(data, len, &id, &total, &size)) {
+        const audio_clip_t* clip = clip_for(false, total, size);
+        packet.len = len - AUDIO_HEADER_SIZE;
+        packet.data = data + AUDIO_HEADER_SIZE;
+        packet.seq = clip->base_seq + id;
+        packet.timestamp = clip->base_ts + (id == total - 1 ? size - packet.len : id * packet.len);
+        packet.last = id == total - 1;
+        packet.samples = packet.len;  // 8-bit PCM：每字节一个样本
+        s_codec_packets[AUDIO_CODEC_PCM8]++;
+    }
+    else if (len <= AUDIO_MAX_DATAGRAM) {
+        audio_clip_t* clip = clip_for(true, 0, 0);
+        packet.len = len;
+        packet.data = data;
+        packet.seq = clip->base_seq + clip->total;
+        packet.timestamp = clip->base_ts + clip->size;
+        clip->total++;
+        clip->size += len;
+        packet.samples = packet.len;
+        s_raw++;
+        s_codec_packets[AUDIO_CODEC_PCM8]++;
+    }
+    else {
+        s_invalid++;
+        publish_stats();
+        return;
+    }
+    audio_jitter_put(&s_jitter, &packet, esp_timer_get_time());
+
+    fill_ring();
+    publish_stats();
+}
+
+void audio_stream_poll(void)
+{
+    if (s_task == NULL) {
+        return;
+    }
+    fill_ring();
+    publish_stats();
+}
+
+static void write_pcm(const int16_t* pcm, size_t count)
+{
+    esp_err_t ret = audio_player_write_pcm16(pcm, count, AUDIO_WRITE_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        ESP_LOGD(TAG, "写入I2S失败: %s", esp_err_to_name(ret));
+        atomic_fetch_add(&s_write_errors, 1);
+        vTaskDelay(pdMS_TO_TICKS(100));  // 播放器未初始化时不空转
+    }
+}
+
+/**
+ * @brief 播放任务：环形缓冲达到高水位（或接收端不再输出）后开始，I2S 写入阻塞到 DMA 缓冲区有空间为止
+ */
+static void playout_task(void* arg)
+{
+    bool running = false;   // 正在从环形缓冲输出
+    bool sounding = false;  // 最近写入的是音频，停止时需要用静音覆盖 DMA 缓冲区
+
+    while (true) {
+        if (!running) {
+            uint32_t level = audio_ring_level(&s_ring);
+            if (level >= s_ring.high_water || (level > 0 && !atomic_load(&s_producing))) {
+                running = true;
+            }
+            else {
+                if (sounding) {
+                    memset(s_out, 0, sizeof(s_out));
+                    for (size_t left = AUDIO_SILENCE_SAMPLES; left > 0; left -= AUDIO_OUT_SAMPLES) {
+                        write_pcm(s_out, AUDIO_OUT_SAMPLES);
+                    }
+                    sounding = false;
+                }
+                ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(AUDIO_STREAM_POLL_MS));
+                continue;
+            }
+        }
+
+        uint32_t n = audio_ring_read(&s_ring, s_out, sizeof(s_out));
+        if (n == 0) {
+            // 接收端仍在输出却没有及时补充：欠载，重新等待高水位
+            if (atomic_load(&s_producing)) {
+                audio_ring_count_underrun(&s_ring);
+            }
+            running = false;
+            continue;
+        }
+        write_pcm(s_out, n / sizeof(int16_t));
+        sounding = true;
+    }
+}
+
+esp_err_t audio_stream_init(void)
+{
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+
+    // 环形缓冲容量：高水位加一个最大包，向上取 2 的幂
+    uint32_t low_water = CONFIG_AUDIO_RING_LOW_MS * AUDIO_BYTES_PER_MS;
+    uint32_t high_water = CONFIG_AUDIO_RING_HIGH_MS * AUDIO_BYTES_PER_MS;
+    uint32_t ring_size = 1;
+    while (ring_size < high_water + AUDIO_MAX_SAMPLES * sizeof(int16_t)) {
+        ring_size <<= 1;
+    }
+
+    size_t size = (size_t)CONFIG_AUDIO_JITTER_SLOTS * AUDIO_MAX_DATAGRAM;
+    s_storage = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (s_storage == NULL) {
+        s_storage = malloc(size);
+    }
+    s_ring_buf = heap_caps_malloc(ring_size, MALLOC_CAP_INTERNAL);
+    if (s_storage == NULL || s_ring_buf == NULL) {
+        ESP_LOGE(TAG, "无法分配抖动缓冲 (%u 字节) 与环形缓冲 (%u 字节)", (unsigned)size, (unsigned)ring_size);
+        goto fail;
+    }
+
+    audio_jitter_config_t config = {
+        .capacity = CONFIG_AUDIO_JITTER_SLOTS,
+        .max_payload = AUDIO_MAX_DATAGRAM,
+        .sample_rate = AUDIO_SAMPLE_RATE,
+        .min_depth_ms = CONFIG_AUDIO_JITTER_MIN_MS,
+        .max_depth_ms = CONFIG_AUDIO_JITTER_MAX_MS,
+        .idle_ms = AUDIO_IDLE_MS,
+    };
+    if (audio_jitter_init(&s_jitter, &config, s_storage) != ESP_OK || audio_ring_init(&s_ring, s_ring_buf, ring_size, low_water, high_water) != ESP_OK) {
+        ESP_LOGE(TAG, "抖动缓冲或环形缓冲配置无效");
+        goto fail;
+    }
+    audio_plc_init(&s_plc, AUDIO_SAMPLE_RATE);
+#if CONFIG_AUDIO_OPUS
+    if (audio_opus_init(AUDIO_SAMPLE_RATE) != ESP_OK) {
+        ESP_LOGW(TAG, "Opus解码器不可用，Opus包将被丢弃");
+    }
+#endif
+    atomic_init(&s_producing, false);
+    atomic_init(&s_write_errors, 0);
+
+    if (xTaskCreate(playout_task, "audio_playout", 4096, NULL, 4, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "创建播放任务失败");
+        goto fail;
+    }
+
+    ESP_LOGI(TAG, "语音下行已启动：抖动缓冲 %d 个包，目标深度 %d-%d ms；环形缓冲 %u 字节，水位 %d/%d ms", CONFIG_AUDIO_JITTER_SLOTS, CONFIG_AUDIO_JITTER_MIN_MS,
+             CONFIG_AUDIO_JITTER_MAX_MS, (unsigned)ring_size, CONFIG_AUDIO_RING_LOW_MS, CONFIG_AUDIO_RING_HIGH_MS);
+    return ESP_OK;
+
+fail:
+    heap_caps_free(s_storage);
+    heap_caps_free(s_ring_buf);
+    s_storage = NULL;
+    s_ring_buf = NULL;
+    return ESP_ERR_NO_MEM;
+}
+
+void audio_stream_get_stats(audio_stream_stats_t* stats)
+{
+    if (s_task == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+    audio_ring_get_stats(&s_ring, &stats->ring);
+    stats->write_errors = atomic_load(&s_write_errors);
+}
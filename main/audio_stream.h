@@ -0,0 +1,87 @@
+/*
+ * audio_stream.h
+ * PC 语音下行 - 解析 UDP 音频包，经抖动缓冲 (audio_jitter.h) 重排
+ *
+ * 接收任务拥有抖动缓冲：放入收到的包，并在 PCM 环形缓冲 (audio_ring.h) 低于低水位时按序取包、解码、
+ * 丢包隐藏，补充到高水位；播放任务只从环形缓冲读出并写入 I2S。两者之间没有锁，网络接收从不等待 DAC。
+ *
+ * 编码包格式（网络字节序，audio_sender.py 发送）：magic u16 "AU", version u8 (1), codec u8 (audio_codec_t), flags u8 (bit0 段的最后一个包),
+ * reserved u8, samples u16（解码后的样本数，不超过 1400）, seq u32, timestamp u32（样本数，16 kHz），之后是编码后的载荷
+ * (audio_codec.h；Opus 每包一帧，见 audio_opus.h)。以 magic 与版本开头而包头无效的数据报（如未启用 Opus 时的 Opus 包）计入 invalid 丢弃。
+ *
+ * 旧音频包格式：packet_id u32, total_packets u32, audio_size u32, 8-bit 无符号 PCM (16 kHz)。
+ * 一段语音的 packet_id 从 0 开始，除最后一个包外每个包的数据长度相同，时间戳由此推算；
+ * 不同的段按 (total_packets, audio_size) 区分并映射为连续的序号。没有包头的数据报按到达顺序播放。
+ */
+
+#ifndef AUDIO_STREAM_H
+#define AUDIO_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "audio_jitter.h"
+#include "audio_ring.h"
+#include "audio_codec.h"
+#include "audio_opus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_STREAM_MAX_CORES 2  // 分核统计解码占用的核数
+#define AUDIO_STREAM_POLL_MS 10  // 接收任务没有收到包时调用 audio_stream_poll() 的间隔（接收超时）
+
+/**
+ * @brief 统计信息
+ */
+typedef struct
+{
+    audio_jitter_stats_t jitter;
+    audio_ring_stats_t ring;  // PCM 环形缓冲（字节，16 kHz 16-bit 下 32 字节/ms）
+    uint32_t datagrams;       // 收到的数据报数
+    uint32_t raw;             // 没有包头、按到达顺序播放的数据报数
+    uint32_t invalid;         // 超长或包头无效而丢弃的数据报数
+    uint32_t codec_packets[AUDIO_CODEC_COUNT];  // 各编码收到的数据报数（旧格式与无包头的计为 8-bit PCM）
+    uint32_t concealed_ms;    // 丢包隐藏输出的时长
+    uint32_t plc_events;      // 丢包隐藏次数
+    uint32_t played_ms;       // 解码输出的正常音频时长
+    uint32_t decode_us_per_s;  // 每秒音频的平均解码耗时 (us)
+    uint32_t decode_avg_us;    // 每个包的平均解码耗时（解码延迟）
+    uint32_t decode_max_us;    // 单个包的最长解码耗时
+    uint16_t decode_load_permille[AUDIO_STREAM_MAX_CORES];  // 最近 1 秒内解码在各核上占用的时间比例 (‰)
+    audio_opus_stats_t opus;   // Opus 解码与 FEC/PLC 统计
+    uint32_t write_errors;    // 写入 I2S 失败的次数
+} audio_stream_stats_t;
+
+/**
+ * @brief 分配抖动缓冲与环形缓冲并启动播放任务（已初始化时直接返回）
+ * @return esp_err_t
+ */
+esp_err_t audio_stream_init(void);
+
+/**
+ * @brief 放入收到的一个数据报并补充环形缓冲（只在接收任务中调用，不等待 I2S）
+ * @param data 数据报
+ * @param len 长度
+ */
+void audio_stream_receive(const uint8_t* data, size_t len);
+
+/**
+ * @brief 没有收到包时补充环形缓冲（只在接收任务中调用，间隔不超过 AUDIO_STREAM_POLL_MS）
+ *
+ * 预缓冲超时、丢包判定与欠载淡出都在取包时发生，因此接收空闲时也要定期调用。
+ */
+void audio_stream_poll(void);
+
+/**
+ * @brief 获取统计信息（未初始化时输出全 0）
+ * @param stats 输出统计信息
+ */
+void audio_stream_get_stats(audio_stream_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_STREAM_H */
@@ -0,0 +1,188 @@
+/*
+ * bitrate_ctrl.c
+ * 闭环自适应码率控制实现
+ */
+
+#include <string.h>
+
+#include "bitrate_ctrl.h"
+
+// 帧大小与发送耗时的平滑系数 1/4
+#define BITRATE_CTRL_EMA_SHIFT 2
+// 发送耗时占帧周期的比例上限/下限（百分比），超过上限说明链路跟不上目标帧率
+#define BITRATE_CTRL_SEND_HIGH_PCT 90
+#define BITRATE_CTRL_SEND_LOW_PCT 60
+
+static uint8_t clamp_quality(const bitrate_ctrl_config_t* config, int quality)
+{
+    if (quality < config->quality_min) {
+        return config->quality_min;
+    }
+    if (quality > config->quality_max) {
+        return config->quality_max;
+    }
+    return (uint8_t)quality;
+}
+
+esp_err_t bitrate_ctrl_init(bitrate_ctrl_t* ctrl, const bitrate_ctrl_config_t* config, const bitrate_ctrl_setting_t* initial)
+{
+    if (ctrl == NULL || config == NULL || initial == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->levels == 0 || config->quality_min > config->quality_max || config->quality_step == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(ctrl, 0, sizeof(*ctrl));
+    ctrl->config = *config;
+    if (ctrl->config.confirm_frames == 0) {
+        ctrl->config.confirm_frames = 1;
+    }
+    ctrl->setting.quality = clamp_quality(config, initial->quality);
+    ctrl->setting.level = initial->level < config->levels ? initial->level : config->levels - 1;
+    ctrl->since_change = config->hold_frames;  // 启动后无需等待即可调整
+    ctrl->stats.setting = ctrl->setting;
+    return ESP_OK;
+}
+
+void bitrate_ctrl_set_target(bitrate_ctrl_t* ctrl, uint32_t target_bps, uint32_t target_fps)
+{
+    ctrl->config.target_bps = target_bps;
+    ctrl->config.target_fps = target_fps;
+    ctrl->over_count = 0;
+    ctrl->under_count = 0;
+}
+
+/**
+ * @brief 降低码率：先提高质量数值（降低画质），到上限后降一档分辨率
+ */
+static bool step_down(bitrate_ctrl_t* ctrl)
+{
+    const bitrate_ctrl_config_t* config = &ctrl->config;
+    if (ctrl->setting.quality < config->quality_max) {
+        ctrl->setting.quality = clamp_quality(config, ctrl->setting.quality + config->quality_step);
+        return true;
+    }
+    if (ctrl->setting.level > 0) {
+        // 分辨率减半左右，同时回收一部分画质，避免在低分辨率上停留在最差质量
+        ctrl->setting.level--;
+        ctrl->setting.quality = clamp_quality(config, config->quality_max - 4 * config->quality_step);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 提高码率：先降低质量数值（提高画质），到下限后升一档分辨率
+ */
+static bool step_up(bitrate_ctrl_t* ctrl)
+{
+    const bitrate_ctrl_config_t* config = &ctrl->config;
+    if (ctrl->setting.quality > config->quality_min) {
+        ctrl->setting.quality = clamp_quality(config, ctrl->setting.quality - config->quality_step);
+        return true;
+    }
+    if (ctrl->setting.level + 1 < config->levels) {
+        // 升分辨率时先用较低画质，避免帧大小突增
+        ctrl->setting.level++;
+        ctrl->setting.quality = clamp_quality(config, config->quality_min + 4 * config->quality_step);
+        return true;
+    }
+    return false;
+}
+
+bool bitrate_ctrl_observe(bitrate_ctrl_t* ctrl, const bitrate_ctrl_sample_t* sample, bitrate_ctrl_setting_t* setting)
+{
+    const bitrate_ctrl_config_t* config = &ctrl->config;
+    uint32_t bits = sample->frame_bytes * 8;
+
+    // 平滑帧大小与发送耗时；调整参数后的第一帧重新取样
+    if (!ctrl->avg_valid) {
+        ctrl->avg_bits = bits;
+        ctrl->avg_send_us = sample->send_us;
+        ctrl->avg_valid = true;
+    }
+    else {
+        ctrl->avg_bits += ((int32_t)bits - (int32_t)ctrl->avg_bits) >> BITRATE_CTRL_EMA_SHIFT;
+        ctrl->avg_send_us += ((int32_t)sample->send_us - (int32_t)ctrl->avg_send_us) >> BITRATE_CTRL_EMA_SHIFT;
+    }
+    if (ctrl->since_change < UINT16_MAX) {
+        ctrl->since_change++;
+    }
+
+    float fps = config->target_fps > 0 ? (float)config->target_fps : sample->fps;
+    uint32_t demand_bps = fps > 0 ? (uint32_t)((float)ctrl->avg_bits * fps) : 0;
+    uint32_t period_us = fps > 0 ? (uint32_t)(1000000.0f / fps) : 0;
+
+    bool congested = sample->send_errors > 0 || (config->loss_high_permille > 0 && sample->loss_permille >= config->loss_high_permille);
+    bool send_slow = period_us > 0 && (uint64_t)ctrl->avg_send_us * 100 > (uint64_t)period_us * BITRATE_CTRL_SEND_HIGH_PCT;
+    bool send_fast = period_us == 0 || (uint64_t)ctrl->avg_send_us * 100 < (uint64_t)period_us * BITRATE_CTRL_SEND_LOW_PCT;
+    uint64_t high = (uint64_t)config->target_bps * (100 + config->deadband_pct) / 100;
+    uint64_t low = (uint64_t)config->target_bps * (100 - config->deadband_pct) / 100;
+
+    bool over = congested || send_slow || (config->target_bps > 0 && demand_bps > high);
+    bool under = !over && send_fast && sample->loss_permille < config->loss_high_permille / 2 && (config->target_bps == 0 || demand_bps < low);
+
+    ctrl->over_count = over ? (ctrl->over_count < UINT8_MAX ? ctrl->over_count + 1 : UINT8_MAX) : 0;
+    ctrl->under_count = under ? (ctrl->under_count < UINT8_MAX ? ctrl->under_count + 1 : UINT8_MAX) : 0;
+
+    ctrl->stats.demand_bps = demand_bps;
+    ctrl->stats.avg_frame_bytes = ctrl->avg_bits / 8;
+    ctrl->stats.avg_send_us = ctrl->avg_send_us;
+    if (congested) {
+        ctrl->stats.congestion_frames++;
+    }
+
+    // 滞回：调整后至少保持 hold_frames 帧，反向调整需要保持两倍时间
+    int8_t direction = 0;
+    if (ctrl->over_count >= config->confirm_frames) {
+        direction = -1;
+    }
+    else if (ctrl->under_count >= config->confirm_frames) {
+        direction = 1;
+    }
+    if (direction == 0) {
+        return false;
+    }
+    uint32_t hold = config->hold_frames;
+    if (ctrl->last_direction != 0 && direction != ctrl->last_direction) {
+        hold *= 2;
+    }
+    // 拥塞时尽快降码率，只保持四分之一的时间
+    if (direction < 0 && congested) {
+        hold /= 4;
+    }
+    if (ctrl->since_change < hold) {
+        return false;
+    }
+
+    bool changed = direction < 0 ? step_down(ctrl) : step_up(ctrl);
+    if (!changed) {
+        return false;
+    }
+
+    if (direction < 0) {
+        ctrl->stats.steps_down++;
+    }
+    else {
+        ctrl->stats.steps_up++;
+    }
+    ctrl->last_direction = direction;
+    ctrl->since_change = 0;
+    ctrl->over_count = 0;
+    ctrl->under_count = 0;
+    ctrl->avg_valid = false;
+    ctrl->stats.setting = ctrl->setting;
+    if (setting != NULL) {
+        *setting = ctrl->setting;
+    }
+    return true;
+}
+
+void bitrate_ctrl_get_stats(const bitrate_ctrl_t* ctrl, bitrate_ctrl_stats_t* stats)
+{
+    if (ctrl == NULL || stats == NULL) {
+        return;
+    }
+    *stats = ctrl->stats;
+}
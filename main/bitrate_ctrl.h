@@ -0,0 +1,126 @@
+/*
+ * bitrate_ctrl.h
+ * 闭环自适应码率控制：根据帧大小、发送耗时、发送错误与接收端丢包报告调整 JPEG 质量与分辨率
+ *
+ * 本模块不依赖 FreeRTOS 与相机驱动（分辨率以“档位”索引表示，由调用方映射为 framesize_t），
+ * 可在 Linux 主机上单独编译，用记录的帧大小轨迹回放验证控制行为。
+ */
+
+#ifndef BITRATE_CTRL_H
+#define BITRATE_CTRL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 控制器配置
+ */
+typedef struct
+{
+    uint32_t target_bps;         // 目标码率 (bit/s)
+    uint32_t target_fps;         // 目标帧率，0 表示使用样本中的实测帧率
+    uint8_t quality_min;         // 最好的 JPEG 质量（数值越小质量越高）
+    uint8_t quality_max;         // 最差的 JPEG 质量
+    uint8_t quality_step;        // 每次调整的质量步长
+    uint8_t levels;              // 分辨率档位数，档位 0 为最小分辨率
+    uint8_t deadband_pct;        // 目标码率上下的死区 (百分比)
+    uint8_t confirm_frames;      // 连续多少帧超出死区才动作
+    uint16_t hold_frames;        // 两次调整之间的最少帧数；反向调整需要两倍
+    uint16_t loss_high_permille;  // 接收端丢包率高于该值视为拥塞
+} bitrate_ctrl_config_t;
+
+/**
+ * @brief 编码参数
+ */
+typedef struct
+{
+    uint8_t quality;  // JPEG 质量
+    uint8_t level;    // 分辨率档位
+} bitrate_ctrl_setting_t;
+
+/**
+ * @brief 单帧观测样本
+ */
+typedef struct
+{
+    uint32_t frame_bytes;     // JPEG 帧大小
+    uint32_t send_us;         // 发送耗时
+    uint32_t send_errors;     // 本帧发送中出现的 socket 错误次数
+    uint16_t loss_permille;   // 接收端报告的丢包率，无报告时为 0
+    float fps;                // 实测帧率（target_fps 为 0 时使用）
+} bitrate_ctrl_sample_t;
+
+/**
+ * @brief 控制器统计信息
+ */
+typedef struct
+{
+    bitrate_ctrl_setting_t setting;  // 当前编码参数
+    uint32_t demand_bps;             // 按平滑后的帧大小与帧率估算的码率
+    uint32_t avg_frame_bytes;        // 平滑后的帧大小
+    uint32_t avg_send_us;            // 平滑后的发送耗时
+    uint32_t steps_down;             // 降低码率的调整次数
+    uint32_t steps_up;               // 提高码率的调整次数
+    uint32_t congestion_frames;      // 出现发送错误或高丢包的帧数
+} bitrate_ctrl_stats_t;
+
+/**
+ * @brief 控制器实例
+ */
+typedef struct
+{
+    bitrate_ctrl_config_t config;
+    bitrate_ctrl_setting_t setting;
+    uint32_t avg_bits;        // 帧大小滑动平均 (bit)
+    uint32_t avg_send_us;     // 发送耗时滑动平均
+    bool avg_valid;           // 调整后重新取样
+    uint8_t over_count;       // 连续高于死区的帧数
+    uint8_t under_count;      // 连续低于死区的帧数
+    uint16_t since_change;    // 距上次调整的帧数
+    int8_t last_direction;    // 上次调整方向: -1 降码率, +1 升码率, 0 无
+    bitrate_ctrl_stats_t stats;
+} bitrate_ctrl_t;
+
+/**
+ * @brief 初始化控制器
+ * @param ctrl 控制器实例
+ * @param config 配置
+ * @param initial 初始编码参数（会被限制在配置范围内）
+ * @return esp_err_t
+ */
+esp_err_t bitrate_ctrl_init(bitrate_ctrl_t* ctrl, const bitrate_ctrl_config_t* config, const bitrate_ctrl_setting_t* initial);
+
+/**
+ * @brief 运行时修改目标码率与帧率
+ * @param ctrl 控制器实例
+ * @param target_bps 目标码率 (bit/s)
+ * @param target_fps 目标帧率，0 表示使用实测帧率
+ */
+void bitrate_ctrl_set_target(bitrate_ctrl_t* ctrl, uint32_t target_bps, uint32_t target_fps);
+
+/**
+ * @brief 输入一帧的观测结果
+ * @param ctrl 控制器实例
+ * @param sample 观测样本
+ * @param setting 输出编码参数（返回 true 时为新的参数）
+ * @return 编码参数是否需要改变
+ */
+bool bitrate_ctrl_observe(bitrate_ctrl_t* ctrl, const bitrate_ctrl_sample_t* sample, bitrate_ctrl_setting_t* setting);
+
+/**
+ * @brief 获取统计信息
+ * @param ctrl 控制器实例
+ * @param stats 输出统计信息
+ */
+void bitrate_ctrl_get_stats(const bitrate_ctrl_t* ctrl, bitrate_ctrl_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BITRATE_CTRL_H */
@@ -4,6 +4,7 @@
 #include "freertos/FreeRTOS.h"  // 添加 FreeRTOS 核心头文件
 #include "freertos/task.h"      // 再添加 FreeRTOS 任务相关头文件
 #include "camera_app.h"         // 添加头文件引用
+#include "camera_ctrl.h"
 
 // 相机配置 - ESP32S3_EYE板型
 #define CAM_PIN_PWDN PWDN_GPIO_NUM
@@ -26,7 +27,8 @@
 
 static const char* TAG = "camera";  // 添加TAG用于日志输出
 
-static camera_config_t camera_config = {
+// 默认配置：XCLK、分辨率、JPEG质量、帧缓冲个数与取帧模式可在运行时修改并保存 (camera_ctrl.h)
+static const camera_config_t camera_config = {
     .pin_pwdn = CAM_PIN_PWDN,
     .pin_reset = CAM_PIN_RESET,
     .pin_xclk = CAM_PIN_XCLK,
@@ -54,9 +56,11 @@ static camera_config_t camera_config = {
                                      //   ESP32-S series has improved a lot, but JPEG mode always gives better frame rates.
 
     .jpeg_quality = 10,  // 0-63, for OV series camera sensors, lower number means higher quality
-    .fb_count = 2,       // When jpeg mode is used, if fb_count more than one, the driver will work in continuous mode.
+    // When jpeg mode is used, if fb_count more than one, the driver will work in continuous mode.
+    // Frames are shared by reference between consumers (frame_broker.h); see CAMERA_FB_COUNT for the buffers in flight.
+    .fb_count = CAMERA_FB_COUNT,
     .fb_location = CAMERA_FB_IN_PSRAM,
-    .grab_mode = CAMERA_GRAB_WHEN_EMPTY,  // CAMERA_GRAB_WHEN_EMPTY,  // CAMERA_GRAB_LATEST. Sets when buffers should be filled
+    .grab_mode = CAMERA_GRAB_LATEST,  // CAMERA_GRAB_WHEN_EMPTY,  // CAMERA_GRAB_LATEST. Sets when buffers should be filled
 };
 
 // 临时的process_image函数实现，后续可根据需要替换
@@ -82,16 +86,13 @@ esp_err_t camera_init()
         vTaskDelay(5 / portTICK_PERIOD_MS);  // 延迟等待电源稳定
     }
 
-    // initialize the camera
-    esp_err_t err = esp_camera_init(&camera_config);
+    // 按默认配置与 NVS 中保存的运行时参数初始化驱动，之后可通过 camera_ctrl_set() 不重启修改
+    esp_err_t err = camera_ctrl_init(&camera_config);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Camera Init Failed");
         return err;
     }
-    else {
-        ESP_LOGI(TAG, "Camera Init Success");
-    }
-
+    ESP_LOGI(TAG, "Camera Init Success");
     return ESP_OK;
 }
 
@@ -2,6 +2,16 @@
 #define CAMERA_APP_H
 
 #include "esp_err.h"
+#include "frame_slot.h"
+
+// 相机帧缓冲个数：驱动写入中一帧、待发送与发送中各一帧、最新帧槽一帧，加上NACK重传环保存的帧。
+// 不按每个消费者的最坏占用求和：帧缓冲越多，排队的旧帧越多，延迟越大（驱动使用 CAMERA_GRAB_LATEST 总是交出最新一帧）。
+// 帧缓冲紧张时发送队列丢弃旧帧；事件片段、运动检测与缩略图流等可选订阅者，以及最新帧槽与它的 HTTP/RTSP 读者，
+// 只在还有空闲帧缓冲时取得帧（frame_broker_has_spare()），慢读者持有帧再久也不会占光驱动可写入的帧缓冲
+#define CAMERA_FB_COUNT (4 + CONFIG_UDP_RETRANSMIT_RING_FRAMES)
+// 运行时可减少帧缓冲个数（丢帧换 PSRAM）：重传环长期持有的帧之外至少要留一帧采集、一帧发送，否则采集会停住。
+// 最新帧槽的读者受空闲帧缓冲的限制，不会让采集停住，再留一帧只是让它们在最少的帧缓冲下仍能取得帧
+#define CAMERA_FB_MIN_COUNT (2 + CONFIG_UDP_RETRANSMIT_RING_FRAMES + (FRAME_SLOT_MAX_PINNED > 0 ? 1 : 0))
 
 #define CAMERA_MODEL_ESP32S3_EYE
 
@@ -0,0 +1,729 @@
+/*
+ * camera_ctrl.c
+ * 相机运行时控制实现
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+#include "camera_ctrl.h"
+#include "camera_app.h"
+#include "udp_camera_client.h"
+#include "frame_broker.h"
+
+static const char* TAG = "CAM_CTRL";
+
+#define CAMERA_CTRL_NVS_NAMESPACE "camera"
+#define CAMERA_CTRL_NVS_KEY "settings"
+#define CAMERA_CTRL_BLOB_VERSION 1
+#define CAMERA_CTRL_PAUSE_TIMEOUT_MS 3000  // 等待采集暂停与帧缓冲归还的最长时间
+#define CAMERA_CTRL_OV2640_MODE_UXGA 0     // OV2640 set_res_raw 的 startX 为传感器模式，UXGA 模式下窗口坐标为全分辨率像素
+
+#define CAMERA_CTRL_REINIT 0x01  // 修改需要重新初始化驱动
+#define CAMERA_CTRL_WINDOW 0x02  // 开窗参数，与分辨率一起校验
+
+/**
+ * @brief 参数描述
+ */
+typedef struct
+{
+    const char* name;
+    int32_t min;
+    int32_t max;
+    uint8_t flags;
+} camera_ctrl_param_info_t;
+
+static const camera_ctrl_param_info_t s_params[CAMERA_CTRL_PARAM_COUNT] = {
+    [CAMERA_CTRL_FRAMESIZE] = {"framesize", 0, FRAMESIZE_INVALID - 1, 0},
+    [CAMERA_CTRL_QUALITY] = {"quality", 0, 63, 0},
+    [CAMERA_CTRL_BRIGHTNESS] = {"brightness", -2, 2, 0},
+    [CAMERA_CTRL_CONTRAST] = {"contrast", -2, 2, 0},
+    [CAMERA_CTRL_SATURATION] = {"saturation", -2, 2, 0},
+    [CAMERA_CTRL_AEC] = {"aec", 0, 1, 0},
+    [CAMERA_CTRL_AE_LEVEL] = {"ae_level", -2, 2, 0},
+    [CAMERA_CTRL_AEC_VALUE] = {"aec_value", 0, 1200, 0},
+    [CAMERA_CTRL_AGC] = {"agc", 0, 1, 0},
+    [CAMERA_CTRL_AGC_GAIN] = {"agc_gain", 0, 30, 0},
+    [CAMERA_CTRL_GAINCEILING] = {"gainceiling", 0, 6, 0},
+    [CAMERA_CTRL_AWB] = {"awb", 0, 1, 0},
+    [CAMERA_CTRL_HMIRROR] = {"hmirror", 0, 1, 0},
+    [CAMERA_CTRL_VFLIP] = {"vflip", 0, 1, 0},
+    [CAMERA_CTRL_WINDOW_X] = {"window_x", 0, 4096, CAMERA_CTRL_WINDOW},
+    [CAMERA_CTRL_WINDOW_Y] = {"window_y", 0, 4096, CAMERA_CTRL_WINDOW},
+    [CAMERA_CTRL_WINDOW_W] = {"window_w", 0, 4096, CAMERA_CTRL_WINDOW},
+    [CAMERA_CTRL_WINDOW_H] = {"window_h", 0, 4096, CAMERA_CTRL_WINDOW},
+    [CAMERA_CTRL_XCLK_HZ] = {"xclk_hz", 6000000, 24000000, CAMERA_CTRL_REINIT},
+    [CAMERA_CTRL_FB_COUNT] = {"fb_count", CAMERA_FB_MIN_COUNT, CAMERA_FB_COUNT, CAMERA_CTRL_REINIT},
+    [CAMERA_CTRL_GRAB_MODE] = {"grab_mode", CAMERA_GRAB_WHEN_EMPTY, CAMERA_GRAB_LATEST, CAMERA_CTRL_REINIT},
+};
+
+/**
+ * @brief NVS 中保存的参数（参数编号只追加，旧版本的 count 较小时只恢复前 count 个）
+ */
+typedef struct
+{
+    uint8_t version;
+    uint8_t count;
+    uint16_t reserved;
+    uint32_t mask;  // 保存了哪些参数
+    int32_t values[CAMERA_CTRL_PARAM_COUNT];
+} camera_ctrl_blob_t;
+
+// 以下由 s_mutex 保护
+static SemaphoreHandle_t s_mutex = NULL;
+static camera_config_t s_base;    // 默认驱动配置
+static camera_config_t s_config;  // 当前驱动配置
+static int32_t s_values[CAMERA_CTRL_PARAM_COUNT];
+static uint32_t s_mask = 0;
+static bool s_dirty = false;
+static camera_ctrl_blob_t s_saved;  // 最近一次写入（或加载）的内容，相同时跳过提交
+static camera_ctrl_stats_t s_stats;
+static esp_timer_handle_t s_commit_timer = NULL;
+static volatile bool s_commit_task_running = false;
+
+static uint32_t framesize_area(framesize_t framesize)
+{
+    return (uint32_t)resolution[framesize].width * resolution[framesize].height;
+}
+
+/**
+ * @brief 帧缓冲按此分辨率分配：自适应码率可能在运行时升到 VGA，按其中较大者分配
+ */
+static framesize_t buffer_framesize(framesize_t framesize)
+{
+#if CONFIG_UDP_ABR_ENABLE
+    if (framesize_area(FRAMESIZE_VGA) > framesize_area(framesize)) {
+        return FRAMESIZE_VGA;
+    }
+#endif
+    return framesize;
+}
+
+static void fill_driver_config(camera_config_t* config, const int32_t* values)
+{
+    config->frame_size = buffer_framesize((framesize_t)values[CAMERA_CTRL_FRAMESIZE]);
+    config->jpeg_quality = values[CAMERA_CTRL_QUALITY];
+    config->xclk_freq_hz = values[CAMERA_CTRL_XCLK_HZ];
+    config->fb_count = values[CAMERA_CTRL_FB_COUNT];
+    config->grab_mode = (camera_grab_mode_t)values[CAMERA_CTRL_GRAB_MODE];
+}
+
+static framesize_t sensor_max_framesize(sensor_t* sensor)
+{
+    camera_sensor_info_t* info = (sensor != NULL) ? esp_camera_sensor_get_info(&sensor->id) : NULL;
+    return (info != NULL) ? info->max_size : FRAMESIZE_INVALID - 1;
+}
+
+static bool window_enabled(const int32_t* values)
+{
+    return values[CAMERA_CTRL_WINDOW_W] != 0 && values[CAMERA_CTRL_WINDOW_H] != 0;
+}
+
+/**
+ * @brief 传感器是否提供该参数的设置函数
+ */
+static bool sensor_supports(sensor_t* sensor, camera_ctrl_param_t param)
+{
+    switch (param) {
+        case CAMERA_CTRL_FRAMESIZE:
+            return sensor->set_framesize != NULL;
+        case CAMERA_CTRL_QUALITY:
+            return sensor->set_quality != NULL;
+        case CAMERA_CTRL_BRIGHTNESS:
+            return sensor->set_brightness != NULL;
+        case CAMERA_CTRL_CONTRAST:
+            return sensor->set_contrast != NULL;
+        case CAMERA_CTRL_SATURATION:
+            return sensor->set_saturation != NULL;
+        case CAMERA_CTRL_AEC:
+            return sensor->set_exposure_ctrl != NULL;
+        case CAMERA_CTRL_AE_LEVEL:
+            return sensor->set_ae_level != NULL;
+        case CAMERA_CTRL_AEC_VALUE:
+            return sensor->set_aec_value != NULL;
+        case CAMERA_CTRL_AGC:
+            return sensor->set_gain_ctrl != NULL;
+        case CAMERA_CTRL_AGC_GAIN:
+            return sensor->set_agc_gain != NULL;
+        case CAMERA_CTRL_GAINCEILING:
+            return sensor->set_gainceiling != NULL;
+        case CAMERA_CTRL_AWB:
+            return sensor->set_whitebal != NULL;
+        case CAMERA_CTRL_HMIRROR:
+            return sensor->set_hmirror != NULL;
+        case CAMERA_CTRL_VFLIP:
+            return sensor->set_vflip != NULL;
+        case CAMERA_CTRL_WINDOW_X:
+        case CAMERA_CTRL_WINDOW_Y:
+        case CAMERA_CTRL_WINDOW_W:
+        case CAMERA_CTRL_WINDOW_H:
+            // 各型号 set_res_raw 的参数含义不同，目前只支持 OV2640
+            return sensor->set_res_raw != NULL && sensor->id.PID == OV2640_PID;
+        default:
+            return true;
+    }
+}
+
+/**
+ * @brief 读取传感器当前的参数值
+ */
+static int32_t sensor_value(sensor_t* sensor, camera_ctrl_param_t param, int32_t fallback)
+{
+    const camera_status_t* status = &sensor->status;
+    switch (param) {
+        case CAMERA_CTRL_FRAMESIZE:
+            return status->framesize;
+        case CAMERA_CTRL_QUALITY:
+            return status->quality;
+        case CAMERA_CTRL_BRIGHTNESS:
+            return status->brightness;
+        case CAMERA_CTRL_CONTRAST:
+            return status->contrast;
+        case CAMERA_CTRL_SATURATION:
+            return status->saturation;
+        case CAMERA_CTRL_AEC:
+            return status->aec;
+        case CAMERA_CTRL_AE_LEVEL:
+            return status->ae_level;
+        case CAMERA_CTRL_AEC_VALUE:
+            return status->aec_value;
+        case CAMERA_CTRL_AGC:
+            return status->agc;
+        case CAMERA_CTRL_AGC_GAIN:
+            return status->agc_gain;
+        case CAMERA_CTRL_GAINCEILING:
+            return status->gainceiling;
+        case CAMERA_CTRL_AWB:
+            return status->awb;
+        case CAMERA_CTRL_HMIRROR:
+            return status->hmirror;
+        case CAMERA_CTRL_VFLIP:
+            return status->vflip;
+        default:
+            return fallback;
+    }
+}
+
+/**
+ * @brief 写入一个传感器参数（开窗参数由 apply_window 统一写入）
+ * @return 0 表示成功
+ */
+static int apply_param(sensor_t* sensor, camera_ctrl_param_t param, int32_t value)
+{
+    switch (param) {
+        case CAMERA_CTRL_FRAMESIZE:
+            return sensor->set_framesize(sensor, (framesize_t)value);
+        case CAMERA_CTRL_QUALITY:
+            return sensor->set_quality(sensor, value);
+        case CAMERA_CTRL_BRIGHTNESS:
+            return sensor->set_brightness(sensor, value);
+        case CAMERA_CTRL_CONTRAST:
+            return sensor->set_contrast(sensor, value);
+        case CAMERA_CTRL_SATURATION:
+            return sensor->set_saturation(sensor, value);
+        case CAMERA_CTRL_AEC:
+            return sensor->set_exposure_ctrl(sensor, value);
+        case CAMERA_CTRL_AE_LEVEL:
+            return sensor->set_ae_level(sensor, value);
+        case CAMERA_CTRL_AEC_VALUE:
+            return sensor->set_aec_value(sensor, value);
+        case CAMERA_CTRL_AGC:
+            return sensor->set_gain_ctrl(sensor, value);
+        case CAMERA_CTRL_AGC_GAIN:
+            return sensor->set_agc_gain(sensor, value);
+        case CAMERA_CTRL_GAINCEILING:
+            return sensor->set_gainceiling(sensor, (gainceiling_t)value);
+        case CAMERA_CTRL_AWB:
+            return sensor->set_whitebal(sensor, value);
+        case CAMERA_CTRL_HMIRROR:
+            return sensor->set_hmirror(sensor, value);
+        case CAMERA_CTRL_VFLIP:
+            return sensor->set_vflip(sensor, value);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief 按开窗参数设置传感器窗口，输出尺寸为当前分辨率
+ * @return 0 表示成功
+ */
+static int apply_window(sensor_t* sensor, const int32_t* values)
+{
+    framesize_t framesize = (framesize_t)values[CAMERA_CTRL_FRAMESIZE];
+    if (!window_enabled(values)) {
+        // set_framesize 恢复该分辨率的完整视场
+        return sensor->set_framesize(sensor, framesize);
+    }
+    return sensor->set_res_raw(sensor, CAMERA_CTRL_OV2640_MODE_UXGA, 0, 0, 0, values[CAMERA_CTRL_WINDOW_X], values[CAMERA_CTRL_WINDOW_Y], values[CAMERA_CTRL_WINDOW_W],
+                               values[CAMERA_CTRL_WINDOW_H], resolution[framesize].width, resolution[framesize].height, false, false);
+}
+
+/**
+ * @brief 初始化驱动后写入保存过的传感器参数，其余参数取传感器的默认值
+ */
+static void apply_all(sensor_t* sensor, int32_t* values, uint32_t mask)
+{
+    for (int p = 0; p < CAMERA_CTRL_PARAM_COUNT; p++) {
+        if ((s_params[p].flags & (CAMERA_CTRL_REINIT | CAMERA_CTRL_WINDOW)) != 0) {
+            continue;
+        }
+        // 帧缓冲可能按更大的分辨率分配，分辨率总是写入
+        if ((mask & (1u << p)) != 0 || p == CAMERA_CTRL_FRAMESIZE) {
+            if (!sensor_supports(sensor, p) || apply_param(sensor, p, values[p]) != 0) {
+                ESP_LOGW(TAG, "恢复参数 %s = %ld 失败", s_params[p].name, (long)values[p]);
+                s_stats.apply_failures++;
+            }
+        }
+        values[p] = sensor_value(sensor, p, values[p]);
+    }
+    if (window_enabled(values) && (!sensor_supports(sensor, CAMERA_CTRL_WINDOW_W) || apply_window(sensor, values) != 0)) {
+        ESP_LOGW(TAG, "恢复开窗失败，使用完整视场");
+        s_stats.apply_failures++;
+        values[CAMERA_CTRL_WINDOW_W] = 0;
+        values[CAMERA_CTRL_WINDOW_H] = 0;
+    }
+}
+
+/**
+ * @brief 校验修改后的整组参数
+ */
+static esp_err_t validate(sensor_t* sensor, const int32_t* next, uint32_t changed)
+{
+    for (int p = 0; p < CAMERA_CTRL_PARAM_COUNT; p++) {
+        if ((changed & (1u << p)) == 0) {
+            continue;
+        }
+        if (next[p] < s_params[p].min || next[p] > s_params[p].max) {
+            ESP_LOGW(TAG, "参数 %s 超出范围: %ld (%ld - %ld)", s_params[p].name, (long)next[p], (long)s_params[p].min, (long)s_params[p].max);
+            return ESP_ERR_INVALID_ARG;
+        }
+        if ((s_params[p].flags & CAMERA_CTRL_REINIT) == 0 && !sensor_supports(sensor, p) && !(p >= CAMERA_CTRL_WINDOW_X && p <= CAMERA_CTRL_WINDOW_H && !window_enabled(next))) {
+            ESP_LOGW(TAG, "传感器不支持参数 %s", s_params[p].name);
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+    }
+
+    framesize_t framesize = (framesize_t)next[CAMERA_CTRL_FRAMESIZE];
+    framesize_t max_framesize = sensor_max_framesize(sensor);
+    if (framesize > max_framesize) {
+        ESP_LOGW(TAG, "分辨率 %d 超过传感器上限 %d", framesize, max_framesize);
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 窗口须在传感器最大分辨率内，且不小于输出尺寸（传感器只能缩小）
+    if (window_enabled(next)) {
+        const resolution_info_t* max = &resolution[max_framesize];
+        const resolution_info_t* out = &resolution[framesize];
+        if (next[CAMERA_CTRL_WINDOW_X] + next[CAMERA_CTRL_WINDOW_W] > max->width || next[CAMERA_CTRL_WINDOW_Y] + next[CAMERA_CTRL_WINDOW_H] > max->height ||
+            next[CAMERA_CTRL_WINDOW_W] < out->width || next[CAMERA_CTRL_WINDOW_H] < out->height) {
+            ESP_LOGW(TAG, "窗口 %ldx%ld+%ld+%ld 无效（传感器 %ux%u，输出 %ux%u）", (long)next[CAMERA_CTRL_WINDOW_W], (long)next[CAMERA_CTRL_WINDOW_H], (long)next[CAMERA_CTRL_WINDOW_X],
+                     (long)next[CAMERA_CTRL_WINDOW_Y], max->width, max->height, out->width, out->height);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 暂停采集并等待帧缓冲归还后，按新参数重新初始化驱动；失败时恢复原配置
+ */
+static esp_err_t reinit_driver(int32_t* next, uint32_t mask)
+{
+    esp_err_t err = udp_camera_pause_capture(true, pdMS_TO_TICKS(CAMERA_CTRL_PAUSE_TIMEOUT_MS));
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    camera_config_t config = s_config;
+    fill_driver_config(&config, next);
+    ESP_LOGI(TAG, "重新初始化相机: XCLK %d Hz, 帧缓冲 %u 个 (分辨率 %d), 取帧模式 %d", config.xclk_freq_hz, (unsigned)config.fb_count, config.frame_size, config.grab_mode);
+    esp_camera_deinit();
+    err = esp_camera_init(&config);
+    if (err == ESP_OK) {
+        s_config = config;
+        apply_all(esp_camera_sensor_get(), next, mask);
+    }
+    else {
+        ESP_LOGE(TAG, "重新初始化失败: %s，恢复原配置", esp_err_to_name(err));
+        s_stats.reinit_failures++;
+        esp_camera_deinit();
+        if (esp_camera_init(&s_config) == ESP_OK) {
+            apply_all(esp_camera_sensor_get(), s_values, s_mask);
+        }
+        else {
+            ESP_LOGE(TAG, "恢复原配置失败，相机不可用");
+        }
+    }
+    s_stats.reinits++;
+    frame_broker_set_capacity(s_config.fb_count);
+    udp_camera_resume_capture();
+    return err;
+}
+
+/**
+ * @brief 把当前参数写入 NVS（调用者持有 s_mutex）
+ */
+static esp_err_t commit_locked(void)
+{
+#if CONFIG_CAMERA_CTRL_PERSIST
+    if (!s_dirty) {
+        return ESP_OK;
+    }
+    camera_ctrl_blob_t blob = {
+        .version = CAMERA_CTRL_BLOB_VERSION,
+        .count = CAMERA_CTRL_PARAM_COUNT,
+        .mask = s_mask,
+    };
+    for (int p = 0; p < CAMERA_CTRL_PARAM_COUNT; p++) {
+        // 未保存的参数写 0，使内容只取决于保存的参数
+        blob.values[p] = ((s_mask & (1u << p)) != 0) ? s_values[p] : 0;
+    }
+    s_dirty = false;
+    if (memcmp(&blob, &s_saved, sizeof(blob)) == 0) {
+        s_stats.commit_skipped++;
+        return ESP_OK;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(CAMERA_CTRL_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = (s_mask != 0) ? nvs_set_blob(handle, CAMERA_CTRL_NVS_KEY, &blob, sizeof(blob)) : nvs_erase_key(handle, CAMERA_CTRL_NVS_KEY);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            err = ESP_OK;
+        }
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "保存相机参数失败: %s", esp_err_to_name(err));
+        s_stats.commit_failures++;
+        s_dirty = true;
+        return err;
+    }
+    s_saved = blob;
+    s_stats.commits++;
+    ESP_LOGI(TAG, "相机参数已保存 (mask 0x%06lx)", (unsigned long)s_mask);
+    return ESP_OK;
+#else
+    s_dirty = false;
+    return ESP_OK;
+#endif
+}
+
+static void commit_task(void* arg)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    commit_locked();
+    s_commit_task_running = false;
+    xSemaphoreGive(s_mutex);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 延迟提交到期：NVS 写入可能耗时数十毫秒，放到临时任务中执行，不阻塞 esp_timer 任务（节拍器与调速定时器）
+ */
+static void commit_timer_cb(void* arg)
+{
+    if (s_commit_task_running) {
+        return;
+    }
+    s_commit_task_running = true;
+    if (xTaskCreate(commit_task, "cam_commit", 3072, NULL, 1, NULL) != pdPASS) {
+        s_commit_task_running = false;
+        ESP_LOGW(TAG, "创建保存任务失败，稍后重试");
+        esp_timer_start_once(s_commit_timer, (uint64_t)CONFIG_CAMERA_CTRL_COMMIT_DELAY_MS * 1000);
+    }
+}
+
+/**
+ * @brief 标记有待提交的修改：定时器未运行时启动，运行中不重新计时，保证连续修改时也按周期提交
+ */
+static void schedule_commit(void)
+{
+    s_dirty = true;
+    if (s_commit_timer != NULL && !esp_timer_is_active(s_commit_timer)) {
+        esp_timer_start_once(s_commit_timer, (uint64_t)CONFIG_CAMERA_CTRL_COMMIT_DELAY_MS * 1000);
+    }
+}
+
+/**
+ * @brief 加载保存的参数
+ * @return 保存了哪些参数
+ */
+static uint32_t load_saved(int32_t* values)
+{
+    memset(&s_saved, 0, sizeof(s_saved));
+#if CONFIG_CAMERA_CTRL_PERSIST
+    nvs_handle_t handle;
+    if (nvs_open(CAMERA_CTRL_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return 0;
+    }
+    camera_ctrl_blob_t blob = {0};
+    size_t size = sizeof(blob);
+    esp_err_t err = nvs_get_blob(handle, CAMERA_CTRL_NVS_KEY, &blob, &size);
+    nvs_close(handle);
+    if (err != ESP_OK || size < offsetof(camera_ctrl_blob_t, values) || blob.version != CAMERA_CTRL_BLOB_VERSION) {
+        return 0;
+    }
+
+    uint32_t count = blob.count < CAMERA_CTRL_PARAM_COUNT ? blob.count : CAMERA_CTRL_PARAM_COUNT;
+    if (size < offsetof(camera_ctrl_blob_t, values) + count * sizeof(int32_t)) {
+        return 0;
+    }
+    uint32_t mask = 0;
+    for (uint32_t p = 0; p < count; p++) {
+        if ((blob.mask & (1u << p)) != 0 && blob.values[p] >= s_params[p].min && blob.values[p] <= s_params[p].max) {
+            values[p] = blob.values[p];
+            mask |= 1u << p;
+        }
+    }
+    if (count == CAMERA_CTRL_PARAM_COUNT && mask == blob.mask) {
+        s_saved = blob;
+    }
+    return mask;
+#else
+    return 0;
+#endif
+}
+
+static void default_values(int32_t* values)
+{
+    memset(values, 0, sizeof(int32_t) * CAMERA_CTRL_PARAM_COUNT);
+    values[CAMERA_CTRL_FRAMESIZE] = s_base.frame_size;
+    values[CAMERA_CTRL_QUALITY] = s_base.jpeg_quality;
+    values[CAMERA_CTRL_XCLK_HZ] = s_base.xclk_freq_hz;
+    values[CAMERA_CTRL_FB_COUNT] = s_base.fb_count;
+    values[CAMERA_CTRL_GRAB_MODE] = s_base.grab_mode;
+}
+
+esp_err_t camera_ctrl_init(const camera_config_t* base)
+{
+    if (base == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        const esp_timer_create_args_t timer_args = {
+            .callback = commit_timer_cb,
+            .arg = NULL,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "cam_commit",
+        };
+        if (esp_timer_create(&timer_args, &s_commit_timer) != ESP_OK) {
+            ESP_LOGW(TAG, "创建保存定时器失败，修改只在调用 camera_ctrl_commit() 时保存");
+            s_commit_timer = NULL;
+        }
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_base = *base;
+    default_values(s_values);
+    s_mask = load_saved(s_values);
+    s_config = s_base;
+    fill_driver_config(&s_config, s_values);
+
+    esp_err_t err = esp_camera_init(&s_config);
+    if (err != ESP_OK && (s_mask & ((1u << CAMERA_CTRL_XCLK_HZ) | (1u << CAMERA_CTRL_FB_COUNT) | (1u << CAMERA_CTRL_GRAB_MODE))) != 0) {
+        // 保存的驱动配置可能不适用于当前硬件，退回默认配置，避免每次启动都失败
+        ESP_LOGW(TAG, "按保存的参数初始化失败: %s，使用默认驱动配置", esp_err_to_name(err));
+        esp_camera_deinit();
+        s_mask &= ~((1u << CAMERA_CTRL_XCLK_HZ) | (1u << CAMERA_CTRL_FB_COUNT) | (1u << CAMERA_CTRL_GRAB_MODE));
+        s_values[CAMERA_CTRL_XCLK_HZ] = s_base.xclk_freq_hz;
+        s_values[CAMERA_CTRL_FB_COUNT] = s_base.fb_count;
+        s_values[CAMERA_CTRL_GRAB_MODE] = s_base.grab_mode;
+        fill_driver_config(&s_config, s_values);
+        err = esp_camera_init(&s_config);
+        schedule_commit();
+    }
+    if (err != ESP_OK) {
+        xSemaphoreGive(s_mutex);
+        return err;
+    }
+
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (sensor != NULL) {
+        apply_all(sensor, s_values, s_mask);
+    }
+    if (s_mask != 0) {
+        ESP_LOGI(TAG, "已恢复保存的相机参数 (mask 0x%06lx)", (unsigned long)s_mask);
+    }
+    frame_broker_set_capacity(s_config.fb_count);
+    xSemaphoreGive(s_mutex);
+    return ESP_OK;
+}
+
+esp_err_t camera_ctrl_set(const camera_ctrl_change_t* changes, size_t count)
+{
+    if (changes == NULL || count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (sensor == NULL) {
+        xSemaphoreGive(s_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 传感器参数以传感器当前值为基础（可能已被自适应码率调整）
+    int32_t next[CAMERA_CTRL_PARAM_COUNT];
+    for (int p = 0; p < CAMERA_CTRL_PARAM_COUNT; p++) {
+        next[p] = sensor_value(sensor, p, s_values[p]);
+    }
+    uint32_t changed = 0;
+    esp_err_t err = ESP_OK;
+    for (size_t i = 0; i < count; i++) {
+        if ((uint32_t)changes[i].param >= CAMERA_CTRL_PARAM_COUNT) {
+            err = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        next[changes[i].param] = changes[i].value;
+        changed |= 1u << changes[i].param;
+    }
+    if (err == ESP_OK) {
+        err = validate(sensor, next, changed);
+    }
+    if (err != ESP_OK) {
+        s_stats.rejected++;
+        xSemaphoreGive(s_mutex);
+        return err;
+    }
+
+    bool reinit = framesize_area((framesize_t)next[CAMERA_CTRL_FRAMESIZE]) > framesize_area(s_config.frame_size);
+    for (int p = 0; p < CAMERA_CTRL_PARAM_COUNT; p++) {
+        if ((s_params[p].flags & CAMERA_CTRL_REINIT) != 0 && next[p] != s_values[p]) {
+            reinit = true;
+        }
+    }
+    uint32_t mask = s_mask | changed;
+
+    if (reinit) {
+        err = reinit_driver(next, mask);
+        if (err == ESP_OK) {
+            memcpy(s_values, next, sizeof(s_values));
+        }
+    }
+    else {
+        // 采集任务在取帧间隙也会修改传感器（自适应码率），暂停后再写，避免寄存器分组切换交错
+        err = udp_camera_pause_capture(false, pdMS_TO_TICKS(CAMERA_CTRL_PAUSE_TIMEOUT_MS));
+        if (err == ESP_OK) {
+            bool window_changed = (changed & (1u << CAMERA_CTRL_FRAMESIZE)) != 0;
+            for (int p = 0; p < CAMERA_CTRL_PARAM_COUNT; p++) {
+                if ((changed & (1u << p)) == 0) {
+                    continue;
+                }
+                if ((s_params[p].flags & CAMERA_CTRL_WINDOW) != 0) {
+                    window_changed = true;
+                }
+                else if (apply_param(sensor, p, next[p]) != 0) {
+                    ESP_LOGW(TAG, "设置参数 %s = %ld 失败", s_params[p].name, (long)next[p]);
+                    s_stats.apply_failures++;
+                    mask &= ~(1u << p);
+                    err = ESP_FAIL;
+                }
+            }
+            // 修改分辨率会取消开窗，需重新设置
+            if (window_changed && (window_enabled(next) || window_enabled(s_values)) && apply_window(sensor, next) != 0) {
+                ESP_LOGW(TAG, "设置窗口失败");
+                s_stats.apply_failures++;
+                err = ESP_FAIL;
+            }
+            udp_camera_resume_capture();
+            for (int p = 0; p < CAMERA_CTRL_PARAM_COUNT; p++) {
+                s_values[p] = sensor_value(sensor, p, next[p]);
+            }
+        }
+    }
+
+    if (err == ESP_OK || err == ESP_FAIL) {
+        s_mask = mask;
+        s_stats.applied++;
+        schedule_commit();
+    }
+    xSemaphoreGive(s_mutex);
+    return err;
+}
+
+esp_err_t camera_ctrl_reset(void)
+{
+    if (s_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int32_t next[CAMERA_CTRL_PARAM_COUNT];
+    default_values(next);
+    esp_err_t err = reinit_driver(next, 0);
+    if (err == ESP_OK) {
+        memcpy(s_values, next, sizeof(s_values));
+        s_mask = 0;
+        s_dirty = true;
+        commit_locked();
+    }
+    xSemaphoreGive(s_mutex);
+    return err;
+}
+
+esp_err_t camera_ctrl_commit(void)
+{
+    if (s_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    esp_err_t err = commit_locked();
+    xSemaphoreGive(s_mutex);
+    return err;
+}
+
+void camera_ctrl_get(camera_ctrl_state_t* state)
+{
+    if (state == NULL) {
+        return;
+    }
+    memset(state, 0, sizeof(*state));
+    if (s_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    sensor_t* sensor = esp_camera_sensor_get();
+    for (int p = 0; p < CAMERA_CTRL_PARAM_COUNT; p++) {
+        state->values[p] = (sensor != NULL) ? sensor_value(sensor, p, s_values[p]) : s_values[p];
+    }
+    state->persisted_mask = s_mask;
+    state->commit_pending = s_dirty;
+    camera_sensor_info_t* info = (sensor != NULL) ? esp_camera_sensor_get_info(&sensor->id) : NULL;
+    state->sensor_name = (info != NULL) ? info->name : NULL;
+    state->max_framesize = sensor_max_framesize(sensor);
+    state->buffer_framesize = s_config.frame_size;
+    state->stats = s_stats;
+    xSemaphoreGive(s_mutex);
+}
+
+const char* camera_ctrl_param_name(camera_ctrl_param_t param)
+{
+    return ((uint32_t)param < CAMERA_CTRL_PARAM_COUNT) ? s_params[param].name : NULL;
+}
+
+bool camera_ctrl_param_find(const char* name, camera_ctrl_param_t* param)
+{
+    for (int p = 0; p < CAMERA_CTRL_PARAM_COUNT; p++) {
+        if (strcmp(s_params[p].name, name) == 0) {
+            *param = (camera_ctrl_param_t)p;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,147 @@
+/*
+ * camera_ctrl.h
+ * 相机运行时控制 - 不重启修改传感器参数与驱动配置，并把修改过的参数保存到 NVS
+ *
+ * 传感器参数（分辨率、JPEG 质量、亮度、曝光、增益、开窗等）通过 esp_camera_sensor_get() 直接生效；
+ * 驱动参数（XCLK、帧缓冲个数、取帧模式）以及超过帧缓冲大小的分辨率需要重新初始化驱动：
+ * 暂停采集、等待全部帧缓冲归还后 deinit/init，socket 与 HTTP/RTSP 服务不中断，失败时恢复原配置。
+ * 修改过的参数合并写入 NVS：第一次修改后延迟 CONFIG_CAMERA_CTRL_COMMIT_DELAY_MS 提交一次，期间的修改一起提交。
+ *
+ * HTTP (/api/camera) 按参数名、UDP 控制报文 (IMAGE_PROTO_CTRL_CAMERA) 按参数编号修改，编号只追加不复用。
+ */
+
+#ifndef CAMERA_CTRL_H
+#define CAMERA_CTRL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 参数编号（UDP 控制报文使用，只追加）
+ */
+typedef enum {
+    CAMERA_CTRL_FRAMESIZE = 0,  // 分辨率 (framesize_t)
+    CAMERA_CTRL_QUALITY,        // JPEG 质量 0-63，越小质量越高
+    CAMERA_CTRL_BRIGHTNESS,     // 亮度 -2 - 2
+    CAMERA_CTRL_CONTRAST,       // 对比度 -2 - 2
+    CAMERA_CTRL_SATURATION,     // 饱和度 -2 - 2
+    CAMERA_CTRL_AEC,            // 自动曝光 0/1
+    CAMERA_CTRL_AE_LEVEL,       // 自动曝光补偿 -2 - 2
+    CAMERA_CTRL_AEC_VALUE,      // 手动曝光值 0-1200（自动曝光关闭时生效）
+    CAMERA_CTRL_AGC,            // 自动增益 0/1
+    CAMERA_CTRL_AGC_GAIN,       // 手动增益 0-30（自动增益关闭时生效）
+    CAMERA_CTRL_GAINCEILING,    // 自动增益上限 0-6 (2x - 128x)
+    CAMERA_CTRL_AWB,            // 自动白平衡 0/1
+    CAMERA_CTRL_HMIRROR,        // 水平镜像 0/1
+    CAMERA_CTRL_VFLIP,          // 垂直翻转 0/1
+    CAMERA_CTRL_WINDOW_X,       // 传感器开窗（传感器最大分辨率下的像素坐标），宽或高为 0 表示不开窗
+    CAMERA_CTRL_WINDOW_Y,
+    CAMERA_CTRL_WINDOW_W,
+    CAMERA_CTRL_WINDOW_H,
+    CAMERA_CTRL_XCLK_HZ,        // 以下修改需要重新初始化驱动：XCLK 频率 (Hz)
+    CAMERA_CTRL_FB_COUNT,       // 帧缓冲个数 CAMERA_FB_MIN_COUNT - CAMERA_FB_COUNT
+    CAMERA_CTRL_GRAB_MODE,      // 取帧模式 (camera_grab_mode_t)
+    CAMERA_CTRL_PARAM_COUNT,
+} camera_ctrl_param_t;
+
+/**
+ * @brief 一个参数的修改
+ */
+typedef struct
+{
+    camera_ctrl_param_t param;
+    int32_t value;
+} camera_ctrl_change_t;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct
+{
+    uint32_t applied;          // 成功的修改请求数
+    uint32_t rejected;         // 参数无效或不支持而拒绝的请求数
+    uint32_t apply_failures;   // 传感器写入失败的参数数
+    uint32_t reinits;          // 重新初始化驱动的次数
+    uint32_t reinit_failures;  // 重新初始化失败（已恢复原配置）的次数
+    uint32_t commits;          // 写入 NVS 的次数
+    uint32_t commit_skipped;   // 与已保存内容相同而跳过的提交次数
+    uint32_t commit_failures;  // 写入 NVS 失败的次数
+} camera_ctrl_stats_t;
+
+/**
+ * @brief 当前状态
+ */
+typedef struct
+{
+    int32_t values[CAMERA_CTRL_PARAM_COUNT];  // 当前值（传感器参数从传感器读取，包含自适应码率的调整）
+    uint32_t persisted_mask;                  // 修改过、启动时恢复的参数位图 (1 << camera_ctrl_param_t)
+    bool commit_pending;                      // 有修改尚未写入 NVS
+    const char* sensor_name;                  // 传感器型号，未初始化时为 NULL
+    framesize_t max_framesize;                // 传感器支持的最大分辨率
+    framesize_t buffer_framesize;             // 帧缓冲按此分辨率分配，更大的分辨率需要重新初始化
+    camera_ctrl_stats_t stats;
+} camera_ctrl_state_t;
+
+/**
+ * @brief 加载 NVS 中保存的参数并初始化相机驱动（保存的驱动配置初始化失败时退回默认配置）
+ * @param base 默认驱动配置（引脚、像素格式等），复制保存用于重新初始化
+ * @return esp_err_t
+ */
+esp_err_t camera_ctrl_init(const camera_config_t* base);
+
+/**
+ * @brief 修改一组参数：全部校验通过后才生效，需要时重新初始化驱动
+ *
+ * 自适应码率开启时分辨率与 JPEG 质量随后可能被码率控制器调整，调整分辨率会取消开窗。
+ *
+ * @param changes 修改
+ * @param count 修改个数
+ * @return esp_err_t 参数编号或取值无效时返回 ESP_ERR_INVALID_ARG，传感器不支持时返回 ESP_ERR_NOT_SUPPORTED，
+ *                   等待帧缓冲归还超时返回 ESP_ERR_TIMEOUT，传感器写入失败返回 ESP_FAIL（其余参数已生效）
+ */
+esp_err_t camera_ctrl_set(const camera_ctrl_change_t* changes, size_t count);
+
+/**
+ * @brief 清除保存的参数，按默认配置重新初始化驱动（传感器参数恢复为驱动的默认值）
+ * @return esp_err_t
+ */
+esp_err_t camera_ctrl_reset(void);
+
+/**
+ * @brief 立即把待提交的修改写入 NVS
+ * @return esp_err_t
+ */
+esp_err_t camera_ctrl_commit(void);
+
+/**
+ * @brief 获取当前状态
+ * @param state 输出状态
+ */
+void camera_ctrl_get(camera_ctrl_state_t* state);
+
+/**
+ * @brief 参数名（HTTP JSON 的键）
+ * @return 参数名，编号无效时返回 NULL
+ */
+const char* camera_ctrl_param_name(camera_ctrl_param_t param);
+
+/**
+ * @brief 按参数名查找编号
+ * @param name 参数名
+ * @param param 输出编号
+ * @return 找到返回 true
+ */
+bool camera_ctrl_param_find(const char* name, camera_ctrl_param_t* param);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAMERA_CTRL_H */
@@ -0,0 +1,1281 @@
+/*
+ * camera_httpd.c
+ * 正常推流模式下的HTTP接口
+ *
+ * GET  /api/destinations  列出目标表与每个目标的发送统计
+ * POST /api/destinations  {"action": "add"|"remove"|"clear", "ip": "192.168.1.10", "port": 8080}
+ * GET  /api/multicast     组播配置与组播发送统计
+ * POST /api/multicast     {"enable": true, "group": "239.255.0.1", "port": 5000, "ttl": 1}，省略的字段保持不变
+ * GET  /stream.sdp        RTP/JPEG 输出的SDP描述 (ffplay -protocol_whitelist file,http,udp,rtp -i http://<ip>/stream.sdp)
+ * GET  /stream            multipart/x-mixed-replace MJPEG 流，每个客户端一个任务，从最新帧槽取帧
+ * GET  /capture.jpg       单帧JPEG快照
+ * GET  /api/rtsp          RTSP会话列表：建立耗时、发送帧数/跳帧数、每帧CPU周期与CPU占用
+ * GET  /api/frames        帧分发统计：在用帧缓冲数与每个订阅者的队列深度、丢帧数（可选订阅者因帧缓冲不足丢弃的帧数）
+ * GET  /api/clip          事件片段统计：预录环用量、淘汰速率、导出吞吐
+ * POST /api/clip          {"ip": "192.168.1.10", "port": 8090, "post_seconds": 5} 触发事件片段导出；
+ *                         只给 port 时发往请求方，省略全部字段时发往默认接收端
+ * GET  /api/motion        运动检测：最新评分与运动区域（原图坐标）、解码与检测耗时；运动门控配置与发送/抑制统计
+ * POST /api/motion        {"gate": true, "threshold": 5, "keepalive_ms": 10000, "holdoff_ms": 3000} 修改运动门控，省略的字段保持不变
+ * GET  /api/streams       主图像流与缩略图流各自的带宽与CPU占用、主图像流的输出格式 ("image" 分包协议 / "rtp" RTP/JPEG) 与发送参数、帧率/抖动、自适应码率与NACK重传统计，缩略图流配置
+ * POST /api/streams       {"main": {"format": "rtp", "kbps": 8000, "burst_bytes": 16384, "protocol": 2, "fec_group": 8, "fps": 15, "abr": true, "abr_kbps": 3000}} 修改主图像流的发送参数；
+ *                         {"thumb": {"enable": true, "ip": "192.168.1.10", "port": 8083, "fps": 2, "kbps": 256, "quality": 60, "color": true}}，
+ *                         省略的对象与字段保持不变，"ip": "" 表示发往主图像流的目标
+ * GET  /api/camera        相机参数当前值、已保存的参数与统计
+ * POST /api/camera        {"framesize": 8, "quality": 12, "brightness": 1, "aec": false, ...} 不重启修改相机参数（键名见 camera_ctrl.c），
+ *                         {"reset": true} 清除保存的参数并恢复默认，{"commit": true} 立即写入NVS
+ * GET  /api/audio         语音下行：抖动缓冲深度与目标深度、到达抖动，迟到/重复/丢失/挤出的包数，丢包隐藏与欠载统计；
+ *                         播放环形缓冲的水位（字节）与欠载/溢出次数，各编码的包数，解码耗时（每秒音频、每包平均/最长）
+ *                         与最近 1 秒内各核的解码占用 (‰)，Opus 帧数与 FEC/PLC 恢复的帧数
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_http_server.h"
+#include "cJSON.h"
+#include "lwip/inet.h"
+
+#include "camera_httpd.h"
+#include "stream_dest.h"
+#include "udp_camera_client.h"
+#include "image_proto.h"
+#include "image_fec.h"
+#include "frame_slot.h"
+#include "frame_broker.h"
+#include "rtsp_server.h"
+#include "event_clip.h"
+#include "motion_stage.h"
+#include "thumb_stream.h"
+#include "camera_ctrl.h"
+#include "audio_stream.h"
+
+static const char* TAG = "CAMERA_HTTPD";
+
+static httpd_handle_t s_server = NULL;
+
+#define STREAM_BOUNDARY "esp32camframeboundary"
+#define STREAM_CONTENT_TYPE "multipart/x-mixed-replace;boundary=" STREAM_BOUNDARY
+#define STREAM_PART_HEADER "\r\n--" STREAM_BOUNDARY "\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\nX-Timestamp: %llu.%06lu\r\n\r\n"
+#define STREAM_FRAME_TIMEOUT_MS 1000  // 等待新帧的超时，超时后检查是否需要停止
+#define STREAM_STOP_TIMEOUT_MS 3000   // 停止服务器时等待流任务退出的最长时间
+#define CAPTURE_MAX_AGE_US 200000     // /capture.jpg 直接使用的最新帧的最大年龄
+#define CAPTURE_TIMEOUT_MS 2000
+
+static portMUX_TYPE s_stream_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_stream_clients = 0;
+static volatile bool s_stream_stopping = false;
+
+/**
+ * @brief 返回JSON错误
+ */
+static esp_err_t send_json_error(httpd_req_t* req, const char* status, const char* message)
+{
+    char resp[128];
+    snprintf(resp, sizeof(resp), "{\"success\": false, \"message\": \"%s\"}", message);
+    httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+/**
+ * @brief 读取请求体并解析为JSON
+ */
+static cJSON* recv_json_body(httpd_req_t* req)
+{
+    char content[256];
+    size_t received = 0;
+
+    if (req->content_len == 0 || req->content_len >= sizeof(content)) {
+        return NULL;
+    }
+    while (received < req->content_len) {
+        int ret = httpd_req_recv(req, content + received, req->content_len - received);
+        if (ret <= 0) {
+            if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+                continue;
+            }
+            return NULL;
+        }
+        received += ret;
+    }
+    content[received] = '\0';
+    return cJSON_Parse(content);
+}
+
+/**
+ * @brief 输出目标表与统计
+ */
+static esp_err_t send_destinations(httpd_req_t* req)
+{
+    stream_dest_info_t infos[STREAM_DEST_MAX];
+    uint32_t count = stream_dest_get_info(infos);
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "success", 1);
+    cJSON_AddNumberToObject(root, "max", STREAM_DEST_MAX);
+    cJSON* list = cJSON_AddArrayToObject(root, "destinations");
+    for (uint32_t i = 0; i < count; i++) {
+        char ip[16];
+        inet_ntoa_r(infos[i].addr.sin_addr, ip, sizeof(ip));
+
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "ip", ip);
+        cJSON_AddNumberToObject(item, "port", ntohs(infos[i].addr.sin_port));
+        cJSON_AddNumberToObject(item, "frames", infos[i].stats.frames);
+        cJSON_AddNumberToObject(item, "packets", infos[i].stats.packets);
+        cJSON_AddNumberToObject(item, "bytes", (double)infos[i].stats.bytes);
+        cJSON_AddNumberToObject(item, "errors", infos[i].stats.errors);
+        cJSON_AddNumberToObject(item, "last_errno", infos[i].stats.last_errno);
+        cJSON_AddItemToArray(list, item);
+    }
+
+    char* json_str = cJSON_PrintUnformatted(root);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, json_str);
+    free(json_str);
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
+static esp_err_t destinations_get_handler(httpd_req_t* req)
+{
+    return send_destinations(req);
+}
+
+static esp_err_t destinations_post_handler(httpd_req_t* req)
+{
+    cJSON* root = recv_json_body(req);
+    if (!root) {
+        return send_json_error(req, "400 Bad Request", "Invalid JSON");
+    }
+
+    cJSON* action_json = cJSON_GetObjectItem(root, "action");
+    cJSON* ip_json = cJSON_GetObjectItem(root, "ip");
+    cJSON* port_json = cJSON_GetObjectItem(root, "port");
+    if (!action_json || !cJSON_IsString(action_json)) {
+        cJSON_Delete(root);
+        return send_json_error(req, "400 Bad Request", "action is required");
+    }
+
+    esp_err_t err;
+    if (strcmp(action_json->valuestring, "clear") == 0) {
+        err = stream_dest_clear();
+    }
+    else {
+        struct in_addr addr;
+        if (!ip_json || !cJSON_IsString(ip_json) || inet_aton(ip_json->valuestring, &addr) == 0 || !port_json || !cJSON_IsNumber(port_json) || port_json->valueint <= 0 ||
+            port_json->valueint > 65535) {
+            cJSON_Delete(root);
+            return send_json_error(req, "400 Bad Request", "valid ip and port are required");
+        }
+
+        if (strcmp(action_json->valuestring, "add") == 0) {
+            err = stream_dest_add(addr.s_addr, (uint16_t)port_json->valueint);
+        }
+        else if (strcmp(action_json->valuestring, "remove") == 0) {
+            err = stream_dest_remove(addr.s_addr, (uint16_t)port_json->valueint);
+        }
+        else {
+            cJSON_Delete(root);
+            return send_json_error(req, "400 Bad Request", "unknown action");
+        }
+    }
+    cJSON_Delete(root);
+
+    if (err == ESP_ERR_NO_MEM) {
+        return send_json_error(req, "409 Conflict", "destination table is full");
+    }
+    if (err == ESP_ERR_NOT_FOUND) {
+        return send_json_error(req, "404 Not Found", "destination not found");
+    }
+    if (err != ESP_OK) {
+        return send_json_error(req, "500 Internal Server Error", esp_err_to_name(err));
+    }
+    return send_destinations(req);
+}
+
+/**
+ * @brief 输出组播配置与统计
+ */
+static esp_err_t send_multicast(httpd_req_t* req)
+{
+    stream_dest_multicast_t config;
+    stream_dest_stats_t stats;
+    stream_dest_get_multicast(&config, &stats);
+
+    char group[16];
+    struct in_addr addr = {.s_addr = config.group};
+    inet_ntoa_r(addr, group, sizeof(group));
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "success", 1);
+    cJSON_AddBoolToObject(root, "enable", config.enabled);
+    cJSON_AddStringToObject(root, "group", group);
+    cJSON_AddNumberToObject(root, "port", config.port);
+    cJSON_AddNumberToObject(root, "ttl", config.ttl);
+    cJSON_AddNumberToObject(root, "frames", stats.frames);
+    cJSON_AddNumberToObject(root, "packets", stats.packets);
+    cJSON_AddNumberToObject(root, "bytes", (double)stats.bytes);
+    cJSON_AddNumberToObject(root, "errors", stats.errors);
+    cJSON_AddNumberToObject(root, "last_errno", stats.last_errno);
+
+    char* json_str = cJSON_PrintUnformatted(root);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, json_str);
+    free(json_str);
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
+static esp_err_t multicast_get_handler(httpd_req_t* req)
+{
+    return send_multicast(req);
+}
+
+static esp_err_t multicast_post_handler(httpd_req_t* req)
+{
+    cJSON* root = recv_json_body(req);
+    if (!root) {
+        return send_json_error(req, "400 Bad Request", "Invalid JSON");
+    }
+
+    stream_dest_multicast_t config;
+    stream_dest_get_multicast(&config, NULL);
+
+    cJSON* enable_json = cJSON_GetObjectItem(root, "enable");
+    cJSON* group_json = cJSON_GetObjectItem(root, "group");
+    cJSON* port_json = cJSON_GetObjectItem(root, "port");
+    cJSON* ttl_json = cJSON_GetObjectItem(root, "ttl");
+
+    bool valid = true;
+    if (enable_json) {
+        valid &= cJSON_IsBool(enable_json);
+        config.enabled = cJSON_IsTrue(enable_json);
+    }
+    if (group_json) {
+        struct in_addr addr;
+        valid &= cJSON_IsString(group_json) && inet_aton(group_json->valuestring, &addr) != 0;
+        config.group = valid ? addr.s_addr : 0;
+    }
+    if (port_json) {
+        valid &= cJSON_IsNumber(port_json) && port_json->valueint > 0 && port_json->valueint <= 65535;
+        config.port = (uint16_t)port_json->valueint;
+    }
+    if (ttl_json) {
+        valid &= cJSON_IsNumber(ttl_json) && ttl_json->valueint > 0 && ttl_json->valueint <= 255;
+        config.ttl = (uint8_t)ttl_json->valueint;
+    }
+    cJSON_Delete(root);
+
+    if (!valid || stream_dest_set_multicast(&config) == ESP_ERR_INVALID_ARG) {
+        return send_json_error(req, "400 Bad Request", "invalid multicast group, port or ttl");
+    }
+    return send_multicast(req);
+}
+
+static esp_err_t sdp_get_handler(httpd_req_t* req)
+{
+    if (udp_camera_get_stream_format() != UDP_CAMERA_FORMAT_RTP_JPEG) {
+        return send_json_error(req, "409 Conflict", "stream format is not RTP/JPEG");
+    }
+
+    char sdp[256];
+    if (udp_camera_get_sdp(sdp, sizeof(sdp)) == 0) {
+        return send_json_error(req, "404 Not Found", "no stream destination");
+    }
+    httpd_resp_set_type(req, "application/sdp");
+    httpd_resp_sendstr(req, sdp);
+    return ESP_OK;
+}
+
+/**
+ * @brief MJPEG流任务：每个客户端一个，按自己的速度取最新帧，发送慢时自动跳帧
+ *
+ * @param arg 异步请求（httpd_req_async_handler_begin 的副本）
+ */
+static void stream_task(void* arg)
+{
+    httpd_req_t* req = (httpd_req_t*)arg;
+    uint32_t last_seq = 0;
+    uint32_t sent = 0;
+    uint32_t skipped = 0;
+    int64_t start_us = esp_timer_get_time();
+
+    httpd_resp_set_type(req, STREAM_CONTENT_TYPE);
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    esp_err_t err = ESP_OK;
+    while (err == ESP_OK && !s_stream_stopping) {
+        const frame_slot_frame_t* frame = frame_slot_acquire(last_seq, pdMS_TO_TICKS(STREAM_FRAME_TIMEOUT_MS));
+        if (frame == NULL) {
+            continue;
+        }
+        if (last_seq != 0) {
+            skipped += frame->seq - last_seq - 1;
+        }
+        last_seq = frame->seq;
+
+        char part[128];
+        int len = snprintf(part,
+                           sizeof(part),
+                           STREAM_PART_HEADER,
+                           (unsigned)frame->len,
+                           (unsigned long long)(frame->timestamp_us / 1000000),
+                           (unsigned long)(frame->timestamp_us % 1000000));
+        err = httpd_resp_send_chunk(req, part, len);
+        if (err == ESP_OK) {
+            err = httpd_resp_send_chunk(req, (const char*)frame->data, frame->len);
+        }
+        frame_slot_release(frame);
+        if (err == ESP_OK) {
+            sent++;
+        }
+    }
+    if (err == ESP_OK) {
+        httpd_resp_send_chunk(req, NULL, 0);
+    }
+
+    int64_t elapsed_ms = (esp_timer_get_time() - start_us) / 1000;
+    ESP_LOGI(TAG, "MJPEG客户端断开: 发送 %lu 帧, 跳过 %lu 帧, 持续 %lld ms", (unsigned long)sent, (unsigned long)skipped, (long long)elapsed_ms);
+
+    httpd_req_async_handler_complete(req);
+    taskENTER_CRITICAL(&s_stream_lock);
+    s_stream_clients--;
+    taskEXIT_CRITICAL(&s_stream_lock);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t stream_get_handler(httpd_req_t* req)
+{
+    taskENTER_CRITICAL(&s_stream_lock);
+    bool accepted = !s_stream_stopping && s_stream_clients < CONFIG_CAMERA_HTTP_STREAM_CLIENTS;
+    if (accepted) {
+        s_stream_clients++;
+    }
+    taskEXIT_CRITICAL(&s_stream_lock);
+    if (!accepted) {
+        return send_json_error(req, "503 Service Unavailable", "too many stream clients");
+    }
+
+    // 流在独立任务中发送，服务器任务立即返回，其他请求与其他流不受影响
+    httpd_req_t* async_req = NULL;
+    esp_err_t err = httpd_req_async_handler_begin(req, &async_req);
+    if (err == ESP_OK && xTaskCreate(stream_task, "mjpeg_stream", 4096, async_req, 2, NULL) != pdPASS) {
+        httpd_resp_send_err(async_req, HTTPD_500_INTERNAL_SERVER_ERROR, "no memory for stream task");
+        httpd_req_async_handler_complete(async_req);
+        err = ESP_ERR_NO_MEM;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "启动MJPEG流失败: %s", esp_err_to_name(err));
+        taskENTER_CRITICAL(&s_stream_lock);
+        s_stream_clients--;
+        taskEXIT_CRITICAL(&s_stream_lock);
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "MJPEG客户端连接，当前 %lu 个", (unsigned long)s_stream_clients);
+    return ESP_OK;
+}
+
+static esp_err_t capture_get_handler(httpd_req_t* req)
+{
+    // 最新帧足够新时直接使用，否则等待下一帧
+    int64_t age_us;
+    uint32_t seq = frame_slot_latest_seq(&age_us);
+    uint32_t after_seq = (seq != 0 && age_us < CAPTURE_MAX_AGE_US) ? seq - 1 : seq;
+
+    const frame_slot_frame_t* frame = frame_slot_acquire(after_seq, pdMS_TO_TICKS(CAPTURE_TIMEOUT_MS));
+    if (frame == NULL) {
+        return send_json_error(req, "503 Service Unavailable", "no frame available");
+    }
+
+    char timestamp[32];
+    snprintf(timestamp, sizeof(timestamp), "%llu.%06lu", (unsigned long long)(frame->timestamp_us / 1000000), (unsigned long)(frame->timestamp_us % 1000000));
+    httpd_resp_set_type(req, "image/jpeg");
+    httpd_resp_set_hdr(req, "Content-Disposition", "inline; filename=capture.jpg");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "X-Timestamp", timestamp);
+    esp_err_t err = httpd_resp_send(req, (const char*)frame->data, frame->len);
+    frame_slot_release(frame);
+    return err;
+}
+
+static esp_err_t rtsp_get_handler(httpd_req_t* req)
+{
+    rtsp_session_stats_t sessions[RTSP_SERVER_MAX_SESSIONS];
+    uint32_t count = rtsp_server_get_sessions(sessions);
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "success", 1);
+    cJSON_AddNumberToObject(root, "max", RTSP_SERVER_MAX_SESSIONS);
+    cJSON* list = cJSON_AddArrayToObject(root, "sessions");
+    for (uint32_t i = 0; i < count; i++) {
+        char ip[16];
+        char id[12];
+        inet_ntoa_r(sessions[i].peer.sin_addr, ip, sizeof(ip));
+        snprintf(id, sizeof(id), "%08lX", (unsigned long)sessions[i].session_id);
+
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "session", id);
+        cJSON_AddStringToObject(item, "client", ip);
+        cJSON_AddStringToObject(item, "transport", sessions[i].tcp ? "tcp" : "udp");
+        cJSON_AddBoolToObject(item, "playing", sessions[i].playing);
+        cJSON_AddNumberToObject(item, "setup_us", sessions[i].setup_us);
+        cJSON_AddNumberToObject(item, "first_frame_us", sessions[i].first_frame_us);
+        cJSON_AddNumberToObject(item, "frames", sessions[i].frames);
+        cJSON_AddNumberToObject(item, "skipped", sessions[i].skipped);
+        cJSON_AddNumberToObject(item, "packets", sessions[i].packets);
+        cJSON_AddNumberToObject(item, "bytes", (double)sessions[i].bytes);
+        cJSON_AddNumberToObject(item, "send_errors", sessions[i].send_errors);
+        cJSON_AddNumberToObject(item, "cycles_per_frame", sessions[i].cycles_per_frame);
+        cJSON_AddNumberToObject(item, "cpu_percent", sessions[i].cpu_permille / 10.0);
+        cJSON_AddItemToArray(list, item);
+    }
+
+    char* json_str = cJSON_PrintUnformatted(root);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, json_str);
+    free(json_str);
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
+static esp_err_t frames_get_handler(httpd_req_t* req)
+{
+    frame_broker_stats_t stats;
+    frame_broker_get_stats(&stats);
+    frame_slot_stats_t slot;
+    frame_slot_get_stats(&slot);
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "success", 1);
+    cJSON_AddNumberToObject(root, "published", stats.published);
+    cJSON_AddNumberToObject(root, "wrap_fails", stats.wrap_fails);
+    cJSON_AddNumberToObject(root, "in_use", stats.in_use);
+    cJSON_AddNumberToObject(root, "in_use_max", stats.in_use_max);
+    cJSON_AddNumberToObject(root, "pool_size", stats.pool_size);
+    cJSON_AddNumberToObject(root, "fb_count", stats.capacity);
+    cJSON_AddNumberToObject(root, "slot_readers", slot.readers);
+    cJSON_AddNumberToObject(root, "slot_starved", slot.starved);
+    cJSON* list = cJSON_AddArrayToObject(root, "subscribers");
+    for (uint32_t i = 0; i < stats.subscribers; i++) {
+        const frame_broker_sub_stats_t* sub = &stats.sub[i];
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", sub->name);
+        cJSON_AddStringToObject(item, "policy", sub->policy == FRAME_BROKER_DROP_OLDEST ? "drop_oldest" : "drop_newest");
+        cJSON_AddNumberToObject(item, "capacity", sub->queue.capacity);
+        cJSON_AddNumberToObject(item, "depth", sub->queue.depth);
+        cJSON_AddNumberToObject(item, "high_water", sub->queue.high_water);
+        cJSON_AddNumberToObject(item, "delivered", sub->queue.pushed);
+        cJSON_AddNumberToObject(item, "consumed", sub->queue.popped);
+        cJSON_AddNumberToObject(item, "dropped", sub->queue.dropped + sub->rejected);
+        cJSON_AddBoolToObject(item, "optional", sub->optional);
+        cJSON_AddNumberToObject(item, "starved", sub->starved);
+        cJSON_AddItemToArray(list, item);
+    }
+
+    char* json_str = cJSON_PrintUnformatted(root);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, json_str);
+    free(json_str);
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
+/**
+ * @brief 输出事件片段统计
+ */
+static esp_err_t send_clip_stats(httpd_req_t* req)
+{
+    event_clip_stats_t stats;
+    event_clip_get_stats(&stats);
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "success", 1);
+    cJSON_AddNumberToObject(root, "arena_bytes", stats.arena_bytes);
+    cJSON_AddNumberToObject(root, "used_bytes", stats.used_bytes);
+    cJSON_AddNumberToObject(root, "frames", stats.frames);
+    cJSON_AddNumberToObject(root, "span_ms", stats.span_ms);
+    cJSON_AddNumberToObject(root, "recorded", stats.recorded);
+    cJSON_AddNumberToObject(root, "evicted_age", stats.evicted_age);
+    cJSON_AddNumberToObject(root, "evicted_space", stats.evicted_space);
+    cJSON_AddNumberToObject(root, "evictions_per_s", stats.evictions_per_s);
+    cJSON_AddNumberToObject(root, "dropped", stats.dropped);
+    cJSON_AddNumberToObject(root, "triggers", stats.triggers);
+    cJSON_AddNumberToObject(root, "clips", stats.clips);
+    cJSON_AddNumberToObject(root, "failures", stats.failures);
+    cJSON_AddBoolToObject(root, "dumping", stats.dumping);
+    cJSON* last = cJSON_AddObjectToObject(root, "last_clip");
+    cJSON_AddNumberToObject(last, "frames", stats.last_frames);
+    cJSON_AddNumberToObject(last, "bytes", stats.last_bytes);
+    cJSON_AddNumberToObject(last, "duration_ms", stats.last_dump_ms);
+    cJSON_AddNumberToObject(last, "kbps", stats.last_kbps);
+
+    char* json_str = cJSON_PrintUnformatted(root);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, json_str);
+    free(json_str);
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
+static esp_err_t clip_get_handler(httpd_req_t* req)
+{
+    return send_clip_stats(req);
+}
+
+/**
+ * @brief 取得请求方的 IPv4 地址（IPv6 套接字上为 IPv4 映射地址）
+ */
+static bool get_peer_ipv4(httpd_req_t* req, struct in_addr* addr)
+{
+    struct sockaddr_storage peer;
+    socklen_t len = sizeof(peer);
+    if (getpeername(httpd_req_to_sockfd(req), (struct sockaddr*)&peer, &len) != 0) {
+        return false;
+    }
+    if (peer.ss_family == AF_INET) {
+        *addr = ((struct sockaddr_in*)&peer)->sin_addr;
+        return true;
+    }
+    if (peer.ss_family == AF_INET6) {
+        memcpy(&addr->s_addr, &((struct sockaddr_in6*)&peer)->sin6_addr.s6_addr[12], 4);
+        return true;
+    }
+    return false;
+}
+
+static esp_err_t clip_post_handler(httpd_req_t* req)
+{
+    // 请求体可省略，全部使用默认值
+    cJSON* root = NULL;
+    if (req->content_len > 0) {
+        root = recv_json_body(req);
+        if (!root) {
+            return send_json_error(req, "400 Bad Request", "Invalid JSON");
+        }
+    }
+
+    cJSON* ip_json = cJSON_GetObjectItem(root, "ip");
+    cJSON* port_json = cJSON_GetObjectItem(root, "port");
+    cJSON* post_json = cJSON_GetObjectItem(root, "post_seconds");
+
+    bool valid = true;
+    struct sockaddr_in receiver = {.sin_family = AF_INET};
+    if (ip_json) {
+        valid &= cJSON_IsString(ip_json) && inet_aton(ip_json->valuestring, &receiver.sin_addr) != 0;
+    }
+    else if (port_json) {
+        valid &= get_peer_ipv4(req, &receiver.sin_addr);
+    }
+    if (port_json) {
+        valid &= cJSON_IsNumber(port_json) && port_json->valueint > 0 && port_json->valueint <= 65535;
+        receiver.sin_port = htons((uint16_t)port_json->valueint);
+    }
+    else {
+        receiver.sin_port = htons(CONFIG_EVENT_CLIP_RECEIVER_PORT);
+    }
+    uint32_t post_ms = 0;
+    if (post_json) {
+        valid &= cJSON_IsNumber(post_json) && post_json->valueint > 0 && post_json->valueint <= 60;
+        post_ms = (uint32_t)post_json->valueint * 1000;
+    }
+    bool has_receiver = (ip_json != NULL || port_json != NULL);
+    cJSON_Delete(root);
+
+    if (!valid) {
+        return send_json_error(req, "400 Bad Request", "invalid ip, port or post_seconds");
+    }
+    esp_err_t err = event_clip_trigger(has_receiver ? &receiver : NULL, post_ms, EVENT_CLIP_SOURCE_HTTP);
+    if (err == ESP_ERR_NOT_FOUND) {
+        return send_json_error(req, "409 Conflict", "no clip receiver");
+    }
+    if (err != ESP_OK) {
+        return send_json_error(req, "503 Service Unavailable", esp_err_to_name(err));
+    }
+    return send_clip_stats(req);
+}
+
+/**
+ * @brief 输出运动检测结果、统计与运动门控
+ */
+static esp_err_t send_motion(httpd_req_t* req)
+{
+    motion_stage_state_t state;
+    bool valid = motion_stage_get_state(&state);
+    motion_stage_stats_t stats;
+    motion_stage_get_stats(&stats);
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "success", 1);
+    cJSON_AddBoolToObject(root, "valid", valid);
+    if (valid) {
+        const motion_detect_result_t* r = &state.result;
+        cJSON_AddNumberToObject(root, "frame_seq", state.frame_seq);
+        cJSON_AddBoolToObject(root, "motion", r->motion);
+        cJSON_AddBoolToObject(root, "global_change", r->global_change);
+        cJSON_AddNumberToObject(root, "score", r->score);
+        cJSON_AddNumberToObject(root, "level", r->level);
+        cJSON_AddNumberToObject(root, "motion_blocks", r->motion_blocks);
+        cJSON_AddNumberToObject(root, "since_motion_ms", state.last_motion_us > 0 ? (double)((esp_timer_get_time() - state.last_motion_us) / 1000) : -1);
+        cJSON* list = cJSON_AddArrayToObject(root, "regions");
+        for (uint32_t i = 0; i < r->region_count; i++) {
+            cJSON* item = cJSON_CreateObject();
+            cJSON_AddNumberToObject(item, "x", r->regions[i].x * MOTION_STAGE_SCALE);
+            cJSON_AddNumberToObject(item, "y", r->regions[i].y * MOTION_STAGE_SCALE);
+            cJSON_AddNumberToObject(item, "w", r->regions[i].w * MOTION_STAGE_SCALE);
+            cJSON_AddNumberToObject(item, "h", r->regions[i].h * MOTION_STAGE_SCALE);
+            cJSON_AddNumberToObject(item, "blocks", r->regions[i].blocks);
+            cJSON_AddItemToArray(list, item);
+        }
+    }
+    cJSON_AddNumberToObject(root, "plane_width", state.width);
+    cJSON_AddNumberToObject(root, "plane_height", state.height);
+    cJSON_AddNumberToObject(root, "block", stats.block);
+    cJSON_AddNumberToObject(root, "analysed", stats.analysed);
+    cJSON_AddNumberToObject(root, "skipped", stats.skipped);
+    cJSON_AddNumberToObject(root, "decode_failures", stats.decode_failures);
+    cJSON_AddNumberToObject(root, "resets", stats.resets);
+    cJSON_AddNumberToObject(root, "motion_frames", stats.detector.motion_frames);
+    cJSON_AddNumberToObject(root, "global_changes", stats.detector.global_changes);
+    cJSON_AddNumberToObject(root, "decode_avg_us", stats.decode_avg_us);
+    cJSON_AddNumberToObject(root, "detect_avg_us", stats.detect_avg_us);
+
+    motion_gate_config_t gate_config;
+    motion_gate_stats_t gate_stats;
+    udp_camera_get_motion_gate(&gate_config, &gate_stats);
+    cJSON* gate = cJSON_AddObjectToObject(root, "gate");
+    cJSON_AddBoolToObject(gate, "enable", gate_config.enabled);
+    cJSON_AddBoolToObject(gate, "active", gate_stats.active);
+    cJSON_AddNumberToObject(gate, "threshold", gate_config.score_threshold);
+    cJSON_AddNumberToObject(gate, "keepalive_ms", gate_config.keepalive_ms);
+    cJSON_AddNumberToObject(gate, "holdoff_ms", gate_config.holdoff_ms);
+    cJSON_AddNumberToObject(gate, "sent_motion", gate_stats.sent_motion);
+    cJSON_AddNumberToObject(gate, "sent_holdoff", gate_stats.sent_holdoff);
+    cJSON_AddNumberToObject(gate, "sent_keepalive", gate_stats.sent_keepalive);
+    cJSON_AddNumberToObject(gate, "sent_ungated", gate_stats.sent_ungated);
+    cJSON_AddNumberToObject(gate, "suppressed", gate_stats.suppressed);
+    cJSON_AddNumberToObject(gate, "bytes_sent", (double)gate_stats.bytes_sent);
+    cJSON_AddNumberToObject(gate, "bytes_suppressed", (double)gate_stats.bytes_suppressed);
+
+    char* json_str = cJSON_PrintUnformatted(root);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, json_str);
+    free(json_str);
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
+static esp_err_t motion_get_handler(httpd_req_t* req)
+{
+    return send_motion(req);
+}
+
+static esp_err_t motion_post_handler(httpd_req_t* req)
+{
+    cJSON* root = recv_json_body(req);
+    if (!root) {
+        return send_json_error(req, "400 Bad Request", "Invalid JSON");
+    }
+
+    motion_gate_config_t config;
+    udp_camera_get_motion_gate(&config, NULL);
+
+    cJSON* gate_json = cJSON_GetObjectItem(root, "gate");
+    cJSON* threshold_json = cJSON_GetObjectItem(root, "threshold");
+    cJSON* keepalive_json = cJSON_GetObjectItem(root, "keepalive_ms");
+    cJSON* holdoff_json = cJSON_GetObjectItem(root, "holdoff_ms");
+
+    bool valid = true;
+    if (gate_json) {
+        valid &= cJSON_IsBool(gate_json);
+        config.enabled = cJSON_IsTrue(gate_json);
+    }
+    if (threshold_json) {
+        valid &= cJSON_IsNumber(threshold_json) && threshold_json->valueint >= 0 && threshold_json->valueint <= 1000;
+        config.score_threshold = (uint16_t)threshold_json->valueint;
+    }
+    if (keepalive_json) {
+        valid &= cJSON_IsNumber(keepalive_json) && keepalive_json->valueint >= 100 && keepalive_json->valueint <= 600000;
+        config.keepalive_ms = (uint32_t)keepalive_json->valueint;
+    }
+    if (holdoff_json) {
+        valid &= cJSON_IsNumber(holdoff_json) && holdoff_json->valueint >= 0 && holdoff_json->valueint <= 600000;
+        config.holdoff_ms = (uint32_t)holdoff_json->valueint;
+    }
+    cJSON_Delete(root);
+
+    if (!valid) {
+        return send_json_error(req, "400 Bad Request", "invalid gate, threshold, keepalive_ms or holdoff_ms");
+    }
+    udp_camera_set_motion_gate(&config);
+    return send_motion(req);
+}
+
+/**
+ * @brief 输出两路图像流的带宽与CPU占用
+ */
+static esp_err_t send_streams(httpd_req_t* req)
+{
+    udp_camera_pipeline_stats_t pipeline;
+    udp_camera_get_pipeline_stats(&pipeline);
+    udp_pacer_stats_t pacer;
+    udp_camera_get_pacer_stats(&pacer);
+    retransmit_stats_t retransmit;
+    udp_camera_get_retransmit_stats(&retransmit);
+    udp_camera_frame_timing_t timing;
+    udp_camera_get_frame_timing(&timing);
+    uint32_t abr_target_bps = 0;
+    bool abr_enabled = udp_camera_get_adaptive_bitrate(&abr_target_bps);
+    bitrate_ctrl_stats_t abr;
+    udp_camera_get_bitrate_stats(&abr);
+    thumb_stream_config_t config;
+    thumb_stream_stats_t stats;
+    thumb_stream_get(&config, &stats);
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "success", 1);
+
+    cJSON* main_json = cJSON_AddObjectToObject(root, "main");
+    cJSON_AddStringToObject(main_json, "format", udp_camera_get_stream_format() == UDP_CAMERA_FORMAT_RTP_JPEG ? "rtp" : "image");
+    cJSON_AddNumberToObject(main_json, "sent", pipeline.sent);
+    cJSON_AddNumberToObject(main_json, "send_failures", pipeline.send_failures);
+    cJSON_AddNumberToObject(main_json, "bytes", (double)pipeline.bytes_sent);
+    cJSON_AddNumberToObject(main_json, "target_bps", pacer.target_bps);
+    cJSON_AddNumberToObject(main_json, "burst_bytes", pacer.burst_bytes);
+    cJSON_AddNumberToObject(main_json, "protocol", udp_camera_get_protocol_version());
+    cJSON_AddNumberToObject(main_json, "fec_group", udp_camera_get_fec_group_size());
+    cJSON_AddNumberToObject(main_json, "achieved_bps", pacer.achieved_bps);
+    cJSON_AddNumberToObject(main_json, "send_avg_us", pipeline.send_avg_us);
+    cJSON_AddNumberToObject(main_json, "cycles_per_frame", pipeline.cycles_per_frame);
+    cJSON_AddNumberToObject(main_json, "cpu_permille", pipeline.cpu_permille);
+
+    cJSON* timing_json = cJSON_AddObjectToObject(main_json, "timing");
+    cJSON_AddNumberToObject(timing_json, "target_fps", timing.governor.target_fps);
+    cJSON_AddNumberToObject(timing_json, "fps", timing.fps);
+    cJSON_AddNumberToObject(timing_json, "jitter_us", timing.jitter_us);
+    cJSON_AddNumberToObject(timing_json, "missed", timing.governor.missed);
+    cJSON_AddNumberToObject(timing_json, "late_avg_us", timing.governor.late_avg_us);
+    cJSON_AddNumberToObject(timing_json, "late_max_us", timing.governor.late_max_us);
+
+    cJSON* abr_json = cJSON_AddObjectToObject(main_json, "abr");
+    cJSON_AddBoolToObject(abr_json, "enable", abr_enabled);
+    cJSON_AddNumberToObject(abr_json, "target_bps", abr_target_bps);
+    cJSON_AddNumberToObject(abr_json, "quality", abr.setting.quality);
+    cJSON_AddNumberToObject(abr_json, "level", abr.setting.level);
+    cJSON_AddNumberToObject(abr_json, "demand_bps", abr.demand_bps);
+    cJSON_AddNumberToObject(abr_json, "avg_frame_bytes", abr.avg_frame_bytes);
+    cJSON_AddNumberToObject(abr_json, "avg_send_us", abr.avg_send_us);
+    cJSON_AddNumberToObject(abr_json, "steps_down", abr.steps_down);
+    cJSON_AddNumberToObject(abr_json, "steps_up", abr.steps_up);
+    cJSON_AddNumberToObject(abr_json, "congestion_frames", abr.congestion_frames);
+
+    cJSON* retransmit_json = cJSON_AddObjectToObject(main_json, "retransmit");
+    cJSON_AddNumberToObject(retransmit_json, "nacks", retransmit.nacks);
+    cJSON_AddNumberToObject(retransmit_json, "rejected", retransmit.rejected);
+    cJSON_AddNumberToObject(retransmit_json, "hits", retransmit.hits);
+    cJSON_AddNumberToObject(retransmit_json, "misses", retransmit.misses);
+    cJSON_AddNumberToObject(retransmit_json, "evictions", retransmit.evictions);
+    cJSON_AddNumberToObject(retransmit_json, "frames", retransmit.frames);
+    cJSON_AddNumberToObject(retransmit_json, "bytes", retransmit.bytes);
+    cJSON_AddNumberToObject(retransmit_json, "latency_avg_us", retransmit.latency_avg_us);
+    cJSON_AddNumberToObject(retransmit_json, "latency_max_us", retransmit.latency_max_us);
+
+    char ip[16] = "";
+    if (config.ip != 0) {
+        struct in_addr addr = {.s_addr = config.ip};
+        inet_ntoa_r(addr, ip, sizeof(ip));
+    }
+    cJSON* thumb = cJSON_AddObjectToObject(root, "thumb");
+    cJSON_AddBoolToObject(thumb, "enable", config.enabled);
+    cJSON_AddStringToObject(thumb, "ip", ip);
+    cJSON_AddNumberToObject(thumb, "port", config.port);
+    cJSON_AddNumberToObject(thumb, "fps", config.fps);
+    cJSON_AddNumberToObject(thumb, "kbps", config.max_bps / 1000);
+    cJSON_AddNumberToObject(thumb, "quality", config.quality);
+    cJSON_AddBoolToObject(thumb, "color", config.color);
+    cJSON_AddNumberToObject(thumb, "width", stats.width);
+    cJSON_AddNumberToObject(thumb, "height", stats.height);
+    cJSON_AddNumberToObject(thumb, "last_size", stats.last_size);
+    cJSON_AddNumberToObject(thumb, "sent", stats.sent);
+    cJSON_AddNumberToObject(thumb, "rate_skipped", stats.rate_skipped);
+    cJSON_AddNumberToObject(thumb, "busy_skipped", stats.busy_skipped);
+    cJSON_AddNumberToObject(thumb, "failures", stats.failures);
+    cJSON_AddNumberToObject(thumb, "send_errors", stats.send_errors);
+    cJSON_AddNumberToObject(thumb, "bytes", (double)stats.bytes);
+    cJSON_AddNumberToObject(thumb, "achieved_bps", stats.achieved_bps);
+    cJSON_AddNumberToObject(thumb, "decode_avg_us", stats.decode_avg_us);
+    cJSON_AddNumberToObject(thumb, "encode_avg_us", stats.encode_avg_us);
+    cJSON_AddNumberToObject(thumb, "send_avg_us", stats.send_avg_us);
+    cJSON_AddNumberToObject(thumb, "cycles_per_frame", stats.cycles_per_frame);
+    cJSON_AddNumberToObject(thumb, "cpu_permille", stats.cpu_permille);
+
+    char* json_str = cJSON_PrintUnformatted(root);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, json_str);
+    free(json_str);
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
+static esp_err_t streams_get_handler(httpd_req_t* req)
+{
+    return send_streams(req);
+}
+
+/**
+ * @brief 主图像流的运行时参数修改请求，-1 表示保持不变
+ */
+typedef struct
+{
+    int32_t format;  // udp_camera_stream_format_t
+    int32_t kbps;
+    int32_t burst_bytes;
+    int32_t protocol;
+    int32_t fec_group;
+    int32_t fps;
+    int32_t abr;       // 0 关闭, 1 开启
+    int32_t abr_kbps;  // 自适应码率的目标码率
+} main_stream_request_t;
+
+/**
+ * @brief 解析 POST /api/streams 的 "main" 对象
+ * @return 全部字段有效时返回 true
+ */
+static bool parse_main_stream(cJSON* json, main_stream_request_t* request)
+{
+    bool valid = true;
+    cJSON* format_json = cJSON_GetObjectItem(json, "format");
+    cJSON* kbps_json = cJSON_GetObjectItem(json, "kbps");
+    cJSON* burst_json = cJSON_GetObjectItem(json, "burst_bytes");
+    cJSON* protocol_json = cJSON_GetObjectItem(json, "protocol");
+    cJSON* fec_json = cJSON_GetObjectItem(json, "fec_group");
+    cJSON* fps_json = cJSON_GetObjectItem(json, "fps");
+    cJSON* abr_json = cJSON_GetObjectItem(json, "abr");
+    cJSON* abr_kbps_json = cJSON_GetObjectItem(json, "abr_kbps");
+    if (format_json) {
+        if (cJSON_IsString(format_json) && strcmp(format_json->valuestring, "image") == 0) {
+            request->format = UDP_CAMERA_FORMAT_IMAGE_PROTO;
+        }
+        else if (cJSON_IsString(format_json) && strcmp(format_json->valuestring, "rtp") == 0) {
+            request->format = UDP_CAMERA_FORMAT_RTP_JPEG;
+        }
+        else {
+            valid = false;
+        }
+    }
+    if (kbps_json) {
+        valid &= cJSON_IsNumber(kbps_json) && kbps_json->valueint >= 0 && kbps_json->valueint <= 100000;
+        request->kbps = kbps_json->valueint;
+    }
+    if (burst_json) {
+        valid &= cJSON_IsNumber(burst_json) && burst_json->valueint >= IMAGE_PROTO_MAX_PACKET_SIZE && burst_json->valueint <= 262144;
+        request->burst_bytes = burst_json->valueint;
+    }
+    if (protocol_json) {
+        valid &= cJSON_IsNumber(protocol_json) && (protocol_json->valueint == 1 || protocol_json->valueint == IMAGE_PROTO_VERSION);
+        request->protocol = protocol_json->valueint;
+    }
+    if (fec_json) {
+        valid &= cJSON_IsNumber(fec_json) && fec_json->valueint >= 0 && fec_json->valueint <= IMAGE_FEC_MAX_GROUP_SIZE;
+        request->fec_group = fec_json->valueint;
+    }
+    if (fps_json) {
+        valid &= cJSON_IsNumber(fps_json) && fps_json->valueint >= 0 && fps_json->valueint <= 60;
+        request->fps = fps_json->valueint;
+    }
+    if (abr_json) {
+        valid &= cJSON_IsBool(abr_json);
+        request->abr = cJSON_IsTrue(abr_json) ? 1 : 0;
+    }
+    if (abr_kbps_json) {
+        valid &= cJSON_IsNumber(abr_kbps_json) && abr_kbps_json->valueint >= 1 && abr_kbps_json->valueint <= 100000;
+        request->abr_kbps = abr_kbps_json->valueint;
+    }
+    return valid;
+}
+
+/**
+ * @brief 应用主图像流的参数修改（字段已校验）
+ */
+static void apply_main_stream(const main_stream_request_t* request)
+{
+    if (request->format >= 0) {
+        udp_camera_set_stream_format((udp_camera_stream_format_t)request->format);
+    }
+    if (request->kbps >= 0 || request->burst_bytes >= 0) {
+        udp_pacer_stats_t pacer;
+        udp_camera_get_pacer_stats(&pacer);
+        udp_camera_set_bitrate(request->kbps >= 0 ? (uint32_t)request->kbps * 1000 : pacer.target_bps,
+                               request->burst_bytes >= 0 ? (uint32_t)request->burst_bytes : pacer.burst_bytes);
+    }
+    if (request->protocol >= 0) {
+        udp_camera_set_protocol_version((uint8_t)request->protocol);
+    }
+    if (request->fec_group >= 0) {
+        udp_camera_set_fec_group_size((uint8_t)request->fec_group);
+    }
+    if (request->fps >= 0) {
+        udp_camera_set_target_fps((uint32_t)request->fps);
+    }
+    if (request->abr >= 0 || request->abr_kbps >= 0) {
+        bool enable = request->abr >= 0 ? request->abr == 1 : udp_camera_get_adaptive_bitrate(NULL);
+        udp_camera_set_adaptive_bitrate(enable, request->abr_kbps >= 0 ? (uint32_t)request->abr_kbps * 1000 : 0);
+    }
+}
+
+static esp_err_t streams_post_handler(httpd_req_t* req)
+{
+    cJSON* root = recv_json_body(req);
+    if (!root) {
+        return send_json_error(req, "400 Bad Request", "Invalid JSON");
+    }
+
+    thumb_stream_config_t config;
+    thumb_stream_get(&config, NULL);
+    main_stream_request_t main_request = {.format = -1, .kbps = -1, .burst_bytes = -1, .protocol = -1, .fec_group = -1, .fps = -1, .abr = -1, .abr_kbps = -1};
+
+    cJSON* main_json = cJSON_GetObjectItem(root, "main");
+    cJSON* thumb = cJSON_GetObjectItem(root, "thumb");
+    bool valid = (main_json != NULL || thumb != NULL);
+    if (main_json) {
+        valid &= cJSON_IsObject(main_json) && parse_main_stream(main_json, &main_request);
+    }
+    if (thumb && !cJSON_IsObject(thumb)) {
+        valid = false;
+    }
+    else if (thumb) {
+        cJSON* enable_json = cJSON_GetObjectItem(thumb, "enable");
+        cJSON* ip_json = cJSON_GetObjectItem(thumb, "ip");
+        cJSON* port_json = cJSON_GetObjectItem(thumb, "port");
+        cJSON* fps_json = cJSON_GetObjectItem(thumb, "fps");
+        cJSON* kbps_json = cJSON_GetObjectItem(thumb, "kbps");
+        cJSON* quality_json = cJSON_GetObjectItem(thumb, "quality");
+        cJSON* color_json = cJSON_GetObjectItem(thumb, "color");
+        if (enable_json) {
+            valid &= cJSON_IsBool(enable_json);
+            config.enabled = cJSON_IsTrue(enable_json);
+        }
+        if (ip_json) {
+            struct in_addr addr = {0};
+            valid &= cJSON_IsString(ip_json) && (ip_json->valuestring[0] == '\0' || inet_aton(ip_json->valuestring, &addr) != 0);
+            config.ip = valid ? addr.s_addr : 0;
+        }
+        if (port_json) {
+            valid &= cJSON_IsNumber(port_json) && port_json->valueint > 0 && port_json->valueint <= 65535;
+            config.port = (uint16_t)port_json->valueint;
+        }
+        if (fps_json) {
+            valid &= cJSON_IsNumber(fps_json) && fps_json->valueint >= 1 && fps_json->valueint <= 30;
+            config.fps = (uint8_t)fps_json->valueint;
+        }
+        if (kbps_json) {
+            valid &= cJSON_IsNumber(kbps_json) && kbps_json->valueint >= 0 && kbps_json->valueint <= 10000;
+            config.max_bps = (uint32_t)kbps_json->valueint * 1000;
+        }
+        if (quality_json) {
+            valid &= cJSON_IsNumber(quality_json) && quality_json->valueint >= 1 && quality_json->valueint <= 100;
+            config.quality = (uint8_t)quality_json->valueint;
+        }
+        if (color_json) {
+            valid &= cJSON_IsBool(color_json);
+            config.color = cJSON_IsTrue(color_json);
+        }
+    }
+    cJSON_Delete(root);
+
+    if (!valid) {
+        return send_json_error(req, "400 Bad Request", "invalid main or thumb settings");
+    }
+    if (thumb) {
+        esp_err_t err = thumb_stream_set_config(&config);
+        if (err == ESP_ERR_INVALID_STATE) {
+            return send_json_error(req, "409 Conflict", "thumbnail stream not enabled in build");
+        }
+        if (err != ESP_OK) {
+            return send_json_error(req, "400 Bad Request", esp_err_to_name(err));
+        }
+    }
+    apply_main_stream(&main_request);
+    return send_streams(req);
+}
+
+/**
+ * @brief 输出相机参数与统计
+ */
+static esp_err_t send_camera(httpd_req_t* req)
+{
+    camera_ctrl_state_t state;
+    camera_ctrl_get(&state);
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "success", 1);
+    cJSON_AddStringToObject(root, "sensor", state.sensor_name != NULL ? state.sensor_name : "");
+    cJSON_AddNumberToObject(root, "max_framesize", state.max_framesize);
+    cJSON_AddNumberToObject(root, "buffer_framesize", state.buffer_framesize);
+    cJSON* settings = cJSON_AddObjectToObject(root, "settings");
+    cJSON* persisted = cJSON_AddArrayToObject(root, "persisted");
+    for (int p = 0; p < CAMERA_CTRL_PARAM_COUNT; p++) {
+        const char* name = camera_ctrl_param_name(p);
+        cJSON_AddNumberToObject(settings, name, state.values[p]);
+        if ((state.persisted_mask & (1u << p)) != 0) {
+            cJSON_AddItemToArray(persisted, cJSON_CreateString(name));
+        }
+    }
+    cJSON_AddBoolToObject(root, "commit_pending", state.commit_pending);
+    cJSON* stats = cJSON_AddObjectToObject(root, "stats");
+    cJSON_AddNumberToObject(stats, "applied", state.stats.applied);
+    cJSON_AddNumberToObject(stats, "rejected", state.stats.rejected);
+    cJSON_AddNumberToObject(stats, "apply_failures", state.stats.apply_failures);
+    cJSON_AddNumberToObject(stats, "reinits", state.stats.reinits);
+    cJSON_AddNumberToObject(stats, "reinit_failures", state.stats.reinit_failures);
+    cJSON_AddNumberToObject(stats, "commits", state.stats.commits);
+    cJSON_AddNumberToObject(stats, "commit_skipped", state.stats.commit_skipped);
+    cJSON_AddNumberToObject(stats, "commit_failures", state.stats.commit_failures);
+
+    char* json_str = cJSON_PrintUnformatted(root);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, json_str);
+    free(json_str);
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
+static esp_err_t camera_get_handler(httpd_req_t* req)
+{
+    return send_camera(req);
+}
+
+static esp_err_t camera_post_handler(httpd_req_t* req)
+{
+    cJSON* root = recv_json_body(req);
+    if (!root) {
+        return send_json_error(req, "400 Bad Request", "Invalid JSON");
+    }
+
+    camera_ctrl_change_t changes[CAMERA_CTRL_PARAM_COUNT];
+    size_t count = 0;
+    bool reset = false;
+    bool commit = false;
+    const char* invalid = NULL;
+    for (cJSON* item = root->child; item != NULL; item = item->next) {
+        camera_ctrl_param_t param;
+        if (strcmp(item->string, "reset") == 0 && cJSON_IsBool(item)) {
+            reset = cJSON_IsTrue(item);
+        }
+        else if (strcmp(item->string, "commit") == 0 && cJSON_IsBool(item)) {
+            commit = cJSON_IsTrue(item);
+        }
+        else if (camera_ctrl_param_find(item->string, &param) && (cJSON_IsNumber(item) || cJSON_IsBool(item)) && count < CAMERA_CTRL_PARAM_COUNT) {
+            changes[count].param = param;
+            changes[count].value = cJSON_IsBool(item) ? cJSON_IsTrue(item) : item->valueint;
+            count++;
+        }
+        else {
+            invalid = item->string;
+            break;
+        }
+    }
+    char message[64];
+    if (invalid != NULL) {
+        snprintf(message, sizeof(message), "invalid camera setting: %s", invalid);
+    }
+    cJSON_Delete(root);
+
+    if (invalid != NULL) {
+        return send_json_error(req, "400 Bad Request", message);
+    }
+    if (count == 0 && !reset && !commit) {
+        return send_json_error(req, "400 Bad Request", "no camera setting given");
+    }
+
+    esp_err_t err = reset ? camera_ctrl_reset() : ESP_OK;
+    if (err == ESP_OK && count > 0) {
+        err = camera_ctrl_set(changes, count);
+    }
+    if (err == ESP_OK && commit) {
+        err = camera_ctrl_commit();
+    }
+    if (err == ESP_ERR_INVALID_ARG) {
+        return send_json_error(req, "400 Bad Request", "camera setting out of range");
+    }
+    if (err == ESP_ERR_NOT_SUPPORTED) {
+        return send_json_error(req, "409 Conflict", "camera setting not supported by sensor");
+    }
+    if (err == ESP_ERR_TIMEOUT) {
+        return send_json_error(req, "503 Service Unavailable", "frame buffers still in use");
+    }
+    if (err != ESP_OK) {
+        return send_json_error(req, "500 Internal Server Error", esp_err_to_name(err));
+    }
+    return send_camera(req);
+}
+
+static esp_err_t audio_get_handler(httpd_req_t* req)
+{
+    audio_stream_stats_t stats;
+    audio_stream_get_stats(&stats);
+    const audio_jitter_stats_t* j = &stats.jitter;
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "success", 1);
+    cJSON_AddBoolToObject(root, "playing", j->playing);
+    cJSON_AddNumberToObject(root, "depth", j->depth);
+    cJSON_AddNumberToObject(root, "depth_ms", j->depth_ms);
+    cJSON_AddNumberToObject(root, "target_ms", j->target_ms);
+    cJSON_AddNumberToObject(root, "jitter_ms", j->jitter_ms);
+    cJSON_AddNumberToObject(root, "datagrams", stats.datagrams);
+    cJSON_AddNumberToObject(root, "raw", stats.raw);
+    cJSON_AddNumberToObject(root, "invalid", stats.invalid);
+    cJSON_AddNumberToObject(root, "received", j->received);
+    cJSON_AddNumberToObject(root, "late", j->late);
+    cJSON_AddNumberToObject(root, "duplicate", j->duplicate);
+    cJSON_AddNumberToObject(root, "lost", j->lost);
+    cJSON_AddNumberToObject(root, "overflow", j->overflow);
+    cJSON_AddNumberToObject(root, "dropped", j->dropped);
+    cJSON_AddNumberToObject(root, "underruns", j->underruns);
+    cJSON_AddNumberToObject(root, "streams", j->streams);
+    cJSON_AddNumberToObject(root, "played_ms", stats.played_ms);
+    cJSON_AddNumberToObject(root, "concealed_ms", stats.concealed_ms);
+    cJSON_AddNumberToObject(root, "plc_events", stats.plc_events);
+    cJSON_AddNumberToObject(root, "write_errors", stats.write_errors);
+    cJSON_AddNumberToObject(root, "decode_us_per_s", stats.decode_us_per_s);
+    cJSON* codecs = cJSON_AddObjectToObject(root, "codecs");
+    for (int i = 0; i < AUDIO_CODEC_COUNT; i++) {
+        cJSON_AddNumberToObject(codecs, audio_codec_name(i), stats.codec_packets[i]);
+    }
+    cJSON_AddNumberToObject(root, "decode_avg_us", stats.decode_avg_us);
+    cJSON_AddNumberToObject(root, "decode_max_us", stats.decode_max_us);
+    cJSON* load = cJSON_AddArrayToObject(root, "decode_load_permille");
+    for (int i = 0; i < AUDIO_STREAM_MAX_CORES; i++) {
+        cJSON_AddItemToArray(load, cJSON_CreateNumber(stats.decode_load_permille[i]));
+    }
+    cJSON* opus = cJSON_AddObjectToObject(root, "opus");
+    cJSON_AddBoolToObject(opus, "enabled", stats.opus.enabled);
+    cJSON_AddNumberToObject(opus, "state_bytes", stats.opus.state_bytes);
+    cJSON_AddNumberToObject(opus, "frames", stats.opus.frames);
+    cJSON_AddNumberToObject(opus, "fec", stats.opus.fec);
+    cJSON_AddNumberToObject(opus, "plc", stats.opus.plc);
+    cJSON_AddNumberToObject(opus, "errors", stats.opus.errors);
+    cJSON* ring = cJSON_AddObjectToObject(root, "ring");
+    cJSON_AddNumberToObject(ring, "size", stats.ring.size);
+    cJSON_AddNumberToObject(ring, "level", stats.ring.level);
+    cJSON_AddNumberToObject(ring, "peak", stats.ring.peak);
+    cJSON_AddNumberToObject(ring, "low_water", stats.ring.low_water);
+    cJSON_AddNumberToObject(ring, "high_water", stats.ring.high_water);
+    cJSON_AddNumberToObject(ring, "underruns", stats.ring.underruns);
+    cJSON_AddNumberToObject(ring, "overruns", stats.ring.overruns);
+
+    char* json_str = cJSON_PrintUnformatted(root);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, json_str);
+    free(json_str);
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
+static httpd_uri_t destinations_get_uri = {.uri = "/api/destinations", .method = HTTP_GET, .handler = destinations_get_handler, .user_ctx = NULL};
+
+static httpd_uri_t destinations_post_uri = {.uri = "/api/destinations", .method = HTTP_POST, .handler = destinations_post_handler, .user_ctx = NULL};
+
+static httpd_uri_t multicast_get_uri = {.uri = "/api/multicast", .method = HTTP_GET, .handler = multicast_get_handler, .user_ctx = NULL};
+
+static httpd_uri_t multicast_post_uri = {.uri = "/api/multicast", .method = HTTP_POST, .handler = multicast_post_handler, .user_ctx = NULL};
+
+static httpd_uri_t sdp_get_uri = {.uri = "/stream.sdp", .method = HTTP_GET, .handler = sdp_get_handler, .user_ctx = NULL};
+
+static httpd_uri_t stream_get_uri = {.uri = "/stream", .method = HTTP_GET, .handler = stream_get_handler, .user_ctx = NULL};
+
+static httpd_uri_t capture_get_uri = {.uri = "/capture.jpg", .method = HTTP_GET, .handler = capture_get_handler, .user_ctx = NULL};
+
+static httpd_uri_t rtsp_get_uri = {.uri = "/api/rtsp", .method = HTTP_GET, .handler = rtsp_get_handler, .user_ctx = NULL};
+
+static httpd_uri_t frames_get_uri = {.uri = "/api/frames", .method = HTTP_GET, .handler = frames_get_handler, .user_ctx = NULL};
+
+static httpd_uri_t clip_get_uri = {.uri = "/api/clip", .method = HTTP_GET, .handler = clip_get_handler, .user_ctx = NULL};
+
+static httpd_uri_t clip_post_uri = {.uri = "/api/clip", .method = HTTP_POST, .handler = clip_post_handler, .user_ctx = NULL};
+
+static httpd_uri_t motion_get_uri = {.uri = "/api/motion", .method = HTTP_GET, .handler = motion_get_handler, .user_ctx = NULL};
+
+static httpd_uri_t motion_post_uri = {.uri = "/api/motion", .method = HTTP_POST, .handler = motion_post_handler, .user_ctx = NULL};
+
+static httpd_uri_t streams_get_uri = {.uri = "/api/streams", .method = HTTP_GET, .handler = streams_get_handler, .user_ctx = NULL};
+
+static httpd_uri_t streams_post_uri = {.uri = "/api/streams", .method = HTTP_POST, .handler = streams_post_handler, .user_ctx = NULL};
+
+static httpd_uri_t camera_get_uri = {.uri = "/api/camera", .method = HTTP_GET, .handler = camera_get_handler, .user_ctx = NULL};
+
+static httpd_uri_t camera_post_uri = {.uri = "/api/camera", .method = HTTP_POST, .handler = camera_post_handler, .user_ctx = NULL};
+
+static httpd_uri_t audio_get_uri = {.uri = "/api/audio", .method = HTTP_GET, .handler = audio_get_handler, .user_ctx = NULL};
+
+// 注册的全部URI处理器，max_uri_handlers 按此表的大小设置；新增接口时加入此表
+static httpd_uri_t* const s_uris[] = {
+    &destinations_get_uri, &destinations_post_uri, &multicast_get_uri, &multicast_post_uri,
+    &sdp_get_uri, &stream_get_uri, &capture_get_uri, &rtsp_get_uri,
+    &frames_get_uri, &clip_get_uri, &clip_post_uri, &motion_get_uri,
+    &motion_post_uri, &streams_get_uri, &streams_post_uri, &camera_get_uri,
+    &camera_post_uri, &audio_get_uri,
+};
+
+esp_err_t camera_httpd_start(void)
+{
+#if CONFIG_CAMERA_HTTP_SERVER
+    if (s_server != NULL) {
+        return ESP_OK;
+    }
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = CONFIG_CAMERA_HTTP_PORT;
+    config.max_uri_handlers = sizeof(s_uris) / sizeof(s_uris[0]);
+    config.stack_size = 6144;
+    // 每个MJPEG流占用一个连接，另留出API请求所需的连接；连接不足时回收最久未活动的连接
+    config.max_open_sockets = CAMERA_HTTPD_MAX_OPEN_SOCKETS;
+    config.lru_purge_enable = true;
+
+    ESP_LOGI(TAG, "启动HTTP接口，端口: %d", config.server_port);
+    esp_err_t err = httpd_start(&s_server, &config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "启动HTTP接口失败: %s", esp_err_to_name(err));
+        s_server = NULL;
+        return err;
+    }
+
+    for (size_t i = 0; i < sizeof(s_uris) / sizeof(s_uris[0]); i++) {
+        err = httpd_register_uri_handler(s_server, s_uris[i]);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "注册 %s 失败: %s", s_uris[i]->uri, esp_err_to_name(err));
+        }
+    }
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void camera_httpd_stop(void)
+{
+    if (s_server == NULL) {
+        return;
+    }
+
+    // 先让流任务结束异步请求，再停止服务器
+    s_stream_stopping = true;
+    for (int waited = 0; s_stream_clients > 0 && waited < STREAM_STOP_TIMEOUT_MS; waited += 50) {
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    if (s_stream_clients > 0) {
+        ESP_LOGW(TAG, "仍有 %lu 个MJPEG流未退出", (unsigned long)s_stream_clients);
+    }
+    s_stream_stopping = false;
+
+    httpd_stop(s_server);
+    s_server = NULL;
+    ESP_LOGI(TAG, "HTTP接口已停止");
+}
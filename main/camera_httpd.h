@@ -0,0 +1,40 @@
+/*
+ * camera_httpd.h
+ * 正常推流模式下的HTTP接口（目标表管理等），配网模式使用 wifi_config_manager 中的服务器
+ */
+
+#ifndef CAMERA_HTTPD_H
+#define CAMERA_HTTPD_H
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+// 最大连接数：每个MJPEG流一个，另留三个给API请求
+#if CONFIG_CAMERA_HTTP_SERVER
+#define CAMERA_HTTPD_MAX_OPEN_SOCKETS (CONFIG_CAMERA_HTTP_STREAM_CLIENTS + 3)
+// 占用的 lwIP 套接字：连接之外还有监听 socket 与 esp_http_server 内部的两个控制 socket
+#define CAMERA_HTTPD_SOCKETS (CAMERA_HTTPD_MAX_OPEN_SOCKETS + 3)
+#else
+#define CAMERA_HTTPD_SOCKETS 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 启动HTTP服务器（已启动时直接返回）
+ * @return esp_err_t
+ */
+esp_err_t camera_httpd_start(void);
+
+/**
+ * @brief 停止HTTP服务器
+ */
+void camera_httpd_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAMERA_HTTPD_H */
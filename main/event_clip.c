@@ -0,0 +1,608 @@
+/*
+ * event_clip.c
+ * 事件片段实现：变长记录预录环、录制任务与TCP导出任务
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "lwip/inet.h"
+
+#include "event_clip.h"
+#include "frame_broker.h"
+#include "stream_dest.h"
+
+static const char* TAG = "EVENT_CLIP";
+
+#define CLIP_ARENA_BYTES ((uint32_t)CONFIG_EVENT_CLIP_RING_KB * 1024)
+#define CLIP_PRE_US ((int64_t)CONFIG_EVENT_CLIP_PRE_SECONDS * 1000000)
+#define CLIP_MAX_POST_MS 60000           // 单个片段触发后最长录制时间（含多次触发的延长）
+#define CLIP_END_GRACE_US 1000000        // 录制结束时间过后仍没有新帧时结束导出
+#define CLIP_CONNECT_TIMEOUT_MS 3000
+#define CLIP_SEND_TIMEOUT_S 5
+#define CLIP_INDEX_GROW 64               // 索引数组每次扩容的条目数
+#define CLIP_WRAP_MARK 0xFFFFFFFFu       // 记录头 len 为该值表示从环的开头继续
+
+/**
+ * @brief 预录环中的记录头，后接 JPEG 数据（按 8 字节对齐）
+ */
+typedef struct
+{
+    uint32_t len;           // JPEG 长度，CLIP_WRAP_MARK 表示回绕
+    uint32_t seq;           // 帧序号
+    uint64_t timestamp_us;  // 采集时间戳
+} clip_record_t;
+
+#define CLIP_RECORD_SIZE(len) (sizeof(clip_record_t) + (((len) + 7) & ~7u))
+
+// 预录环：有效数据为 [tail, head)（可能回绕），由 s_lock 保护；只有录制任务写入与淘汰
+static uint8_t* s_arena = NULL;
+static uint32_t s_head = 0;
+static uint32_t s_tail = 0;
+static uint32_t s_head_id = 0;  // 下一条记录的编号
+static uint32_t s_tail_id = 0;  // 最旧记录的编号，帧数 = s_head_id - s_tail_id
+static uint32_t s_used = 0;
+static uint64_t s_newest_us = 0;
+
+// 导出状态：导出中编号不小于 s_dump_id 的记录不会被淘汰
+static bool s_pending = false;
+static bool s_dumping = false;
+static uint32_t s_dump_id = 0;
+static uint32_t s_dump_off = 0;
+static struct sockaddr_in s_request_addr;
+static event_clip_source_t s_request_source;
+static int64_t s_trigger_us = 0;
+static int64_t s_post_end_us = 0;
+static struct sockaddr_in s_last_receiver;
+static bool s_last_receiver_valid = false;
+
+static frame_broker_sub_t* s_sub = NULL;
+static TaskHandle_t s_dump_task = NULL;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static event_clip_stats_t s_stats;
+static uint32_t s_clip_id = 0;
+
+static void put_u16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void put_u32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static void put_u64(uint8_t* p, uint64_t v)
+{
+    put_u32(p, (uint32_t)(v >> 32));
+    put_u32(p + 4, (uint32_t)v);
+}
+
+/**
+ * @brief 读取位置 off 处的记录，遇到回绕标记或末尾放不下记录头时从开头读（调用者持有锁，off 处必须有已提交的记录）
+ */
+static uint32_t record_offset(uint32_t off)
+{
+    if (CLIP_ARENA_BYTES - off < sizeof(clip_record_t) || ((clip_record_t*)(s_arena + off))->len == CLIP_WRAP_MARK) {
+        return 0;
+    }
+    return off;
+}
+
+/**
+ * @brief 淘汰最旧的一条记录（调用者持有锁）
+ * @return 被导出占用而不能淘汰时返回 false
+ */
+static bool evict_oldest(void)
+{
+    if (s_head_id == s_tail_id || (s_dumping && s_tail_id >= s_dump_id)) {
+        return false;
+    }
+
+    uint32_t off = record_offset(s_tail);
+    s_used -= off - s_tail + ((off < s_tail) ? CLIP_ARENA_BYTES : 0);  // 回绕空隙
+    uint32_t size = CLIP_RECORD_SIZE(((clip_record_t*)(s_arena + off))->len);
+    s_used -= size;
+    s_tail = off + size;
+    s_tail_id++;
+    if (s_tail_id == s_head_id) {
+        // 环已空，从头开始写，减少回绕；导出中此时导出任务正等待下一帧
+        s_head = 0;
+        s_tail = 0;
+        s_used = 0;
+        s_dump_off = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief 在 head 处预留 need 字节，必要时回绕（调用者持有锁）
+ * @return 能放下时返回 true
+ */
+static bool reserve(uint32_t need)
+{
+    if (s_head_id == s_tail_id) {
+        return need <= CLIP_ARENA_BYTES;
+    }
+    if (s_head > s_tail) {
+        if (s_head + need <= CLIP_ARENA_BYTES) {
+            return true;
+        }
+        if (need < s_tail) {
+            // 末尾放不下：写回绕标记后从开头继续
+            if (CLIP_ARENA_BYTES - s_head >= sizeof(clip_record_t)) {
+                ((clip_record_t*)(s_arena + s_head))->len = CLIP_WRAP_MARK;
+            }
+            s_used += CLIP_ARENA_BYTES - s_head;
+            s_head = 0;
+            return true;
+        }
+        return false;
+    }
+    // 已回绕：严格小于，保证 head 不追上 tail
+    return s_head < s_tail && s_head + need < s_tail;
+}
+
+/**
+ * @brief 把一帧拷入预录环
+ */
+static void record_frame(const frame_ref_t* frame)
+{
+    uint32_t need = CLIP_RECORD_SIZE(frame->len);
+    bool ok = false;
+    uint32_t evicted = 0;
+
+    taskENTER_CRITICAL(&s_lock);
+    while (need < CLIP_ARENA_BYTES && !(ok = reserve(need)) && evict_oldest()) {
+        evicted++;
+    }
+    uint32_t off = s_head;
+    s_stats.evicted_space += evicted;
+    if (!ok) {
+        s_stats.dropped++;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    if (!ok) {
+        return;
+    }
+
+    // 预留的区域在提交前对导出任务不可见，锁外拷贝
+    clip_record_t* rec = (clip_record_t*)(s_arena + off);
+    rec->len = frame->len;
+    rec->seq = frame->seq;
+    rec->timestamp_us = frame->timestamp_us;
+    memcpy(rec + 1, frame->data, frame->len);
+
+    taskENTER_CRITICAL(&s_lock);
+    s_head = off + need;
+    s_head_id++;
+    s_used += need;
+    s_newest_us = frame->timestamp_us;
+    s_stats.recorded++;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (s_dump_task != NULL) {
+        xTaskNotifyGive(s_dump_task);
+    }
+}
+
+/**
+ * @brief 淘汰超过预录时长的帧
+ */
+static void evict_aged(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    while (s_head_id != s_tail_id) {
+        const clip_record_t* rec = (const clip_record_t*)(s_arena + record_offset(s_tail));
+        if (rec->timestamp_us + CLIP_PRE_US >= s_newest_us || !evict_oldest()) {
+            break;
+        }
+        s_stats.evicted_age++;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * @brief 录制任务：从帧分发取帧拷入预录环，立即释放相机帧缓冲
+ */
+static void clip_record_task(void* arg)
+{
+    int64_t rate_start_us = esp_timer_get_time();
+    uint32_t rate_base = 0;
+
+    for (;;) {
+        frame_ref_t* frame = frame_broker_pop(s_sub, pdMS_TO_TICKS(200));
+        if (frame != NULL) {
+            record_frame(frame);
+            frame_broker_release(frame);
+        }
+        evict_aged();
+
+        int64_t now = esp_timer_get_time();
+        if (now - rate_start_us >= 1000000) {
+            taskENTER_CRITICAL(&s_lock);
+            uint32_t total = s_stats.evicted_age + s_stats.evicted_space;
+            s_stats.evictions_per_s = (uint32_t)((uint64_t)(total - rate_base) * 1000000 / (now - rate_start_us));
+            taskEXIT_CRITICAL(&s_lock);
+            rate_base = total;
+            rate_start_us = now;
+        }
+    }
+}
+
+/**
+ * @brief 发送全部数据
+ */
+static esp_err_t send_all(int sock, const void* data, size_t len)
+{
+    const uint8_t* p = data;
+    while (len > 0) {
+        int sent = send(sock, p, len, 0);
+        if (sent < 0) {
+            ESP_LOGW(TAG, "发送片段失败: errno %d", errno);
+            return ESP_FAIL;
+        }
+        p += sent;
+        len -= sent;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 带超时地连接接收端
+ * @return socket，失败返回 -1
+ */
+static int connect_receiver(const struct sockaddr_in* addr)
+{
+    int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        return -1;
+    }
+
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+    int err = 0;
+    if (connect(sock, (const struct sockaddr*)addr, sizeof(*addr)) < 0) {
+        if (errno != EINPROGRESS) {
+            err = errno;
+        }
+        else {
+            fd_set wfds;
+            FD_ZERO(&wfds);
+            FD_SET(sock, &wfds);
+            struct timeval timeout = {.tv_sec = CLIP_CONNECT_TIMEOUT_MS / 1000, .tv_usec = (CLIP_CONNECT_TIMEOUT_MS % 1000) * 1000};
+            if (select(sock + 1, NULL, &wfds, NULL, &timeout) <= 0) {
+                err = ETIMEDOUT;
+            }
+            else {
+                socklen_t len = sizeof(err);
+                getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len);
+            }
+        }
+    }
+    if (err != 0) {
+        ESP_LOGW(TAG, "连接接收端失败: errno %d", err);
+        close(sock);
+        return -1;
+    }
+
+    fcntl(sock, F_SETFL, flags);
+    struct timeval send_timeout = {.tv_sec = CLIP_SEND_TIMEOUT_S, .tv_usec = 0};
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+    return sock;
+}
+
+/**
+ * @brief 导出一个片段：预录帧与触发后的帧依次从预录环发送，最后发送索引
+ * @return 成功时返回 ESP_OK
+ */
+static esp_err_t dump_clip(int sock, uint32_t clip_id, event_clip_source_t source, int64_t trigger_us, uint32_t* out_frames, uint32_t* out_bytes)
+{
+    uint8_t header[EVENT_CLIP_HEADER_SIZE] = {0};
+    put_u32(header + 0, EVENT_CLIP_MAGIC);
+    header[4] = EVENT_CLIP_VERSION;
+    header[5] = (uint8_t)source;
+    put_u32(header + 8, clip_id);
+    put_u64(header + 12, (uint64_t)trigger_us);
+    put_u32(header + 20, CONFIG_EVENT_CLIP_PRE_SECONDS * 1000);
+    taskENTER_CRITICAL(&s_lock);
+    int64_t post_end_us = s_post_end_us;
+    taskEXIT_CRITICAL(&s_lock);
+    put_u32(header + 24, (uint32_t)((post_end_us - trigger_us) / 1000));  // 导出中再次触发会延长，以索引中的帧为准
+    if (send_all(sock, header, sizeof(header)) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    uint32_t offset = sizeof(header);
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+    uint8_t* index = NULL;
+    esp_err_t result = ESP_OK;
+
+    for (;;) {
+        taskENTER_CRITICAL(&s_lock);
+        bool available = (s_dump_id != s_head_id);
+        const clip_record_t* rec = NULL;
+        if (available) {
+            s_dump_off = record_offset(s_dump_off);
+            rec = (const clip_record_t*)(s_arena + s_dump_off);
+        }
+        post_end_us = s_post_end_us;
+        taskEXIT_CRITICAL(&s_lock);
+
+        if (!available) {
+            if (esp_timer_get_time() > post_end_us + CLIP_END_GRACE_US) {
+                break;  // 采集已停止或帧率过低，不再等待
+            }
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+            continue;
+        }
+        if ((int64_t)rec->timestamp_us > post_end_us) {
+            break;
+        }
+
+        // 超出预录时长的旧帧（尚未被淘汰）不发送
+        if ((int64_t)rec->timestamp_us + CLIP_PRE_US >= trigger_us) {
+            if (count == capacity) {
+                uint32_t grow = capacity + CLIP_INDEX_GROW;
+                uint8_t* p = heap_caps_realloc(index, grow * EVENT_CLIP_INDEX_ENTRY_SIZE, MALLOC_CAP_SPIRAM);
+                if (p == NULL) {
+                    p = realloc(index, grow * EVENT_CLIP_INDEX_ENTRY_SIZE);
+                }
+                if (p == NULL) {
+                    ESP_LOGE(TAG, "无法分配片段索引");
+                    result = ESP_ERR_NO_MEM;
+                    break;
+                }
+                index = p;
+                capacity = grow;
+            }
+
+            uint8_t frame_header[EVENT_CLIP_FRAME_HEADER_SIZE];
+            put_u32(frame_header + 0, EVENT_CLIP_FRAME_MAGIC);
+            put_u32(frame_header + 4, rec->seq);
+            put_u64(frame_header + 8, rec->timestamp_us);
+            put_u32(frame_header + 16, rec->len);
+            put_u32(frame_header + 20, (int64_t)rec->timestamp_us <= trigger_us ? EVENT_CLIP_FRAME_PRE : 0);
+            // 记录被导出占用，不会被淘汰，可以在锁外直接从预录环发送
+            if (send_all(sock, frame_header, sizeof(frame_header)) != ESP_OK || send_all(sock, rec + 1, rec->len) != ESP_OK) {
+                result = ESP_FAIL;
+                break;
+            }
+
+            uint8_t* entry = index + count * EVENT_CLIP_INDEX_ENTRY_SIZE;
+            put_u32(entry + 0, offset);
+            put_u32(entry + 4, rec->len);
+            put_u64(entry + 8, rec->timestamp_us);
+            count++;
+            offset += sizeof(frame_header) + rec->len;
+        }
+
+        taskENTER_CRITICAL(&s_lock);
+        s_dump_off += CLIP_RECORD_SIZE(rec->len);
+        s_dump_id++;
+        taskEXIT_CRITICAL(&s_lock);
+    }
+
+    if (result == ESP_OK) {
+        uint8_t index_header[8];
+        uint8_t trailer[8];
+        put_u32(index_header + 0, EVENT_CLIP_INDEX_MAGIC);
+        put_u32(index_header + 4, count);
+        put_u32(trailer + 0, offset);
+        put_u32(trailer + 4, EVENT_CLIP_END_MAGIC);
+        if (send_all(sock, index_header, sizeof(index_header)) != ESP_OK || (count > 0 && send_all(sock, index, count * EVENT_CLIP_INDEX_ENTRY_SIZE) != ESP_OK) ||
+            send_all(sock, trailer, sizeof(trailer)) != ESP_OK) {
+            result = ESP_FAIL;
+        }
+        offset += sizeof(index_header) + count * EVENT_CLIP_INDEX_ENTRY_SIZE + sizeof(trailer);
+    }
+    free(index);
+
+    *out_frames = count;
+    *out_bytes = offset;
+    return result;
+}
+
+/**
+ * @brief 导出任务：等待触发，锁定预录环中的帧并导出
+ */
+static void clip_dump_task(void* arg)
+{
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+
+        taskENTER_CRITICAL(&s_lock);
+        bool pending = s_pending;
+        struct sockaddr_in receiver = s_request_addr;
+        event_clip_source_t source = s_request_source;
+        int64_t trigger_us = s_trigger_us;
+        if (pending) {
+            s_pending = false;
+            s_dumping = true;
+            s_dump_id = s_tail_id;
+            s_dump_off = s_tail;
+            s_stats.dumping = true;
+        }
+        taskEXIT_CRITICAL(&s_lock);
+        if (!pending) {
+            continue;
+        }
+
+        char ip[16];
+        inet_ntoa_r(receiver.sin_addr, ip, sizeof(ip));
+        uint32_t clip_id = ++s_clip_id;
+        ESP_LOGI(TAG, "导出片段 #%lu 到 %s:%d", (unsigned long)clip_id, ip, ntohs(receiver.sin_port));
+
+        int64_t start_us = esp_timer_get_time();
+        uint32_t frames = 0;
+        uint32_t bytes = 0;
+        esp_err_t result = ESP_FAIL;
+        int sock = connect_receiver(&receiver);
+        if (sock >= 0) {
+            result = dump_clip(sock, clip_id, source, trigger_us, &frames, &bytes);
+            close(sock);
+        }
+        uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+
+        taskENTER_CRITICAL(&s_lock);
+        s_dumping = false;
+        s_stats.dumping = false;
+        if (result == ESP_OK) {
+            s_stats.clips++;
+            s_stats.last_frames = frames;
+            s_stats.last_bytes = bytes;
+            s_stats.last_dump_ms = elapsed_ms;
+            s_stats.last_kbps = elapsed_ms > 0 ? (uint32_t)((uint64_t)bytes * 8 / elapsed_ms) : 0;
+        }
+        else {
+            s_stats.failures++;
+        }
+        taskEXIT_CRITICAL(&s_lock);
+
+        if (result == ESP_OK) {
+            ESP_LOGI(TAG, "片段 #%lu 导出完成: %lu 帧, %lu bytes, 耗时 %lu ms", (unsigned long)clip_id, (unsigned long)frames, (unsigned long)bytes, (unsigned long)elapsed_ms);
+        }
+        else {
+            ESP_LOGW(TAG, "片段 #%lu 导出失败", (unsigned long)clip_id);
+        }
+    }
+}
+
+esp_err_t event_clip_init(void)
+{
+    if (s_arena != NULL) {
+        return ESP_OK;
+    }
+
+    s_arena = heap_caps_malloc(CLIP_ARENA_BYTES, MALLOC_CAP_SPIRAM);
+    if (s_arena == NULL) {
+        s_arena = malloc(CLIP_ARENA_BYTES);
+    }
+    if (s_arena == NULL) {
+        ESP_LOGE(TAG, "无法分配 %lu bytes 的预录环", (unsigned long)CLIP_ARENA_BYTES);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 录制任务只做拷贝，队列只需一帧；来不及时丢弃最旧的帧
+    s_sub = frame_broker_subscribe("clip", 1, FRAME_BROKER_DROP_OLDEST);
+    if (s_sub == NULL) {
+        free(s_arena);
+        s_arena = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    frame_broker_set_optional(s_sub);
+    s_stats.arena_bytes = CLIP_ARENA_BYTES;
+
+    if (xTaskCreate(clip_dump_task, "clip_dump", 4096, NULL, 2, &s_dump_task) != pdPASS ||
+        xTaskCreate(clip_record_task, "clip_record", 3072, NULL, 4, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "创建事件片段任务失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "预录环: %lu KB, 预录 %d 秒, 触发后录制 %d 秒", (unsigned long)(CLIP_ARENA_BYTES / 1024), CONFIG_EVENT_CLIP_PRE_SECONDS, CONFIG_EVENT_CLIP_POST_SECONDS);
+    return ESP_OK;
+}
+
+esp_err_t event_clip_trigger(const struct sockaddr_in* receiver, uint32_t post_ms, event_clip_source_t source)
+{
+    if (s_arena == NULL || s_dump_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (post_ms == 0) {
+        post_ms = CONFIG_EVENT_CLIP_POST_SECONDS * 1000;
+    }
+    if (post_ms > CLIP_MAX_POST_MS) {
+        post_ms = CLIP_MAX_POST_MS;
+    }
+
+    struct sockaddr_in addr;
+    taskENTER_CRITICAL(&s_lock);
+    bool have_last = s_last_receiver_valid;
+    struct sockaddr_in last = s_last_receiver;
+    taskEXIT_CRITICAL(&s_lock);
+    if (receiver != NULL) {
+        addr = *receiver;
+    }
+    else if (have_last) {
+        addr = last;
+    }
+    else {
+        // 默认发给第一个单播目标
+        stream_dest_info_t infos[STREAM_DEST_MAX];
+        if (stream_dest_get_info(infos) == 0) {
+            ESP_LOGW(TAG, "没有可用的片段接收端");
+            return ESP_ERR_NOT_FOUND;
+        }
+        addr = infos[0].addr;
+        addr.sin_port = htons(CONFIG_EVENT_CLIP_RECEIVER_PORT);
+    }
+
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.triggers++;
+    bool extend = s_dumping || s_pending;
+    if (extend) {
+        // 导出中再次触发：延长录制时间，不超过单个片段的上限
+        int64_t end = now + (int64_t)post_ms * 1000;
+        int64_t limit = s_trigger_us + (int64_t)CLIP_MAX_POST_MS * 1000;
+        if (end > limit) {
+            end = limit;
+        }
+        if (end > s_post_end_us) {
+            s_post_end_us = end;
+        }
+    }
+    else {
+        s_pending = true;
+        s_request_addr = addr;
+        s_request_source = source;
+        s_trigger_us = now;
+        s_post_end_us = now + (int64_t)post_ms * 1000;
+    }
+    if (receiver != NULL) {
+        s_last_receiver = *receiver;
+        s_last_receiver_valid = true;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (!extend) {
+        xTaskNotifyGive(s_dump_task);
+    }
+    ESP_LOGI(TAG, "事件触发 (来源 %d)%s", source, extend ? "，延长正在导出的片段" : "");
+    return ESP_OK;
+}
+
+void event_clip_get_stats(event_clip_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (s_arena == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    stats->used_bytes = s_used;
+    stats->frames = s_head_id - s_tail_id;
+    if (stats->frames > 0) {
+        const clip_record_t* oldest = (const clip_record_t*)(s_arena + record_offset(s_tail));
+        stats->span_ms = (uint32_t)((s_newest_us - oldest->timestamp_us) / 1000);
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,121 @@
+/*
+ * event_clip.h
+ * 事件片段 - PSRAM 预录环保存最近 N 秒的 JPEG 帧，触发后把预录帧与之后 M 秒的帧作为一个带索引的片段发给接收端
+ *
+ * 预录环是一块连续的字节区（变长记录，不按最大帧预留固定槽位），按时间与容量淘汰最旧的帧。
+ * 录制任务是帧分发 (frame_broker.h) 的可选订阅者，把帧拷入预录环后立即释放相机帧缓冲；空闲帧缓冲不足时收不到帧，片段中相应缺帧；
+ * 导出任务经 TCP 直接从预录环发送，正在导出的帧不会被淘汰。
+ *
+ * 片段格式（多字节字段均为大端序）:
+ *   片段头 (32 字节):
+ *     0  uint32 magic      "ECLP"
+ *     4  uint8  version    1
+ *     5  uint8  source     EVENT_CLIP_SOURCE_*
+ *     6  uint16 reserved
+ *     8  uint32 clip_id    片段序号
+ *    12  uint64 trigger_us 触发时间（与帧时间戳同一时钟）
+ *    20  uint32 pre_ms     预录时长
+ *    24  uint32 post_ms    触发后录制时长
+ *    28  uint32 reserved
+ *   帧记录 (24 字节 + JPEG)，按时间顺序:
+ *     0  uint32 magic      "FRME"
+ *     4  uint32 seq        帧序号
+ *     8  uint64 timestamp_us
+ *    16  uint32 len        JPEG 长度
+ *    20  uint32 flags      EVENT_CLIP_FRAME_*
+ *   索引:
+ *     0  uint32 magic      "CIDX"
+ *     4  uint32 count
+ *     8  每帧 16 字节: uint32 offset（帧记录相对片段开头的偏移）, uint32 len, uint64 timestamp_us
+ *   片段尾 (8 字节): uint32 index_offset, uint32 magic "CEND"
+ */
+
+#ifndef EVENT_CLIP_H
+#define EVENT_CLIP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lwip/sockets.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EVENT_CLIP_MAGIC 0x45434C50        // "ECLP"
+#define EVENT_CLIP_FRAME_MAGIC 0x46524D45  // "FRME"
+#define EVENT_CLIP_INDEX_MAGIC 0x43494458  // "CIDX"
+#define EVENT_CLIP_END_MAGIC 0x43454E44    // "CEND"
+#define EVENT_CLIP_VERSION 1
+#define EVENT_CLIP_HEADER_SIZE 32
+#define EVENT_CLIP_FRAME_HEADER_SIZE 24
+#define EVENT_CLIP_INDEX_ENTRY_SIZE 16
+
+#define EVENT_CLIP_FRAME_PRE 0x01  // 触发前的预录帧
+
+// 占用的 lwIP 套接字：导出任务同一时刻只有一个TCP连接
+#if CONFIG_EVENT_CLIP
+#define EVENT_CLIP_SOCKETS 1
+#else
+#define EVENT_CLIP_SOCKETS 0
+#endif
+
+/**
+ * @brief 触发来源
+ */
+typedef enum {
+    EVENT_CLIP_SOURCE_UDP = 0,  // UDP 控制报文 IMAGE_PROTO_CTRL_CLIP
+    EVENT_CLIP_SOURCE_HTTP,     // POST /api/clip
+    EVENT_CLIP_SOURCE_BUTTON,   // 按键短按
+} event_clip_source_t;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct
+{
+    uint32_t arena_bytes;      // 预录环容量
+    uint32_t used_bytes;       // 已用字节（含记录头与回绕空隙）
+    uint32_t frames;           // 环中的帧数
+    uint32_t span_ms;          // 环中最旧到最新帧的时长
+    uint32_t recorded;         // 写入环的帧数
+    uint32_t evicted_age;      // 超过预录时长被淘汰的帧数
+    uint32_t evicted_space;    // 因空间不足被淘汰的帧数
+    uint32_t evictions_per_s;  // 最近一秒的淘汰帧数
+    uint32_t dropped;          // 未能写入的帧数（单帧超过容量，或导出中空间被占满）
+    uint32_t triggers;         // 触发次数（导出中再次触发只延长录制时间）
+    uint32_t clips;            // 导出成功的片段数
+    uint32_t failures;         // 导出失败的片段数
+    bool dumping;              // 是否正在导出
+    uint32_t last_frames;      // 最近一个片段的帧数
+    uint32_t last_bytes;       // 最近一个片段的字节数
+    uint32_t last_dump_ms;     // 最近一个片段的导出耗时
+    uint32_t last_kbps;        // 最近一个片段的导出吞吐 (kbit/s)
+} event_clip_stats_t;
+
+/**
+ * @brief 初始化：分配预录环，注册帧分发订阅者并启动录制与导出任务（已初始化时直接返回）
+ * @return esp_err_t
+ */
+esp_err_t event_clip_init(void);
+
+/**
+ * @brief 触发导出；正在导出时只把录制结束时间延长到本次触发之后 post_ms
+ * @param receiver 接收端TCP地址，NULL 表示默认接收端（最近一次指定的接收端，否则第一个单播目标的 CONFIG_EVENT_CLIP_RECEIVER_PORT）
+ * @param post_ms 触发后继续录制的时长，0 表示 CONFIG_EVENT_CLIP_POST_SECONDS
+ * @param source 触发来源
+ * @return esp_err_t 未初始化时返回 ESP_ERR_INVALID_STATE，没有可用接收端时返回 ESP_ERR_NOT_FOUND
+ */
+esp_err_t event_clip_trigger(const struct sockaddr_in* receiver, uint32_t post_ms, event_clip_source_t source);
+
+/**
+ * @brief 获取统计信息
+ * @param stats 输出统计信息
+ */
+void event_clip_get_stats(event_clip_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_CLIP_H */
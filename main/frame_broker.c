@@ -0,0 +1,312 @@
+/*
+ * frame_broker.c
+ * 多消费者帧分发实现
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#include "frame_broker.h"
+
+static const char* TAG = "FRAME_BROKER";
+
+struct frame_broker_sub
+{
+    bool used;
+    char name[FRAME_BROKER_NAME_LEN];
+    frame_broker_policy_t policy;
+    frame_queue_t queue;  // 生产者为采集任务，消费者为订阅者任务
+    uint32_t rejected;
+    bool optional;
+    uint32_t starved;
+};
+
+static frame_ref_t* s_pool = NULL;
+static uint32_t s_pool_size = 0;
+static uint32_t s_seq = 0;
+static uint32_t s_capacity = 0;  // 相机驱动的帧缓冲个数，0 表示按句柄个数
+static frame_broker_sub_t s_subs[FRAME_BROKER_MAX_SUBSCRIBERS];
+static SemaphoreHandle_t s_mutex = NULL;  // 保护订阅者表，发布时持有，避免投递与注销并发
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;  // 保护句柄分配与统计
+static frame_broker_stats_t s_stats;
+
+esp_err_t frame_broker_init(uint32_t pool_size)
+{
+    if (s_pool != NULL) {
+        return ESP_OK;
+    }
+    if (pool_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_pool = calloc(pool_size, sizeof(frame_ref_t));
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_pool == NULL || s_mutex == NULL) {
+        free(s_pool);
+        s_pool = NULL;
+        if (s_mutex != NULL) {
+            vSemaphoreDelete(s_mutex);
+            s_mutex = NULL;
+        }
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint32_t i = 0; i < pool_size; i++) {
+        atomic_init(&s_pool[i].refs, 0);
+    }
+
+    s_pool_size = pool_size;
+    s_stats.pool_size = pool_size;
+    if (s_capacity == 0) {
+        s_capacity = pool_size;
+    }
+    ESP_LOGI(TAG, "帧分发初始化: %lu 个句柄", (unsigned long)pool_size);
+    return ESP_OK;
+}
+
+void frame_broker_set_capacity(uint32_t fb_count)
+{
+    taskENTER_CRITICAL(&s_lock);
+    s_capacity = fb_count;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+frame_ref_t* frame_broker_wrap(camera_fb_t* fb)
+{
+    if (s_pool == NULL || fb == NULL) {
+        return NULL;
+    }
+
+    frame_ref_t* ref = NULL;
+    taskENTER_CRITICAL(&s_lock);
+    for (uint32_t i = 0; i < s_pool_size; i++) {
+        if (atomic_load_explicit(&s_pool[i].refs, memory_order_acquire) == 0) {
+            ref = &s_pool[i];
+            atomic_store_explicit(&ref->refs, 1, memory_order_relaxed);
+            break;
+        }
+    }
+    if (ref == NULL) {
+        s_stats.wrap_fails++;
+    }
+    else {
+        s_stats.in_use++;
+        if (s_stats.in_use > s_stats.in_use_max) {
+            s_stats.in_use_max = s_stats.in_use;
+        }
+        ref->seq = ++s_seq;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    if (ref == NULL) {
+        return NULL;
+    }
+
+    ref->fb = fb;
+    ref->data = fb->buf;
+    ref->len = fb->len;
+    ref->timestamp_us = (uint64_t)fb->timestamp.tv_sec * 1000000ULL + fb->timestamp.tv_usec;
+    return ref;
+}
+
+void frame_broker_retain(frame_ref_t* ref)
+{
+    atomic_fetch_add_explicit(&ref->refs, 1, memory_order_relaxed);
+}
+
+void frame_broker_release(frame_ref_t* ref)
+{
+    if (ref == NULL) {
+        return;
+    }
+    // 计数归零后句柄可能立即被重新分配，先取出帧缓冲
+    camera_fb_t* fb = ref->fb;
+    if (atomic_fetch_sub_explicit(&ref->refs, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    esp_camera_fb_return(fb);
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.in_use--;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * @brief 队列丢弃回调：释放队列持有的引用
+ */
+static void release_queued(void* item)
+{
+    frame_broker_release((frame_ref_t*)item);
+}
+
+frame_broker_sub_t* frame_broker_subscribe(const char* name, uint32_t depth, frame_broker_policy_t policy)
+{
+    if (s_mutex == NULL || name == NULL || depth == 0) {
+        return NULL;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    frame_broker_sub_t* sub = NULL;
+    for (uint32_t i = 0; i < FRAME_BROKER_MAX_SUBSCRIBERS; i++) {
+        if (!s_subs[i].used) {
+            sub = &s_subs[i];
+            break;
+        }
+    }
+    if (sub != NULL && frame_queue_init(&sub->queue, depth, release_queued) == ESP_OK) {
+        strncpy(sub->name, name, sizeof(sub->name) - 1);
+        sub->name[sizeof(sub->name) - 1] = '\0';
+        sub->policy = policy;
+        sub->rejected = 0;
+        sub->optional = false;
+        sub->starved = 0;
+        sub->used = true;
+        s_stats.subscribers++;
+    }
+    else {
+        sub = NULL;
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (sub == NULL) {
+        ESP_LOGE(TAG, "订阅者 %s 注册失败", name);
+        return NULL;
+    }
+    ESP_LOGI(TAG, "订阅者 %s: 队列深度 %lu, 满时丢弃%s", name, (unsigned long)depth, policy == FRAME_BROKER_DROP_OLDEST ? "最旧帧" : "新帧");
+    return sub;
+}
+
+void frame_broker_set_optional(frame_broker_sub_t* sub)
+{
+    if (sub == NULL || s_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    sub->optional = true;
+    xSemaphoreGive(s_mutex);
+}
+
+void frame_broker_unsubscribe(frame_broker_sub_t* sub)
+{
+    if (sub == NULL || s_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (sub->used) {
+        sub->used = false;
+        frame_queue_drain(&sub->queue);
+        frame_queue_deinit(&sub->queue);
+        s_stats.subscribers--;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+bool frame_broker_has_spare(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    bool spare = s_stats.in_use + FRAME_BROKER_OPTIONAL_RESERVE <= s_capacity;
+    taskEXIT_CRITICAL(&s_lock);
+    return spare;
+}
+
+uint32_t frame_broker_publish(frame_ref_t* ref)
+{
+    if (ref == NULL || s_mutex == NULL) {
+        return 0;
+    }
+
+    // 本帧已计入在用帧数；空闲帧缓冲不足时可选订阅者不再延长帧的持有时间
+    bool spare = frame_broker_has_spare();
+
+    uint32_t delivered = 0;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < FRAME_BROKER_MAX_SUBSCRIBERS; i++) {
+        frame_broker_sub_t* sub = &s_subs[i];
+        if (!sub->used) {
+            continue;
+        }
+        if (sub->optional && !spare) {
+            sub->starved++;
+            continue;
+        }
+        if (sub->policy == FRAME_BROKER_DROP_NEWEST) {
+            // 只有消费者会让队列变短，这里看到未满则入队时一定不会挤掉旧帧
+            uint32_t depth = atomic_load_explicit(&sub->queue.head, memory_order_relaxed) - atomic_load_explicit(&sub->queue.tail, memory_order_acquire);
+            if (depth >= sub->queue.capacity) {
+                sub->rejected++;
+                continue;
+            }
+        }
+        // 先为队列增加引用，DROP_OLDEST 挤掉的旧帧由丢弃回调释放
+        frame_broker_retain(ref);
+        frame_queue_push(&sub->queue, ref);
+        delivered++;
+    }
+    xSemaphoreGive(s_mutex);
+
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.published++;
+    taskEXIT_CRITICAL(&s_lock);
+    return delivered;
+}
+
+frame_ref_t* frame_broker_pop(frame_broker_sub_t* sub, TickType_t timeout)
+{
+    if (sub == NULL || !sub->used) {
+        return NULL;
+    }
+    return (frame_ref_t*)frame_queue_pop(&sub->queue, timeout);
+}
+
+void frame_broker_flush(frame_broker_sub_t* sub)
+{
+    if (sub == NULL || !sub->used) {
+        return;
+    }
+    frame_queue_drain(&sub->queue);
+}
+
+void frame_broker_get_sub_stats(frame_broker_sub_t* sub, frame_broker_sub_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (sub == NULL || !sub->used) {
+        return;
+    }
+    memcpy(stats->name, sub->name, sizeof(stats->name));
+    stats->policy = sub->policy;
+    stats->rejected = sub->rejected;
+    stats->optional = sub->optional;
+    stats->starved = sub->starved;
+    frame_queue_get_stats(&sub->queue, &stats->queue);
+}
+
+void frame_broker_get_stats(frame_broker_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (s_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    taskENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    stats->capacity = s_capacity;
+    taskEXIT_CRITICAL(&s_lock);
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < FRAME_BROKER_MAX_SUBSCRIBERS; i++) {
+        if (s_subs[i].used) {
+            frame_broker_get_sub_stats(&s_subs[i], &stats->sub[n++]);
+        }
+    }
+    stats->subscribers = n;
+    xSemaphoreGive(s_mutex);
+}
@@ -0,0 +1,196 @@
+/*
+ * frame_broker.h
+ * 多消费者帧分发 - 把相机帧缓冲包装成引用计数的句柄，分发给各个订阅者
+ *
+ * 采集任务取帧后包装为句柄并发布，每个订阅者有独立的队列深度与丢帧策略，
+ * 队列中的每一项都持有一个引用；最后一个引用释放时帧缓冲才归还相机驱动。
+ * 所有消费者（UDP发送、重传环、HTTP/RTSP最新帧槽等）共享同一块帧缓冲，不拷贝图像数据。
+ *
+ * 帧缓冲个数是固定的小值，不按每个消费者的最坏占用求和。可选订阅者（事件片段、运动检测、缩略图流）与最新帧槽的读者
+ * 只在空闲帧缓冲不少于 FRAME_BROKER_OPTIONAL_RESERVE 个时才取得新帧，否则丢弃，保证采集与主图像流不会因它们停住。
+ */
+
+#ifndef FRAME_BROKER_H
+#define FRAME_BROKER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "frame_queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_BROKER_MAX_SUBSCRIBERS 8
+#define FRAME_BROKER_NAME_LEN 16
+#define FRAME_BROKER_OPTIONAL_RESERVE 1  // 向可选订阅者投递时至少要留给驱动的空闲帧缓冲个数
+
+/**
+ * @brief 引用计数的帧句柄（只读，持有引用期间内容不变）
+ */
+typedef struct
+{
+    camera_fb_t* fb;        // 相机帧缓冲
+    const uint8_t* data;    // JPEG 数据 (fb->buf)
+    size_t len;             // 数据长度 (fb->len)
+    uint32_t seq;           // 发布序号，从 1 开始
+    uint64_t timestamp_us;  // 采集时间戳
+    _Atomic uint32_t refs;  // 引用数，为 0 时句柄空闲
+} frame_ref_t;
+
+/**
+ * @brief 订阅者队列满时的丢帧策略
+ */
+typedef enum {
+    FRAME_BROKER_DROP_OLDEST = 0,  // 丢弃队列中最旧的帧，保证消费者拿到最新的帧（实时发送）
+    FRAME_BROKER_DROP_NEWEST,      // 丢弃新发布的帧，队列中的帧保持连续（处理耗时的分析任务）
+} frame_broker_policy_t;
+
+/**
+ * @brief 订阅者句柄
+ */
+typedef struct frame_broker_sub frame_broker_sub_t;
+
+/**
+ * @brief 单个订阅者的统计信息
+ */
+typedef struct
+{
+    char name[FRAME_BROKER_NAME_LEN];
+    frame_broker_policy_t policy;
+    frame_queue_stats_t queue;  // 队列统计，dropped 为 DROP_OLDEST 丢弃的帧数
+    uint32_t rejected;          // DROP_NEWEST 策略下因队列满未投递的帧数
+    bool optional;              // 可选订阅者
+    uint32_t starved;           // 可选订阅者因空闲帧缓冲不足未投递的帧数
+} frame_broker_sub_stats_t;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct
+{
+    uint32_t published;     // 发布的帧数
+    uint32_t wrap_fails;    // 句柄耗尽而无法包装的帧数
+    uint32_t in_use;        // 当前被引用的帧数（未归还驱动的帧缓冲）
+    uint32_t in_use_max;    // 历史最大在用帧数
+    uint32_t pool_size;     // 句柄个数
+    uint32_t capacity;      // 相机驱动当前的帧缓冲个数
+    uint32_t subscribers;   // 订阅者个数
+    frame_broker_sub_stats_t sub[FRAME_BROKER_MAX_SUBSCRIBERS];
+} frame_broker_stats_t;
+
+/**
+ * @brief 初始化（已初始化时直接返回）
+ *
+ * 每个帧缓冲同一时刻只对应一个句柄，句柄个数不小于相机的 fb_count 时包装总能成功。
+ *
+ * @param pool_size 句柄个数
+ * @return esp_err_t
+ */
+esp_err_t frame_broker_init(uint32_t pool_size);
+
+/**
+ * @brief 设置相机驱动当前的帧缓冲个数（相机初始化或重新初始化后调用，可在 frame_broker_init() 之前调用）
+ *
+ * 用于判断空闲帧缓冲是否足够向可选订阅者投递；未设置时按句柄个数计算。
+ *
+ * @param fb_count 帧缓冲个数
+ */
+void frame_broker_set_capacity(uint32_t fb_count);
+
+/**
+ * @brief 把相机帧缓冲包装成句柄，调用者持有返回的一个引用
+ * @param fb 帧缓冲（成功后所有权转移给句柄）
+ * @return 句柄，句柄耗尽时返回 NULL（帧缓冲仍归调用者）
+ */
+frame_ref_t* frame_broker_wrap(camera_fb_t* fb);
+
+/**
+ * @brief 增加一个引用
+ * @param ref 句柄
+ */
+void frame_broker_retain(frame_ref_t* ref);
+
+/**
+ * @brief 释放一个引用，最后一个引用释放时帧缓冲归还驱动
+ * @param ref 句柄，可为 NULL
+ */
+void frame_broker_release(frame_ref_t* ref);
+
+/**
+ * @brief 是否还有空闲帧缓冲可以让可选的消费者长时间持有帧
+ *
+ * 调用者持有的帧已计入在用帧数；返回 false 时不应再延长帧的持有时间，驱动至少保留一个可写入的帧缓冲。
+ *
+ * @return 在用帧数加上 FRAME_BROKER_OPTIONAL_RESERVE 不超过帧缓冲个数时返回 true
+ */
+bool frame_broker_has_spare(void);
+
+/**
+ * @brief 注册订阅者
+ * @param name 名称（用于统计）
+ * @param depth 队列深度
+ * @param policy 队列满时的丢帧策略
+ * @return 订阅者，失败返回 NULL
+ */
+frame_broker_sub_t* frame_broker_subscribe(const char* name, uint32_t depth, frame_broker_policy_t policy);
+
+/**
+ * @brief 把订阅者标记为可选：空闲帧缓冲不足时不向其投递，计入 starved
+ *
+ * 用于允许丢帧的分析与录制任务，它们排队或处理中的帧不计入相机帧缓冲个数。
+ *
+ * @param sub 订阅者
+ */
+void frame_broker_set_optional(frame_broker_sub_t* sub);
+
+/**
+ * @brief 注销订阅者并释放队列中的帧（由消费者任务在停止取帧后调用）
+ * @param sub 订阅者
+ */
+void frame_broker_unsubscribe(frame_broker_sub_t* sub);
+
+/**
+ * @brief 把一帧投递给全部订阅者，每个入队的订阅者增加一个引用（只由采集任务调用），从不阻塞
+ * @param ref 句柄（调用者的引用不变）
+ * @return 入队的订阅者个数
+ */
+uint32_t frame_broker_publish(frame_ref_t* ref);
+
+/**
+ * @brief 从订阅者队列取一帧（仅该订阅者的消费者调用）
+ * @param sub 订阅者
+ * @param timeout 队列为空时的最长等待时间
+ * @return 句柄（调用者持有一个引用，用完调用 frame_broker_release()），超时返回 NULL
+ */
+frame_ref_t* frame_broker_pop(frame_broker_sub_t* sub, TickType_t timeout);
+
+/**
+ * @brief 清空订阅者队列，释放其中的帧
+ * @param sub 订阅者
+ */
+void frame_broker_flush(frame_broker_sub_t* sub);
+
+/**
+ * @brief 获取单个订阅者的统计信息
+ * @param sub 订阅者
+ * @param stats 输出统计信息
+ */
+void frame_broker_get_sub_stats(frame_broker_sub_t* sub, frame_broker_sub_stats_t* stats);
+
+/**
+ * @brief 获取统计信息（含全部订阅者）
+ * @param stats 输出统计信息
+ */
+void frame_broker_get_stats(frame_broker_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_BROKER_H */
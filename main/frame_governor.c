@@ -0,0 +1,200 @@
+/*
+ * frame_governor.c
+ * 目标帧率调速器与帧率/抖动估计实现
+ */
+
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "frame_governor.h"
+
+static const char* TAG = "FRAME_GOV";
+
+// 超过该值的帧间隔按该值计入，避免暂停后的单个样本撑爆平方和
+#define FPS_ESTIMATOR_MAX_INTERVAL_US 10000000U
+
+static void governor_timer_cb(void* arg)
+{
+    frame_governor_t* governor = (frame_governor_t*)arg;
+    if (governor->waiter != NULL) {
+        xTaskNotifyGive(governor->waiter);
+    }
+}
+
+/**
+ * @brief 睡眠到绝对时间 deadline_us
+ */
+static void governor_sleep_until(frame_governor_t* governor, int64_t deadline_us)
+{
+    int64_t delay_us = deadline_us - esp_timer_get_time();
+    if (delay_us <= 0) {
+        return;
+    }
+
+    if (governor->timer == NULL) {
+        vTaskDelay(pdMS_TO_TICKS((delay_us + 999) / 1000));
+        return;
+    }
+
+    governor->waiter = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, 0);  // 清除残留的通知
+    if (esp_timer_start_once(governor->timer, (uint64_t)delay_us) == ESP_OK) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    else {
+        vTaskDelay(pdMS_TO_TICKS((delay_us + 999) / 1000));
+    }
+    governor->waiter = NULL;
+}
+
+esp_err_t frame_governor_init(frame_governor_t* governor, uint32_t target_fps)
+{
+    if (governor == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(governor, 0, sizeof(*governor));
+    portMUX_INITIALIZE(&governor->lock);
+    governor->period_us = target_fps > 0 ? 1000000LL / target_fps : 0;
+    governor->stats.target_fps = target_fps;
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = governor_timer_cb,
+        .arg = governor,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "frame_gov",
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &governor->timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "创建调速定时器失败: %s", esp_err_to_name(ret));
+        governor->timer = NULL;
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "调速器初始化: 目标帧率 %lu FPS (0 表示不限速)", (unsigned long)target_fps);
+    return ESP_OK;
+}
+
+void frame_governor_deinit(frame_governor_t* governor)
+{
+    if (governor == NULL || governor->timer == NULL) {
+        return;
+    }
+    esp_timer_stop(governor->timer);
+    esp_timer_delete(governor->timer);
+    governor->timer = NULL;
+}
+
+void frame_governor_set_fps(frame_governor_t* governor, uint32_t target_fps)
+{
+    taskENTER_CRITICAL(&governor->lock);
+    governor->period_us = target_fps > 0 ? 1000000LL / target_fps : 0;
+    governor->next_deadline_us = 0;  // 下一帧立即放行并以新周期重新对齐
+    governor->stats.target_fps = target_fps;
+    taskEXIT_CRITICAL(&governor->lock);
+    ESP_LOGI(TAG, "目标帧率修改为 %lu FPS", (unsigned long)target_fps);
+}
+
+void frame_governor_wait(frame_governor_t* governor)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t missed = 0;
+
+    taskENTER_CRITICAL(&governor->lock);
+    int64_t period = governor->period_us;
+    int64_t deadline = governor->next_deadline_us;
+    if (period <= 0 || deadline == 0) {
+        deadline = now;
+    }
+    else if (now - deadline >= period) {
+        // 落后超过一个周期：跳过错过的周期，对齐到下一个未来的截止时间
+        int64_t behind = (now - deadline) / period;
+        missed = (uint32_t)behind;
+        deadline += behind * period;
+        if (deadline < now) {
+            deadline += period;
+        }
+    }
+    governor->next_deadline_us = period > 0 ? deadline + period : 0;
+    taskEXIT_CRITICAL(&governor->lock);
+
+    governor_sleep_until(governor, deadline);
+
+    int64_t late = esp_timer_get_time() - deadline;
+    uint32_t late_us = late > 0 ? (uint32_t)late : 0;
+
+    taskENTER_CRITICAL(&governor->lock);
+    governor->stats.frames++;
+    governor->stats.missed += missed;
+    governor->stats.late_avg_us = (governor->stats.late_avg_us * 7 + late_us) / 8;
+    if (late_us > governor->stats.late_max_us) {
+        governor->stats.late_max_us = late_us;
+    }
+    taskEXIT_CRITICAL(&governor->lock);
+}
+
+void frame_governor_get_stats(frame_governor_t* governor, frame_governor_stats_t* stats)
+{
+    if (governor == NULL || stats == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&governor->lock);
+    *stats = governor->stats;
+    taskEXIT_CRITICAL(&governor->lock);
+}
+
+void fps_estimator_reset(fps_estimator_t* estimator)
+{
+    memset(estimator, 0, sizeof(*estimator));
+}
+
+void fps_estimator_update(fps_estimator_t* estimator, int64_t now_us)
+{
+    estimator->total++;
+    if (estimator->last_us == 0) {
+        estimator->last_us = now_us;
+        return;
+    }
+
+    int64_t delta = now_us - estimator->last_us;
+    estimator->last_us = now_us;
+    uint32_t interval = delta <= 0 ? 0 : (delta > FPS_ESTIMATOR_MAX_INTERVAL_US ? FPS_ESTIMATOR_MAX_INTERVAL_US : (uint32_t)delta);
+
+    // 窗口已满时移出最旧的间隔
+    if (estimator->count == FPS_ESTIMATOR_WINDOW) {
+        uint32_t oldest = estimator->intervals[estimator->index];
+        estimator->sum -= oldest;
+        estimator->sum_sq -= (uint64_t)oldest * oldest;
+    }
+    else {
+        estimator->count++;
+    }
+
+    estimator->intervals[estimator->index] = interval;
+    estimator->index = (estimator->index + 1) % FPS_ESTIMATOR_WINDOW;
+    estimator->sum += interval;
+    estimator->sum_sq += (uint64_t)interval * interval;
+}
+
+float fps_estimator_fps(const fps_estimator_t* estimator)
+{
+    if (estimator->count == 0 || estimator->sum == 0) {
+        return 0.0f;
+    }
+    return (float)estimator->count * 1000000.0f / (float)estimator->sum;
+}
+
+uint32_t fps_estimator_jitter_us(const fps_estimator_t* estimator)
+{
+    if (estimator->count < 2) {
+        return 0;
+    }
+    double mean = (double)estimator->sum / estimator->count;
+    double variance = (double)estimator->sum_sq / estimator->count - mean * mean;
+    return variance > 0 ? (uint32_t)sqrt(variance) : 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * frame_governor.h
+ * 目标帧率调速器（按绝对截止时间调度采集）与滑动窗口帧率/抖动估计
+ */
+
+#ifndef FRAME_GOVERNOR_H
+#define FRAME_GOVERNOR_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FPS_ESTIMATOR_WINDOW 32  // 滑动窗口内保留的帧间隔个数
+
+/**
+ * @brief 调速器统计信息
+ */
+typedef struct
+{
+    uint32_t target_fps;      // 目标帧率，0 表示尽可能快
+    uint32_t frames;          // 已放行的帧数
+    uint32_t missed;          // 错过的截止时间（被跳过的采集周期）数
+    uint32_t late_avg_us;     // 实际唤醒时间相对截止时间的延迟（滑动平均）
+    uint32_t late_max_us;     // 最大延迟
+} frame_governor_stats_t;
+
+/**
+ * @brief 调速器实例
+ *
+ * 每个周期的截止时间 = 上一个截止时间 + 周期，而不是“上次结束后再睡一个周期”，
+ * 因此采集与发送的耗时会被自动扣除，不会累计漂移。
+ */
+typedef struct
+{
+    portMUX_TYPE lock;
+    int64_t period_us;           // 采集周期，0 表示不限速
+    int64_t next_deadline_us;    // 下一帧的绝对截止时间，0 表示尚未开始
+    esp_timer_handle_t timer;    // 微秒级唤醒定时器
+    TaskHandle_t waiter;         // 正在等待的任务
+    frame_governor_stats_t stats;
+} frame_governor_t;
+
+/**
+ * @brief 帧率/抖动估计器：最近 FPS_ESTIMATOR_WINDOW 个帧间隔的均值与标准差
+ */
+typedef struct
+{
+    int64_t last_us;                              // 上一帧的时间戳
+    uint32_t intervals[FPS_ESTIMATOR_WINDOW];     // 帧间隔环形缓冲 (微秒)
+    uint32_t count;                               // 窗口内的有效间隔数
+    uint32_t index;                               // 下一个写入位置
+    uint64_t sum;                                 // 窗口内间隔之和
+    uint64_t sum_sq;                              // 窗口内间隔平方和
+    uint32_t total;                               // 累计帧数
+} fps_estimator_t;
+
+/**
+ * @brief 初始化调速器
+ * @param governor 调速器实例
+ * @param target_fps 目标帧率，0 表示尽可能快
+ * @return esp_err_t 定时器创建失败时返回错误，实例退化为按 tick 延时
+ */
+esp_err_t frame_governor_init(frame_governor_t* governor, uint32_t target_fps);
+
+/**
+ * @brief 释放调速器占用的定时器
+ * @param governor 调速器实例
+ */
+void frame_governor_deinit(frame_governor_t* governor);
+
+/**
+ * @brief 运行时修改目标帧率，从下一帧开始按新周期重新对齐
+ * @param governor 调速器实例
+ * @param target_fps 目标帧率，0 表示尽可能快
+ */
+void frame_governor_set_fps(frame_governor_t* governor, uint32_t target_fps);
+
+/**
+ * @brief 阻塞到本帧的截止时间
+ *
+ * 若已错过截止时间超过一个周期，则跳过错过的周期并计入 missed，重新对齐到下一个未来的截止时间。
+ *
+ * @param governor 调速器实例
+ */
+void frame_governor_wait(frame_governor_t* governor);
+
+/**
+ * @brief 获取调速器统计信息
+ * @param governor 调速器实例
+ * @param stats 输出统计信息
+ */
+void frame_governor_get_stats(frame_governor_t* governor, frame_governor_stats_t* stats);
+
+/**
+ * @brief 重置估计器
+ * @param estimator 估计器实例
+ */
+void fps_estimator_reset(fps_estimator_t* estimator);
+
+/**
+ * @brief 记录一帧
+ * @param estimator 估计器实例
+ * @param now_us 帧时间戳 (微秒)
+ */
+void fps_estimator_update(fps_estimator_t* estimator, int64_t now_us);
+
+/**
+ * @brief 窗口内的平均帧率
+ * @param estimator 估计器实例
+ * @return 帧率 (FPS)，样本不足时返回 0
+ */
+float fps_estimator_fps(const fps_estimator_t* estimator);
+
+/**
+ * @brief 窗口内帧间隔的标准差
+ * @param estimator 估计器实例
+ * @return 抖动 (微秒)
+ */
+uint32_t fps_estimator_jitter_us(const fps_estimator_t* estimator);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_GOVERNOR_H */
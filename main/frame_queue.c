@@ -0,0 +1,130 @@
+/*
+ * frame_queue.c
+ * 单生产者/单消费者无锁帧队列实现
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "frame_queue.h"
+
+esp_err_t frame_queue_init(frame_queue_t* queue, uint32_t capacity, frame_queue_drop_cb_t drop_cb)
+{
+    if (queue == NULL || capacity == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(queue, 0, sizeof(*queue));
+    queue->slots = calloc(capacity, sizeof(void*));
+    if (queue->slots == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    queue->ready = xSemaphoreCreateBinary();
+    if (queue->ready == NULL) {
+        free(queue->slots);
+        queue->slots = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    queue->capacity = capacity;
+    queue->drop_cb = drop_cb;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    return ESP_OK;
+}
+
+void frame_queue_deinit(frame_queue_t* queue)
+{
+    if (queue == NULL || queue->slots == NULL) {
+        return;
+    }
+    vSemaphoreDelete(queue->ready);
+    free(queue->slots);
+    queue->slots = NULL;
+    queue->ready = NULL;
+}
+
+uint32_t frame_queue_push(frame_queue_t* queue, void* item)
+{
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    uint32_t dropped = 0;
+
+    // 队列已满：与消费者竞争推进 tail，抢到的一方拥有最旧的帧
+    while (head - tail >= queue->capacity) {
+        void* oldest = queue->slots[tail % queue->capacity];
+        if (atomic_compare_exchange_weak_explicit(&queue->tail, &tail, tail + 1, memory_order_acq_rel, memory_order_acquire)) {
+            if (queue->drop_cb != NULL) {
+                queue->drop_cb(oldest);
+            }
+            dropped++;
+            tail++;
+        }
+    }
+
+    queue->slots[head % queue->capacity] = item;
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+
+    atomic_fetch_add_explicit(&queue->pushed, 1, memory_order_relaxed);
+    if (dropped > 0) {
+        atomic_fetch_add_explicit(&queue->dropped, dropped, memory_order_relaxed);
+    }
+    uint32_t depth = head + 1 - tail;
+    if (depth > atomic_load_explicit(&queue->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&queue->high_water, depth, memory_order_relaxed);
+    }
+
+    xSemaphoreGive(queue->ready);
+    return dropped;
+}
+
+/**
+ * @brief 非阻塞出队
+ */
+static void* frame_queue_try_pop(frame_queue_t* queue)
+{
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    while (tail != atomic_load_explicit(&queue->head, memory_order_acquire)) {
+        void* item = queue->slots[tail % queue->capacity];
+        // CAS 失败说明生产者刚丢弃了这一帧，读到的指针作废，用新的 tail 重试
+        if (atomic_compare_exchange_weak_explicit(&queue->tail, &tail, tail + 1, memory_order_acq_rel, memory_order_acquire)) {
+            atomic_fetch_add_explicit(&queue->popped, 1, memory_order_relaxed);
+            return item;
+        }
+    }
+    return NULL;
+}
+
+void* frame_queue_pop(frame_queue_t* queue, TickType_t timeout)
+{
+    void* item = frame_queue_try_pop(queue);
+    if (item == NULL && xSemaphoreTake(queue->ready, timeout) == pdTRUE) {
+        item = frame_queue_try_pop(queue);
+    }
+    return item;
+}
+
+void frame_queue_drain(frame_queue_t* queue)
+{
+    void* item;
+    while ((item = frame_queue_try_pop(queue)) != NULL) {
+        if (queue->drop_cb != NULL) {
+            queue->drop_cb(item);
+        }
+    }
+}
+
+void frame_queue_get_stats(frame_queue_t* queue, frame_queue_stats_t* stats)
+{
+    if (queue == NULL || stats == NULL) {
+        return;
+    }
+    stats->pushed = atomic_load(&queue->pushed);
+    stats->popped = atomic_load(&queue->popped);
+    stats->dropped = atomic_load(&queue->dropped);
+    stats->high_water = atomic_load(&queue->high_water);
+    stats->depth = atomic_load(&queue->head) - atomic_load(&queue->tail);
+    stats->capacity = queue->capacity;
+}
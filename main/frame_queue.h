@@ -0,0 +1,105 @@
+/*
+ * frame_queue.h
+ * 单生产者/单消费者无锁帧队列，队列满时丢弃最旧的帧
+ *
+ * 生产者只推进 head，消费者与生产者(丢弃最旧帧时)通过CAS竞争推进 tail，
+ * 因此数据通路不需要互斥锁；空队列时消费者在二值信号量上阻塞等待。
+ */
+
+#ifndef FRAME_QUEUE_H
+#define FRAME_QUEUE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 丢弃帧时的回调（例如把帧缓冲归还驱动）
+ */
+typedef void (*frame_queue_drop_cb_t)(void* item);
+
+/**
+ * @brief 队列统计信息
+ */
+typedef struct
+{
+    uint32_t pushed;      // 入队帧数
+    uint32_t popped;      // 出队帧数
+    uint32_t dropped;     // 因队列满被丢弃的最旧帧数
+    uint32_t depth;       // 当前队列深度
+    uint32_t high_water;  // 历史最大深度
+    uint32_t capacity;    // 队列容量
+} frame_queue_stats_t;
+
+/**
+ * @brief 帧队列
+ */
+typedef struct
+{
+    void** slots;
+    uint32_t capacity;
+    _Atomic uint32_t head;  // 下一个写入位置（仅生产者修改）
+    _Atomic uint32_t tail;  // 最旧帧的位置（消费者出队与生产者丢弃时CAS推进）
+    _Atomic uint32_t pushed;
+    _Atomic uint32_t popped;
+    _Atomic uint32_t dropped;
+    _Atomic uint32_t high_water;
+    frame_queue_drop_cb_t drop_cb;
+    SemaphoreHandle_t ready;  // 有新帧时唤醒消费者
+} frame_queue_t;
+
+/**
+ * @brief 初始化帧队列
+ * @param queue 队列
+ * @param capacity 容量
+ * @param drop_cb 丢弃帧回调，可为 NULL
+ * @return esp_err_t
+ */
+esp_err_t frame_queue_init(frame_queue_t* queue, uint32_t capacity, frame_queue_drop_cb_t drop_cb);
+
+/**
+ * @brief 释放队列（调用前应先用 frame_queue_drain() 清空）
+ * @param queue 队列
+ */
+void frame_queue_deinit(frame_queue_t* queue);
+
+/**
+ * @brief 入队（仅生产者调用），队列满时丢弃最旧的帧
+ * @param queue 队列
+ * @param item 帧
+ * @return 被丢弃的帧数
+ */
+uint32_t frame_queue_push(frame_queue_t* queue, void* item);
+
+/**
+ * @brief 出队（仅消费者调用）
+ * @param queue 队列
+ * @param timeout 队列为空时的最长等待时间
+ * @return 帧，超时返回 NULL
+ */
+void* frame_queue_pop(frame_queue_t* queue, TickType_t timeout);
+
+/**
+ * @brief 清空队列，对每个剩余的帧调用丢弃回调
+ * @param queue 队列
+ */
+void frame_queue_drain(frame_queue_t* queue);
+
+/**
+ * @brief 获取统计信息
+ * @param queue 队列
+ * @param stats 输出统计信息
+ */
+void frame_queue_get_stats(frame_queue_t* queue, frame_queue_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_QUEUE_H */
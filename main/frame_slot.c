@@ -0,0 +1,165 @@
+/*
+ * frame_slot.c
+ * 最新帧槽实现
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "frame_slot.h"
+
+static const char* TAG = "FRAME_SLOT";
+
+#define FRAME_SLOT_NEW_FRAME_BIT BIT0
+#define FRAME_SLOT_DEMAND_US 2000000  // 读者最后一次取帧后继续保存最新帧的时间
+#define FRAME_SLOT_WAIT_SLICE_MS 50   // 等待新帧的单次时长，覆盖检查与等待之间错过广播的情况
+
+static frame_ref_t* s_latest = NULL;  // 槽持有的最新帧引用
+static volatile int64_t s_demand_us = 0;  // 最近一次有读者取帧的时间
+static EventGroupHandle_t s_events = NULL;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static frame_slot_stats_t s_stats;
+
+esp_err_t frame_slot_init(void)
+{
+    if (s_events != NULL) {
+        return ESP_OK;
+    }
+
+    s_events = xEventGroupCreate();
+    if (s_events == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "最新帧槽初始化: 最多占用 %d 个帧缓冲", FRAME_SLOT_MAX_PINNED);
+    return ESP_OK;
+}
+
+void frame_slot_publish(frame_ref_t* frame)
+{
+    if (s_events == NULL || frame == NULL) {
+        return;
+    }
+
+    // 最近没有读者时不占用帧缓冲；空闲帧缓冲不足时也不保存，读者持有的帧不会把驱动可写入的帧缓冲占光
+    bool wanted = esp_timer_get_time() - s_demand_us < FRAME_SLOT_DEMAND_US;
+    bool spare = wanted && frame_broker_has_spare();
+    if (spare) {
+        frame_broker_retain(frame);
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    frame_ref_t* old = s_latest;
+    s_latest = spare ? frame : NULL;
+    if (spare) {
+        s_stats.published++;
+    }
+    else if (wanted) {
+        s_stats.starved++;
+    }
+    else {
+        s_stats.idle++;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    // 槽的引用在锁外释放，可能归还帧缓冲
+    frame_broker_release(old);
+    if (!spare) {
+        return;
+    }
+
+    // 广播: 置位唤醒所有等待者后立即清除
+    xEventGroupSetBits(s_events, FRAME_SLOT_NEW_FRAME_BIT);
+    xEventGroupClearBits(s_events, FRAME_SLOT_NEW_FRAME_BIT);
+}
+
+void frame_slot_clear(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    frame_ref_t* old = s_latest;
+    s_latest = NULL;
+    taskEXIT_CRITICAL(&s_lock);
+    frame_broker_release(old);
+}
+
+uint32_t frame_slot_latest_seq(int64_t* age_us)
+{
+    uint32_t seq = 0;
+    uint64_t timestamp_us = 0;
+    taskENTER_CRITICAL(&s_lock);
+    if (s_latest != NULL) {
+        seq = s_latest->seq;
+        timestamp_us = s_latest->timestamp_us;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (age_us != NULL) {
+        *age_us = (seq != 0) ? esp_timer_get_time() - (int64_t)timestamp_us : INT64_MAX;
+    }
+    return seq;
+}
+
+const frame_slot_frame_t* frame_slot_acquire(uint32_t after_seq, TickType_t timeout)
+{
+    if (s_events == NULL) {
+        return NULL;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    for (;;) {
+        s_demand_us = esp_timer_get_time();
+
+        // 读者可能持有帧数秒（慢速 TCP 连接），与可选订阅者相同，只在还有空闲帧缓冲时交出帧，否则跳过本帧
+        bool spare = frame_broker_has_spare();
+        frame_ref_t* frame = NULL;
+        taskENTER_CRITICAL(&s_lock);
+        if (s_latest != NULL && s_latest->seq > after_seq) {
+            if (spare) {
+                frame = s_latest;
+                frame_broker_retain(frame);
+                s_stats.readers++;
+            }
+            else {
+                s_stats.starved++;
+                after_seq = s_latest->seq;
+            }
+        }
+        taskEXIT_CRITICAL(&s_lock);
+        if (frame != NULL) {
+            return frame;
+        }
+
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            return NULL;
+        }
+        TickType_t wait = timeout - elapsed;
+        if (wait > pdMS_TO_TICKS(FRAME_SLOT_WAIT_SLICE_MS)) {
+            wait = pdMS_TO_TICKS(FRAME_SLOT_WAIT_SLICE_MS);
+        }
+        xEventGroupWaitBits(s_events, FRAME_SLOT_NEW_FRAME_BIT, pdFALSE, pdFALSE, wait > 0 ? wait : 1);
+    }
+}
+
+void frame_slot_release(const frame_slot_frame_t* frame)
+{
+    if (frame == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.readers--;
+    taskEXIT_CRITICAL(&s_lock);
+    frame_broker_release((frame_ref_t*)frame);
+}
+
+void frame_slot_get_stats(frame_slot_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,114 @@
+/*
+ * frame_slot.h
+ * 最新帧槽 - 采集任务发布最新一帧，HTTP/RTSP 等多个读者共享，不各自调用 esp_camera_fb_get()
+ *
+ * 槽中保存帧分发句柄 (frame_broker.h) 的一个引用，读者取帧时各自增加引用，直接读取相机帧缓冲，不拷贝。
+ * 发布从不等待读者；每个读者总是取当时最新的一帧，慢读者自然跳过中间的帧。
+ * 每个读者最多持有一帧，因此槽占用的帧缓冲不超过 FRAME_SLOT_MAX_PINNED 个；这些帧缓冲不计入相机的帧缓冲个数，
+ * 槽与读者按可选订阅者的规则 (frame_broker_has_spare()) 只在还有空闲帧缓冲时取得帧，慢读者不会让采集停住。
+ * 最近没有读者时槽不持有帧，帧缓冲全部留给发送流水线。
+ */
+
+#ifndef FRAME_SLOT_H
+#define FRAME_SLOT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "frame_broker.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 读者数：HTTP MJPEG 流与 RTSP 会话各自最多持有一帧
+#if CONFIG_CAMERA_HTTP_SERVER
+#define FRAME_SLOT_HTTP_READERS CONFIG_CAMERA_HTTP_STREAM_CLIENTS
+#else
+#define FRAME_SLOT_HTTP_READERS 0
+#endif
+#if CONFIG_RTSP_SERVER
+#define FRAME_SLOT_RTSP_READERS CONFIG_RTSP_MAX_SESSIONS
+#else
+#define FRAME_SLOT_RTSP_READERS 0
+#endif
+#if CONFIG_CAMERA_HTTP_SERVER || CONFIG_RTSP_SERVER
+// 读者各持有一帧，加上槽中的最新帧，另留一个给 /capture.jpg
+#define FRAME_SLOT_MAX_PINNED (FRAME_SLOT_HTTP_READERS + FRAME_SLOT_RTSP_READERS + 2)
+#else
+#define FRAME_SLOT_MAX_PINNED 0
+#endif
+
+/**
+ * @brief 一帧已发布的 JPEG（只读，持有期间内容不变）
+ */
+typedef frame_ref_t frame_slot_frame_t;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct
+{
+    uint32_t published;  // 发布的帧数
+    uint32_t idle;       // 没有读者而未保存的帧数
+    uint32_t starved;    // 空闲帧缓冲不足而未保存或未交给读者的帧数
+    uint32_t readers;    // 当前持有帧的读者数
+} frame_slot_stats_t;
+
+/**
+ * @brief 初始化（已初始化时直接返回）
+ * @return esp_err_t
+ */
+esp_err_t frame_slot_init(void);
+
+/**
+ * @brief 发布一帧（增加一个引用），替换槽中的上一帧，从不阻塞
+ *
+ * 最近 2 秒内没有读者调用过 frame_slot_acquire()，或空闲帧缓冲不足时不保存本帧，并释放槽中的帧。
+ *
+ * @param frame 帧分发句柄（调用者的引用不变）
+ */
+void frame_slot_publish(frame_ref_t* frame);
+
+/**
+ * @brief 释放槽中的帧（暂停采集后归还帧缓冲用），读者已取得的帧不受影响
+ */
+void frame_slot_clear(void);
+
+/**
+ * @brief 返回最新一帧的序号与距今时间
+ * @param age_us 输出距采集的时间（微秒），可为 NULL
+ * @return 最新帧序号，尚未发布过时返回 0
+ */
+uint32_t frame_slot_latest_seq(int64_t* age_us);
+
+/**
+ * @brief 获取序号大于 after_seq 的最新一帧，必要时等待新帧发布
+ *
+ * 空闲帧缓冲不足时跳过当前帧，等待之后的帧。
+ *
+ * @param after_seq 读者已处理的最后一帧序号
+ * @param timeout 最长等待时间
+ * @return 帧（需调用 frame_slot_release() 归还），超时返回 NULL
+ */
+const frame_slot_frame_t* frame_slot_acquire(uint32_t after_seq, TickType_t timeout);
+
+/**
+ * @brief 归还 frame_slot_acquire() 取得的帧
+ * @param frame 帧
+ */
+void frame_slot_release(const frame_slot_frame_t* frame);
+
+/**
+ * @brief 获取统计信息
+ * @param stats 输出统计信息
+ */
+void frame_slot_get_stats(frame_slot_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_SLOT_H */
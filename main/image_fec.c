@@ -0,0 +1,116 @@
+/*
+ * image_fec.c
+ * UDP图像流前向纠错实现
+ */
+
+#include <string.h>
+#include "image_fec.h"
+
+void image_fec_xor(uint8_t* parity, const uint8_t* data, size_t len)
+{
+    size_t i = 0;
+
+    // 两端对齐情况相同时按32位字处理，PSRAM上的帧缓冲读取次数减少为1/4
+    if ((((uintptr_t)parity ^ (uintptr_t)data) & 3) == 0) {
+        while (i < len && ((uintptr_t)(parity + i) & 3) != 0) {
+            parity[i] ^= data[i];
+            i++;
+        }
+        uint32_t* p32 = (uint32_t*)(parity + i);
+        const uint32_t* d32 = (const uint32_t*)(data + i);
+        size_t words = (len - i) / 4;
+        for (size_t w = 0; w < words; w++) {
+            p32[w] ^= d32[w];
+        }
+        i += words * 4;
+    }
+
+    for (; i < len; i++) {
+        parity[i] ^= data[i];
+    }
+}
+
+/**
+ * @brief 计算数据包负载长度
+ */
+static size_t chunk_len(size_t image_size, size_t chunk_payload, uint32_t chunk_id)
+{
+    size_t offset = (size_t)chunk_id * chunk_payload;
+    if (offset >= image_size) {
+        return 0;
+    }
+    size_t remaining = image_size - offset;
+    return remaining > chunk_payload ? chunk_payload : remaining;
+}
+
+size_t image_fec_parity_len(size_t image_size, size_t chunk_payload, uint32_t group, uint32_t group_size)
+{
+    if (chunk_payload == 0 || group_size == 0) {
+        return 0;
+    }
+    // 组内第一个包总是最长的
+    return chunk_len(image_size, chunk_payload, image_fec_group_first(group, group_size));
+}
+
+esp_err_t image_fec_recover(uint8_t* image,
+                            size_t image_size,
+                            size_t chunk_payload,
+                            bool* received,
+                            uint32_t group,
+                            uint32_t group_size,
+                            const uint8_t* parity,
+                            size_t parity_len,
+                            uint32_t* recovered_chunk)
+{
+    if (image == NULL || received == NULL || parity == NULL || chunk_payload == 0 || group_size == 0 || group_size > IMAGE_FEC_MAX_GROUP_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t total_chunks = (image_size + chunk_payload - 1) / chunk_payload;
+    uint32_t first = image_fec_group_first(group, group_size);
+    if (first >= total_chunks) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t end = first + group_size;
+    if (end > total_chunks) {
+        end = total_chunks;
+    }
+
+    if (parity_len != image_fec_parity_len(image_size, chunk_payload, group, group_size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // 找出组内丢失的包
+    uint32_t missing = UINT32_MAX;
+    uint32_t missing_count = 0;
+    for (uint32_t id = first; id < end; id++) {
+        if (!received[id]) {
+            missing = id;
+            missing_count++;
+        }
+    }
+    if (missing_count == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (missing_count > 1) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    // 丢失包 = 校验 ^ 组内其余所有包，直接在图像缓冲区的目标位置上累加
+    size_t lost_len = chunk_len(image_size, chunk_payload, missing);
+    uint8_t* dst = image + (size_t)missing * chunk_payload;
+    memcpy(dst, parity, lost_len);
+    for (uint32_t id = first; id < end; id++) {
+        if (id == missing) {
+            continue;
+        }
+        size_t len = chunk_len(image_size, chunk_payload, id);
+        image_fec_xor(dst, image + (size_t)id * chunk_payload, len < lost_len ? len : lost_len);
+    }
+
+    received[missing] = true;
+    if (recovered_chunk != NULL) {
+        *recovered_chunk = missing;
+    }
+    return ESP_OK;
+}
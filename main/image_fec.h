@@ -0,0 +1,84 @@
+/*
+ * image_fec.h
+ * UDP图像流前向纠错 (XOR 奇偶校验包)
+ *
+ * 每 N 个数据包生成一个校验包，校验包负载为组内所有数据包负载的异或
+ * (较短的包按0补齐)。组内丢失任意一个数据包时，可由校验包和其余数据包恢复。
+ * 本模块不依赖 FreeRTOS 与网络协议栈，可在 Linux 主机上单独编译测试。
+ */
+
+#ifndef IMAGE_FEC_H
+#define IMAGE_FEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMAGE_FEC_MAX_GROUP_SIZE 64  // 最大分组大小 (最小冗余 1/64)
+
+/**
+ * @brief 把 data 异或累加到 parity（按字对齐部分一次处理4字节）
+ * @param parity 校验缓冲区，长度至少为 len
+ * @param data 数据
+ * @param len 数据长度
+ */
+void image_fec_xor(uint8_t* parity, const uint8_t* data, size_t len);
+
+/**
+ * @brief 计算分组中第一个数据包的编号
+ * @param group 组号
+ * @param group_size 分组大小
+ * @return 包序号
+ */
+static inline uint32_t image_fec_group_first(uint32_t group, uint32_t group_size)
+{
+    return group * group_size;
+}
+
+/**
+ * @brief 计算分组的校验包负载长度（组内最长数据包的长度）
+ * @param image_size 图像总大小
+ * @param chunk_payload 每包最大负载
+ * @param group 组号
+ * @param group_size 分组大小
+ * @return 校验负载长度，组不存在时返回0
+ */
+size_t image_fec_parity_len(size_t image_size, size_t chunk_payload, uint32_t group, uint32_t group_size);
+
+/**
+ * @brief 利用校验包恢复组内唯一丢失的数据包
+ *
+ * 数据包按 chunk_id * chunk_payload 的偏移放置在 image 中。
+ *
+ * @param image 正在重组的图像缓冲区，恢复出的数据直接写入其中
+ * @param image_size 图像总大小
+ * @param chunk_payload 每包最大负载
+ * @param received 每个数据包是否已收到 (按 chunk_id 索引)，恢复成功后对应项置 true
+ * @param group 组号
+ * @param group_size 分组大小
+ * @param parity 校验包负载
+ * @param parity_len 校验包负载长度
+ * @param recovered_chunk 输出被恢复的包序号，可为 NULL
+ * @return ESP_OK 恢复成功; ESP_ERR_NOT_FOUND 组内没有丢包;
+ *         ESP_ERR_NOT_SUPPORTED 丢包多于一个无法恢复; ESP_ERR_INVALID_SIZE 校验长度不符
+ */
+esp_err_t image_fec_recover(uint8_t* image,
+                            size_t image_size,
+                            size_t chunk_payload,
+                            bool* received,
+                            uint32_t group,
+                            uint32_t group_size,
+                            const uint8_t* parity,
+                            size_t parity_len,
+                            uint32_t* recovered_chunk);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IMAGE_FEC_H */
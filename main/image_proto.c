@@ -0,0 +1,334 @@
+/*
+ * image_proto.c
+ * UDP图像传输协议编解码实现
+ */
+
+#include <string.h>
+#include "image_proto.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_rom_crc.h"
+#endif
+
+static void put_u16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void put_u32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint16_t get_u16(const uint8_t* p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+#ifndef ESP_PLATFORM
+static uint32_t s_crc_table[256];
+static bool s_crc_table_ready = false;
+
+static void crc32_build_table(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        s_crc_table[i] = c;
+    }
+    s_crc_table_ready = true;
+}
+#endif
+
+uint32_t image_proto_crc32(uint32_t crc, const uint8_t* data, size_t len)
+{
+#ifdef ESP_PLATFORM
+    // ROM 中的查表实现，与 zlib.crc32 语义一致
+    return esp_rom_crc32_le(crc, data, len);
+#else
+    if (!s_crc_table_ready) {
+        crc32_build_table();
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = s_crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+#endif
+}
+
+size_t image_proto_header_size(uint8_t version)
+{
+    return (version == 1) ? IMAGE_PROTO_V1_HEADER_SIZE : IMAGE_PROTO_V2_HEADER_SIZE;
+}
+
+esp_err_t image_proto_encode_header(const image_proto_chunk_t* chunk, const uint8_t* payload, size_t payload_len, uint8_t* out)
+{
+    if (chunk == NULL || out == NULL || (payload == NULL && payload_len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (chunk->version == 1) {
+        put_u32(out + 0, chunk->chunk_id);
+        put_u32(out + 4, chunk->total_chunks);
+        put_u32(out + 8, chunk->image_size);
+        return ESP_OK;
+    }
+
+    if (chunk->version != IMAGE_PROTO_VERSION || chunk->chunk_id > 0xFFFF || chunk->total_chunks > 0xFFFF) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    put_u16(out + 0, IMAGE_PROTO_MAGIC);
+    out[2] = IMAGE_PROTO_VERSION;
+    out[3] = chunk->flags;
+    put_u32(out + 4, chunk->frame_seq);
+    put_u32(out + 8, (uint32_t)(chunk->timestamp_us >> 32));
+    put_u32(out + 12, (uint32_t)chunk->timestamp_us);
+    put_u32(out + 16, chunk->offset);
+    put_u32(out + 20, chunk->image_size);
+    put_u16(out + 24, (uint16_t)chunk->chunk_id);
+    put_u16(out + 26, (uint16_t)chunk->total_chunks);
+    put_u32(out + 28, 0);
+
+    uint32_t crc = image_proto_crc32(0, out, IMAGE_PROTO_V2_HEADER_SIZE);
+    crc = image_proto_crc32(crc, payload, payload_len);
+    put_u32(out + 28, crc);
+
+    return ESP_OK;
+}
+
+esp_err_t image_proto_decode(const uint8_t* packet, size_t len, image_proto_chunk_t* chunk, const uint8_t** payload, size_t* payload_len)
+{
+    if (packet == NULL || chunk == NULL || payload == NULL || payload_len == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(chunk, 0, sizeof(*chunk));
+
+    if (len >= 2 && get_u16(packet) == IMAGE_PROTO_MAGIC) {
+        if (len < IMAGE_PROTO_V2_HEADER_SIZE) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        if (packet[2] != IMAGE_PROTO_VERSION) {
+            return ESP_ERR_INVALID_VERSION;
+        }
+
+        // 校验CRC：包头中的CRC字段按0参与计算
+        uint8_t header[IMAGE_PROTO_V2_HEADER_SIZE];
+        memcpy(header, packet, sizeof(header));
+        put_u32(header + 28, 0);
+        uint32_t crc = image_proto_crc32(0, header, sizeof(header));
+        crc = image_proto_crc32(crc, packet + IMAGE_PROTO_V2_HEADER_SIZE, len - IMAGE_PROTO_V2_HEADER_SIZE);
+        if (crc != get_u32(packet + 28)) {
+            return ESP_ERR_INVALID_CRC;
+        }
+
+        chunk->version = IMAGE_PROTO_VERSION;
+        chunk->flags = packet[3];
+        chunk->frame_seq = get_u32(packet + 4);
+        chunk->timestamp_us = ((uint64_t)get_u32(packet + 8) << 32) | get_u32(packet + 12);
+        chunk->offset = get_u32(packet + 16);
+        chunk->image_size = get_u32(packet + 20);
+        chunk->chunk_id = get_u16(packet + 24);
+        chunk->total_chunks = get_u16(packet + 26);
+        *payload = packet + IMAGE_PROTO_V2_HEADER_SIZE;
+        *payload_len = len - IMAGE_PROTO_V2_HEADER_SIZE;
+        return ESP_OK;
+    }
+
+    // 旧版包头：无魔数，仅有三个 uint32
+    if (len < IMAGE_PROTO_V1_HEADER_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    chunk->version = 1;
+    chunk->chunk_id = get_u32(packet + 0);
+    chunk->total_chunks = get_u32(packet + 4);
+    chunk->image_size = get_u32(packet + 8);
+    chunk->offset = chunk->chunk_id * IMAGE_PROTO_V1_PAYLOAD_SIZE;
+    *payload = packet + IMAGE_PROTO_V1_HEADER_SIZE;
+    *payload_len = len - IMAGE_PROTO_V1_HEADER_SIZE;
+    return ESP_OK;
+}
+
+esp_err_t image_proto_decode_ctrl(const uint8_t* packet, size_t len, uint8_t* type)
+{
+    if (packet == NULL || type == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len < IMAGE_PROTO_CTRL_HEADER_SIZE || get_u16(packet) != IMAGE_PROTO_CTRL_MAGIC || packet[2] != IMAGE_PROTO_VERSION) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    *type = packet[3];
+    return ESP_OK;
+}
+
+esp_err_t image_proto_encode_nack(const image_proto_nack_t* nack, uint8_t* out, size_t out_size, size_t* out_len)
+{
+    if (nack == NULL || out == NULL || out_len == NULL || nack->words == 0 || nack->words > IMAGE_PROTO_NACK_MAX_WORDS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t len = 12 + (size_t)nack->words * 4;
+    if (out_size < len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    put_u16(out + 0, IMAGE_PROTO_CTRL_MAGIC);
+    out[2] = IMAGE_PROTO_VERSION;
+    out[3] = IMAGE_PROTO_CTRL_NACK;
+    put_u32(out + 4, nack->frame_seq);
+    put_u16(out + 8, nack->base_chunk);
+    put_u16(out + 10, nack->words);
+    for (uint16_t i = 0; i < nack->words; i++) {
+        put_u32(out + 12 + i * 4, nack->bitmap[i]);
+    }
+    *out_len = len;
+    return ESP_OK;
+}
+
+esp_err_t image_proto_decode_nack(const uint8_t* packet, size_t len, image_proto_nack_t* nack)
+{
+    uint8_t type;
+    esp_err_t ret = image_proto_decode_ctrl(packet, len, &type);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (nack == NULL || type != IMAGE_PROTO_CTRL_NACK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len < 12) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    memset(nack, 0, sizeof(*nack));
+    nack->frame_seq = get_u32(packet + 4);
+    nack->base_chunk = get_u16(packet + 8);
+    nack->words = get_u16(packet + 10);
+    if (nack->words == 0 || nack->words > IMAGE_PROTO_NACK_MAX_WORDS || len < 12 + (size_t)nack->words * 4) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    for (uint16_t i = 0; i < nack->words; i++) {
+        nack->bitmap[i] = get_u32(packet + 12 + i * 4);
+    }
+    return ESP_OK;
+}
+
+esp_err_t image_proto_encode_report(const image_proto_report_t* report, uint8_t* out, size_t out_size)
+{
+    if (report == NULL || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (out_size < IMAGE_PROTO_REPORT_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    put_u16(out + 0, IMAGE_PROTO_CTRL_MAGIC);
+    out[2] = IMAGE_PROTO_VERSION;
+    out[3] = IMAGE_PROTO_CTRL_REPORT;
+    put_u32(out + 4, report->frame_seq);
+    put_u16(out + 8, report->loss_permille);
+    put_u16(out + 10, 0);
+    return ESP_OK;
+}
+
+esp_err_t image_proto_decode_report(const uint8_t* packet, size_t len, image_proto_report_t* report)
+{
+    uint8_t type;
+    esp_err_t ret = image_proto_decode_ctrl(packet, len, &type);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (report == NULL || type != IMAGE_PROTO_CTRL_REPORT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len < IMAGE_PROTO_REPORT_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    report->frame_seq = get_u32(packet + 4);
+    report->loss_permille = get_u16(packet + 8);
+    if (report->loss_permille > 1000) {
+        report->loss_permille = 1000;
+    }
+    return ESP_OK;
+}
+
+esp_err_t image_proto_decode_dest(const uint8_t* packet, size_t len, image_proto_dest_t* dest)
+{
+    uint8_t type;
+    esp_err_t ret = image_proto_decode_ctrl(packet, len, &type);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (dest == NULL || type != IMAGE_PROTO_CTRL_DEST) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len < IMAGE_PROTO_DEST_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    dest->op = packet[4];
+    dest->port = get_u16(packet + 6);
+    memcpy(&dest->ip, packet + 8, sizeof(dest->ip));  // 保持网络字节序
+    if (dest->op < IMAGE_PROTO_DEST_ADD || dest->op > IMAGE_PROTO_DEST_CLEAR) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+esp_err_t image_proto_decode_clip(const uint8_t* packet, size_t len, image_proto_clip_t* clip)
+{
+    uint8_t type;
+    esp_err_t ret = image_proto_decode_ctrl(packet, len, &type);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (clip == NULL || type != IMAGE_PROTO_CTRL_CLIP) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len < IMAGE_PROTO_CLIP_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    clip->port = get_u16(packet + 4);
+    clip->post_seconds = get_u16(packet + 6);
+    return ESP_OK;
+}
+
+esp_err_t image_proto_decode_camera(const uint8_t* packet, size_t len, image_proto_camera_t* camera)
+{
+    uint8_t type;
+    esp_err_t ret = image_proto_decode_ctrl(packet, len, &type);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (camera == NULL || type != IMAGE_PROTO_CTRL_CAMERA) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len < IMAGE_PROTO_CAMERA_HEADER_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t count = packet[4];
+    if (count == 0 || count > IMAGE_PROTO_CAMERA_MAX_PARAMS || len < IMAGE_PROTO_CAMERA_HEADER_SIZE + (size_t)count * IMAGE_PROTO_CAMERA_PARAM_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    camera->count = count;
+    const uint8_t* p = packet + IMAGE_PROTO_CAMERA_HEADER_SIZE;
+    for (uint8_t i = 0; i < count; i++, p += IMAGE_PROTO_CAMERA_PARAM_SIZE) {
+        camera->params[i].param = get_u16(p);
+        camera->params[i].value = (int32_t)get_u32(p + 2);
+    }
+    return ESP_OK;
+}
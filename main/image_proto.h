@@ -0,0 +1,290 @@
+/*
+ * image_proto.h
+ * UDP图像传输协议编解码 (v1 兼容包头 / v2 带帧序号、时间戳与CRC32的包头)
+ *
+ * 本模块不依赖 FreeRTOS 与网络协议栈，可在 Linux 主机上单独编译测试。
+ */
+
+#ifndef IMAGE_PROTO_H
+#define IMAGE_PROTO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMAGE_PROTO_MAGIC 0x4543  // "EC"
+#define IMAGE_PROTO_VERSION 2
+
+#define IMAGE_PROTO_MAX_PACKET_SIZE 1400  // 单个UDP包最大长度 (MTU限制)
+
+#define IMAGE_PROTO_V1_HEADER_SIZE 12  // chunk_id, total_chunks, image_size (各 uint32)
+#define IMAGE_PROTO_V2_HEADER_SIZE 32
+
+// 各版本每包的最大负载
+#define IMAGE_PROTO_V1_PAYLOAD_SIZE (IMAGE_PROTO_MAX_PACKET_SIZE - IMAGE_PROTO_V1_HEADER_SIZE)
+#define IMAGE_PROTO_V2_PAYLOAD_SIZE (IMAGE_PROTO_MAX_PACKET_SIZE - IMAGE_PROTO_V2_HEADER_SIZE)
+
+/*
+ * v2 包头布局（网络字节序）:
+ *   0  uint16 magic         "EC"
+ *   2  uint8  version       2
+ *   3  uint8  flags         IMAGE_PROTO_FLAG_*
+ *   4  uint32 frame_seq     帧序号
+ *   8  uint64 timestamp_us  采集时间戳 (fb->timestamp)
+ *  16  uint32 offset        本包负载在图像中的字节偏移
+ *  20  uint32 image_size    图像总大小
+ *  24  uint16 chunk_id      包序号
+ *  26  uint16 total_chunks  总包数
+ *  28  uint32 crc32         包头(crc32字段置0) + 负载的CRC32
+ */
+
+#define IMAGE_PROTO_FLAG_FIRST 0x01     // 帧的第一个包
+#define IMAGE_PROTO_FLAG_LAST 0x02      // 帧的最后一个包
+#define IMAGE_PROTO_FLAG_KEYFRAME 0x04  // 可独立解码的帧 (JPEG 每帧均为关键帧)
+#define IMAGE_PROTO_FLAG_PARITY 0x08    // FEC校验包: chunk_id 为组号, offset 为分组大小 (见 image_fec.h)
+#define IMAGE_PROTO_FLAG_RETRANSMIT 0x10  // 应答NACK的重传包
+
+/*
+ * 控制报文（接收端 -> 设备，发往图像socket绑定的本地端口）:
+ *   0  uint16 magic  "EK"
+ *   2  uint8  version 2
+ *   3  uint8  type    IMAGE_PROTO_CTRL_*
+ *   4  ...    按类型定义的内容
+ *
+ * NACK (type = IMAGE_PROTO_CTRL_NACK):
+ *   4  uint32 frame_seq    帧序号
+ *   8  uint16 base_chunk   位图第0位对应的包序号
+ *  10  uint16 words        位图的 uint32 个数
+ *  12  uint32 bitmap[]     第 i 位为1表示包 base_chunk + i 丢失 (每个字内 bit0 为最低位)
+ *
+ * 接收报告 (type = IMAGE_PROTO_CTRL_REPORT):
+ *   4  uint32 frame_seq      最近收到的帧序号
+ *   8  uint16 loss_permille  统计窗口内的丢包率 (千分比，FEC/重传恢复之前)
+ *  10  uint16 reserved
+ *
+ * 目标表修改 (type = IMAGE_PROTO_CTRL_DEST):
+ *   4  uint8  op       IMAGE_PROTO_DEST_*
+ *   5  uint8  reserved
+ *   6  uint16 port     目标端口
+ *   8  uint32 ip       目标IPv4地址
+ *
+ * 事件片段触发 (type = IMAGE_PROTO_CTRL_CLIP):
+ *   4  uint16 port          接收片段的TCP端口，地址为本报文的源地址 (0 表示使用默认接收端)
+ *   6  uint16 post_seconds  触发后继续录制的秒数 (0 表示使用默认值)
+ *
+ * 相机参数修改 (type = IMAGE_PROTO_CTRL_CAMERA):
+ *   4  uint8  count     参数个数 (1 - IMAGE_PROTO_CAMERA_MAX_PARAMS)
+ *   5  uint8  reserved
+ *   6  { uint16 param; int32 value; } [count]   参数编号见 camera_ctrl.h 的 camera_ctrl_param_t
+ */
+#define IMAGE_PROTO_CTRL_MAGIC 0x454B  // "EK"
+#define IMAGE_PROTO_CTRL_HEADER_SIZE 4
+#define IMAGE_PROTO_CTRL_NACK 0x01
+#define IMAGE_PROTO_CTRL_REPORT 0x02
+#define IMAGE_PROTO_CTRL_DEST 0x03
+#define IMAGE_PROTO_CTRL_CLIP 0x04
+#define IMAGE_PROTO_CTRL_CAMERA 0x05
+
+#define IMAGE_PROTO_REPORT_SIZE 12
+#define IMAGE_PROTO_DEST_SIZE 12
+#define IMAGE_PROTO_CLIP_SIZE 8
+#define IMAGE_PROTO_CAMERA_HEADER_SIZE 6
+#define IMAGE_PROTO_CAMERA_PARAM_SIZE 6
+#define IMAGE_PROTO_CAMERA_MAX_PARAMS 16
+
+#define IMAGE_PROTO_DEST_ADD 0x01     // 添加目标
+#define IMAGE_PROTO_DEST_REMOVE 0x02  // 删除目标
+#define IMAGE_PROTO_DEST_CLEAR 0x03   // 清空目标表 (忽略 port/ip)
+
+#define IMAGE_PROTO_NACK_MAX_WORDS 8  // 单个NACK最多覆盖 256 个包
+
+/**
+ * @brief 单个图像分包的描述信息
+ */
+typedef struct
+{
+    uint8_t version;        // 1 或 2
+    uint8_t flags;          // IMAGE_PROTO_FLAG_* (仅 v2)
+    uint32_t frame_seq;     // 帧序号 (仅 v2)
+    uint64_t timestamp_us;  // 采集时间戳 (仅 v2)
+    uint32_t offset;        // 负载偏移 (v1 由 chunk_id 推算)
+    uint32_t image_size;    // 图像总大小
+    uint32_t chunk_id;      // 包序号
+    uint32_t total_chunks;  // 总包数
+} image_proto_chunk_t;
+
+/**
+ * @brief 丢包重传请求
+ */
+typedef struct
+{
+    uint32_t frame_seq;                           // 帧序号
+    uint16_t base_chunk;                          // 位图第0位对应的包序号
+    uint16_t words;                               // 位图的 uint32 个数
+    uint32_t bitmap[IMAGE_PROTO_NACK_MAX_WORDS];  // 丢包位图
+} image_proto_nack_t;
+
+/**
+ * @brief 接收端报告
+ */
+typedef struct
+{
+    uint32_t frame_seq;      // 最近收到的帧序号
+    uint16_t loss_permille;  // 丢包率 (千分比)
+} image_proto_report_t;
+
+/**
+ * @brief 目标表修改请求
+ */
+typedef struct
+{
+    uint8_t op;     // IMAGE_PROTO_DEST_*
+    uint16_t port;  // 目标端口（主机字节序）
+    uint32_t ip;    // 目标IPv4地址（网络字节序，可直接填入 sin_addr.s_addr）
+} image_proto_dest_t;
+
+/**
+ * @brief 事件片段触发请求
+ */
+typedef struct
+{
+    uint16_t port;          // 接收片段的TCP端口（主机字节序），0 表示默认接收端
+    uint16_t post_seconds;  // 触发后继续录制的秒数，0 表示默认值
+} image_proto_clip_t;
+
+/**
+ * @brief 相机参数修改请求
+ */
+typedef struct
+{
+    uint8_t count;  // 参数个数
+    struct
+    {
+        uint16_t param;  // 参数编号
+        int32_t value;   // 参数值
+    } params[IMAGE_PROTO_CAMERA_MAX_PARAMS];
+} image_proto_camera_t;
+
+/**
+ * @brief 计算CRC32 (IEEE 802.3，与 zlib.crc32 一致)，支持分段累加
+ * @param crc 上一段的结果，首段传 0
+ * @param data 数据
+ * @param len 数据长度
+ * @return 累加后的CRC32
+ */
+uint32_t image_proto_crc32(uint32_t crc, const uint8_t* data, size_t len);
+
+/**
+ * @brief 返回指定协议版本的包头长度
+ * @param version 1 或 2
+ * @return 包头字节数
+ */
+size_t image_proto_header_size(uint8_t version);
+
+/**
+ * @brief 编码包头
+ *
+ * v2 包头的CRC32覆盖包头与负载，因此需要传入负载（只读，不拷贝）。
+ *
+ * @param chunk 分包描述，chunk->version 决定编码格式
+ * @param payload 本包负载
+ * @param payload_len 负载长度
+ * @param out 输出缓冲区，至少 image_proto_header_size(chunk->version) 字节
+ * @return esp_err_t
+ */
+esp_err_t image_proto_encode_header(const image_proto_chunk_t* chunk, const uint8_t* payload, size_t payload_len, uint8_t* out);
+
+/**
+ * @brief 解码一个UDP包，自动识别 v1/v2 包头并校验 v2 的CRC32
+ * @param packet 完整的UDP包
+ * @param len 包长度
+ * @param chunk 输出分包描述
+ * @param payload 输出负载起始地址（指向 packet 内部）
+ * @param payload_len 输出负载长度
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE (包过短), ESP_ERR_INVALID_VERSION, ESP_ERR_INVALID_CRC
+ */
+esp_err_t image_proto_decode(const uint8_t* packet, size_t len, image_proto_chunk_t* chunk, const uint8_t** payload, size_t* payload_len);
+
+/**
+ * @brief 解析控制报文的公共头
+ * @param packet 报文
+ * @param len 报文长度
+ * @param type 输出报文类型 IMAGE_PROTO_CTRL_*
+ * @return ESP_OK; 不是控制报文时返回 ESP_ERR_INVALID_VERSION
+ */
+esp_err_t image_proto_decode_ctrl(const uint8_t* packet, size_t len, uint8_t* type);
+
+/**
+ * @brief 编码NACK报文
+ * @param nack 重传请求
+ * @param out 输出缓冲区
+ * @param out_size 输出缓冲区大小
+ * @param out_len 输出报文长度
+ * @return esp_err_t
+ */
+esp_err_t image_proto_encode_nack(const image_proto_nack_t* nack, uint8_t* out, size_t out_size, size_t* out_len);
+
+/**
+ * @brief 解析NACK报文
+ * @param packet 报文
+ * @param len 报文长度
+ * @param nack 输出重传请求
+ * @return esp_err_t
+ */
+esp_err_t image_proto_decode_nack(const uint8_t* packet, size_t len, image_proto_nack_t* nack);
+
+/**
+ * @brief 编码接收报告
+ * @param report 接收报告
+ * @param out 输出缓冲区，至少 IMAGE_PROTO_REPORT_SIZE 字节
+ * @param out_size 输出缓冲区大小
+ * @return esp_err_t
+ */
+esp_err_t image_proto_encode_report(const image_proto_report_t* report, uint8_t* out, size_t out_size);
+
+/**
+ * @brief 解析接收报告
+ * @param packet 报文
+ * @param len 报文长度
+ * @param report 输出接收报告
+ * @return esp_err_t
+ */
+esp_err_t image_proto_decode_report(const uint8_t* packet, size_t len, image_proto_report_t* report);
+
+/**
+ * @brief 解析目标表修改请求
+ * @param packet 报文
+ * @param len 报文长度
+ * @param dest 输出请求
+ * @return esp_err_t
+ */
+esp_err_t image_proto_decode_dest(const uint8_t* packet, size_t len, image_proto_dest_t* dest);
+
+/**
+ * @brief 解析事件片段触发请求
+ * @param packet 报文
+ * @param len 报文长度
+ * @param clip 输出请求
+ * @return esp_err_t
+ */
+esp_err_t image_proto_decode_clip(const uint8_t* packet, size_t len, image_proto_clip_t* clip);
+
+/**
+ * @brief 解析相机参数修改请求
+ * @param packet 报文
+ * @param len 报文长度
+ * @param camera 输出请求
+ * @return esp_err_t 参数个数为 0、超过上限或与报文长度不符时返回 ESP_ERR_INVALID_SIZE
+ */
+esp_err_t image_proto_decode_camera(const uint8_t* packet, size_t len, image_proto_camera_t* camera);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IMAGE_PROTO_H */
@@ -0,0 +1,543 @@
+/*
+ * jpeg_dc.c
+ * JPEG 直流分量解码实现
+ */
+
+#include <string.h>
+
+#include "jpeg_dc.h"
+
+#define JPEG_DC_MAX_PADDING 8  // 熵编码数据耗尽后允许补入的零字节数，超过视为数据截断
+
+/**
+ * @brief 熵编码数据的位读取器：32 位缓冲区高位对齐，处理 0xFF00 填充字节，遇到标记后补零
+ */
+typedef struct
+{
+    const uint8_t* p;
+    const uint8_t* end;
+    uint32_t bits;
+    int32_t count;     // 缓冲区中的有效位数
+    uint32_t padding;  // 补入的零字节数
+} bit_reader_t;
+
+static uint16_t be16(const uint8_t* p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+/**
+ * @brief 补充缓冲区到至少 25 位；不越过标记，标记之后与数据末尾补零
+ */
+static inline void br_fill(bit_reader_t* br)
+{
+    while (br->count <= 24) {
+        uint32_t byte = 0;
+        if (br->p < br->end && br->p[0] != 0xFF) {
+            byte = *br->p++;
+        }
+        else if (br->p + 1 < br->end && br->p[1] == 0x00) {
+            byte = 0xFF;
+            br->p += 2;
+        }
+        else {
+            br->padding++;
+        }
+        br->bits |= byte << (24 - br->count);
+        br->count += 8;
+    }
+}
+
+static inline void br_consume(bit_reader_t* br, int32_t n)
+{
+    br->bits <<= n;
+    br->count -= n;
+}
+
+/**
+ * @brief 读取 s 位并按 JPEG 规则扩展为有符号数 (1 <= s <= 16)
+ */
+static inline int32_t br_receive_extend(bit_reader_t* br, int32_t s)
+{
+    if (br->count < s) {
+        br_fill(br);
+    }
+    int32_t v = (int32_t)(br->bits >> (32 - s));
+    br_consume(br, s);
+    if (v < (1 << (s - 1))) {
+        v -= (1 << s) - 1;
+    }
+    return v;
+}
+
+/**
+ * @brief 在重启标记处重置读取器
+ * @return 下一个标记不是期望的 RSTn 时返回 false
+ */
+static bool br_restart(bit_reader_t* br, uint8_t* next_rst)
+{
+    // 缓冲区中剩余的是标记前的填充位，直接丢弃
+    br->bits = 0;
+    br->count = 0;
+    br->padding = 0;
+    while (br->p + 1 < br->end && br->p[0] == 0xFF && br->p[1] == 0xFF) {
+        br->p++;
+    }
+    if (br->p + 1 >= br->end || br->p[0] != 0xFF || br->p[1] != 0xD0 + *next_rst) {
+        return false;
+    }
+    br->p += 2;
+    *next_rst = (*next_rst + 1) & 7;
+    return true;
+}
+
+/**
+ * @brief 解码一个霍夫曼符号
+ * @return 符号，码字无效时返回 -1
+ */
+static inline int32_t huff_decode(bit_reader_t* br, const jpeg_dc_huff_t* h)
+{
+    br_fill(br);
+    uint32_t entry = h->lookup[br->bits >> (32 - JPEG_DC_LOOKUP_BITS)];
+    if (entry >> 8) {
+        br_consume(br, (int32_t)(entry >> 8));
+        return (int32_t)(entry & 0xFF);
+    }
+    for (int32_t l = JPEG_DC_LOOKUP_BITS + 1; l <= 16; l++) {
+        int32_t code = (int32_t)(br->bits >> (32 - l));
+        if (code <= h->maxcode[l]) {
+            int32_t index = h->valptr[l] + code;
+            if (index < 0 || index >= h->count) {
+                return -1;
+            }
+            br_consume(br, l);
+            return h->values[index];
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 跳过一个块的 63 个交流系数
+ */
+static inline bool skip_ac(bit_reader_t* br, const jpeg_dc_huff_t* h)
+{
+    for (int32_t k = 1; k < 64;) {
+        int32_t rs;
+        br_fill(br);
+        uint32_t entry = h->lookup[br->bits >> (32 - JPEG_DC_LOOKUP_BITS)];
+        if (entry >> 8) {
+            // 短码字：补充后至少 25 位，码字 (<= 8) 与附加位 (<= 15) 一次跳过
+            rs = (int32_t)(entry & 0xFF);
+            br_consume(br, (int32_t)(entry >> 8) + (rs & 15));
+            if (rs & 15) {
+                k += (rs >> 4) + 1;
+                continue;
+            }
+        }
+        else {
+            rs = huff_decode(br, h);
+            if (rs < 0) {
+                return false;
+            }
+            if (rs & 15) {
+                if (br->count < (rs & 15)) {
+                    br_fill(br);
+                }
+                br_consume(br, rs & 15);
+                k += (rs >> 4) + 1;
+                continue;
+            }
+        }
+        int32_t s = rs & 15;
+        int32_t r = rs >> 4;
+        if (s != 0) {
+            k += r + 1;
+        }
+        else if (r == 15) {
+            k += 16;
+        }
+        else {
+            return true;  // EOB
+        }
+        if (k > 64) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 由各码长的码字数与符号表生成规范霍夫曼表
+ */
+static esp_err_t build_huff(jpeg_dc_huff_t* h, const uint8_t* counts, const uint8_t* symbols, uint16_t total)
+{
+    memset(h->lookup, 0, sizeof(h->lookup));
+    memcpy(h->values, symbols, total);
+    h->count = total;
+
+    int32_t code = 0;
+    int32_t k = 0;
+    for (int32_t l = 1; l <= 16; l++) {
+        h->valptr[l] = k - code;
+        for (int32_t i = 0; i < counts[l - 1]; i++) {
+            if (code >= (1 << l)) {
+                return ESP_ERR_INVALID_SIZE;  // 码字空间溢出
+            }
+            if (l <= JPEG_DC_LOOKUP_BITS) {
+                int32_t shift = JPEG_DC_LOOKUP_BITS - l;
+                int32_t base = code << shift;
+                for (int32_t j = 0; j < (1 << shift); j++) {
+                    h->lookup[base + j] = (uint16_t)((l << 8) | symbols[k]);
+                }
+            }
+            code++;
+            k++;
+        }
+        h->maxcode[l] = counts[l - 1] ? code - 1 : -1;
+        code <<= 1;
+    }
+    h->present = true;
+    return ESP_OK;
+}
+
+static esp_err_t parse_dht(jpeg_dc_t* dec, const uint8_t* seg, size_t n)
+{
+    while (n > 0) {
+        if (n < 17) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        uint8_t tc = seg[0] >> 4;
+        uint8_t th = seg[0] & 15;
+        if (tc > 1 || th > 1) {
+            return ESP_ERR_NOT_SUPPORTED;  // 基线只有两组表
+        }
+        uint16_t total = 0;
+        for (int i = 0; i < 16; i++) {
+            total += seg[1 + i];
+        }
+        if (total > 256 || n < 17 + (size_t)total) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        esp_err_t err = build_huff(tc == 0 ? &dec->dc[th] : &dec->ac[th], seg + 1, seg + 17, total);
+        if (err != ESP_OK) {
+            return err;
+        }
+        seg += 17 + total;
+        n -= 17 + total;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t parse_dqt(jpeg_dc_t* dec, const uint8_t* seg, size_t n)
+{
+    while (n > 0) {
+        uint8_t pq = seg[0] >> 4;
+        uint8_t tq = seg[0] & 15;
+        size_t size = pq == 0 ? 65 : 129;
+        if (pq > 1 || tq > 3 || n < size) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        // 量化表按之字形顺序存放，第一项即直流量化值
+        dec->qdc[tq] = pq == 0 ? seg[1] : be16(seg + 1);
+        dec->q_present |= 1 << tq;
+        seg += size;
+        n -= size;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t parse_sof(jpeg_dc_t* dec, const uint8_t* seg, size_t n)
+{
+    if (n < 6) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (seg[0] != 8) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    uint16_t height = be16(seg + 1);
+    uint16_t width = be16(seg + 3);
+    uint8_t ncomp = seg[5];
+    if (height == 0) {
+        return ESP_ERR_NOT_SUPPORTED;  // 高度由 DNL 标记给出
+    }
+    if (ncomp != 1 && ncomp != 3) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (width == 0 || n < 6 + 3 * (size_t)ncomp) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    dec->ncomp = ncomp;
+    dec->hmax = 1;
+    dec->vmax = 1;
+    for (uint8_t i = 0; i < ncomp; i++) {
+        jpeg_dc_component_t* c = &dec->comp[i];
+        const uint8_t* p = seg + 6 + 3 * i;
+        c->id = p[0];
+        c->h = p[1] >> 4;
+        c->v = p[1] & 15;
+        c->tq = p[2];
+        if (c->h < 1 || c->h > 4 || c->v < 1 || c->v > 4 || c->tq > 3) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        if (ncomp == 1) {
+            c->h = 1;  // 单分量的扫描不交织，采样因子无意义
+            c->v = 1;
+        }
+        dec->hmax = c->h > dec->hmax ? c->h : dec->hmax;
+        dec->vmax = c->v > dec->vmax ? c->v : dec->vmax;
+    }
+    if (ncomp == 3 && (dec->comp[1].h != dec->comp[2].h || dec->comp[1].v != dec->comp[2].v)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (ncomp == 3 && dec->comp[0].h * dec->comp[0].v + 2 * dec->comp[1].h * dec->comp[1].v > 10) {
+        return ESP_ERR_INVALID_SIZE;  // 每个 MCU 最多 10 个块
+    }
+
+    for (uint8_t i = 0; i < ncomp; i++) {
+        jpeg_dc_component_t* c = &dec->comp[i];
+        uint32_t comp_w = ((uint32_t)width * c->h + dec->hmax - 1) / dec->hmax;
+        uint32_t comp_h = ((uint32_t)height * c->v + dec->vmax - 1) / dec->vmax;
+        c->blocks_w = (uint16_t)((comp_w + 7) / 8);
+        c->blocks_h = (uint16_t)((comp_h + 7) / 8);
+    }
+    dec->info.image_width = width;
+    dec->info.image_height = height;
+    return ESP_OK;
+}
+
+static esp_err_t parse_sos(jpeg_dc_t* dec, const uint8_t* seg, size_t n)
+{
+    if (dec->ncomp == 0) {
+        return ESP_ERR_INVALID_SIZE;  // 扫描前没有 SOF
+    }
+    if (n < 1) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t ns = seg[0];
+    if (ns != dec->ncomp) {
+        return ESP_ERR_NOT_SUPPORTED;  // 分量分多次扫描
+    }
+    if (n < 1 + 2 * (size_t)ns + 3) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    for (uint8_t i = 0; i < ns; i++) {
+        uint8_t id = seg[1 + 2 * i];
+        uint8_t tables = seg[2 + 2 * i];
+        uint8_t index = 0;
+        while (index < dec->ncomp && dec->comp[index].id != id) {
+            index++;
+        }
+        if (index == dec->ncomp) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        jpeg_dc_component_t* c = &dec->comp[index];
+        c->td = tables >> 4;
+        c->ta = tables & 15;
+        if (c->td > 1 || c->ta > 1) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        if (!dec->dc[c->td].present || !dec->ac[c->ta].present || !(dec->q_present & (1 << c->tq))) {
+            return ESP_ERR_NOT_SUPPORTED;  // 缺少霍夫曼表（如省略 DHT 的 MJPEG）或量化表
+        }
+        dec->scan[i] = index;
+    }
+    const uint8_t* spectral = seg + 1 + 2 * ns;
+    if (spectral[0] != 0 || spectral[1] != 63 || spectral[2] != 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return ESP_OK;
+}
+
+esp_err_t jpeg_dc_parse(jpeg_dc_t* dec, const uint8_t* data, size_t len, jpeg_dc_info_t* info)
+{
+    if (dec == NULL || data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    dec->parsed = false;
+    dec->dc[0].present = dec->dc[1].present = false;
+    dec->ac[0].present = dec->ac[1].present = false;
+    dec->q_present = 0;
+    dec->ncomp = 0;
+    dec->restart_interval = 0;
+    memset(&dec->info, 0, sizeof(dec->info));
+    if (len < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint8_t* p = data + 2;
+    const uint8_t* end = data + len;
+    for (;;) {
+        // 标记前可以有任意个 0xFF 填充字节
+        while (p < end && *p != 0xFF) {
+            p++;
+        }
+        while (p < end && *p == 0xFF) {
+            p++;
+        }
+        if (p >= end) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        uint8_t marker = *p++;
+        if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            continue;  // 没有长度字段的标记
+        }
+        if (marker == 0xD9 || end - p < 2) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        size_t seg_len = be16(p);
+        if (seg_len < 2 || seg_len > (size_t)(end - p)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        const uint8_t* seg = p + 2;
+        size_t n = seg_len - 2;
+        p += seg_len;
+
+        esp_err_t err = ESP_OK;
+        switch (marker) {
+            case 0xC0:  // 基线
+            case 0xC1:  // 扩展顺序，霍夫曼编码
+                err = parse_sof(dec, seg, n);
+                break;
+            case 0xC2:
+            case 0xC3:
+            case 0xC5:
+            case 0xC6:
+            case 0xC7:
+            case 0xC9:
+            case 0xCA:
+            case 0xCB:
+            case 0xCD:
+            case 0xCE:
+            case 0xCF:
+                return ESP_ERR_NOT_SUPPORTED;  // 渐进式、无损、算术编码
+            case 0xC4:
+                err = parse_dht(dec, seg, n);
+                break;
+            case 0xDB:
+                err = parse_dqt(dec, seg, n);
+                break;
+            case 0xDD:
+                if (n < 2) {
+                    return ESP_ERR_INVALID_SIZE;
+                }
+                dec->restart_interval = be16(seg);
+                break;
+            case 0xDA:
+                err = parse_sos(dec, seg, n);
+                if (err != ESP_OK) {
+                    return err;
+                }
+                dec->scan_data = p;
+                dec->end = end;
+                dec->info.width = dec->comp[0].blocks_w;
+                dec->info.height = dec->comp[0].blocks_h;
+                dec->info.components = dec->ncomp;
+                dec->info.h_samp = dec->comp[0].h;
+                dec->info.v_samp = dec->comp[0].v;
+                if (dec->ncomp == 3) {
+                    dec->info.chroma_width = dec->comp[1].blocks_w;
+                    dec->info.chroma_height = dec->comp[1].blocks_h;
+                }
+                dec->parsed = true;
+                if (info != NULL) {
+                    *info = dec->info;
+                }
+                return ESP_OK;
+            default:
+                break;  // APPn、COM 等
+        }
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+}
+
+size_t jpeg_dc_output_size(const jpeg_dc_info_t* info, jpeg_dc_format_t format)
+{
+    size_t size = (size_t)info->width * info->height;
+    if (format == JPEG_DC_YUV) {
+        size += 2 * (size_t)info->chroma_width * info->chroma_height;
+    }
+    return size;
+}
+
+esp_err_t jpeg_dc_decode(jpeg_dc_t* dec, jpeg_dc_format_t format, uint8_t* out, size_t out_size)
+{
+    if (dec == NULL || !dec->parsed || out == NULL || out_size < jpeg_dc_output_size(&dec->info, format)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t* planes[3] = {out, NULL, NULL};
+    if (format == JPEG_DC_YUV && dec->ncomp == 3) {
+        planes[1] = out + (size_t)dec->info.width * dec->info.height;
+        planes[2] = planes[1] + (size_t)dec->info.chroma_width * dec->info.chroma_height;
+    }
+
+    // 单分量为逐块扫描，三分量按 MCU 交织
+    uint32_t mcus_x = dec->comp[0].blocks_w;
+    uint32_t mcus_y = dec->comp[0].blocks_h;
+    if (dec->ncomp > 1) {
+        mcus_x = ((uint32_t)dec->info.image_width + 8 * dec->hmax - 1) / (8 * dec->hmax);
+        mcus_y = ((uint32_t)dec->info.image_height + 8 * dec->vmax - 1) / (8 * dec->vmax);
+    }
+
+    bit_reader_t br = {.p = dec->scan_data, .end = dec->end};
+    int32_t pred[3] = {0, 0, 0};
+    uint32_t restarts_left = dec->restart_interval;
+    uint8_t next_rst = 0;
+
+    for (uint32_t my = 0; my < mcus_y; my++) {
+        for (uint32_t mx = 0; mx < mcus_x; mx++) {
+            if (dec->restart_interval != 0) {
+                if (restarts_left == 0) {
+                    if (!br_restart(&br, &next_rst)) {
+                        return ESP_ERR_INVALID_SIZE;
+                    }
+                    pred[0] = pred[1] = pred[2] = 0;
+                    restarts_left = dec->restart_interval;
+                }
+                restarts_left--;
+            }
+
+            for (uint8_t si = 0; si < dec->ncomp; si++) {
+                uint8_t ci = dec->scan[si];
+                const jpeg_dc_component_t* c = &dec->comp[ci];
+                const jpeg_dc_huff_t* dc = &dec->dc[c->td];
+                const jpeg_dc_huff_t* ac = &dec->ac[c->ta];
+                int32_t q = dec->qdc[c->tq];
+                uint8_t* plane = planes[ci];
+
+                for (uint32_t v = 0; v < c->v; v++) {
+                    for (uint32_t h = 0; h < c->h; h++) {
+                        int32_t s = huff_decode(&br, dc);
+                        if (s < 0 || s > 11) {
+                            return ESP_ERR_INVALID_SIZE;
+                        }
+                        if (s != 0) {
+                            pred[ci] += br_receive_extend(&br, s);
+                            // 合法数据的直流值不超出 ±2047，限制累加使损坏的数据不会溢出
+                            pred[ci] = pred[ci] > 2047 ? 2047 : (pred[ci] < -2047 ? -2047 : pred[ci]);
+                        }
+                        if (!skip_ac(&br, ac)) {
+                            return ESP_ERR_INVALID_SIZE;
+                        }
+
+                        // 直流系数为块均值减 128 的 8 倍；MCU 超出图像的填充块不输出
+                        uint32_t bx = mx * c->h + h;
+                        uint32_t by = my * c->v + v;
+                        if (plane != NULL && bx < c->blocks_w && by < c->blocks_h) {
+                            int32_t pixel = 128 + ((pred[ci] * q + 4) >> 3);
+                            plane[by * c->blocks_w + bx] = (uint8_t)(pixel < 0 ? 0 : (pixel > 255 ? 255 : pixel));
+                        }
+                    }
+                }
+            }
+            if (br.padding > JPEG_DC_MAX_PADDING) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,129 @@
+/*
+ * jpeg_dc.h
+ * JPEG 直流分量解码：只取每个 8x8 块的直流系数，得到 1/8 缩小的灰度或 YUV 缩略图
+ *
+ * 交流系数只做霍夫曼解码以跳过，不做反量化与 IDCT，耗时远低于完整解码。
+ * 支持相机输出的基线 (baseline) 霍夫曼编码 JPEG：8 位精度、单次扫描、1 或 3 个分量、重启间隔；
+ * 渐进式、算术编码、12 位精度等返回 ESP_ERR_NOT_SUPPORTED。
+ * 输入为完整的 JPEG 数据（如 camera_fb_t 的 buf/len 或 frame_ref_t 的 data/len）。
+ *
+ * 本模块不依赖 FreeRTOS 与相机驱动，可在 Linux 主机上单独编译，用于模糊测试与对照 libjpeg 的 1/8 缩放解码测速。
+ */
+
+#ifndef JPEG_DC_H
+#define JPEG_DC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JPEG_DC_LOOKUP_BITS 8  // 霍夫曼快速查找表的位数，更长的码字逐位查找
+
+/**
+ * @brief 输出格式
+ */
+typedef enum {
+    JPEG_DC_GRAY = 0,  // 只输出亮度平面
+    JPEG_DC_YUV,       // 平面 YUV：亮度平面后接 Cb、Cr 平面，色度平面按 JPEG 的采样因子缩小
+} jpeg_dc_format_t;
+
+/**
+ * @brief 图像与缩略图尺寸
+ */
+typedef struct
+{
+    uint16_t image_width;    // 原图尺寸
+    uint16_t image_height;
+    uint16_t width;          // 亮度缩略图尺寸，原图尺寸除以 8 向上取整
+    uint16_t height;
+    uint16_t chroma_width;   // 色度缩略图尺寸，灰度 JPEG 为 0
+    uint16_t chroma_height;
+    uint8_t components;      // 1 或 3
+    uint8_t h_samp;          // 亮度的采样因子（相对色度），422 为 2x1，420 为 2x2
+    uint8_t v_samp;
+} jpeg_dc_info_t;
+
+/**
+ * @brief 霍夫曼表
+ */
+typedef struct
+{
+    uint16_t lookup[1 << JPEG_DC_LOOKUP_BITS];  // 高 8 位为码长（0 表示码字更长），低 8 位为符号
+    int32_t maxcode[18];                        // 各码长的最大码字，没有该码长时为 -1
+    int32_t valptr[17];                         // 各码长的第一个符号下标减去该码长的最小码字
+    uint8_t values[256];
+    uint16_t count;                             // 符号数
+    bool present;
+} jpeg_dc_huff_t;
+
+/**
+ * @brief 分量
+ */
+typedef struct
+{
+    uint8_t id;
+    uint8_t h;           // 采样因子
+    uint8_t v;
+    uint8_t tq;          // 量化表
+    uint8_t td;          // 扫描中使用的直流、交流霍夫曼表
+    uint8_t ta;
+    uint16_t blocks_w;   // 分量的块网格（即缩略图平面尺寸）
+    uint16_t blocks_h;
+} jpeg_dc_component_t;
+
+/**
+ * @brief 解码器实例，约 3.6 KB，不在解码时分配内存
+ */
+typedef struct
+{
+    jpeg_dc_huff_t dc[2];
+    jpeg_dc_huff_t ac[2];
+    uint16_t qdc[4];      // 各量化表的直流量化值
+    uint8_t q_present;    // 已定义的量化表位图
+    jpeg_dc_component_t comp[3];
+    uint8_t ncomp;
+    uint8_t scan[3];      // 扫描中的分量顺序
+    uint8_t hmax;
+    uint8_t vmax;
+    uint16_t restart_interval;
+    const uint8_t* scan_data;  // 熵编码数据起点
+    const uint8_t* end;
+    jpeg_dc_info_t info;
+    bool parsed;
+} jpeg_dc_t;
+
+/**
+ * @brief 解析 JPEG 头部（到扫描开始为止），取得尺寸
+ * @param dec 解码器实例
+ * @param data JPEG 数据，须在 jpeg_dc_decode 完成前保持有效
+ * @param len 数据长度
+ * @param info 输出尺寸，可为 NULL
+ * @return esp_err_t 数据不完整或损坏时返回 ESP_ERR_INVALID_SIZE，不支持的编码返回 ESP_ERR_NOT_SUPPORTED
+ */
+esp_err_t jpeg_dc_parse(jpeg_dc_t* dec, const uint8_t* data, size_t len, jpeg_dc_info_t* info);
+
+/**
+ * @brief 按格式计算输出缩略图的字节数
+ */
+size_t jpeg_dc_output_size(const jpeg_dc_info_t* info, jpeg_dc_format_t format);
+
+/**
+ * @brief 解码最近一次解析的 JPEG 的直流分量
+ * @param dec 解码器实例，须先成功调用 jpeg_dc_parse
+ * @param format 输出格式
+ * @param out 输出缓冲区，行间距为对应平面的宽度
+ * @param out_size 输出缓冲区大小，至少 jpeg_dc_output_size()
+ * @return esp_err_t 熵编码数据损坏或截断时返回 ESP_ERR_INVALID_SIZE，已解码的部分保留在输出中
+ */
+esp_err_t jpeg_dc_decode(jpeg_dc_t* dec, jpeg_dc_format_t format, uint8_t* out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JPEG_DC_H */
@@ -0,0 +1,257 @@
+/*
+ * motion_detect.c
+ * 运动检测实现
+ */
+
+#include <string.h>
+
+#include "motion_detect.h"
+
+#define MOTION_LABEL_NONE 0
+#define MOTION_LABEL_MOTION 1   // 运动块，尚未归入区域
+#define MOTION_LABEL_REGION 2   // 运动块，已归入区域
+
+esp_err_t motion_detect_init(motion_detect_t* md, const motion_detect_config_t* config, uint8_t* background)
+{
+    if (md == NULL || config == NULL || background == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->block == 0 || (config->block % 4) != 0 || config->block > 16 || config->width < config->block || config->height < config->block) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t cols = config->width / config->block;
+    uint32_t rows = config->height / config->block;
+    if (cols * rows > MOTION_DETECT_MAX_BLOCKS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(md, 0, sizeof(*md));
+    md->config = *config;
+    md->background = background;
+    md->cols = (uint16_t)cols;
+    md->rows = (uint16_t)rows;
+    return ESP_OK;
+}
+
+#ifdef MOTION_DETECT_SCALAR
+
+uint32_t motion_detect_block_sad(const uint8_t* a, const uint8_t* b, uint32_t stride, uint32_t block)
+{
+    uint32_t sad = 0;
+    for (uint32_t y = 0; y < block; y++) {
+        for (uint32_t x = 0; x < block; x++) {
+            int d = (int)a[x] - (int)b[x];
+            sad += (uint32_t)(d < 0 ? -d : d);
+        }
+        a += stride;
+        b += stride;
+    }
+    return sad;
+}
+
+#else
+
+/**
+ * @brief 4 个字节逐字节的 |a - b|（SWAR，一次 32 位运算处理 4 个像素）
+ *
+ * 按字节相减时屏蔽各字节最高位以阻断跨字节借位，再由借位公式得到每个字节 a < b 的标记，
+ * 对这些字节取反加一得到绝对值；a < b 时差值不为 0，加一不会向上一字节进位。
+ */
+static inline uint32_t absdiff_u8x4(uint32_t a, uint32_t b)
+{
+    const uint32_t h = 0x80808080u;
+    uint32_t d = ((a | h) - (b & ~h)) ^ ((a ^ ~b) & h);  // 逐字节 (a - b) mod 256
+    uint32_t lt = ((~a & b) | (~(a ^ b) & d)) & h;        // 逐字节借位：a < b
+    uint32_t neg = lt >> 7;
+    return (d ^ (neg * 0xFFu)) + neg;
+}
+
+static inline uint32_t load_u32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));  // 亮度平面的行间距不一定是 4 的倍数
+    return v;
+}
+
+uint32_t motion_detect_block_sad(const uint8_t* a, const uint8_t* b, uint32_t stride, uint32_t block)
+{
+    // 两个 16 位累加通道分别累加奇偶字节；块边长不超过 16 时每通道最多 128 个字节，不会溢出
+    uint32_t acc = 0;
+    for (uint32_t y = 0; y < block; y++) {
+        for (uint32_t x = 0; x < block; x += 4) {
+            uint32_t d = absdiff_u8x4(load_u32(a + x), load_u32(b + x));
+            acc += (d & 0x00FF00FFu) + ((d >> 8) & 0x00FF00FFu);
+        }
+        a += stride;
+        b += stride;
+    }
+    return (acc & 0xFFFFu) + (acc >> 16);
+}
+
+#endif /* MOTION_DETECT_SCALAR */
+
+/**
+ * @brief 背景向当前帧靠近 1/2^shift，保证差值不为 0 时至少移动 1
+ */
+static void learn_block(uint8_t* bg, const uint8_t* cur, uint32_t stride, uint32_t block, uint8_t shift)
+{
+    int32_t round = (1 << shift) - 1;
+    for (uint32_t y = 0; y < block; y++) {
+        for (uint32_t x = 0; x < block; x++) {
+            int32_t d = (int32_t)cur[x] - (int32_t)bg[x];
+            if (d > 0) {
+                bg[x] += (uint8_t)((d + round) >> shift);
+            }
+            else if (d < 0) {
+                bg[x] -= (uint8_t)((-d + round) >> shift);
+            }
+        }
+        bg += stride;
+        cur += stride;
+    }
+}
+
+/**
+ * @brief 从 start 块开始按 4 邻域生长一个运动区域
+ * @return 区域内各块 SAD 之和
+ */
+static uint32_t grow_region(motion_detect_t* md, uint32_t start, motion_region_t* region)
+{
+    uint32_t cols = md->cols;
+    uint32_t min_c = start % cols, max_c = min_c;
+    uint32_t min_r = start / cols, max_r = min_r;
+    uint32_t top = 0;
+    uint16_t blocks = 0;
+    uint32_t sad_sum = 0;
+
+    md->label[start] = MOTION_LABEL_REGION;
+    md->stack[top++] = (uint16_t)start;
+    while (top > 0) {
+        uint32_t i = md->stack[--top];
+        uint32_t c = i % cols;
+        uint32_t r = i / cols;
+        blocks++;
+        sad_sum += md->sad[i];
+        min_c = c < min_c ? c : min_c;
+        max_c = c > max_c ? c : max_c;
+        min_r = r < min_r ? r : min_r;
+        max_r = r > max_r ? r : max_r;
+
+        uint32_t next[4];
+        uint32_t n = 0;
+        if (c > 0) {
+            next[n++] = i - 1;
+        }
+        if (c + 1 < cols) {
+            next[n++] = i + 1;
+        }
+        if (r > 0) {
+            next[n++] = i - cols;
+        }
+        if (r + 1 < md->rows) {
+            next[n++] = i + cols;
+        }
+        for (uint32_t k = 0; k < n; k++) {
+            if (md->label[next[k]] == MOTION_LABEL_MOTION) {
+                md->label[next[k]] = MOTION_LABEL_REGION;
+                md->stack[top++] = (uint16_t)next[k];
+            }
+        }
+    }
+
+    uint32_t block = md->config.block;
+    region->x = (uint16_t)(min_c * block);
+    region->y = (uint16_t)(min_r * block);
+    region->w = (uint16_t)((max_c - min_c + 1) * block);
+    region->h = (uint16_t)((max_r - min_r + 1) * block);
+    region->blocks = blocks;
+    return sad_sum;
+}
+
+void motion_detect_process(motion_detect_t* md, const uint8_t* luma, motion_detect_result_t* result)
+{
+    const motion_detect_config_t* config = &md->config;
+    uint32_t stride = config->width;
+    uint32_t block = config->block;
+    uint32_t total = (uint32_t)md->cols * md->rows;
+
+    memset(result, 0, sizeof(*result));
+    md->stats.frames++;
+    if (!md->background_valid) {
+        memcpy(md->background, luma, (size_t)config->width * config->height);
+        md->background_valid = true;
+        return;
+    }
+
+    // 逐块 SAD 并标记运动块
+    uint32_t threshold = (uint32_t)config->pixel_threshold * block * block;
+    uint32_t candidates = 0;
+    for (uint32_t r = 0; r < md->rows; r++) {
+        for (uint32_t c = 0; c < md->cols; c++) {
+            uint32_t offset = r * block * stride + c * block;
+            uint32_t i = r * md->cols + c;
+            uint32_t sad = motion_detect_block_sad(luma + offset, md->background + offset, stride, block);
+            md->sad[i] = (uint16_t)(sad > 0xFFFF ? 0xFFFF : sad);
+            md->label[i] = sad > threshold ? MOTION_LABEL_MOTION : MOTION_LABEL_NONE;
+            candidates += (sad > threshold);
+        }
+    }
+
+    if (candidates * 1000 > (uint32_t)config->global_permille * total) {
+        // 大部分画面同时变化，多为曝光或照明变化：重建背景而不报告运动
+        memcpy(md->background, luma, (size_t)config->width * config->height);
+        md->stats.global_changes++;
+        result->global_change = true;
+        return;
+    }
+
+    // 连通区域：去掉小区域，保留块数最多的几个
+    uint64_t sad_sum = 0;
+    for (uint32_t i = 0; i < total && candidates > 0; i++) {
+        if (md->label[i] != MOTION_LABEL_MOTION) {
+            continue;
+        }
+        motion_region_t region;
+        uint32_t region_sad = grow_region(md, i, &region);
+        candidates -= region.blocks;
+        if (region.blocks < config->min_region_blocks) {
+            continue;
+        }
+
+        result->motion_blocks += region.blocks;
+        sad_sum += region_sad;
+        uint32_t slot = result->region_count;
+        if (slot == MOTION_DETECT_MAX_REGIONS) {
+            // 替换最小的区域
+            slot = 0;
+            for (uint32_t k = 1; k < MOTION_DETECT_MAX_REGIONS; k++) {
+                if (result->regions[k].blocks < result->regions[slot].blocks) {
+                    slot = k;
+                }
+            }
+            if (result->regions[slot].blocks >= region.blocks) {
+                continue;
+            }
+        }
+        else {
+            result->region_count++;
+        }
+        result->regions[slot] = region;
+    }
+
+    if (result->motion_blocks > 0) {
+        result->motion = true;
+        result->score = (uint16_t)(result->motion_blocks * 1000 / total);
+        result->level = (uint16_t)(sad_sum / ((uint64_t)result->motion_blocks * block * block));
+        md->stats.motion_frames++;
+    }
+
+    // 更新背景：运动块更新更慢
+    for (uint32_t r = 0; r < md->rows; r++) {
+        for (uint32_t c = 0; c < md->cols; c++) {
+            uint32_t offset = r * block * stride + c * block;
+            uint8_t shift = md->label[r * md->cols + c] == MOTION_LABEL_NONE ? config->learn_shift : config->motion_learn_shift;
+            learn_block(md->background + offset, luma + offset, stride, block, shift);
+        }
+    }
+}
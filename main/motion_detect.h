@@ -0,0 +1,121 @@
+/*
+ * motion_detect.h
+ * 运动检测：在缩小的亮度平面上按块计算与背景模型的 SAD（绝对差之和），输出运动区域与评分
+ *
+ * 本模块不依赖 FreeRTOS 与相机驱动，可在 Linux 主机上单独编译；
+ * 定义 MOTION_DETECT_SCALAR 时 SAD 使用逐像素的标量实现，便于对照与测速。
+ */
+
+#ifndef MOTION_DETECT_H
+#define MOTION_DETECT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MOTION_DETECT_MAX_BLOCKS 1200  // 块网格的最大块数
+#define MOTION_DETECT_MAX_REGIONS 4    // 输出的运动区域数（按块数从大到小）
+
+/**
+ * @brief 检测器配置
+ */
+typedef struct
+{
+    uint16_t width;               // 亮度平面宽度
+    uint16_t height;              // 亮度平面高度
+    uint8_t block;                // 块边长（像素），须为 4 的倍数；不足一块的边缘像素不参与检测
+    uint8_t pixel_threshold;      // 块内平均每像素绝对差超过该值判为运动块
+    uint8_t learn_shift;          // 静止块的背景更新系数 1/2^shift
+    uint8_t motion_learn_shift;   // 运动块的背景更新系数，更慢，使长时间停留的新物体最终并入背景
+    uint16_t global_permille;     // 运动块占比超过该值视为全局亮度变化（曝光、开关灯），重建背景
+    uint16_t min_region_blocks;   // 块数少于该值的区域视为噪声
+} motion_detect_config_t;
+
+/**
+ * @brief 运动区域（亮度平面坐标）
+ */
+typedef struct
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+    uint16_t blocks;  // 区域内的运动块数
+} motion_region_t;
+
+/**
+ * @brief 单帧检测结果
+ */
+typedef struct
+{
+    bool motion;            // 是否有运动区域
+    bool global_change;     // 本帧判为全局亮度变化，背景已重建
+    uint16_t score;         // 运动区域内的块占全部块的千分比
+    uint16_t level;         // 运动块的平均每像素绝对差
+    uint16_t motion_blocks;  // 运动区域内的块数
+    uint8_t region_count;
+    motion_region_t regions[MOTION_DETECT_MAX_REGIONS];
+} motion_detect_result_t;
+
+/**
+ * @brief 检测器统计信息
+ */
+typedef struct
+{
+    uint32_t frames;          // 处理的帧数
+    uint32_t motion_frames;   // 有运动的帧数
+    uint32_t global_changes;  // 全局亮度变化次数
+} motion_detect_stats_t;
+
+/**
+ * @brief 检测器实例
+ */
+typedef struct
+{
+    motion_detect_config_t config;
+    uint8_t* background;  // 背景模型，width * height 字节，由调用方提供
+    uint16_t cols;        // 块网格列数
+    uint16_t rows;        // 块网格行数
+    bool background_valid;
+    uint16_t sad[MOTION_DETECT_MAX_BLOCKS];     // 每块的 SAD
+    uint8_t label[MOTION_DETECT_MAX_BLOCKS];    // 运动块标记
+    uint16_t stack[MOTION_DETECT_MAX_BLOCKS];   // 区域生长的待访问块
+    motion_detect_stats_t stats;
+} motion_detect_t;
+
+/**
+ * @brief 初始化检测器，下一帧作为初始背景
+ * @param md 检测器实例
+ * @param config 配置
+ * @param background 背景模型缓冲区，至少 width * height 字节
+ * @return esp_err_t 块网格超过 MOTION_DETECT_MAX_BLOCKS 或参数无效时返回 ESP_ERR_INVALID_ARG
+ */
+esp_err_t motion_detect_init(motion_detect_t* md, const motion_detect_config_t* config, uint8_t* background);
+
+/**
+ * @brief 处理一帧亮度平面并更新背景模型
+ * @param md 检测器实例
+ * @param luma 亮度平面，尺寸与配置一致，行间距为 width
+ * @param result 输出检测结果
+ */
+void motion_detect_process(motion_detect_t* md, const uint8_t* luma, motion_detect_result_t* result);
+
+/**
+ * @brief 计算一个块与背景对应块的 SAD
+ * @param a 块左上角
+ * @param b 背景中对应块的左上角
+ * @param stride 行间距
+ * @param block 块边长，须为 4 的倍数
+ * @return SAD
+ */
+uint32_t motion_detect_block_sad(const uint8_t* a, const uint8_t* b, uint32_t stride, uint32_t block);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MOTION_DETECT_H */
@@ -0,0 +1,85 @@
+/*
+ * motion_gate.c
+ * 运动门控发送实现
+ */
+
+#include <string.h>
+
+#include "motion_gate.h"
+
+esp_err_t motion_gate_init(motion_gate_t* gate, const motion_gate_config_t* config)
+{
+    if (gate == NULL || config == NULL || config->keepalive_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(gate, 0, sizeof(*gate));
+    gate->config = *config;
+    return ESP_OK;
+}
+
+void motion_gate_configure(motion_gate_t* gate, const motion_gate_config_t* config)
+{
+    gate->config = *config;
+    if (gate->config.keepalive_ms == 0) {
+        gate->config.keepalive_ms = 1;
+    }
+}
+
+static motion_gate_decision_t decide(motion_gate_t* gate, int64_t now_us, const motion_gate_sample_t* sample)
+{
+    const motion_gate_config_t* config = &gate->config;
+    if (!config->enabled || sample == NULL || !sample->valid || now_us - sample->result_us > (int64_t)config->stale_ms * 1000) {
+        return MOTION_GATE_SEND_UNGATED;
+    }
+
+    if (sample->motion && sample->score >= config->score_threshold) {
+        // 保持期从检测结果的时间算起，同一个结果不会一直延长保持期
+        int64_t until = sample->result_us + (int64_t)config->holdoff_ms * 1000;
+        if (until > gate->holdoff_until_us) {
+            gate->holdoff_until_us = until;
+        }
+        return MOTION_GATE_SEND_MOTION;
+    }
+    if (now_us < gate->holdoff_until_us) {
+        return MOTION_GATE_SEND_HOLDOFF;
+    }
+    if (!gate->sent_once || now_us - gate->last_sent_us >= (int64_t)config->keepalive_ms * 1000) {
+        return MOTION_GATE_SEND_KEEPALIVE;
+    }
+    return MOTION_GATE_SUPPRESS;
+}
+
+motion_gate_decision_t motion_gate_decide(motion_gate_t* gate, int64_t now_us, const motion_gate_sample_t* sample, uint32_t frame_bytes)
+{
+    motion_gate_decision_t decision = decide(gate, now_us, sample);
+
+    switch (decision) {
+        case MOTION_GATE_SUPPRESS:
+            gate->stats.suppressed++;
+            gate->stats.bytes_suppressed += frame_bytes;
+            return decision;
+        case MOTION_GATE_SEND_MOTION:
+            gate->stats.sent_motion++;
+            break;
+        case MOTION_GATE_SEND_HOLDOFF:
+            gate->stats.sent_holdoff++;
+            break;
+        case MOTION_GATE_SEND_KEEPALIVE:
+            gate->stats.sent_keepalive++;
+            break;
+        default:
+            gate->stats.sent_ungated++;
+            break;
+    }
+    gate->stats.bytes_sent += frame_bytes;
+    gate->last_sent_us = now_us;
+    gate->sent_once = true;
+    return decision;
+}
+
+void motion_gate_get_stats(const motion_gate_t* gate, int64_t now_us, motion_gate_stats_t* stats)
+{
+    *stats = gate->stats;
+    stats->active = gate->config.enabled && now_us < gate->holdoff_until_us;
+}
@@ -0,0 +1,119 @@
+/*
+ * motion_gate.h
+ * 运动门控发送：画面静止时只按保活间隔发送，检测到运动后在保持期内全速发送
+ *
+ * 本模块不依赖 FreeRTOS 与相机驱动，输入为每帧的时间与最新的运动检测结果，
+ * 可在 Linux 主机上单独编译，用记录的帧序列（时间戳、大小、运动评分）回放验证带宽节省。
+ * 没有检测结果或结果过期（检测停止或跟不上）时不门控，所有帧照常发送。
+ */
+
+#ifndef MOTION_GATE_H
+#define MOTION_GATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 门控配置
+ */
+typedef struct
+{
+    bool enabled;             // 关闭时所有帧按不门控发送
+    uint16_t score_threshold;  // 运动评分（运动块千分比）达到该值视为场景变化
+    uint32_t keepalive_ms;    // 静止时两次发送的最大间隔
+    uint32_t holdoff_ms;      // 最近一次运动之后继续全速发送的时长
+    uint32_t stale_ms;        // 检测结果超过该时间未更新视为不可用
+} motion_gate_config_t;
+
+/**
+ * @brief 单帧的门控判定
+ */
+typedef enum {
+    MOTION_GATE_SUPPRESS = 0,    // 不发送
+    MOTION_GATE_SEND_MOTION,     // 检测到运动
+    MOTION_GATE_SEND_HOLDOFF,    // 运动后的保持期内
+    MOTION_GATE_SEND_KEEPALIVE,  // 保活帧
+    MOTION_GATE_SEND_UNGATED,    // 门控关闭或检测结果不可用
+} motion_gate_decision_t;
+
+/**
+ * @brief 最新的运动检测结果
+ */
+typedef struct
+{
+    bool valid;          // 是否有检测结果
+    bool motion;         // 检测器是否报告运动区域
+    uint16_t score;      // 运动评分
+    int64_t result_us;   // 结果产生的时间，与 now_us 同一时钟
+} motion_gate_sample_t;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct
+{
+    uint32_t sent_motion;
+    uint32_t sent_holdoff;
+    uint32_t sent_keepalive;
+    uint32_t sent_ungated;
+    uint32_t suppressed;
+    uint64_t bytes_sent;
+    uint64_t bytes_suppressed;
+    bool active;  // 当前是否处于运动保持期
+} motion_gate_stats_t;
+
+/**
+ * @brief 门控实例
+ */
+typedef struct
+{
+    motion_gate_config_t config;
+    int64_t last_sent_us;     // 最近一次发送的时间
+    int64_t holdoff_until_us;  // 保持期结束时间
+    bool sent_once;
+    motion_gate_stats_t stats;
+} motion_gate_t;
+
+/**
+ * @brief 初始化门控
+ * @param gate 门控实例
+ * @param config 配置
+ * @return esp_err_t
+ */
+esp_err_t motion_gate_init(motion_gate_t* gate, const motion_gate_config_t* config);
+
+/**
+ * @brief 运行时修改配置（保持期与保活计时保留）
+ * @param gate 门控实例
+ * @param config 配置
+ */
+void motion_gate_configure(motion_gate_t* gate, const motion_gate_config_t* config);
+
+/**
+ * @brief 判定一帧是否发送并计入统计
+ * @param gate 门控实例
+ * @param now_us 当前时间
+ * @param sample 最新的运动检测结果
+ * @param frame_bytes 帧大小
+ * @return 判定结果，MOTION_GATE_SUPPRESS 以外均应发送
+ */
+motion_gate_decision_t motion_gate_decide(motion_gate_t* gate, int64_t now_us, const motion_gate_sample_t* sample, uint32_t frame_bytes);
+
+/**
+ * @brief 获取统计信息
+ * @param gate 门控实例
+ * @param now_us 当前时间（用于判断是否处于保持期）
+ * @param stats 输出统计信息
+ */
+void motion_gate_get_stats(const motion_gate_t* gate, int64_t now_us, motion_gate_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MOTION_GATE_H */
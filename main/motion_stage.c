@@ -0,0 +1,210 @@
+/*
+ * motion_stage.c
+ * 运动检测阶段实现
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+#include "motion_stage.h"
+#include "frame_broker.h"
+#include "jpeg_dc.h"
+
+static const char* TAG = "MOTION";
+
+#define MOTION_LEARN_SHIFT 3          // 静止块背景约 8 帧跟上缓慢的光照变化
+#define MOTION_MOTION_LEARN_SHIFT 6   // 停留的物体约 64 帧后并入背景
+#define MOTION_GLOBAL_PERMILLE 600    // 超过 60% 的块同时变化视为全局亮度变化
+#define MOTION_EMA_SHIFT 3            // 耗时统计的平滑系数 1/8
+
+static frame_broker_sub_t* s_sub = NULL;
+static motion_detect_t s_detector;  // 只由检测任务访问
+static jpeg_dc_t s_jpeg;            // 只由检测任务访问
+static uint8_t* s_luma = NULL;
+static uint8_t* s_background = NULL;
+static uint16_t s_width = 0;
+static uint16_t s_height = 0;
+static bool s_detector_ready = false;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static motion_stage_state_t s_state;
+static bool s_state_valid = false;
+static motion_stage_stats_t s_stats;
+
+/**
+ * @brief 按帧尺寸（重新）分配亮度平面与背景，并初始化检测器
+ */
+static esp_err_t prepare_detector(uint16_t width, uint16_t height)
+{
+    if (s_detector_ready && width == s_width && height == s_height) {
+        return ESP_OK;
+    }
+
+    if (s_detector_ready) {
+        taskENTER_CRITICAL(&s_lock);
+        s_stats.resets++;
+        taskEXIT_CRITICAL(&s_lock);
+        ESP_LOGI(TAG, "分辨率变化，重建背景: %ux%u", width, height);
+    }
+    s_detector_ready = false;
+    heap_caps_free(s_luma);
+    heap_caps_free(s_background);
+    size_t size = (size_t)width * height;
+    s_luma = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    s_background = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (s_luma == NULL || s_background == NULL) {
+        heap_caps_free(s_luma);
+        heap_caps_free(s_background);
+        s_luma = malloc(size);
+        s_background = malloc(size);
+    }
+    if (s_luma == NULL || s_background == NULL) {
+        ESP_LOGE(TAG, "无法分配 %ux%u 的亮度平面", width, height);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 小画面用 4x4 块获得更细的区域，块网格放不下时用 8x8 块
+    motion_detect_config_t config = {
+        .width = width,
+        .height = height,
+        .block = 4,
+        .pixel_threshold = CONFIG_MOTION_BLOCK_THRESHOLD,
+        .learn_shift = MOTION_LEARN_SHIFT,
+        .motion_learn_shift = MOTION_MOTION_LEARN_SHIFT,
+        .global_permille = MOTION_GLOBAL_PERMILLE,
+        .min_region_blocks = CONFIG_MOTION_MIN_REGION_BLOCKS,
+    };
+    if ((width / 4) * (height / 4) > MOTION_DETECT_MAX_BLOCKS) {
+        config.block = 8;
+    }
+    esp_err_t err = motion_detect_init(&s_detector, &config, s_background);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "%ux%u 的亮度平面无法检测", width, height);
+        return err;
+    }
+
+    s_width = width;
+    s_height = height;
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.block = config.block;
+    taskEXIT_CRITICAL(&s_lock);
+    s_detector_ready = true;
+    return ESP_OK;
+}
+
+static void account_us(uint32_t* avg, uint32_t sample)
+{
+    if (*avg == 0) {
+        *avg = sample;
+    }
+    else {
+        *avg = (uint32_t)((int32_t)*avg + (((int32_t)sample - (int32_t)*avg) >> MOTION_EMA_SHIFT));
+    }
+}
+
+static void analyse_frame(const frame_ref_t* frame)
+{
+    // 只取每个 8x8 块的直流分量得到 1/8 亮度平面，交流系数只做霍夫曼解码以跳过
+    int64_t start = esp_timer_get_time();
+    jpeg_dc_info_t info;
+    esp_err_t err = jpeg_dc_parse(&s_jpeg, frame->data, frame->len, &info);
+    if (err == ESP_OK) {
+        err = prepare_detector(info.width, info.height);
+    }
+    if (err == ESP_OK) {
+        err = jpeg_dc_decode(&s_jpeg, JPEG_DC_GRAY, s_luma, (size_t)s_width * s_height);
+    }
+    int64_t decoded = esp_timer_get_time();
+    if (err != ESP_OK) {
+        taskENTER_CRITICAL(&s_lock);
+        s_stats.decode_failures++;
+        taskEXIT_CRITICAL(&s_lock);
+        return;
+    }
+
+    motion_detect_result_t result;
+    motion_detect_process(&s_detector, s_luma, &result);
+    int64_t done = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.analysed++;
+    account_us(&s_stats.decode_avg_us, (uint32_t)(decoded - start));
+    account_us(&s_stats.detect_avg_us, (uint32_t)(done - decoded));
+    s_stats.detector = s_detector.stats;
+    s_state.frame_seq = frame->seq;
+    s_state.timestamp_us = frame->timestamp_us;
+    s_state.width = s_width;
+    s_state.height = s_height;
+    s_state.result = result;
+    s_state.updated_us = done;
+    if (result.motion) {
+        s_state.last_motion_us = done;
+    }
+    s_state_valid = true;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+static void motion_task(void* arg)
+{
+    for (;;) {
+        frame_ref_t* frame = frame_broker_pop(s_sub, portMAX_DELAY);
+        if (frame == NULL) {
+            continue;
+        }
+        analyse_frame(frame);
+        frame_broker_release(frame);
+    }
+}
+
+esp_err_t motion_stage_init(void)
+{
+    if (s_sub != NULL) {
+        return ESP_OK;
+    }
+
+    s_sub = frame_broker_subscribe("motion", 1, FRAME_BROKER_DROP_NEWEST);
+    if (s_sub == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    frame_broker_set_optional(s_sub);
+    if (xTaskCreate(motion_task, "motion_task", 3072, NULL, 2, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "创建运动检测任务失败");
+        frame_broker_unsubscribe(s_sub);
+        s_sub = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "运动检测启动: 1/%d 亮度平面, 阈值 %d, 最小区域 %d 块", MOTION_STAGE_SCALE, CONFIG_MOTION_BLOCK_THRESHOLD, CONFIG_MOTION_MIN_REGION_BLOCKS);
+    return ESP_OK;
+}
+
+bool motion_stage_get_state(motion_stage_state_t* state)
+{
+    if (state == NULL) {
+        return false;
+    }
+    taskENTER_CRITICAL(&s_lock);
+    bool valid = s_state_valid;
+    *state = s_state;
+    taskEXIT_CRITICAL(&s_lock);
+    return valid;
+}
+
+void motion_stage_get_stats(motion_stage_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    frame_broker_sub_stats_t sub;
+    frame_broker_get_sub_stats(s_sub, &sub);
+
+    taskENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_lock);
+    stats->skipped = sub.rejected;
+}
@@ -0,0 +1,76 @@
+/*
+ * motion_stage.h
+ * 运动检测阶段 - 帧分发的订阅者，用 jpeg_dc 取 JPEG 的直流分量得到 1/8 亮度平面后交给 motion_detect 检测
+ *
+ * 检测跟不上采集帧率时丢弃新帧 (FRAME_BROKER_DROP_NEWEST)，空闲帧缓冲不足时作为可选订阅者收不到帧，
+ * 两者都只影响检测的采样率，不影响发送。
+ * 最新的检测结果供发送任务等消费者查询。
+ */
+
+#ifndef MOTION_STAGE_H
+#define MOTION_STAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "motion_detect.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MOTION_STAGE_SCALE 8  // 亮度平面相对原图的缩小倍数
+
+/**
+ * @brief 最新的检测结果
+ */
+typedef struct
+{
+    uint32_t frame_seq;             // 检测的帧序号 (frame_ref_t.seq)
+    uint64_t timestamp_us;          // 该帧的采集时间戳
+    uint16_t width;                 // 亮度平面尺寸，区域坐标乘以 MOTION_STAGE_SCALE 为原图坐标
+    uint16_t height;
+    motion_detect_result_t result;
+    int64_t updated_us;             // 本结果产生的时间 (esp_timer)
+    int64_t last_motion_us;         // 最近一次检测到运动的时间 (esp_timer)，从未检测到时为 0
+} motion_stage_state_t;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct
+{
+    uint32_t analysed;         // 检测的帧数
+    uint32_t skipped;          // 检测繁忙时跳过的帧数
+    uint32_t decode_failures;  // JPEG 解码失败次数（含不支持的编码）
+    uint32_t resets;           // 分辨率变化导致的背景重建次数
+    uint32_t decode_avg_us;    // 缩小解码的平均耗时
+    uint32_t detect_avg_us;    // 块 SAD 与区域分析的平均耗时
+    uint8_t block;             // 块边长（亮度平面像素）
+    motion_detect_stats_t detector;
+} motion_stage_stats_t;
+
+/**
+ * @brief 初始化：注册帧分发订阅者并启动检测任务（已初始化时直接返回）
+ * @return esp_err_t
+ */
+esp_err_t motion_stage_init(void);
+
+/**
+ * @brief 获取最新的检测结果
+ * @param state 输出检测结果
+ * @return 尚未检测过任何帧时返回 false
+ */
+bool motion_stage_get_state(motion_stage_state_t* state);
+
+/**
+ * @brief 获取统计信息
+ * @param stats 输出统计信息
+ */
+void motion_stage_get_stats(motion_stage_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MOTION_STAGE_H */
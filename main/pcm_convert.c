@@ -0,0 +1,74 @@
+/*
+ * pcm_convert.c
+ * 8-bit 转 16-bit PCM 实现
+ */
+
+#include "pcm_convert.h"
+
+// 按 32 位字访问字节缓冲区，告知编译器可能与其他类型别名
+typedef uint32_t __attribute__((may_alias)) pcm_word_t;
+
+#define PCM_S16(x) ((int16_t)(((int)(x) - 128) * 256))
+#define PCM_LUT4(i) PCM_S16(i), PCM_S16((i) + 1), PCM_S16((i) + 2), PCM_S16((i) + 3)
+#define PCM_LUT16(i) PCM_LUT4(i), PCM_LUT4((i) + 4), PCM_LUT4((i) + 8), PCM_LUT4((i) + 12)
+#define PCM_LUT64(i) PCM_LUT16(i), PCM_LUT16((i) + 16), PCM_LUT16((i) + 32), PCM_LUT16((i) + 48)
+
+static const int16_t s_lut[256] = {PCM_LUT64(0), PCM_LUT64(64), PCM_LUT64(128), PCM_LUT64(192)};
+
+void pcm_u8_to_s16_scalar(const uint8_t* in, int16_t* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        out[i] = PCM_S16(in[i]);
+    }
+}
+
+void pcm_u8_to_s16_lut(const uint8_t* in, int16_t* out, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        out[i] = s_lut[in[i]];
+        out[i + 1] = s_lut[in[i + 1]];
+        out[i + 2] = s_lut[in[i + 2]];
+        out[i + 3] = s_lut[in[i + 3]];
+    }
+    for (; i < count; i++) {
+        out[i] = s_lut[in[i]];
+    }
+}
+
+void pcm_u8_to_s16_word(const uint8_t* in, int16_t* out, size_t count)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    pcm_u8_to_s16_lut(in, out, count);
+#else
+    // 逐样本处理到输入 4 字节对齐（Xtensa 不支持非对齐的字访问）
+    while (count > 0 && ((uintptr_t)in & 3) != 0) {
+        *out++ = s_lut[*in++];
+        count--;
+    }
+    if (((uintptr_t)out & 3) != 0) {
+        pcm_u8_to_s16_lut(in, out, count);
+        return;
+    }
+
+    const pcm_word_t* src = (const pcm_word_t*)in;
+    pcm_word_t* dst = (pcm_word_t*)out;
+    size_t words = count / 4;
+    for (size_t i = 0; i < words; i++) {
+        // 小端：字节 b0..b3 依次成为 4 个样本的高字节
+        uint32_t w = src[i] ^ 0x80808080u;
+        dst[2 * i] = ((w & 0x000000FFu) << 8) | ((w & 0x0000FF00u) << 16);
+        dst[2 * i + 1] = ((w & 0x00FF0000u) >> 8) | (w & 0xFF000000u);
+    }
+    pcm_u8_to_s16_lut(in + words * 4, out + words * 4, count - words * 4);
+#endif
+}
+
+void pcm_u8_to_s16(const uint8_t* in, int16_t* out, size_t count)
+{
+#ifdef PCM_CONVERT_LUT
+    pcm_u8_to_s16_lut(in, out, count);
+#else
+    pcm_u8_to_s16_word(in, out, count);
+#endif
+}
@@ -0,0 +1,47 @@
+/*
+ * pcm_convert.h
+ * 8-bit 无符号 PCM 转 16-bit 有符号 PCM
+ *
+ * (x - 128) * 256 的低字节为 0、高字节为 x ^ 0x80，因此转换就是把每个字节异或 0x80 后与 0 交织。
+ * 默认实现在 32 位字内一次处理 4 个样本（输入与输出 4 字节对齐时），查表与逐样本实现用于对照与测速；
+ * 定义 PCM_CONVERT_LUT 时默认使用查表实现。本模块不依赖 FreeRTOS 与音频驱动，可在 Linux 主机上单独编译。
+ */
+
+#ifndef PCM_CONVERT_H
+#define PCM_CONVERT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 转换（默认实现）
+ * @param in 8-bit 无符号样本
+ * @param out 16-bit 有符号样本，不能与 in 重叠
+ * @param count 样本数
+ */
+void pcm_u8_to_s16(const uint8_t* in, int16_t* out, size_t count);
+
+/**
+ * @brief 逐样本计算
+ */
+void pcm_u8_to_s16_scalar(const uint8_t* in, int16_t* out, size_t count);
+
+/**
+ * @brief 256 项查表
+ */
+void pcm_u8_to_s16_lut(const uint8_t* in, int16_t* out, size_t count);
+
+/**
+ * @brief 32 位字内一次处理 4 个样本；输入对齐后输出不是 4 字节对齐时退回查表
+ */
+void pcm_u8_to_s16_word(const uint8_t* in, int16_t* out, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PCM_CONVERT_H */
@@ -0,0 +1,169 @@
+/*
+ * retransmit_ring.c
+ * 重传环实现
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#include "retransmit_ring.h"
+
+static const char* TAG = "RETRANSMIT";
+
+static retransmit_entry_t* s_entries = NULL;
+static uint32_t s_max_frames = 0;
+static uint32_t s_max_bytes = 0;
+static uint32_t s_head = 0;  // 最旧帧的位置
+static uint32_t s_count = 0;
+static uint32_t s_bytes = 0;
+static SemaphoreHandle_t s_mutex = NULL;
+
+static retransmit_stats_t s_stats;
+static uint64_t s_latency_sum_us = 0;
+static uint32_t s_latency_samples = 0;
+
+esp_err_t retransmit_ring_init(uint32_t max_frames, uint32_t max_bytes)
+{
+    if (s_mutex != NULL) {
+        return ESP_OK;  // 已初始化
+    }
+    if (max_frames == 0) {
+        ESP_LOGI(TAG, "重传环已关闭");
+        return ESP_OK;
+    }
+
+    s_entries = heap_caps_calloc(max_frames, sizeof(retransmit_entry_t), MALLOC_CAP_SPIRAM);
+    if (s_entries == NULL) {
+        s_entries = calloc(max_frames, sizeof(retransmit_entry_t));
+    }
+    if (s_entries == NULL) {
+        ESP_LOGE(TAG, "无法分配重传环");
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_mutex == NULL) {
+        heap_caps_free(s_entries);
+        s_entries = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_max_frames = max_frames;
+    s_max_bytes = max_bytes;
+    ESP_LOGI(TAG, "重传环初始化: 最多 %lu 帧 / %lu bytes", (unsigned long)max_frames, (unsigned long)max_bytes);
+    return ESP_OK;
+}
+
+bool retransmit_ring_enabled(void)
+{
+    return s_mutex != NULL;
+}
+
+/**
+ * @brief 淘汰最旧的一帧（调用者持有锁）
+ */
+static void evict_oldest(void)
+{
+    retransmit_entry_t* e = &s_entries[s_head];
+    s_bytes -= e->frame->len;
+    frame_broker_release(e->frame);
+    e->frame = NULL;
+    s_head = (s_head + 1) % s_max_frames;
+    s_count--;
+    s_stats.evictions++;
+}
+
+void retransmit_ring_push(const retransmit_entry_t* entry)
+{
+    if (entry == NULL || entry->frame == NULL) {
+        return;
+    }
+    if (!retransmit_ring_enabled() || entry->frame->len > s_max_bytes) {
+        frame_broker_release(entry->frame);
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    while (s_count > 0 && (s_count >= s_max_frames || s_bytes + entry->frame->len > s_max_bytes)) {
+        evict_oldest();
+    }
+    s_entries[(s_head + s_count) % s_max_frames] = *entry;
+    s_count++;
+    s_bytes += entry->frame->len;
+    xSemaphoreGive(s_mutex);
+}
+
+bool retransmit_ring_acquire(uint32_t frame_seq, retransmit_entry_t* out)
+{
+    if (!retransmit_ring_enabled()) {
+        return false;
+    }
+
+    bool found = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < s_count; i++) {
+        const retransmit_entry_t* e = &s_entries[(s_head + i) % s_max_frames];
+        if (e->frame_seq == frame_seq) {
+            *out = *e;
+            frame_broker_retain(out->frame);
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    return found;
+}
+
+void retransmit_ring_clear(void)
+{
+    if (!retransmit_ring_enabled()) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    while (s_count > 0) {
+        evict_oldest();
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+void retransmit_ring_record(uint32_t hits, uint32_t misses, uint32_t latency_us)
+{
+    if (!retransmit_ring_enabled()) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_stats.nacks++;
+    s_stats.hits += hits;
+    s_stats.misses += misses;
+    if (hits > 0) {
+        s_latency_sum_us += latency_us;
+        s_latency_samples++;
+        if (latency_us > s_stats.latency_max_us) {
+            s_stats.latency_max_us = latency_us;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+void retransmit_ring_get_stats(retransmit_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (!retransmit_ring_enabled()) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *stats = s_stats;
+    stats->frames = s_count;
+    stats->bytes = s_bytes;
+    stats->latency_avg_us = s_latency_samples > 0 ? (uint32_t)(s_latency_sum_us / s_latency_samples) : 0;
+    xSemaphoreGive(s_mutex);
+}
@@ -0,0 +1,106 @@
+/*
+ * retransmit_ring.h
+ * 重传环：按引用保存最近发送的相机帧，用于应答接收端的NACK
+ *
+ * 帧缓冲本身位于PSRAM，环中只持有帧分发句柄的一个引用，不拷贝图像数据；
+ * 帧被淘汰时释放引用，没有其他消费者持有时归还给相机驱动。环的容量同时受帧数和总字节数限制。
+ */
+
+#ifndef RETRANSMIT_RING_H
+#define RETRANSMIT_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "frame_broker.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 环中保存的一帧
+ */
+typedef struct
+{
+    uint32_t frame_seq;     // 帧序号
+    uint8_t version;        // 发送时使用的协议版本
+    uint64_t timestamp_us;  // 采集时间戳
+    int64_t sent_us;        // 首次发送完成的时间
+    frame_ref_t* frame;     // 帧引用
+} retransmit_entry_t;
+
+/**
+ * @brief 重传统计
+ */
+typedef struct
+{
+    uint32_t nacks;             // 收到的NACK数
+    uint32_t hits;              // 成功重传的包数
+    uint32_t misses;            // 请求的帧已不在环中（或包序号无效）的包数
+    uint32_t rejected;          // 来源不是接收端而被忽略的NACK数（由 udp_camera_get_retransmit_stats() 填写）
+    uint32_t evictions;         // 被淘汰的帧数
+    uint32_t frames;            // 当前环中的帧数
+    uint32_t bytes;             // 当前环中的字节数
+    uint32_t latency_avg_us;    // 重传相对首次发送的平均附加延迟
+    uint32_t latency_max_us;    // 最大附加延迟
+} retransmit_stats_t;
+
+/**
+ * @brief 初始化重传环（索引数组分配在PSRAM）
+ * @param max_frames 最多保存的帧数，0 表示关闭重传
+ * @param max_bytes 最多保存的字节数
+ * @return esp_err_t
+ */
+esp_err_t retransmit_ring_init(uint32_t max_frames, uint32_t max_bytes);
+
+/**
+ * @brief 重传环是否可用
+ */
+bool retransmit_ring_enabled(void);
+
+/**
+ * @brief 放入一帧，环接管调用者的一个引用（超出容量时淘汰最旧的帧并释放其引用）
+ *
+ * 环未启用或单帧超出字节上限时，引用立即释放。
+ *
+ * @param entry 帧描述
+ */
+void retransmit_ring_push(const retransmit_entry_t* entry);
+
+/**
+ * @brief 查找帧并取得其帧引用
+ *
+ * 只在查找期间持有环的锁，调用者解锁后再逐包重传，不阻塞发送任务的 retransmit_ring_push()；
+ * 重传期间帧即使被淘汰也仍然有效（多占用一个帧缓冲）。
+ *
+ * @param frame_seq 帧序号
+ * @param out 输出帧描述，找到时 out->frame 持有一个新的引用，用完调用 frame_broker_release()
+ * @return 找到返回 true
+ */
+bool retransmit_ring_acquire(uint32_t frame_seq, retransmit_entry_t* out);
+
+/**
+ * @brief 清空环，释放所有帧引用
+ */
+void retransmit_ring_clear(void);
+
+/**
+ * @brief 记录一次NACK的处理结果
+ * @param hits 重传成功的包数
+ * @param misses 无法重传的包数
+ * @param latency_us 附加延迟 (仅 hits > 0 时有效)
+ */
+void retransmit_ring_record(uint32_t hits, uint32_t misses, uint32_t latency_us);
+
+/**
+ * @brief 获取统计信息
+ * @param stats 输出统计信息
+ */
+void retransmit_ring_get_stats(retransmit_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETRANSMIT_RING_H */
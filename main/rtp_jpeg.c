@@ -0,0 +1,282 @@
+/*
+ * rtp_jpeg.c
+ * RTP/JPEG 分包 (RFC 2435) 与 SDP 描述生成实现
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "rtp_jpeg.h"
+
+// JPEG 标记
+#define JPEG_SOI 0xD8
+#define JPEG_EOI 0xD9
+#define JPEG_SOS 0xDA
+#define JPEG_DQT 0xDB
+#define JPEG_DRI 0xDD
+#define JPEG_SOF0 0xC0
+#define JPEG_SOF1 0xC1
+#define JPEG_DHT 0xC4
+#define JPEG_JPG 0xC8
+#define JPEG_DAC 0xCC
+
+#define JPEG_MAX_QTABLES 4
+
+static void put_u16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void put_u24(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 16);
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)v;
+}
+
+static void put_u32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint16_t get_u16(const uint8_t* p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+/**
+ * @brief 是否为其他帧类型的 SOF 标记（渐进、无损、算术编码等，RFC 2435 不支持）
+ */
+static bool is_unsupported_sof(uint8_t marker)
+{
+    return marker >= 0xC2 && marker <= 0xCF && marker != JPEG_DHT && marker != JPEG_JPG && marker != JPEG_DAC;
+}
+
+void rtp_jpeg_session_init(rtp_jpeg_session_t* session, uint32_t ssrc, uint16_t seq, uint32_t timestamp_offset)
+{
+    session->ssrc = ssrc;
+    session->seq = seq;
+    session->timestamp_offset = timestamp_offset;
+}
+
+uint32_t rtp_jpeg_timestamp(const rtp_jpeg_session_t* session, uint64_t timestamp_us)
+{
+    // 90 kHz = 9 / 100 个时钟每微秒，先乘后除避免累积误差，回绕由 uint32 截断完成
+    return (uint32_t)(timestamp_us * 9 / 100) + session->timestamp_offset;
+}
+
+esp_err_t rtp_jpeg_parse(const uint8_t* jpeg, size_t len, rtp_jpeg_frame_t* frame)
+{
+    if (jpeg == NULL || frame == NULL || len < 4 || jpeg[0] != 0xFF || jpeg[1] != JPEG_SOI) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uint8_t* qtables[JPEG_MAX_QTABLES] = {NULL};
+    uint8_t luma_table = 0;
+    uint8_t chroma_table = 0;
+    bool have_sof = false;
+
+    memset(frame, 0, sizeof(*frame));
+
+    size_t pos = 2;
+    while (pos + 4 <= len) {
+        if (jpeg[pos] != 0xFF) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        uint8_t marker = jpeg[pos + 1];
+        if (marker == 0xFF) {
+            pos++;  // 填充字节
+            continue;
+        }
+        if (marker == JPEG_SOI || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            pos += 2;  // 无长度字段的标记
+            continue;
+        }
+        if (marker == JPEG_EOI) {
+            return ESP_ERR_INVALID_ARG;  // 没有扫描数据
+        }
+
+        size_t seg_len = get_u16(jpeg + pos + 2);
+        const uint8_t* seg = jpeg + pos + 4;
+        if (seg_len < 2 || pos + 2 + seg_len > len) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        size_t body_len = seg_len - 2;
+
+        if (marker == JPEG_DQT) {
+            // 一个 DQT 段可以包含多张表: Pq/Tq (1) + 64 或 128 字节
+            size_t i = 0;
+            while (i < body_len) {
+                uint8_t precision = seg[i] >> 4;
+                uint8_t id = seg[i] & 0x0F;
+                if (precision != 0) {
+                    return ESP_ERR_NOT_SUPPORTED;  // RFC 2435 的量化表头支持16位，但常见解码器只接受8位
+                }
+                if (id >= JPEG_MAX_QTABLES || i + 1 + RTP_JPEG_QTABLE_SIZE > body_len) {
+                    return ESP_ERR_INVALID_ARG;
+                }
+                qtables[id] = seg + i + 1;
+                i += 1 + RTP_JPEG_QTABLE_SIZE;
+            }
+        }
+        else if (marker == JPEG_SOF0 || marker == JPEG_SOF1) {
+            if (body_len < 6 + 3 * 3 || seg[0] != 8 || seg[5] != 3) {
+                return ESP_ERR_NOT_SUPPORTED;  // 只支持 8 位精度的 YCbCr 三分量
+            }
+            uint16_t height = get_u16(seg + 1);
+            uint16_t width = get_u16(seg + 3);
+            if (width == 0 || height == 0 || width % 8 != 0 || height % 8 != 0 || width > 2040 || height > 2040) {
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+
+            // 分量: id, 采样因子 (H<<4 | V), 量化表号
+            const uint8_t* y = seg + 6;
+            const uint8_t* cb = y + 3;
+            const uint8_t* cr = cb + 3;
+            if (cb[1] != 0x11 || cr[1] != 0x11 || cb[2] != cr[2]) {
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            if (y[1] == 0x21) {
+                frame->type = 0;  // 4:2:2
+            }
+            else if (y[1] == 0x22) {
+                frame->type = 1;  // 4:2:0
+            }
+            else {
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            frame->width = (uint8_t)(width / 8);
+            frame->height = (uint8_t)(height / 8);
+            luma_table = y[2] & 0x0F;
+            chroma_table = cb[2] & 0x0F;
+            have_sof = true;
+        }
+        else if (is_unsupported_sof(marker)) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        else if (marker == JPEG_DRI) {
+            if (body_len < 2) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            frame->restart_interval = get_u16(seg);
+        }
+        else if (marker == JPEG_SOS) {
+            pos += 2 + seg_len;
+            break;
+        }
+        // APPn (JFIF)、COM、DHT 等段在 RTP 流中不需要，直接跳过
+
+        pos += 2 + seg_len;
+    }
+
+    if (!have_sof || pos >= len || luma_table >= JPEG_MAX_QTABLES || chroma_table >= JPEG_MAX_QTABLES || qtables[luma_table] == NULL || qtables[chroma_table] == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 扫描数据以 EOI 结束，帧缓冲末尾可能还有对齐填充，从尾部向前查找
+    size_t end = len;
+    while (end >= pos + 2 && !(jpeg[end - 2] == 0xFF && jpeg[end - 1] == JPEG_EOI)) {
+        end--;
+    }
+    if (end < pos + 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (frame->restart_interval != 0) {
+        frame->type += 64;
+    }
+    memcpy(frame->qtables[0], qtables[luma_table], RTP_JPEG_QTABLE_SIZE);
+    memcpy(frame->qtables[1], qtables[chroma_table], RTP_JPEG_QTABLE_SIZE);
+    frame->scan = jpeg + pos;
+    frame->scan_len = end - 2 - pos;
+    return ESP_OK;
+}
+
+size_t rtp_jpeg_header_size(const rtp_jpeg_frame_t* frame, size_t offset)
+{
+    size_t size = RTP_JPEG_RTP_HEADER_SIZE + RTP_JPEG_MAIN_HEADER_SIZE;
+    if (frame->type >= 64) {
+        size += RTP_JPEG_RESTART_HEADER_SIZE;
+    }
+    if (offset == 0) {
+        size += RTP_JPEG_QTABLE_HEADER_SIZE + 2 * RTP_JPEG_QTABLE_SIZE;
+    }
+    return size;
+}
+
+size_t rtp_jpeg_encode_header(rtp_jpeg_session_t* session, const rtp_jpeg_frame_t* frame, uint32_t rtp_timestamp, size_t offset, size_t payload_len, uint8_t* out)
+{
+    uint8_t* p = out;
+    bool last = (offset + payload_len >= frame->scan_len);
+
+    // RTP 头
+    p[0] = 0x80;  // V=2, P=0, X=0, CC=0
+    p[1] = (uint8_t)((last ? 0x80 : 0x00) | RTP_JPEG_PAYLOAD_TYPE);
+    put_u16(p + 2, session->seq++);
+    put_u32(p + 4, rtp_timestamp);
+    put_u32(p + 8, session->ssrc);
+    p += RTP_JPEG_RTP_HEADER_SIZE;
+
+    // JPEG 主头
+    p[0] = 0;  // type-specific: 逐行扫描
+    put_u24(p + 1, (uint32_t)offset);
+    p[4] = frame->type;
+    p[5] = 255;  // Q >= 128: 量化表随帧发送
+    p[6] = frame->width;
+    p[7] = frame->height;
+    p += RTP_JPEG_MAIN_HEADER_SIZE;
+
+    // 重启标记头: F=L=1, count=0x3FFF 表示整帧重组后再解码，分片不必对齐重启间隔
+    if (frame->type >= 64) {
+        put_u16(p, frame->restart_interval);
+        put_u16(p + 2, 0xFFFF);
+        p += RTP_JPEG_RESTART_HEADER_SIZE;
+    }
+
+    // 量化表头，只在分片偏移为 0 的包中出现
+    if (offset == 0) {
+        p[0] = 0;  // MBZ
+        p[1] = 0;  // 两张表均为 8 位精度
+        put_u16(p + 2, 2 * RTP_JPEG_QTABLE_SIZE);
+        memcpy(p + 4, frame->qtables[0], RTP_JPEG_QTABLE_SIZE);
+        memcpy(p + 4 + RTP_JPEG_QTABLE_SIZE, frame->qtables[1], RTP_JPEG_QTABLE_SIZE);
+        p += RTP_JPEG_QTABLE_HEADER_SIZE + 2 * RTP_JPEG_QTABLE_SIZE;
+    }
+
+    return (size_t)(p - out);
+}
+
+size_t rtp_jpeg_build_sdp(char* out, size_t size, const char* addr, uint16_t port, uint8_t ttl, uint32_t ssrc)
+{
+    char conn[24];
+    if (ttl > 0) {
+        snprintf(conn, sizeof(conn), "%s/%u", addr, ttl);
+    }
+    else {
+        snprintf(conn, sizeof(conn), "%s", addr);
+    }
+
+    int n = snprintf(out,
+                     size,
+                     "v=0\r\n"
+                     "o=- %lu 0 IN IP4 %s\r\n"
+                     "s=ESP32 Camera\r\n"
+                     "c=IN IP4 %s\r\n"
+                     "t=0 0\r\n"
+                     "m=video %u RTP/AVP %d\r\n"
+                     "a=rtpmap:%d JPEG/%d\r\n",
+                     (unsigned long)ssrc,
+                     addr,
+                     conn,
+                     port,
+                     RTP_JPEG_PAYLOAD_TYPE,
+                     RTP_JPEG_PAYLOAD_TYPE,
+                     RTP_JPEG_CLOCK_RATE);
+    if (n < 0 || (size_t)n >= size) {
+        return 0;
+    }
+    return (size_t)n;
+}
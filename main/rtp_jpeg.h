@@ -0,0 +1,145 @@
+/*
+ * rtp_jpeg.h
+ * RTP/JPEG 分包 (RFC 2435) 与 SDP 描述生成
+ *
+ * 去掉 JFIF 头部，只发送熵编码扫描数据；量化表放在每帧第一个包的量化表头中 (Q = 255)，
+ * 哈夫曼表使用 RFC 2435 / JPEG Annex K 的标准表（esp32-camera 的 JPEG 编码器即使用标准表）。
+ *
+ * 只支持 RFC 2435 type 0 (4:2:2) 与 type 1 (4:2:0)，带重启标记时为 64/65。JPEG 中的 DHT 段不发送也不检查，
+ * 接收端总是按 Annex K 标准表重建 JPEG 头，使用自定义哈夫曼表的编码器输出会被解成花屏。
+ * 主头只能携带 width/8、height/8，宽高不是 8 的倍数或超过 2040 的帧由 rtp_jpeg_parse() 拒绝，不能用 RTP/JPEG 发送
+ * （esp32-camera 的分辨率都是 8 的倍数，QSXGA 等超过 2040 的分辨率除外）。
+ * 用 ffmpeg 验证输出见仓库根目录的 validate_rtp_jpeg.py。
+ * 负载始终指向原始 JPEG 缓冲区，分包只生成包头，不拷贝扫描数据。
+ *
+ * 本模块不依赖 FreeRTOS 与网络协议栈，可在 Linux 主机上单独编译测试。
+ */
+
+#ifndef RTP_JPEG_H
+#define RTP_JPEG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RTP_JPEG_PAYLOAD_TYPE 26  // RFC 3551 为 JPEG 分配的静态负载类型
+#define RTP_JPEG_CLOCK_RATE 90000
+
+#define RTP_JPEG_RTP_HEADER_SIZE 12
+#define RTP_JPEG_MAIN_HEADER_SIZE 8
+#define RTP_JPEG_RESTART_HEADER_SIZE 4
+#define RTP_JPEG_QTABLE_HEADER_SIZE 4
+#define RTP_JPEG_QTABLE_SIZE 64  // 8 位精度，zigzag 顺序
+
+// 包头最大长度：RTP + JPEG 主头 + 重启标记头 + 量化表头 + 亮度/色度两张量化表
+#define RTP_JPEG_MAX_HEADER_SIZE \
+    (RTP_JPEG_RTP_HEADER_SIZE + RTP_JPEG_MAIN_HEADER_SIZE + RTP_JPEG_RESTART_HEADER_SIZE + RTP_JPEG_QTABLE_HEADER_SIZE + 2 * RTP_JPEG_QTABLE_SIZE)
+
+/*
+ * 每个包的布局（网络字节序）:
+ *   RTP 头 (12)         V=2, PT=26, 帧的最后一个包置 marker，90 kHz 时间戳
+ *   JPEG 主头 (8)       type-specific=0, 24 位分片偏移, type, Q=255, width/8, height/8
+ *   重启标记头 (4)      仅 type 64..127: restart interval, F=1, L=1, count=0x3FFF
+ *   量化表头 (4 + 128)  仅分片偏移为 0 的包: MBZ, precision=0, length=128, 亮度表, 色度表
+ *   扫描数据            SOS 段之后到 EOI 之前的熵编码数据
+ */
+
+/**
+ * @brief 从一帧 JPEG 中解析出的 RTP/JPEG 参数（扫描数据指向原缓冲区）
+ */
+typedef struct
+{
+    uint8_t type;                                  // RFC 2435 type: 0 (4:2:2), 1 (4:2:0)，带重启标记时 +64
+    uint8_t width;                                 // 宽度 / 8
+    uint8_t height;                                // 高度 / 8
+    uint16_t restart_interval;                     // DRI 段的重启间隔，0 表示没有
+    uint8_t qtables[2][RTP_JPEG_QTABLE_SIZE];      // 亮度、色度量化表（zigzag 顺序，与 DQT 一致）
+    const uint8_t* scan;                           // 扫描数据起点（指向 JPEG 缓冲区内部）
+    size_t scan_len;                               // 扫描数据长度（不含 EOI）
+} rtp_jpeg_frame_t;
+
+/**
+ * @brief RTP 会话状态（一路流一个实例）
+ */
+typedef struct
+{
+    uint32_t ssrc;              // 同步源标识
+    uint16_t seq;               // 下一个包的序号
+    uint32_t timestamp_offset;  // 时间戳随机起点
+} rtp_jpeg_session_t;
+
+/**
+ * @brief 初始化会话
+ * @param session 会话
+ * @param ssrc 同步源标识（应为随机数）
+ * @param seq 初始序号（应为随机数）
+ * @param timestamp_offset 时间戳起点（应为随机数）
+ */
+void rtp_jpeg_session_init(rtp_jpeg_session_t* session, uint32_t ssrc, uint16_t seq, uint32_t timestamp_offset);
+
+/**
+ * @brief 把采集时间换算为 90 kHz RTP 时间戳
+ * @param session 会话
+ * @param timestamp_us 采集时间 (fb->timestamp，微秒)
+ * @return RTP 时间戳
+ */
+uint32_t rtp_jpeg_timestamp(const rtp_jpeg_session_t* session, uint64_t timestamp_us);
+
+/**
+ * @brief 解析一帧基线 JPEG，定位量化表与扫描数据
+ * @param jpeg JPEG 数据
+ * @param len 数据长度
+ * @param frame 输出参数
+ *
+ * 不检查 DHT 段，调用者须保证编码器使用 Annex K 标准哈夫曼表（见文件头）。
+ *
+ * @return ESP_OK; ESP_ERR_INVALID_ARG (不是完整的 JPEG); ESP_ERR_NOT_SUPPORTED (非基线、非 YUV 4:2:2/4:2:0
+ *         (RFC 2435 type 0/1)、16 位量化表，或宽高不是 8 的倍数 / 超过 2040)
+ */
+esp_err_t rtp_jpeg_parse(const uint8_t* jpeg, size_t len, rtp_jpeg_frame_t* frame);
+
+/**
+ * @brief 返回指定分片偏移处的包头长度
+ * @param frame 帧参数
+ * @param offset 分片偏移
+ * @return 包头字节数
+ */
+size_t rtp_jpeg_header_size(const rtp_jpeg_frame_t* frame, size_t offset);
+
+/**
+ * @brief 编码一个包的包头（RTP 头 + JPEG 头），并递增会话序号
+ *
+ * 负载为 frame->scan + offset 开始的 payload_len 字节，由调用者直接从原缓冲区发送。
+ *
+ * @param session 会话
+ * @param frame 帧参数
+ * @param rtp_timestamp 本帧的 RTP 时间戳
+ * @param offset 分片偏移
+ * @param payload_len 本包扫描数据长度
+ * @param out 输出缓冲区，至少 RTP_JPEG_MAX_HEADER_SIZE 字节
+ * @return 包头字节数
+ */
+size_t rtp_jpeg_encode_header(rtp_jpeg_session_t* session, const rtp_jpeg_frame_t* frame, uint32_t rtp_timestamp, size_t offset, size_t payload_len, uint8_t* out);
+
+/**
+ * @brief 生成 SDP 描述，供 ffmpeg/GStreamer/VLC 直接打开
+ * @param out 输出缓冲区
+ * @param size 缓冲区大小
+ * @param addr 接收地址（单播为接收端地址，组播为组地址）
+ * @param port 接收端口（应为偶数，RTCP 使用 port + 1）
+ * @param ttl 组播 TTL，单播传 0
+ * @param ssrc 同步源标识（用作会话 ID）
+ * @return 写入的字节数（不含结尾 '\0'），缓冲区不足时返回 0
+ */
+size_t rtp_jpeg_build_sdp(char* out, size_t size, const char* addr, uint16_t port, uint8_t ttl, uint32_t ssrc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTP_JPEG_H */
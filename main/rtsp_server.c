@@ -0,0 +1,715 @@
+/*
+ * rtsp_server.c
+ * 轻量RTSP服务器实现
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/uio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_random.h"
+#include "esp_rom_sys.h"
+#include "lwip/inet.h"
+
+#include "rtsp_server.h"
+#include "rtp_jpeg.h"
+#include "frame_slot.h"
+#include "udp_pacer.h"
+
+static const char* TAG = "RTSP";
+
+#define RTSP_RX_SIZE 1024             // 单个请求（含请求体）的最大长度
+#define RTSP_TX_SIZE 1024             // 单个应答的最大长度
+#define RTSP_MAX_PACKET 1400          // RTP包最大长度（不含TCP交织头）
+#define RTSP_SESSION_TIMEOUT_S 60     // UDP传输时没有任何RTSP请求的超时
+#define RTSP_ACCEPT_TIMEOUT_MS 1000   // accept/recv 超时，用于检查停止标志
+#define RTSP_FRAME_TIMEOUT_MS 100     // PLAY 状态下等待新帧的超时，期间处理客户端请求
+#define RTSP_SEND_TIMEOUT_S 5         // 控制连接（含TCP交织数据）的发送超时
+#define RTSP_SEND_RETRY_MAX 10
+#define RTSP_SEND_BACKOFF_US 2000
+#define RTSP_STOP_TIMEOUT_MS 3000
+#define RTSP_BURST_BYTES 8192         // 会话节拍器的令牌桶容量
+
+/**
+ * @brief 会话状态
+ */
+typedef struct
+{
+    bool used;
+    int sock;                        // RTSP 控制连接
+    int rtp_sock;                    // RTP over UDP 使用的 socket，TCP交织时为 -1
+    struct sockaddr_in rtp_dest;     // 客户端RTP端口
+    uint8_t channel;                 // TCP交织通道号
+    char base_url[128];              // DESCRIBE 的 Content-Base
+    int64_t accept_us;               // TCP 建连时间
+    int64_t last_request_us;         // 最近一次收到请求的时间
+    int64_t play_us;                 // PLAY 的时间，CPU占用按此后的时长计算
+    uint64_t busy_cycles;            // PLAY 以来分包与发送消耗的CPU周期
+    uint32_t last_seq;               // 最近发送的帧槽序号
+    rtp_jpeg_session_t rtp;
+    udp_pacer_t pacer;
+    bool pacer_initialized;
+    size_t rx_len;
+    size_t rx_skip;                  // 尚未收完、需要丢弃的交织数据字节数
+    char rx[RTSP_RX_SIZE + 1];
+    rtsp_session_stats_t stats;
+} rtsp_session_t;
+
+static rtsp_session_t s_sessions[RTSP_SERVER_MAX_SESSIONS];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_running = false;
+static volatile uint32_t s_active_sessions = 0;
+static TaskHandle_t s_server_task = NULL;
+
+static void put_u16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+/**
+ * @brief 在请求头中查找指定字段（不区分大小写），值去掉首尾空白后写入 out
+ */
+static bool rtsp_get_header(const char* request, const char* name, char* out, size_t size)
+{
+    size_t name_len = strlen(name);
+    const char* line = strstr(request, "\r\n");
+    while (line != NULL) {
+        line += 2;
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char* value = line + name_len + 1;
+            while (*value == ' ' || *value == '\t') {
+                value++;
+            }
+            const char* end = strstr(value, "\r\n");
+            size_t len = end ? (size_t)(end - value) : strlen(value);
+            if (len >= size) {
+                len = size - 1;
+            }
+            memcpy(out, value, len);
+            out[len] = '\0';
+            return true;
+        }
+        line = strstr(line, "\r\n");
+    }
+    return false;
+}
+
+/**
+ * @brief 发送完整的数据段（TCP 可能只发送一部分）
+ */
+static ssize_t send_all_iov(int sock, struct iovec* iov, int iovcnt)
+{
+    size_t total = 0;
+    while (iovcnt > 0) {
+        struct msghdr msg = {.msg_iov = iov, .msg_iovlen = iovcnt};
+        ssize_t sent = sendmsg(sock, &msg, 0);
+        if (sent < 0) {
+            return -1;
+        }
+        total += sent;
+        while (iovcnt > 0 && (size_t)sent >= iov->iov_len) {
+            sent -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + sent;
+            iov->iov_len -= sent;
+        }
+    }
+    return (ssize_t)total;
+}
+
+static esp_err_t rtsp_send_response(rtsp_session_t* s, const char* cseq, const char* status, const char* headers, const char* body)
+{
+    char tx[RTSP_TX_SIZE];
+    int len = snprintf(tx, sizeof(tx), "RTSP/1.0 %s\r\nCSeq: %s\r\nServer: ESP32-Camera\r\n%s", status, cseq, headers ? headers : "");
+    if (body != NULL && len > 0 && len < (int)sizeof(tx)) {
+        len += snprintf(tx + len, sizeof(tx) - len, "Content-Length: %u\r\n\r\n%s", (unsigned)strlen(body), body);
+    }
+    else if (len > 0 && len < (int)sizeof(tx)) {
+        len += snprintf(tx + len, sizeof(tx) - len, "\r\n");
+    }
+    if (len <= 0 || len >= (int)sizeof(tx)) {
+        ESP_LOGE(TAG, "应答过长");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    struct iovec iov = {.iov_base = tx, .iov_len = len};
+    return send_all_iov(s->sock, &iov, 1) < 0 ? ESP_FAIL : ESP_OK;
+}
+
+/**
+ * @brief 从控制连接读取一个完整的请求，丢弃客户端发来的交织数据（例如 RTCP 接收报告）
+ *
+ * @param s 会话
+ * @param wait 没有可读数据时是否等待（受 SO_RCVTIMEO 限制）
+ * @param head_len 输出请求头长度（含空行）
+ * @param msg_len 输出整个请求长度（含请求体）
+ * @return 1 收到请求, 0 暂无请求, -1 连接关闭或出错
+ */
+static int rtsp_read_request(rtsp_session_t* s, bool wait, size_t* head_len, size_t* msg_len)
+{
+    for (;;) {
+        // 交织数据: '$' + 通道号 + uint16 长度 + 数据
+        while (s->rx_len >= 4 && s->rx[0] == '$') {
+            size_t frame_len = 4 + (((uint8_t)s->rx[2] << 8) | (uint8_t)s->rx[3]);
+            if (s->rx_len >= frame_len) {
+                memmove(s->rx, s->rx + frame_len, s->rx_len - frame_len);
+                s->rx_len -= frame_len;
+            }
+            else {
+                s->rx_skip = frame_len - s->rx_len;
+                s->rx_len = 0;
+            }
+        }
+
+        if (s->rx_len > 0 && s->rx[0] != '$') {
+            s->rx[s->rx_len] = '\0';
+            char* end = strstr(s->rx, "\r\n\r\n");
+            if (end != NULL) {
+                *head_len = end + 4 - s->rx;
+                char value[16];
+                size_t content_len = 0;
+                char saved = s->rx[*head_len];
+                s->rx[*head_len] = '\0';
+                if (rtsp_get_header(s->rx, "Content-Length", value, sizeof(value))) {
+                    content_len = strtoul(value, NULL, 10);
+                }
+                s->rx[*head_len] = saved;
+                if (*head_len + content_len > RTSP_RX_SIZE) {
+                    return -1;
+                }
+                if (s->rx_len >= *head_len + content_len) {
+                    *msg_len = *head_len + content_len;
+                    return 1;
+                }
+            }
+            else if (s->rx_len >= RTSP_RX_SIZE) {
+                ESP_LOGW(TAG, "请求过长，关闭连接");
+                return -1;
+            }
+        }
+
+        if (!wait) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(s->sock, &readable);
+            struct timeval zero = {0, 0};
+            if (select(s->sock + 1, &readable, NULL, NULL, &zero) <= 0) {
+                return 0;
+            }
+        }
+
+        int n = recv(s->sock, s->rx + s->rx_len, RTSP_RX_SIZE - s->rx_len, 0);
+        if (n == 0) {
+            return -1;
+        }
+        if (n < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        if (s->rx_skip > 0) {
+            size_t drop = (s->rx_skip < (size_t)n) ? s->rx_skip : (size_t)n;
+            memmove(s->rx + s->rx_len, s->rx + s->rx_len + drop, n - drop);
+            s->rx_skip -= drop;
+            n -= drop;
+        }
+        s->rx_len += n;
+    }
+}
+
+/**
+ * @brief 解析 SETUP 的 Transport 头并准备RTP通道
+ * @return 应答的 Transport 头；不支持的传输方式返回 ESP_ERR_NOT_SUPPORTED
+ */
+static esp_err_t rtsp_setup_transport(rtsp_session_t* s, const char* transport, char* reply, size_t reply_size)
+{
+    if (strstr(transport, "multicast") != NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (strstr(transport, "RTP/AVP/TCP") != NULL) {
+        unsigned rtp_channel = 0;
+        const char* interleaved = strstr(transport, "interleaved=");
+        if (interleaved != NULL) {
+            rtp_channel = strtoul(interleaved + strlen("interleaved="), NULL, 10);
+        }
+        if (rtp_channel > 254) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        s->channel = (uint8_t)rtp_channel;
+        s->stats.tcp = true;
+        snprintf(reply, reply_size, "RTP/AVP/TCP;unicast;interleaved=%u-%u;ssrc=%08lX", rtp_channel, rtp_channel + 1, (unsigned long)s->rtp.ssrc);
+        return ESP_OK;
+    }
+
+    const char* client_port = strstr(transport, "client_port=");
+    if (client_port == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    unsigned port = strtoul(client_port + strlen("client_port="), NULL, 10);
+    if (port == 0 || port > 65535) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (s->rtp_sock < 0) {
+        s->rtp_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (s->rtp_sock < 0) {
+            return ESP_ERR_NO_MEM;
+        }
+        struct sockaddr_in local = {.sin_family = AF_INET, .sin_port = 0, .sin_addr.s_addr = htonl(INADDR_ANY)};
+        bind(s->rtp_sock, (struct sockaddr*)&local, sizeof(local));
+    }
+    struct sockaddr_in local;
+    socklen_t local_len = sizeof(local);
+    getsockname(s->rtp_sock, (struct sockaddr*)&local, &local_len);
+
+    s->rtp_dest = s->stats.peer;
+    s->rtp_dest.sin_port = htons((uint16_t)port);
+    s->stats.tcp = false;
+    snprintf(reply,
+             reply_size,
+             "RTP/AVP;unicast;client_port=%u-%u;server_port=%u-%u;ssrc=%08lX",
+             port,
+             port + 1,
+             ntohs(local.sin_port),
+             ntohs(local.sin_port) + 1,
+             (unsigned long)s->rtp.ssrc);
+    return ESP_OK;
+}
+
+/**
+ * @brief 处理一个RTSP请求
+ * @return ESP_OK 继续会话; ESP_FAIL 结束会话 (TEARDOWN 或发送失败)
+ */
+static esp_err_t rtsp_handle_request(rtsp_session_t* s, char* request)
+{
+    char method[16];
+    char url[128];
+    if (sscanf(request, "%15s %127s", method, url) != 2) {
+        return rtsp_send_response(s, "0", "400 Bad Request", NULL, NULL) == ESP_OK ? ESP_OK : ESP_FAIL;
+    }
+
+    char cseq[16] = "0";
+    rtsp_get_header(request, "CSeq", cseq, sizeof(cseq));
+    s->last_request_us = esp_timer_get_time();
+    ESP_LOGD(TAG, "会话 %08lX: %s %s", (unsigned long)s->stats.session_id, method, url);
+
+    // 除 OPTIONS/DESCRIBE/SETUP 外的请求必须带上本会话的 Session
+    char session[32];
+    char headers[256];
+    bool has_session = rtsp_get_header(request, "Session", session, sizeof(session));
+    if (has_session && strtoul(session, NULL, 16) != s->stats.session_id) {
+        return rtsp_send_response(s, cseq, "454 Session Not Found", NULL, NULL);
+    }
+
+    esp_err_t err;
+    if (strcmp(method, "OPTIONS") == 0) {
+        err = rtsp_send_response(s, cseq, "200 OK", "Public: OPTIONS, DESCRIBE, SETUP, PLAY, TEARDOWN, GET_PARAMETER, SET_PARAMETER\r\n", NULL);
+    }
+    else if (strcmp(method, "DESCRIBE") == 0) {
+        struct sockaddr_in local;
+        socklen_t local_len = sizeof(local);
+        char local_ip[16] = "0.0.0.0";
+        if (getsockname(s->sock, (struct sockaddr*)&local, &local_len) == 0) {
+            inet_ntoa_r(local.sin_addr, local_ip, sizeof(local_ip));
+        }
+
+        size_t url_len = strlen(url);
+        snprintf(s->base_url, sizeof(s->base_url), "%s%s", url, (url_len > 0 && url[url_len - 1] == '/') ? "" : "/");
+
+        char sdp[384];
+        snprintf(sdp,
+                 sizeof(sdp),
+                 "v=0\r\n"
+                 "o=- %lu 0 IN IP4 %s\r\n"
+                 "s=ESP32 Camera\r\n"
+                 "c=IN IP4 0.0.0.0\r\n"
+                 "t=0 0\r\n"
+                 "a=control:*\r\n"
+                 "m=video 0 RTP/AVP %d\r\n"
+                 "a=rtpmap:%d JPEG/%d\r\n"
+                 "a=control:track1\r\n",
+                 (unsigned long)s->stats.session_id,
+                 local_ip,
+                 RTP_JPEG_PAYLOAD_TYPE,
+                 RTP_JPEG_PAYLOAD_TYPE,
+                 RTP_JPEG_CLOCK_RATE);
+        snprintf(headers, sizeof(headers), "Content-Base: %s\r\nContent-Type: application/sdp\r\n", s->base_url);
+        err = rtsp_send_response(s, cseq, "200 OK", headers, sdp);
+    }
+    else if (strcmp(method, "SETUP") == 0) {
+        char transport[128];
+        char reply[160];
+        if (!rtsp_get_header(request, "Transport", transport, sizeof(transport))) {
+            return rtsp_send_response(s, cseq, "400 Bad Request", NULL, NULL);
+        }
+        esp_err_t setup_err = rtsp_setup_transport(s, transport, reply, sizeof(reply));
+        if (setup_err == ESP_ERR_NOT_SUPPORTED) {
+            return rtsp_send_response(s, cseq, "461 Unsupported Transport", NULL, NULL);
+        }
+        if (setup_err != ESP_OK) {
+            return rtsp_send_response(s, cseq, "500 Internal Server Error", NULL, NULL);
+        }
+        snprintf(headers, sizeof(headers), "Transport: %s\r\nSession: %08lX;timeout=%d\r\n", reply, (unsigned long)s->stats.session_id, RTSP_SESSION_TIMEOUT_S);
+        err = rtsp_send_response(s, cseq, "200 OK", headers, NULL);
+    }
+    else if (strcmp(method, "PLAY") == 0) {
+        if (!s->stats.tcp && s->rtp_sock < 0) {
+            return rtsp_send_response(s, cseq, "455 Method Not Valid in This State", NULL, NULL);
+        }
+        uint32_t rtptime = rtp_jpeg_timestamp(&s->rtp, esp_timer_get_time());
+        snprintf(headers,
+                 sizeof(headers),
+                 "Session: %08lX\r\nRange: npt=0.000-\r\nRTP-Info: url=%strack1;seq=%u;rtptime=%lu\r\n",
+                 (unsigned long)s->stats.session_id,
+                 s->base_url,
+                 s->rtp.seq,
+                 (unsigned long)rtptime);
+        err = rtsp_send_response(s, cseq, "200 OK", headers, NULL);
+        if (err == ESP_OK && !s->stats.playing) {
+            s->play_us = esp_timer_get_time();
+            s->busy_cycles = 0;
+            s->last_seq = frame_slot_latest_seq(NULL);  // 从下一帧开始发送
+            s->stats.setup_us = (uint32_t)(s->play_us - s->accept_us);
+            s->stats.playing = true;
+            ESP_LOGI(TAG, "会话 %08lX 开始播放 (%s), 建立耗时 %lu us", (unsigned long)s->stats.session_id, s->stats.tcp ? "TCP交织" : "UDP", (unsigned long)s->stats.setup_us);
+        }
+    }
+    else if (strcmp(method, "TEARDOWN") == 0) {
+        snprintf(headers, sizeof(headers), "Session: %08lX\r\n", (unsigned long)s->stats.session_id);
+        rtsp_send_response(s, cseq, "200 OK", headers, NULL);
+        return ESP_FAIL;
+    }
+    else if (strcmp(method, "GET_PARAMETER") == 0 || strcmp(method, "SET_PARAMETER") == 0) {
+        // 客户端保活
+        snprintf(headers, sizeof(headers), "Session: %08lX\r\n", (unsigned long)s->stats.session_id);
+        err = rtsp_send_response(s, cseq, "200 OK", headers, NULL);
+    }
+    else {
+        err = rtsp_send_response(s, cseq, "501 Not Implemented", NULL, NULL);
+    }
+
+    return err == ESP_OK ? ESP_OK : ESP_FAIL;
+}
+
+/**
+ * @brief 发送一个RTP包，UDP发送缓冲区满时退避重试
+ */
+static ssize_t rtsp_send_packet(rtsp_session_t* s, struct iovec* iov, int iovcnt)
+{
+    if (s->stats.tcp) {
+        return send_all_iov(s->sock, iov, iovcnt);
+    }
+
+    struct msghdr msg = {
+        .msg_name = &s->rtp_dest,
+        .msg_namelen = sizeof(s->rtp_dest),
+        .msg_iov = iov,
+        .msg_iovlen = iovcnt,
+    };
+    for (int retry = 0;; retry++) {
+        ssize_t sent = sendmsg(s->rtp_sock, &msg, 0);
+        if (sent >= 0 || errno != ENOMEM || retry >= RTSP_SEND_RETRY_MAX) {
+            return sent;
+        }
+        udp_pacer_backoff(&s->pacer, RTSP_SEND_BACKOFF_US);
+    }
+}
+
+/**
+ * @brief 按 RFC 2435 分包发送一帧；负载指向帧槽中的数据，不拷贝
+ * @return ESP_OK; 发送失败返回 ESP_FAIL
+ */
+static esp_err_t rtsp_send_frame(rtsp_session_t* s, const frame_slot_frame_t* frame)
+{
+    rtp_jpeg_frame_t jpeg;
+    if (rtp_jpeg_parse(frame->data, frame->len, &jpeg) != ESP_OK) {
+        s->stats.skipped++;
+        return ESP_OK;
+    }
+
+    uint32_t rtp_timestamp = rtp_jpeg_timestamp(&s->rtp, frame->timestamp_us);
+    uint8_t header[4 + RTP_JPEG_MAX_HEADER_SIZE];  // TCP交织头 + RTP/JPEG 头
+    uint64_t cycles = 0;
+    size_t offset = 0;
+
+    while (offset < jpeg.scan_len) {
+        uint32_t start_cycles = esp_cpu_get_cycle_count();
+        size_t header_size = rtp_jpeg_header_size(&jpeg, offset);
+        size_t max_payload = RTSP_MAX_PACKET - header_size;
+        size_t payload_size = (jpeg.scan_len - offset > max_payload) ? max_payload : jpeg.scan_len - offset;
+        size_t packet_size = header_size + payload_size;
+
+        rtp_jpeg_encode_header(&s->rtp, &jpeg, rtp_timestamp, offset, payload_size, header + 4);
+        struct iovec iov[2] = {
+            {.iov_base = header + 4, .iov_len = header_size},
+            {.iov_base = (void*)(jpeg.scan + offset), .iov_len = payload_size},
+        };
+        if (s->stats.tcp) {
+            header[0] = '$';
+            header[1] = s->channel;
+            put_u16(header + 2, (uint16_t)packet_size);
+            iov[0].iov_base = header;
+            iov[0].iov_len += 4;
+        }
+        cycles += (uint32_t)(esp_cpu_get_cycle_count() - start_cycles);
+
+        // 会话码率预算
+        udp_pacer_wait(&s->pacer, packet_size);
+
+        start_cycles = esp_cpu_get_cycle_count();
+        ssize_t sent = rtsp_send_packet(s, iov, 2);
+        cycles += (uint32_t)(esp_cpu_get_cycle_count() - start_cycles);
+        if (sent < 0) {
+            s->stats.send_errors++;
+            ESP_LOGW(TAG, "会话 %08lX 发送失败: errno %d", (unsigned long)s->stats.session_id, errno);
+            return ESP_FAIL;
+        }
+
+        s->stats.packets++;
+        s->stats.bytes += sent;
+        offset += payload_size;
+    }
+
+    s->busy_cycles += cycles;
+    s->stats.frames++;
+    s->stats.cycles_per_frame = (s->stats.cycles_per_frame == 0) ? (uint32_t)cycles : (uint32_t)((s->stats.cycles_per_frame * 7ULL + cycles) / 8);
+    int64_t elapsed_us = esp_timer_get_time() - s->play_us;
+    if (elapsed_us > 0) {
+        s->stats.cpu_permille = (uint16_t)(s->busy_cycles * 1000 / ((uint64_t)elapsed_us * esp_rom_get_cpu_ticks_per_us()));
+    }
+    if (s->stats.frames == 1) {
+        s->stats.first_frame_us = (uint32_t)(esp_timer_get_time() - s->accept_us);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 会话任务：处理RTSP请求，PLAY 后从最新帧槽取帧发送
+ *
+ * @param arg 会话
+ */
+static void rtsp_session_task(void* arg)
+{
+    rtsp_session_t* s = (rtsp_session_t*)arg;
+    char peer[16];
+    inet_ntoa_r(s->stats.peer.sin_addr, peer, sizeof(peer));
+    ESP_LOGI(TAG, "会话 %08lX 来自 %s", (unsigned long)s->stats.session_id, peer);
+
+    while (s_running) {
+        size_t head_len;
+        size_t msg_len;
+        int ret = rtsp_read_request(s, !s->stats.playing, &head_len, &msg_len);
+        if (ret < 0) {
+            break;
+        }
+        if (ret > 0) {
+            s->rx[head_len] = '\0';
+            esp_err_t err = rtsp_handle_request(s, s->rx);
+            memmove(s->rx, s->rx + msg_len, s->rx_len - msg_len);
+            s->rx_len -= msg_len;
+            if (err != ESP_OK) {
+                break;
+            }
+            continue;
+        }
+
+        // UDP传输时控制连接可能长时间空闲，按 Session timeout 回收
+        if (!s->stats.tcp && esp_timer_get_time() - s->last_request_us > RTSP_SESSION_TIMEOUT_S * 1000000LL) {
+            ESP_LOGW(TAG, "会话 %08lX 超时", (unsigned long)s->stats.session_id);
+            break;
+        }
+        if (!s->stats.playing) {
+            continue;
+        }
+
+        // 每次取最新一帧，发送慢的会话自然跳过中间的帧
+        const frame_slot_frame_t* frame = frame_slot_acquire(s->last_seq, pdMS_TO_TICKS(RTSP_FRAME_TIMEOUT_MS));
+        if (frame == NULL) {
+            continue;
+        }
+        if (s->last_seq != 0 && frame->seq > s->last_seq + 1) {
+            s->stats.skipped += frame->seq - s->last_seq - 1;
+        }
+        s->last_seq = frame->seq;
+        esp_err_t err = rtsp_send_frame(s, frame);
+        frame_slot_release(frame);
+        if (err != ESP_OK) {
+            break;
+        }
+    }
+
+    ESP_LOGI(TAG,
+             "会话 %08lX 结束: 建立 %lu us, 首帧 %lu us, 发送 %lu 帧 / 跳过 %lu 帧, %llu bytes, 每帧 %lu 周期, CPU %u.%u%%",
+             (unsigned long)s->stats.session_id,
+             (unsigned long)s->stats.setup_us,
+             (unsigned long)s->stats.first_frame_us,
+             (unsigned long)s->stats.frames,
+             (unsigned long)s->stats.skipped,
+             (unsigned long long)s->stats.bytes,
+             (unsigned long)s->stats.cycles_per_frame,
+             s->stats.cpu_permille / 10,
+             s->stats.cpu_permille % 10);
+
+    close(s->sock);
+    if (s->rtp_sock >= 0) {
+        close(s->rtp_sock);
+    }
+    if (s->pacer_initialized) {
+        udp_pacer_deinit(&s->pacer);
+    }
+    taskENTER_CRITICAL(&s_lock);
+    s->used = false;
+    s_active_sessions--;
+    taskEXIT_CRITICAL(&s_lock);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 监听任务：接受连接并为每个连接创建会话任务
+ *
+ * @param arg 未使用
+ */
+static void rtsp_server_task(void* arg)
+{
+    int listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_sock < 0) {
+        ESP_LOGE(TAG, "创建RTSP socket失败: errno %d", errno);
+        goto exit;
+    }
+    int reuse = 1;
+    setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct timeval timeout = {.tv_sec = RTSP_ACCEPT_TIMEOUT_MS / 1000, .tv_usec = (RTSP_ACCEPT_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(listen_sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(CONFIG_RTSP_SERVER_PORT), .sin_addr.s_addr = htonl(INADDR_ANY)};
+    if (bind(listen_sock, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_sock, 2) < 0) {
+        ESP_LOGE(TAG, "监听端口 %d 失败: errno %d", CONFIG_RTSP_SERVER_PORT, errno);
+        close(listen_sock);
+        goto exit;
+    }
+    ESP_LOGI(TAG, "RTSP服务器启动: rtsp://<设备IP>:%d/ , 最多 %d 个会话", CONFIG_RTSP_SERVER_PORT, RTSP_SERVER_MAX_SESSIONS);
+
+    while (s_running) {
+        struct sockaddr_in peer;
+        socklen_t peer_len = sizeof(peer);
+        int sock = accept(listen_sock, (struct sockaddr*)&peer, &peer_len);
+        if (sock < 0) {
+            continue;  // 超时，检查停止标志
+        }
+        int64_t accept_us = esp_timer_get_time();
+
+        rtsp_session_t* s = NULL;
+        taskENTER_CRITICAL(&s_lock);
+        for (int i = 0; i < RTSP_SERVER_MAX_SESSIONS; i++) {
+            if (!s_sessions[i].used) {
+                s = &s_sessions[i];
+                s->used = true;
+                s_active_sessions++;
+                break;
+            }
+        }
+        taskEXIT_CRITICAL(&s_lock);
+        if (s == NULL) {
+            static const char busy[] = "RTSP/1.0 453 Not Enough Bandwidth\r\n\r\n";
+            send(sock, busy, sizeof(busy) - 1, 0);
+            close(sock);
+            ESP_LOGW(TAG, "会话已满，拒绝连接");
+            continue;
+        }
+
+        memset(&s->stats, 0, sizeof(s->stats));
+        s->used = true;
+        s->sock = sock;
+        s->rtp_sock = -1;
+        s->rx_len = 0;
+        s->rx_skip = 0;
+        s->accept_us = accept_us;
+        s->last_request_us = accept_us;
+        s->last_seq = 0;
+        s->base_url[0] = '\0';
+        s->stats.peer = peer;
+        s->stats.session_id = esp_random();
+        rtp_jpeg_session_init(&s->rtp, esp_random(), (uint16_t)esp_random(), esp_random());
+
+        udp_pacer_config_t pacer_config = {.target_bps = CONFIG_RTSP_SESSION_KBPS * 1000, .burst_bytes = RTSP_BURST_BYTES};
+        s->pacer_initialized = (udp_pacer_init(&s->pacer, &pacer_config) == ESP_OK);
+
+        // 接收超时用于轮询停止标志；发送超时避免停滞的TCP客户端阻塞会话任务
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        struct timeval send_timeout = {.tv_sec = RTSP_SEND_TIMEOUT_S, .tv_usec = 0};
+        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+        int nodelay = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        if (xTaskCreate(rtsp_session_task, "rtsp_session", 6144, s, 3, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "创建会话任务失败");
+            close(sock);
+            if (s->pacer_initialized) {
+                udp_pacer_deinit(&s->pacer);
+            }
+            taskENTER_CRITICAL(&s_lock);
+            s->used = false;
+            s_active_sessions--;
+            taskEXIT_CRITICAL(&s_lock);
+        }
+    }
+
+    close(listen_sock);
+exit:
+    s_server_task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t rtsp_server_start(void)
+{
+#if CONFIG_RTSP_SERVER
+    if (s_server_task != NULL) {
+        return ESP_OK;
+    }
+    s_running = true;
+    if (xTaskCreate(rtsp_server_task, "rtsp_server", 4096, NULL, 3, &s_server_task) != pdPASS) {
+        s_running = false;
+        s_server_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void rtsp_server_stop(void)
+{
+    if (s_server_task == NULL && s_active_sessions == 0) {
+        return;
+    }
+    s_running = false;
+    for (int waited = 0; (s_server_task != NULL || s_active_sessions > 0) && waited < RTSP_STOP_TIMEOUT_MS; waited += 50) {
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    ESP_LOGI(TAG, "RTSP服务器已停止");
+}
+
+uint32_t rtsp_server_get_sessions(rtsp_session_stats_t* stats)
+{
+    uint32_t count = 0;
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < RTSP_SERVER_MAX_SESSIONS; i++) {
+        if (s_sessions[i].used) {
+            stats[count++] = s_sessions[i].stats;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return count;
+}
@@ -0,0 +1,72 @@
+/*
+ * rtsp_server.h
+ * 轻量RTSP服务器 - OPTIONS/DESCRIBE/SETUP/PLAY/TEARDOWN，RTP/JPEG 经 UDP 或 TCP 交织通道发送
+ *
+ * 与UDP推流并存，帧来自采集任务发布到最新帧槽 (frame_slot.h) 的同一批帧，不额外取帧。
+ * 每个会话一个任务、一个独立的发送节拍器（会话码率预算），慢会话只会跳帧。
+ */
+
+#ifndef RTSP_SERVER_H
+#define RTSP_SERVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lwip/sockets.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RTSP_SERVER_MAX_SESSIONS CONFIG_RTSP_MAX_SESSIONS
+
+// 占用的 lwIP 套接字：监听 socket、每个会话的RTSP连接与RTP socket，以及会话满时被拒绝的一个临时连接
+#if CONFIG_RTSP_SERVER
+#define RTSP_SERVER_SOCKETS (2 + 2 * RTSP_SERVER_MAX_SESSIONS)
+#else
+#define RTSP_SERVER_SOCKETS 0
+#endif
+
+/**
+ * @brief 单个会话的统计信息
+ */
+typedef struct
+{
+    uint32_t session_id;       // RTSP Session 标识
+    struct sockaddr_in peer;   // 客户端地址
+    bool tcp;                  // true: TCP 交织通道, false: RTP over UDP
+    bool playing;              // 是否已 PLAY
+    uint32_t setup_us;         // 从 TCP 建连到 PLAY 应答的耗时
+    uint32_t first_frame_us;   // 从 TCP 建连到第一帧发完的耗时
+    uint32_t frames;           // 发送的帧数
+    uint32_t skipped;          // 因发送慢而跳过的帧数
+    uint32_t packets;          // 发送的RTP包数
+    uint64_t bytes;            // 发送的字节数（含RTP头）
+    uint32_t send_errors;      // 发送错误次数
+    uint32_t cycles_per_frame; // 每帧分包与发送消耗的CPU周期（滑动平均，不含节拍等待）
+    uint16_t cpu_permille;     // 会话发送占用的CPU（千分比，按单核计）
+} rtsp_session_stats_t;
+
+/**
+ * @brief 启动RTSP服务器（已启动时直接返回）
+ * @return esp_err_t
+ */
+esp_err_t rtsp_server_start(void);
+
+/**
+ * @brief 停止RTSP服务器并结束所有会话
+ */
+void rtsp_server_stop(void);
+
+/**
+ * @brief 获取当前会话的统计信息
+ * @param stats 输出数组，至少 RTSP_SERVER_MAX_SESSIONS 个元素
+ * @return 会话个数
+ */
+uint32_t rtsp_server_get_sessions(rtsp_session_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTSP_SERVER_H */
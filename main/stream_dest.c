@@ -0,0 +1,465 @@
+/*
+ * stream_dest.c
+ * 图像流目标地址表实现
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_netif.h"
+#include "nvs.h"
+#include "lwip/inet.h"
+
+#include "stream_dest.h"
+
+static const char* TAG = "STREAM_DEST";
+
+#define STREAM_DEST_NAMESPACE "stream_dest"
+#define STREAM_DEST_TABLE_KEY "table"
+#define STREAM_DEST_MULTICAST_KEY "multicast"
+
+/**
+ * @brief NVS中保存的目标记录
+ */
+typedef struct
+{
+    uint32_t ip;    // 网络字节序
+    uint16_t port;  // 主机字节序
+    uint16_t reserved;
+} stream_dest_record_t;
+
+/**
+ * @brief NVS中保存的组播配置
+ */
+typedef struct
+{
+    uint32_t group;  // 网络字节序
+    uint16_t port;   // 主机字节序
+    uint8_t ttl;
+    uint8_t enabled;
+} stream_dest_multicast_record_t;
+
+typedef struct
+{
+    bool used;
+    stream_dest_info_t info;
+} stream_dest_slot_t;
+
+/**
+ * @brief 组播模式下的活跃接收端
+ */
+typedef struct
+{
+    uint32_t ip;      // 网络字节序，0 表示空
+    int64_t seen_us;  // 最近一次接收报告的时间
+} stream_dest_receiver_t;
+
+static stream_dest_slot_t s_slots[STREAM_DEST_MAX];
+static stream_dest_receiver_t s_receivers[STREAM_DEST_RECEIVER_MAX];
+static stream_dest_multicast_t s_multicast;
+static stream_dest_stats_t s_multicast_stats;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief 查找目标位置，调用者需持有锁
+ */
+static int find_slot_locked(uint32_t ip, uint16_t port)
+{
+    for (int i = 0; i < STREAM_DEST_MAX; i++) {
+        if (s_slots[i].used && s_slots[i].info.addr.sin_addr.s_addr == ip && s_slots[i].info.addr.sin_port == htons(port)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 填入一个空位置，调用者需持有锁
+ */
+static int add_slot_locked(uint32_t ip, uint16_t port)
+{
+    int slot = find_slot_locked(ip, port);
+    if (slot >= 0) {
+        return slot;
+    }
+    for (int i = 0; i < STREAM_DEST_MAX; i++) {
+        if (!s_slots[i].used) {
+            memset(&s_slots[i], 0, sizeof(s_slots[i]));
+            s_slots[i].used = true;
+            s_slots[i].info.addr.sin_family = AF_INET;
+            s_slots[i].info.addr.sin_port = htons(port);
+            s_slots[i].info.addr.sin_addr.s_addr = ip;
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 把当前目标表写入NVS
+ */
+static esp_err_t stream_dest_save(void)
+{
+    stream_dest_record_t records[STREAM_DEST_MAX];
+    stream_dest_multicast_record_t multicast;
+    size_t count = 0;
+
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < STREAM_DEST_MAX; i++) {
+        if (s_slots[i].used) {
+            records[count].ip = s_slots[i].info.addr.sin_addr.s_addr;
+            records[count].port = ntohs(s_slots[i].info.addr.sin_port);
+            records[count].reserved = 0;
+            count++;
+        }
+    }
+    multicast.group = s_multicast.group;
+    multicast.port = s_multicast.port;
+    multicast.ttl = s_multicast.ttl;
+    multicast.enabled = s_multicast.enabled;
+    taskEXIT_CRITICAL(&s_lock);
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(STREAM_DEST_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // 空表也写入（长度为0的blob），区分“已清空”与“从未配置”
+    err = nvs_set_blob(nvs_handle, STREAM_DEST_TABLE_KEY, records, count * sizeof(stream_dest_record_t));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "nvs_set_blob(table) failed: %s", esp_err_to_name(err));
+        nvs_close(nvs_handle);
+        return err;
+    }
+
+    err = nvs_set_blob(nvs_handle, STREAM_DEST_MULTICAST_KEY, &multicast, sizeof(multicast));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "nvs_set_blob(multicast) failed: %s", esp_err_to_name(err));
+        nvs_close(nvs_handle);
+        return err;
+    }
+
+    err = nvs_commit(nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "nvs_commit failed: %s", esp_err_to_name(err));
+    }
+    nvs_close(nvs_handle);
+    return err;
+}
+
+esp_err_t stream_dest_init(void)
+{
+    stream_dest_record_t records[STREAM_DEST_MAX];
+    stream_dest_multicast_record_t multicast;
+    size_t len = sizeof(records);
+    size_t multicast_len = sizeof(multicast);
+    bool loaded = false;
+    bool multicast_loaded = false;
+
+    // 组播默认配置
+    struct in_addr group;
+    if (inet_aton(CONFIG_UDP_MULTICAST_GROUP, &group) == 0) {
+        group.s_addr = 0;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    memset(s_slots, 0, sizeof(s_slots));
+    memset(&s_multicast_stats, 0, sizeof(s_multicast_stats));
+    s_multicast.enabled = CONFIG_UDP_MULTICAST_ENABLE && group.s_addr != 0;
+    s_multicast.group = group.s_addr;
+    s_multicast.port = CONFIG_UDP_MULTICAST_PORT;
+    s_multicast.ttl = CONFIG_UDP_MULTICAST_TTL;
+    taskEXIT_CRITICAL(&s_lock);
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(STREAM_DEST_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (err == ESP_OK) {
+        err = nvs_get_blob(nvs_handle, STREAM_DEST_TABLE_KEY, records, &len);
+        if (err == ESP_OK) {
+            loaded = true;
+        }
+        else if (err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "nvs_get_blob(table) failed: %s", esp_err_to_name(err));
+        }
+        err = nvs_get_blob(nvs_handle, STREAM_DEST_MULTICAST_KEY, &multicast, &multicast_len);
+        if (err == ESP_OK && multicast_len == sizeof(multicast)) {
+            multicast_loaded = true;
+        }
+        else if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "nvs_get_blob(multicast) failed: %s", esp_err_to_name(err));
+        }
+        nvs_close(nvs_handle);
+    }
+
+    if (multicast_loaded) {
+        taskENTER_CRITICAL(&s_lock);
+        s_multicast.enabled = multicast.enabled;
+        s_multicast.group = multicast.group;
+        s_multicast.port = multicast.port;
+        s_multicast.ttl = multicast.ttl;
+        taskEXIT_CRITICAL(&s_lock);
+    }
+    if (s_multicast.enabled) {
+        struct in_addr addr = {.s_addr = s_multicast.group};
+        ESP_LOGI(TAG, "组播模式: %s:%d, TTL %d", inet_ntoa(addr), s_multicast.port, s_multicast.ttl);
+    }
+
+    if (loaded) {
+        taskENTER_CRITICAL(&s_lock);
+        for (size_t i = 0; i < len / sizeof(stream_dest_record_t); i++) {
+            add_slot_locked(records[i].ip, records[i].port);
+        }
+        taskEXIT_CRITICAL(&s_lock);
+        ESP_LOGI(TAG, "从NVS加载了 %u 个目标", (unsigned)(len / sizeof(stream_dest_record_t)));
+    }
+    else {
+        struct in_addr addr;
+        if (inet_aton(CONFIG_UDP_STREAM_DEFAULT_DEST_IP, &addr) == 0) {
+            ESP_LOGE(TAG, "默认目标地址无效: %s", CONFIG_UDP_STREAM_DEFAULT_DEST_IP);
+            return ESP_ERR_INVALID_ARG;
+        }
+        taskENTER_CRITICAL(&s_lock);
+        add_slot_locked(addr.s_addr, CONFIG_UDP_STREAM_DEFAULT_DEST_PORT);
+        taskEXIT_CRITICAL(&s_lock);
+        ESP_LOGI(TAG, "使用默认目标 %s:%d", CONFIG_UDP_STREAM_DEFAULT_DEST_IP, CONFIG_UDP_STREAM_DEFAULT_DEST_PORT);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t stream_dest_add(uint32_t ip, uint16_t port)
+{
+    if (ip == 0 || port == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    bool existed = find_slot_locked(ip, port) >= 0;
+    int slot = add_slot_locked(ip, port);
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (slot < 0) {
+        ESP_LOGW(TAG, "目标表已满 (%d)", STREAM_DEST_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+    if (existed) {
+        return ESP_OK;
+    }
+
+    struct in_addr addr = {.s_addr = ip};
+    ESP_LOGI(TAG, "添加目标 %s:%d", inet_ntoa(addr), port);
+    return stream_dest_save();
+}
+
+esp_err_t stream_dest_remove(uint32_t ip, uint16_t port)
+{
+    taskENTER_CRITICAL(&s_lock);
+    int slot = find_slot_locked(ip, port);
+    if (slot >= 0) {
+        s_slots[slot].used = false;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (slot < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    struct in_addr addr = {.s_addr = ip};
+    ESP_LOGI(TAG, "删除目标 %s:%d", inet_ntoa(addr), port);
+    return stream_dest_save();
+}
+
+esp_err_t stream_dest_clear(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < STREAM_DEST_MAX; i++) {
+        s_slots[i].used = false;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    ESP_LOGI(TAG, "清空目标表");
+    return stream_dest_save();
+}
+
+/**
+ * @brief 判断是否为IPv4组播地址 (224.0.0.0/4)
+ */
+static bool is_multicast_addr(uint32_t ip)
+{
+    return (ntohl(ip) & 0xF0000000U) == 0xE0000000U;
+}
+
+esp_err_t stream_dest_set_multicast(const stream_dest_multicast_t* config)
+{
+    if (config == NULL || config->ttl == 0 || (config->enabled && (!is_multicast_addr(config->group) || config->port == 0))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    bool group_changed = s_multicast.group != config->group || s_multicast.port != config->port;
+    s_multicast = *config;
+    if (group_changed) {
+        memset(&s_multicast_stats, 0, sizeof(s_multicast_stats));
+        memset(s_receivers, 0, sizeof(s_receivers));
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    struct in_addr addr = {.s_addr = config->group};
+    ESP_LOGI(TAG, "组播模式%s: %s:%d, TTL %d", config->enabled ? "开启" : "关闭", inet_ntoa(addr), config->port, config->ttl);
+    return stream_dest_save();
+}
+
+void stream_dest_get_multicast(stream_dest_multicast_t* config, stream_dest_stats_t* stats)
+{
+    taskENTER_CRITICAL(&s_lock);
+    *config = s_multicast;
+    if (stats != NULL) {
+        *stats = s_multicast_stats;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void stream_dest_snapshot(stream_dest_list_t* list)
+{
+    list->count = 0;
+    list->multicast_ttl = 0;
+    taskENTER_CRITICAL(&s_lock);
+    if (s_multicast.enabled) {
+        // 组播模式：一次发送覆盖所有接收端
+        memset(&list->addr[0], 0, sizeof(list->addr[0]));
+        list->addr[0].sin_family = AF_INET;
+        list->addr[0].sin_port = htons(s_multicast.port);
+        list->addr[0].sin_addr.s_addr = s_multicast.group;
+        list->slot[0] = STREAM_DEST_MULTICAST_SLOT;
+        list->multicast_ttl = s_multicast.ttl;
+        list->count = 1;
+        taskEXIT_CRITICAL(&s_lock);
+        return;
+    }
+    for (int i = 0; i < STREAM_DEST_MAX; i++) {
+        if (s_slots[i].used) {
+            list->addr[list->count] = s_slots[i].info.addr;
+            list->slot[list->count] = i;
+            list->count++;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * @brief 按位置取统计结构，调用者需持有锁
+ */
+static stream_dest_stats_t* stats_for_slot_locked(uint8_t slot)
+{
+    if (slot == STREAM_DEST_MULTICAST_SLOT) {
+        return &s_multicast_stats;
+    }
+    return slot < STREAM_DEST_MAX ? &s_slots[slot].info.stats : NULL;
+}
+
+void stream_dest_account_frame(uint8_t slot)
+{
+    taskENTER_CRITICAL(&s_lock);
+    stream_dest_stats_t* stats = stats_for_slot_locked(slot);
+    if (stats != NULL) {
+        stats->frames++;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void stream_dest_account(uint8_t slot, ssize_t bytes, int err)
+{
+    taskENTER_CRITICAL(&s_lock);
+    stream_dest_stats_t* stats = stats_for_slot_locked(slot);
+    if (stats == NULL) {
+        taskEXIT_CRITICAL(&s_lock);
+        return;
+    }
+    if (bytes >= 0) {
+        stats->packets++;
+        stats->bytes += bytes;
+    }
+    else {
+        stats->errors++;
+        stats->last_errno = err;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * @brief 地址是否与设备 (STA) 在同一网段
+ */
+static bool is_local_subnet(uint32_t ip)
+{
+    esp_netif_t* netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    esp_netif_ip_info_t info;
+    if (netif == NULL || esp_netif_get_ip_info(netif, &info) != ESP_OK || info.ip.addr == 0) {
+        return false;
+    }
+    return (ip & info.netmask.addr) == (info.ip.addr & info.netmask.addr);
+}
+
+void stream_dest_note_receiver(const struct sockaddr_in* addr)
+{
+    uint32_t ip = addr->sin_addr.s_addr;
+    if (ip == 0 || is_multicast_addr(ip) || !is_local_subnet(ip)) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_lock);
+    if (s_multicast.enabled) {
+        // 已有的地址原地刷新，否则替换最久没有报告的一项
+        int oldest = 0;
+        for (int i = 0; i < STREAM_DEST_RECEIVER_MAX; i++) {
+            if (s_receivers[i].ip == ip) {
+                oldest = i;
+                break;
+            }
+            if (s_receivers[i].seen_us < s_receivers[oldest].seen_us) {
+                oldest = i;
+            }
+        }
+        s_receivers[oldest].ip = ip;
+        s_receivers[oldest].seen_us = now_us;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+bool stream_dest_is_receiver(const struct sockaddr_in* addr)
+{
+    uint32_t ip = addr->sin_addr.s_addr;
+    int64_t now_us = esp_timer_get_time();
+    bool found = false;
+
+    taskENTER_CRITICAL(&s_lock);
+    if (s_multicast.enabled) {
+        for (int i = 0; i < STREAM_DEST_RECEIVER_MAX && !found; i++) {
+            found = s_receivers[i].ip == ip && now_us - s_receivers[i].seen_us <= (int64_t)STREAM_DEST_RECEIVER_TIMEOUT_MS * 1000;
+        }
+    }
+    else {
+        for (int i = 0; i < STREAM_DEST_MAX && !found; i++) {
+            found = s_slots[i].used && s_slots[i].info.addr.sin_addr.s_addr == ip;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return found;
+}
+
+uint32_t stream_dest_get_info(stream_dest_info_t* infos)
+{
+    uint32_t count = 0;
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < STREAM_DEST_MAX; i++) {
+        if (s_slots[i].used) {
+            infos[count++] = s_slots[i].info;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return count;
+}
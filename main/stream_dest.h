@@ -0,0 +1,160 @@
+/*
+ * stream_dest.h
+ * 图像流目标地址表：保存在NVS中，可在运行时通过HTTP与UDP控制报文增删，
+ * 同一帧按表中的全部目标发送，并分别统计每个目标的发送情况
+ *
+ * 组播模式下只向组播组发送一份（忽略单播目标表），局域网内任意数量的接收端共享同一次发送。
+ *
+ * NACK 等会让设备向请求方发送数据的控制报文只接受来自接收端的请求（stream_dest_is_receiver()），
+ * 避免伪造源地址的小报文让设备向任意主机发送大量数据（反射放大）：单播模式下接收端是目标表中的地址，
+ * 组播模式下是最近发送过接收报告、且与设备在同一网段的地址。
+ */
+
+#ifndef STREAM_DEST_H
+#define STREAM_DEST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lwip/sockets.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STREAM_DEST_MAX CONFIG_UDP_STREAM_DEST_MAX
+#define STREAM_DEST_MULTICAST_SLOT STREAM_DEST_MAX  // 组播组的统计位置
+#define STREAM_DEST_NO_SLOT 0xFF  // 不属于目标表的地址（例如NACK请求方），不计入目标统计
+#define STREAM_DEST_RECEIVER_MAX 8             // 组播模式下记录的活跃接收端个数
+#define STREAM_DEST_RECEIVER_TIMEOUT_MS 10000  // 超过该时间没有接收报告的组播接收端不再活跃
+
+/**
+ * @brief 单个目标的发送统计
+ */
+typedef struct
+{
+    uint32_t frames;      // 开始发送的帧数
+    uint32_t packets;     // 发送成功的包数
+    uint64_t bytes;       // 发送成功的字节数
+    uint32_t errors;      // 发送失败的包数
+    int last_errno;       // 最近一次失败的 errno
+} stream_dest_stats_t;
+
+/**
+ * @brief 目标信息（地址与统计）
+ */
+typedef struct
+{
+    struct sockaddr_in addr;
+    stream_dest_stats_t stats;
+} stream_dest_info_t;
+
+/**
+ * @brief 组播配置
+ */
+typedef struct
+{
+    bool enabled;    // 是否使用组播模式
+    uint32_t group;  // 组播组地址（网络字节序，224.0.0.0/4）
+    uint16_t port;   // 组播端口（主机字节序）
+    uint8_t ttl;     // 组播TTL，1 表示不出本网段
+} stream_dest_multicast_t;
+
+/**
+ * @brief 发送任务使用的目标快照（每帧取一次，发送过程中不受表修改影响）
+ */
+typedef struct
+{
+    uint32_t count;
+    struct sockaddr_in addr[STREAM_DEST_MAX];
+    uint8_t slot[STREAM_DEST_MAX];  // 目标在表中的位置，用于记录统计
+    uint8_t multicast_ttl;          // 组播模式下的TTL，单播模式为 0
+} stream_dest_list_t;
+
+/**
+ * @brief 从NVS加载目标表，表为空时写入 Kconfig 中的默认目标
+ * @return esp_err_t
+ */
+esp_err_t stream_dest_init(void);
+
+/**
+ * @brief 添加目标（已存在时直接返回成功）并保存到NVS
+ * @param ip IPv4 地址（网络字节序）
+ * @param port 端口（主机字节序）
+ * @return esp_err_t 表满时返回 ESP_ERR_NO_MEM
+ */
+esp_err_t stream_dest_add(uint32_t ip, uint16_t port);
+
+/**
+ * @brief 删除目标并保存到NVS
+ * @param ip IPv4 地址（网络字节序）
+ * @param port 端口（主机字节序）
+ * @return esp_err_t 不存在时返回 ESP_ERR_NOT_FOUND
+ */
+esp_err_t stream_dest_remove(uint32_t ip, uint16_t port);
+
+/**
+ * @brief 清空目标表并保存到NVS
+ * @return esp_err_t
+ */
+esp_err_t stream_dest_clear(void);
+
+/**
+ * @brief 修改组播配置并保存到NVS
+ * @param config 组播配置
+ * @return esp_err_t 地址不是组播地址时返回 ESP_ERR_INVALID_ARG
+ */
+esp_err_t stream_dest_set_multicast(const stream_dest_multicast_t* config);
+
+/**
+ * @brief 获取组播配置与组播发送统计
+ * @param config 输出组播配置
+ * @param stats 输出组播发送统计，可为 NULL
+ */
+void stream_dest_get_multicast(stream_dest_multicast_t* config, stream_dest_stats_t* stats);
+
+/**
+ * @brief 获取当前目标快照
+ * @param list 输出快照
+ */
+void stream_dest_snapshot(stream_dest_list_t* list);
+
+/**
+ * @brief 记录一个目标开始发送新的一帧
+ * @param slot 目标位置
+ */
+void stream_dest_account_frame(uint8_t slot);
+
+/**
+ * @brief 记录一次发送结果
+ * @param slot 目标位置，STREAM_DEST_NO_SLOT 时忽略
+ * @param bytes 发送成功的字节数，失败时为负
+ * @param err 失败时的 errno
+ */
+void stream_dest_account(uint8_t slot, ssize_t bytes, int err);
+
+/**
+ * @brief 记录一个组播接收端（收到接收报告时调用；只在组播模式下记录与设备同一网段的地址）
+ * @param addr 报告的源地址
+ */
+void stream_dest_note_receiver(const struct sockaddr_in* addr);
+
+/**
+ * @brief 判断地址是否是当前的接收端：单播模式下 IP 在目标表中，组播模式下是活跃的组播接收端
+ * @param addr 请求的源地址
+ * @return 是接收端返回 true
+ */
+bool stream_dest_is_receiver(const struct sockaddr_in* addr);
+
+/**
+ * @brief 获取全部目标的地址与统计
+ * @param infos 输出数组，至少 STREAM_DEST_MAX 项
+ * @return 目标个数
+ */
+uint32_t stream_dest_get_info(stream_dest_info_t* infos);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STREAM_DEST_H */
@@ -0,0 +1,467 @@
+/*
+ * thumb_stream.c
+ * 缩略图流实现
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "img_converters.h"
+#include "lwip/inet.h"
+
+#include "thumb_stream.h"
+#include "frame_broker.h"
+#include "jpeg_dc.h"
+#include "image_proto.h"
+#include "stream_dest.h"
+#include "udp_pacer.h"
+
+static const char* TAG = "THUMB";
+
+#define THUMB_EMA_SHIFT 3             // 耗时统计的平滑系数 1/8
+#define THUMB_SEND_RETRY_MAX 3        // 协议栈缓冲区满时的重试次数
+#define THUMB_SEND_BACKOFF_US 2000    // 重试前的退避时间
+#define THUMB_JPEG_HEADROOM 1024      // 编码输出缓冲区在原始像素大小之外的余量（JPEG 头与霍夫曼表）
+#define THUMB_PACER_BURST_PACKETS 4   // 令牌桶容量（包）
+
+/**
+ * @brief 编码输出缓冲区
+ */
+typedef struct
+{
+    uint8_t* buf;
+    size_t size;
+    size_t len;
+} thumb_jpeg_out_t;
+
+static frame_broker_sub_t* s_sub = NULL;
+
+// 以下只由缩略图任务访问
+static jpeg_dc_t s_jpeg;
+static uint8_t* s_planes = NULL;  // 直流解码输出
+static size_t s_planes_size = 0;
+static uint8_t* s_pixels = NULL;  // 编码输入 (RGB565)
+static size_t s_pixels_size = 0;
+static uint8_t* s_jpeg_out = NULL;
+static size_t s_jpeg_out_size = 0;
+static uint8_t s_packet[IMAGE_PROTO_MAX_PACKET_SIZE];
+static int s_socket = -1;
+static uint32_t s_frame_seq = 0;
+static int64_t s_next_due_us = 0;
+static udp_pacer_t s_pacer;
+
+// 配置与统计由 s_lock 保护
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static thumb_stream_config_t s_config;
+static thumb_stream_stats_t s_stats;
+static uint64_t s_busy_cycles = 0;
+static int64_t s_start_us = 0;
+
+/**
+ * @brief 按需扩大缓冲区（优先 PSRAM），容量足够时保留原缓冲区
+ */
+static bool ensure_buffer(uint8_t** buf, size_t* size, size_t need)
+{
+    if (*size >= need) {
+        return true;
+    }
+    heap_caps_free(*buf);
+    *buf = heap_caps_malloc(need, MALLOC_CAP_SPIRAM);
+    if (*buf == NULL) {
+        *buf = malloc(need);
+    }
+    *size = (*buf != NULL) ? need : 0;
+    return *buf != NULL;
+}
+
+static void account_us(uint32_t* avg, uint32_t sample)
+{
+    if (*avg == 0) {
+        *avg = sample;
+    }
+    else {
+        *avg = (uint32_t)((int32_t)*avg + (((int32_t)sample - (int32_t)*avg) >> THUMB_EMA_SHIFT));
+    }
+}
+
+static size_t jpeg_out_write(void* arg, size_t index, const void* data, size_t len)
+{
+    thumb_jpeg_out_t* out = arg;
+    if (data == NULL) {
+        return 0;
+    }
+    if (index + len > out->size) {
+        return 0;  // 缓冲区不足，编码失败
+    }
+    memcpy(out->buf + index, data, len);
+    if (index + len > out->len) {
+        out->len = index + len;
+    }
+    return len;
+}
+
+/**
+ * @brief 平面 YCbCr（色度按 JPEG 采样因子缩小）转为大端 RGB565，色度取最近的采样点
+ */
+static void yuv_to_rgb565(const jpeg_dc_info_t* info, const uint8_t* planes, uint8_t* out)
+{
+    const uint8_t* y_plane = planes;
+    const uint8_t* cb_plane = planes + (size_t)info->width * info->height;
+    const uint8_t* cr_plane = cb_plane + (size_t)info->chroma_width * info->chroma_height;
+
+    for (uint32_t y = 0; y < info->height; y++) {
+        uint32_t cy = y * info->chroma_height / info->height;
+        for (uint32_t x = 0; x < info->width; x++) {
+            uint32_t cx = x * info->chroma_width / info->width;
+            int32_t luma = y_plane[y * info->width + x];
+            int32_t cb = cb_plane[cy * info->chroma_width + cx] - 128;
+            int32_t cr = cr_plane[cy * info->chroma_width + cx] - 128;
+            // JFIF 全范围 YCbCr，系数为 1.402、0.344、0.714、1.772 的 16 位定点
+            int32_t r = luma + ((91881 * cr) >> 16);
+            int32_t g = luma - ((22554 * cb + 46802 * cr) >> 16);
+            int32_t b = luma + ((116130 * cb) >> 16);
+            r = r < 0 ? 0 : (r > 255 ? 255 : r);
+            g = g < 0 ? 0 : (g > 255 ? 255 : g);
+            b = b < 0 ? 0 : (b > 255 ? 255 : b);
+            uint16_t pixel = (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+            *out++ = (uint8_t)(pixel >> 8);
+            *out++ = (uint8_t)pixel;
+        }
+    }
+}
+
+/**
+ * @brief 取得本帧的目标地址
+ * @return 目标个数
+ */
+static uint32_t resolve_dests(const thumb_stream_config_t* config, struct sockaddr_in* addrs)
+{
+    if (config->ip != 0) {
+        memset(&addrs[0], 0, sizeof(addrs[0]));
+        addrs[0].sin_family = AF_INET;
+        addrs[0].sin_port = htons(config->port);
+        addrs[0].sin_addr.s_addr = config->ip;
+        return 1;
+    }
+
+    stream_dest_list_t list;
+    stream_dest_snapshot(&list);
+    for (uint32_t i = 0; i < list.count; i++) {
+        addrs[i] = list.addr[i];
+        addrs[i].sin_port = htons(config->port);
+    }
+    return list.count;
+}
+
+/**
+ * @brief 按 v2 图像协议分包发送一帧缩略图
+ * @param busy_cycles 累加发送耗费的CPU周期（不含节拍等待）
+ * @return 发送的字节数
+ */
+static uint64_t send_thumbnail(const struct sockaddr_in* addrs, uint32_t count, const uint8_t* jpg, size_t len, uint64_t timestamp_us, uint32_t* busy_cycles)
+{
+    if (s_socket < 0) {
+        s_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (s_socket < 0) {
+            ESP_LOGE(TAG, "创建socket失败: errno %d", errno);
+            return 0;
+        }
+    }
+
+    const size_t max_payload = IMAGE_PROTO_V2_PAYLOAD_SIZE;
+    image_proto_chunk_t chunk = {
+        .version = IMAGE_PROTO_VERSION,
+        .frame_seq = s_frame_seq++,
+        .timestamp_us = timestamp_us,
+        .image_size = len,
+        .total_chunks = (len + max_payload - 1) / max_payload,
+    };
+
+    uint64_t bytes = 0;
+    uint32_t errors = 0;
+    for (size_t offset = 0; offset < len; offset += max_payload) {
+        size_t payload_size = (len - offset > max_payload) ? max_payload : len - offset;
+
+        uint32_t start_cycles = esp_cpu_get_cycle_count();
+        chunk.chunk_id = offset / max_payload;
+        chunk.offset = offset;
+        chunk.flags = IMAGE_PROTO_FLAG_KEYFRAME;
+        if (offset == 0) {
+            chunk.flags |= IMAGE_PROTO_FLAG_FIRST;
+        }
+        if (offset + payload_size == len) {
+            chunk.flags |= IMAGE_PROTO_FLAG_LAST;
+        }
+        esp_err_t err = image_proto_encode_header(&chunk, jpg + offset, payload_size, s_packet);
+        if (err != ESP_OK) {
+            // 包头未写入，跳过该分包（接收端按丢包处理），按每个目标一次发送失败计数
+            *busy_cycles += esp_cpu_get_cycle_count() - start_cycles;
+            ESP_LOGE(TAG, "缩略图包头编码失败 (帧 %lu, 分包 %lu/%lu): %s", (unsigned long)chunk.frame_seq, (unsigned long)chunk.chunk_id,
+                     (unsigned long)chunk.total_chunks, esp_err_to_name(err));
+            errors += count;
+            continue;
+        }
+        memcpy(s_packet + IMAGE_PROTO_V2_HEADER_SIZE, jpg + offset, payload_size);
+        size_t packet_size = IMAGE_PROTO_V2_HEADER_SIZE + payload_size;
+        *busy_cycles += esp_cpu_get_cycle_count() - start_cycles;
+
+        for (uint32_t i = 0; i < count; i++) {
+            udp_pacer_wait(&s_pacer, packet_size);
+            start_cycles = esp_cpu_get_cycle_count();
+            ssize_t sent = -1;
+            for (int retry = 0; retry <= THUMB_SEND_RETRY_MAX; retry++) {
+                sent = sendto(s_socket, s_packet, packet_size, 0, (const struct sockaddr*)&addrs[i], sizeof(addrs[i]));
+                if (sent >= 0 || errno != ENOMEM) {
+                    break;
+                }
+                udp_pacer_backoff(&s_pacer, THUMB_SEND_BACKOFF_US);
+            }
+            *busy_cycles += esp_cpu_get_cycle_count() - start_cycles;
+            if (sent >= 0) {
+                bytes += (uint64_t)sent;
+            }
+            else {
+                errors++;
+            }
+        }
+    }
+
+    if (errors > 0) {
+        taskENTER_CRITICAL(&s_lock);
+        s_stats.send_errors += errors;
+        taskEXIT_CRITICAL(&s_lock);
+    }
+    return bytes;
+}
+
+/**
+ * @brief 解码、重新编码并发送一帧；解码完成后即释放帧引用
+ */
+static void process_frame(frame_ref_t* frame, const thumb_stream_config_t* config)
+{
+    uint32_t cycles = 0;
+    uint32_t start_cycles = esp_cpu_get_cycle_count();
+    int64_t start = esp_timer_get_time();
+
+    jpeg_dc_format_t format = config->color ? JPEG_DC_YUV : JPEG_DC_GRAY;
+    jpeg_dc_info_t info = {0};
+    esp_err_t err = jpeg_dc_parse(&s_jpeg, frame->data, frame->len, &info);
+    if (err == ESP_OK) {
+        size_t need = jpeg_dc_output_size(&info, format);
+        err = ensure_buffer(&s_planes, &s_planes_size, need) ? jpeg_dc_decode(&s_jpeg, format, s_planes, need) : ESP_ERR_NO_MEM;
+    }
+    uint64_t timestamp_us = frame->timestamp_us;
+    frame_broker_release(frame);
+
+    // 彩色输出转为 RGB565，灰度 JPEG 或灰度输出直接编码亮度平面
+    uint8_t* src = s_planes;
+    size_t src_len = (size_t)info.width * info.height;
+    pixformat_t pixformat = PIXFORMAT_GRAYSCALE;
+    if (err == ESP_OK && format == JPEG_DC_YUV && info.components == 3) {
+        src_len *= 2;
+        if (ensure_buffer(&s_pixels, &s_pixels_size, src_len)) {
+            yuv_to_rgb565(&info, s_planes, s_pixels);
+            src = s_pixels;
+            pixformat = PIXFORMAT_RGB565;
+        }
+        else {
+            err = ESP_ERR_NO_MEM;
+        }
+    }
+    int64_t decoded = esp_timer_get_time();
+
+    thumb_jpeg_out_t out = {0};
+    bool encoded_ok = false;
+    if (err == ESP_OK && ensure_buffer(&s_jpeg_out, &s_jpeg_out_size, src_len + THUMB_JPEG_HEADROOM)) {
+        out.buf = s_jpeg_out;
+        out.size = s_jpeg_out_size;
+        encoded_ok = fmt2jpg_cb(src, src_len, info.width, info.height, pixformat, config->quality, jpeg_out_write, &out);
+    }
+    int64_t encoded = esp_timer_get_time();
+    cycles += esp_cpu_get_cycle_count() - start_cycles;
+
+    if (!encoded_ok) {
+        taskENTER_CRITICAL(&s_lock);
+        s_stats.failures++;
+        s_busy_cycles += cycles;
+        taskEXIT_CRITICAL(&s_lock);
+        ESP_LOGD(TAG, "缩略图生成失败: %s", esp_err_to_name(err));
+        return;
+    }
+
+    struct sockaddr_in addrs[STREAM_DEST_MAX];
+    uint32_t count = resolve_dests(config, addrs);
+    uint64_t bytes = send_thumbnail(addrs, count, out.buf, out.len, timestamp_us, &cycles);
+    int64_t done = esp_timer_get_time();
+
+    udp_pacer_stats_t pacer;
+    udp_pacer_get_stats(&s_pacer, &pacer);
+
+    taskENTER_CRITICAL(&s_lock);
+    if (bytes > 0) {
+        s_stats.sent++;
+    }
+    s_stats.bytes += bytes;
+    s_stats.achieved_bps = pacer.achieved_bps;
+    s_stats.width = info.width;
+    s_stats.height = info.height;
+    s_stats.last_size = out.len;
+    account_us(&s_stats.decode_avg_us, (uint32_t)(decoded - start));
+    account_us(&s_stats.encode_avg_us, (uint32_t)(encoded - decoded));
+    account_us(&s_stats.send_avg_us, (uint32_t)(done - encoded));
+    s_stats.cycles_per_frame = (s_stats.cycles_per_frame == 0) ? cycles : (uint32_t)((s_stats.cycles_per_frame * 7ULL + cycles) / 8);
+    s_busy_cycles += cycles;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * @brief 按帧率上限放行，保持固定的发送节奏
+ */
+static bool rate_admit(int64_t now, uint8_t fps)
+{
+    if (fps == 0 || now < s_next_due_us) {
+        return false;
+    }
+    int64_t interval = 1000000 / fps;
+    s_next_due_us += interval;
+    if (s_next_due_us <= now) {
+        s_next_due_us = now + interval;
+    }
+    return true;
+}
+
+static void thumb_task(void* arg)
+{
+    for (;;) {
+        frame_ref_t* frame = frame_broker_pop(s_sub, portMAX_DELAY);
+        if (frame == NULL) {
+            continue;
+        }
+
+        thumb_stream_config_t config;
+        taskENTER_CRITICAL(&s_lock);
+        config = s_config;
+        taskEXIT_CRITICAL(&s_lock);
+
+        if (!config.enabled || !rate_admit(esp_timer_get_time(), config.fps)) {
+            frame_broker_release(frame);
+            if (config.enabled) {
+                taskENTER_CRITICAL(&s_lock);
+                s_stats.rate_skipped++;
+                taskEXIT_CRITICAL(&s_lock);
+            }
+            continue;
+        }
+        process_frame(frame, &config);
+    }
+}
+
+static bool config_valid(const thumb_stream_config_t* config)
+{
+    return config->port != 0 && config->fps >= 1 && config->fps <= 30 && config->quality >= 1 && config->quality <= 100;
+}
+
+esp_err_t thumb_stream_init(void)
+{
+    if (s_sub != NULL) {
+        return ESP_OK;
+    }
+
+    thumb_stream_config_t config = {
+        .enabled = true,
+        .ip = 0,
+        .port = CONFIG_THUMB_STREAM_PORT,
+        .fps = CONFIG_THUMB_STREAM_FPS,
+        .max_bps = CONFIG_THUMB_STREAM_KBPS * 1000,
+        .quality = CONFIG_THUMB_STREAM_QUALITY,
+#if CONFIG_THUMB_STREAM_COLOR
+        .color = true,
+#else
+        .color = false,
+#endif
+    };
+    s_config = config;
+
+    udp_pacer_config_t pacer_config = {
+        .target_bps = config.max_bps,
+        .burst_bytes = THUMB_PACER_BURST_PACKETS * IMAGE_PROTO_MAX_PACKET_SIZE,
+    };
+    if (udp_pacer_init(&s_pacer, &pacer_config) != ESP_OK) {
+        ESP_LOGW(TAG, "节拍器定时器创建失败，退化为忙等节拍");
+    }
+
+    s_sub = frame_broker_subscribe("thumb", 1, FRAME_BROKER_DROP_NEWEST);
+    if (s_sub == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    frame_broker_set_optional(s_sub);
+    s_start_us = esp_timer_get_time();
+    if (xTaskCreate(thumb_task, "thumb_task", 4096, NULL, 2, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "创建缩略图任务失败");
+        frame_broker_unsubscribe(s_sub);
+        s_sub = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "缩略图流启动: 端口 %u, %u fps, %lu kbit/s, 质量 %u, %s", config.port, config.fps, (unsigned long)CONFIG_THUMB_STREAM_KBPS, config.quality, config.color ? "彩色" : "灰度");
+    return ESP_OK;
+}
+
+esp_err_t thumb_stream_set_config(const thumb_stream_config_t* config)
+{
+    if (s_sub == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config == NULL || !config_valid(config)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    bool rate_changed = config->max_bps != s_config.max_bps;
+    s_config = *config;
+    taskEXIT_CRITICAL(&s_lock);
+    if (rate_changed) {
+        udp_pacer_set_rate(&s_pacer, config->max_bps, THUMB_PACER_BURST_PACKETS * IMAGE_PROTO_MAX_PACKET_SIZE);
+    }
+
+    ESP_LOGI(TAG, "缩略图流%s: 端口 %u, %u fps, %lu bit/s, 质量 %u, %s", config->enabled ? "开启" : "关闭", config->port, config->fps, (unsigned long)config->max_bps, config->quality,
+             config->color ? "彩色" : "灰度");
+    return ESP_OK;
+}
+
+void thumb_stream_get(thumb_stream_config_t* config, thumb_stream_stats_t* stats)
+{
+    if (s_sub == NULL) {
+        if (config != NULL) {
+            memset(config, 0, sizeof(*config));
+        }
+        if (stats != NULL) {
+            memset(stats, 0, sizeof(*stats));
+        }
+        return;
+    }
+
+    frame_broker_sub_stats_t sub;
+    frame_broker_get_sub_stats(s_sub, &sub);
+    int64_t elapsed_us = esp_timer_get_time() - s_start_us;
+
+    taskENTER_CRITICAL(&s_lock);
+    if (config != NULL) {
+        *config = s_config;
+    }
+    if (stats != NULL) {
+        *stats = s_stats;
+        stats->busy_skipped = sub.rejected;
+        if (elapsed_us > 0) {
+            stats->cpu_permille = (uint16_t)(s_busy_cycles * 1000 / ((uint64_t)elapsed_us * esp_rom_get_cpu_ticks_per_us()));
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
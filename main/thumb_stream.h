@@ -0,0 +1,89 @@
+/*
+ * thumb_stream.h
+ * 缩略图流 - 帧分发的订阅者，用 jpeg_dc 取 1/8 缩略图后重新编码为小 JPEG，按自己的帧率与码率上限发往单独的端口
+ *
+ * 与主图像流并行：主流保持全分辨率用于录像，缩略图流供监控墙预览。
+ * 缩略图流使用 v2 图像协议 (image_proto.h)，有独立的 socket、帧序号与令牌桶节拍器，不做 FEC 与重传，
+ * 可用 udp_image_receiver.py --port <缩略图端口> 接收。
+ * 只在解码时持有相机帧缓冲；作为可选订阅者，空闲帧缓冲不足时收不到帧，缩略图流的帧率随之降低。
+ */
+
+#ifndef THUMB_STREAM_H
+#define THUMB_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 占用的 lwIP 套接字：一个UDP socket
+#if CONFIG_THUMB_STREAM
+#define THUMB_STREAM_SOCKETS 1
+#else
+#define THUMB_STREAM_SOCKETS 0
+#endif
+
+/**
+ * @brief 缩略图流配置
+ */
+typedef struct
+{
+    bool enabled;
+    uint32_t ip;       // 目标地址（网络字节序），0 表示发往主图像流的每个目标（组播模式下为组播组）
+    uint16_t port;     // 目标端口
+    uint8_t fps;       // 帧率上限
+    uint32_t max_bps;  // 码率上限 (bit/s)，0 表示不限速
+    uint8_t quality;   // 重新编码的 JPEG 质量 (1-100，越大越好)
+    bool color;        // false 时输出灰度缩略图
+} thumb_stream_config_t;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct
+{
+    uint32_t sent;              // 发送的缩略图数
+    uint32_t rate_skipped;      // 超过帧率上限跳过的帧数
+    uint32_t busy_skipped;      // 编码繁忙时跳过的帧数
+    uint32_t failures;          // 解码或编码失败次数
+    uint32_t send_errors;       // socket 发送失败的包数
+    uint64_t bytes;             // 发送的字节数（含包头，按目标累计）
+    uint32_t achieved_bps;      // 节拍器统计的实际码率
+    uint16_t width;             // 最近一帧缩略图尺寸
+    uint16_t height;
+    uint32_t last_size;         // 最近一帧缩略图的 JPEG 大小
+    uint32_t decode_avg_us;     // 直流解码耗时（滑动平均）
+    uint32_t encode_avg_us;     // 重新编码耗时（滑动平均）
+    uint32_t send_avg_us;       // 发送耗时（滑动平均，含节拍等待）
+    uint32_t cycles_per_frame;  // 每帧解码、编码与发送消耗的CPU周期（滑动平均，不含节拍等待）
+    uint16_t cpu_permille;      // 缩略图流占用的CPU（千分比，按单核计），自启动以来
+} thumb_stream_stats_t;
+
+/**
+ * @brief 初始化：按 Kconfig 配置注册帧分发订阅者并启动缩略图任务（已初始化时直接返回）
+ * @return esp_err_t
+ */
+esp_err_t thumb_stream_init(void);
+
+/**
+ * @brief 修改配置
+ * @param config 配置
+ * @return esp_err_t 未初始化时返回 ESP_ERR_INVALID_STATE，参数无效时返回 ESP_ERR_INVALID_ARG
+ */
+esp_err_t thumb_stream_set_config(const thumb_stream_config_t* config);
+
+/**
+ * @brief 获取配置与统计信息（未初始化时输出全 0）
+ * @param config 输出配置，可为 NULL
+ * @param stats 输出统计信息，可为 NULL
+ */
+void thumb_stream_get(thumb_stream_config_t* config, thumb_stream_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THUMB_STREAM_H */
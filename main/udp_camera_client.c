@@ -1,5 +1,6 @@
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netdb.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -8,59 +9,155 @@
 #include "esp_wifi.h"
 #include "esp_timer.h"
 #include "esp_heap_caps.h"
+#include "esp_cpu.h"
+#include "esp_random.h"
+#include "esp_rom_sys.h"
 #include "lwip/inet.h"
 #include "led.h"
 #include "driver/i2s.h"
 
 #include "udp_camera_client.h"
-#include "audio_player.h"  // 添加音频播放模块
+#include "udp_pacer.h"
+#include "image_proto.h"
+#include "image_fec.h"
+#include "retransmit_ring.h"
+#include "frame_broker.h"
+#include "frame_governor.h"
+#include "bitrate_ctrl.h"
+#include "stream_dest.h"
+#include "camera_httpd.h"
+#include "rtp_jpeg.h"
+#include "frame_slot.h"
+#include "rtsp_server.h"
+#include "event_clip.h"
+#include "motion_stage.h"
+#include "thumb_stream.h"
+#include "camera_ctrl.h"
+#include "camera_app.h"
+#include "audio_stream.h"
 
 static const char* TAG = "UDP_CAMERA";
 
-// 目标PC的IP地址和端口
-#define UDP_SERVER_IP "192.168.5.3"  // 替换为你的PC的IP地址，请根据实际情况修改
-#define UDP_SERVER_PORT 8080
+// 目标PC的IP地址和端口保存在目标表中（见 stream_dest.h），默认值由 Kconfig 配置
 
 // PC发送语音的端口
 #define UDP_AUDIO_PORT 8081
 
+// 音频接收任务在自己的栈上解码（libopus 需要更大的栈）
+#if CONFIG_AUDIO_OPUS
+#define AUDIO_RECEIVE_STACK CONFIG_AUDIO_OPUS_TASK_STACK
+#else
+#define AUDIO_RECEIVE_STACK 4096
+#endif
+
+// 推流模式下同时打开的 lwIP 套接字：图像与语音各一个UDP socket，加上各模块自己的 socket
+// （配网模式的HTTP/DNS服务器在进入推流模式前已关闭）。超出 CONFIG_LWIP_MAX_SOCKETS 时创建 socket 或接受连接会失败
+#define UDP_CAMERA_SOCKETS (2 + CAMERA_HTTPD_SOCKETS + RTSP_SERVER_SOCKETS + THUMB_STREAM_SOCKETS + EVENT_CLIP_SOCKETS)
+_Static_assert(UDP_CAMERA_SOCKETS <= CONFIG_LWIP_MAX_SOCKETS, "CONFIG_LWIP_MAX_SOCKETS is smaller than the sockets opened in streaming mode");
+
 // UDP相关参数
-#define MAX_UDP_PACKET_SIZE 1400  // MTU限制
+#define MAX_UDP_PACKET_SIZE IMAGE_PROTO_MAX_PACKET_SIZE  // MTU限制
 #define RECV_TIMEOUT_MS 5000
 
-// 图像分包传输结构
-typedef struct
-{
-    uint32_t chunk_id;                                         // 包序号
-    uint32_t total_chunks;                                     // 总包数
-    uint32_t image_size;                                       // 图像总大小
-    uint8_t data[MAX_UDP_PACKET_SIZE - sizeof(uint32_t) * 3];  // 数据区域
-} udp_image_chunk_t;
+// 协议栈发送缓冲区满(ENOMEM)时的退避参数
+#define UDP_SEND_RETRY_MAX 10
+#define UDP_SEND_BACKOFF_US 2000
 
-// 音频数据包结构
-typedef struct
-{
-    uint32_t packet_id;                                        // 音频包序号
-    uint32_t total_packets;                                    // 音频总包数
-    uint32_t audio_size;                                       // 音频总大小
-    uint8_t data[MAX_UDP_PACKET_SIZE - sizeof(uint32_t) * 3];  // 音频数据区域
-} udp_audio_chunk_t;
+#if CONFIG_UDP_CAMERA_ZERO_COPY
+#define UDP_SEND_PATH_NAME "零拷贝"
+#else
+#define UDP_SEND_PATH_NAME "拷贝"
+#endif
 
-// 帧率统计相关变量
-static uint32_t frame_count = 0;
-static uint32_t last_fps_time = 0;
+// 帧率统计：滑动窗口估计发送帧率与帧间隔抖动，每秒打印一次
+static fps_estimator_t s_fps_estimator;
+static int64_t s_last_fps_log_us = 0;
 static float current_fps = 0.0f;
 
+// 目标帧率调速器：按绝对截止时间调度采集
+static frame_governor_t s_governor;
+static bool s_governor_initialized = false;
+
 // UDP socket 复用，避免重复创建
 static int s_udp_socket = -1;
 static int s_audio_socket = -1;  // 新增音频接收socket
-static struct sockaddr_in s_dest_addr;
 static bool s_socket_initialized = false;
+static uint8_t s_multicast_ttl = 0;  // 已设置到图像socket上的组播TTL，0 表示尚未设置
 static bool s_audio_socket_initialized = false;
 
+// 图像协议版本（编译期默认，可运行时切换以兼容旧接收端）与帧序号
+static uint8_t s_proto_version = CONFIG_UDP_IMAGE_PROTO_VERSION;
+static uint32_t s_frame_seq = 0;
+
+// 输出格式：自定义分包协议或 RTP/JPEG
+#if CONFIG_UDP_STREAM_FORMAT_RTP_JPEG
+static volatile udp_camera_stream_format_t s_stream_format = UDP_CAMERA_FORMAT_RTP_JPEG;
+#else
+static volatile udp_camera_stream_format_t s_stream_format = UDP_CAMERA_FORMAT_IMAGE_PROTO;
+#endif
+static rtp_jpeg_session_t s_rtp_session;
+static bool s_rtp_initialized = false;
+
+// FEC分组大小（每N个数据包附加一个XOR校验包），0 表示关闭
+static uint8_t s_fec_group_size = CONFIG_UDP_IMAGE_FEC_GROUP_SIZE;
+
+// 发送节拍器，替代固定的逐包延时
+static udp_pacer_t s_pacer;
+static bool s_pacer_initialized = false;
+
+// 自适应码率：分辨率档位（由低到高）与控制器，新参数由采集任务在两帧之间写入传感器
+static const framesize_t s_abr_framesizes[] = {FRAMESIZE_QQVGA, FRAMESIZE_HQVGA, FRAMESIZE_QVGA, FRAMESIZE_CIF, FRAMESIZE_HVGA, FRAMESIZE_VGA};
+#define ABR_LEVEL_COUNT (sizeof(s_abr_framesizes) / sizeof(s_abr_framesizes[0]))
+#define ABR_INITIAL_LEVEL 2     // FRAMESIZE_QVGA，与 cam.c 的初始配置一致
+#define ABR_INITIAL_QUALITY 10  // 与 cam.c 的 jpeg_quality 一致
+#define ABR_REPORT_TIMEOUT_US 3000000  // 超过该时间没有接收报告则认为丢包率为 0
+static bitrate_ctrl_t s_bitrate_ctrl;
+static bool s_abr_initialized = false;
+#if CONFIG_UDP_ABR_ENABLE
+static volatile bool s_abr_enabled = true;
+#define ABR_LEVEL_LIMIT ABR_LEVEL_COUNT
+#else
+// 未开启时帧缓冲只按初始分辨率分配，运行时开启也只能在初始分辨率以下调整
+static volatile bool s_abr_enabled = false;
+#define ABR_LEVEL_LIMIT (ABR_INITIAL_LEVEL + 1)
+#endif
+static portMUX_TYPE s_abr_lock = portMUX_INITIALIZER_UNLOCKED;
+static bitrate_ctrl_setting_t s_abr_pending;
+static bool s_abr_pending_valid = false;
+static bool s_dest_initialized = false;
+static volatile uint32_t s_send_errors = 0;        // 累计 socket 发送错误次数
+static volatile uint16_t s_report_loss_permille = 0;  // 最近一次接收报告的丢包率
+static volatile uint32_t s_nack_rejected = 0;         // 来源不是接收端而被忽略的NACK数
+static volatile int64_t s_report_time_us = 0;
+
+// 运动门控：静止时只发送保活帧，采集降到空闲帧率；配置与统计由 s_gate_lock 保护
+static motion_gate_t s_motion_gate;
+static bool s_motion_gate_initialized = false;
+static portMUX_TYPE s_gate_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_target_fps = CONFIG_UDP_CAMERA_TARGET_FPS;  // 运行时设置的采集帧率，空闲时暂不生效
+static bool s_capture_idle = false;
+
+// 采集 -> 发送 流水线：采集任务与发送任务分别绑定在两个核心上，发送任务是帧分发的一个订阅者
+static frame_broker_sub_t* s_udp_sub = NULL;
+static udp_camera_pipeline_stats_t s_pipeline_stats;
+static uint32_t s_frame_cycles = 0;      // 最近一帧分包与发送消耗的CPU周期
+static uint64_t s_send_cycles = 0;       // 累计发送CPU周期，用于计算CPU占用
+static int64_t s_pipeline_start_us = 0;
+
+#if CONFIG_FREERTOS_UNICORE
+#define UDP_CAMERA_CAPTURE_CORE 0
+#define UDP_CAMERA_SEND_CORE 0
+#else
+#define UDP_CAMERA_CAPTURE_CORE CONFIG_UDP_CAMERA_CAPTURE_CORE
+#define UDP_CAMERA_SEND_CORE CONFIG_UDP_CAMERA_SEND_CORE
+#endif
+
 // 任务控制标志
 static TaskHandle_t s_udp_task_handle = NULL;
+static TaskHandle_t s_capture_task_handle = NULL;
 static volatile bool s_udp_task_running = false;
+static volatile bool s_capture_pause = false;   // 请求采集任务停止取帧（重新初始化相机驱动用）
+static volatile bool s_capture_parked = false;  // 采集任务已停在暂停点，不再调用相机驱动
 
 /**
  * @brief 初始化UDP socket连接（只初始化一次）
@@ -90,14 +187,19 @@ static esp_err_t init_udp_socket_once(void)
     timeout.tv_usec = (RECV_TIMEOUT_MS % 1000) * 1000;
     setsockopt(s_udp_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
 
-    // 设置目标地址
-    memset(&s_dest_addr, 0, sizeof(struct sockaddr_in));
-    s_dest_addr.sin_family = AF_INET;
-    s_dest_addr.sin_port = htons(UDP_SERVER_PORT);
-    inet_aton(UDP_SERVER_IP, &s_dest_addr.sin_addr);
+    // 绑定本地端口，接收端把NACK等控制报文发回该端口
+    struct sockaddr_in local_addr;
+    memset(&local_addr, 0, sizeof(local_addr));
+    local_addr.sin_family = AF_INET;
+    local_addr.sin_port = htons(CONFIG_UDP_CAMERA_CONTROL_PORT);
+    local_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(s_udp_socket, (struct sockaddr*)&local_addr, sizeof(local_addr)) < 0) {
+        ESP_LOGW(TAG, "绑定控制端口 %d 失败: errno %d，NACK重传不可用", CONFIG_UDP_CAMERA_CONTROL_PORT, errno);
+    }
 
+    s_multicast_ttl = 0;
     s_socket_initialized = true;
-    ESP_LOGI(TAG, "UDP socket初始化成功，目标地址: %s:%d", UDP_SERVER_IP, UDP_SERVER_PORT);
+    ESP_LOGI(TAG, "UDP socket初始化成功，控制端口: %d", CONFIG_UDP_CAMERA_CONTROL_PORT);
 
     return ESP_OK;
 }
@@ -119,10 +221,10 @@ static esp_err_t init_audio_socket(void)
         return ESP_FAIL;
     }
 
-    // 设置接收超时
+    // 接收超时即语音下行的补充间隔：没有包时也要定期从抖动缓冲取包（预缓冲超时、丢包隐藏、欠载淡出）
     struct timeval timeout;
-    timeout.tv_sec = 5;  // 5秒超时
-    timeout.tv_usec = 0;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = AUDIO_STREAM_POLL_MS * 1000;
     setsockopt(s_audio_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
 
     // 绑定到本地端口
@@ -144,35 +246,6 @@ static esp_err_t init_audio_socket(void)
     return ESP_OK;
 }
 
-/**
- * @brief 处理音频数据包
- *
- * @param audio_packet 音频数据包
- * @param packet_size 数据包大小
- */
-static void handle_audio_packet(udp_audio_chunk_t* audio_packet, size_t packet_size)
-{
-    if (audio_packet == NULL) {
-        return;
-    }
-
-    // 解析音频包信息
-    uint32_t packet_id = ntohl(audio_packet->packet_id);
-    uint32_t total_packets = ntohl(audio_packet->total_packets);
-    uint32_t audio_size = ntohl(audio_packet->audio_size);
-
-    ESP_LOGI(TAG, "收到音频包，ID: %lu/%lu, 音频大小: %lu bytes", (unsigned long)packet_id, (unsigned long)total_packets, (unsigned long)audio_size);
-
-    // 播放音频数据
-    size_t actual_data_size = packet_size - sizeof(uint32_t) * 3;
-    if (actual_data_size > 0) {
-        esp_err_t ret = audio_player_play_stream(audio_packet->data, actual_data_size);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "播放音频数据失败: %s", esp_err_to_name(ret));
-        }
-    }
-}
-
 /**
  * @brief 音频接收任务
  *
@@ -197,26 +270,16 @@ static void audio_receive_task(void* pvParameters)
 
         if (len < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                continue;  // 超时，继续循环
+                audio_stream_poll();  // 超时，补充播放缓冲
+                continue;
             }
             ESP_LOGE(TAG, "音频接收错误: errno %d", errno);
             vTaskDelay(pdMS_TO_TICKS(100));  // 错误后短暂延迟
             continue;
         }
 
-        // 尝试解析为音频数据包
-        if (len >= sizeof(udp_audio_chunk_t)) {
-            udp_audio_chunk_t* audio_pkt = (udp_audio_chunk_t*)recv_buffer;
-            handle_audio_packet(audio_pkt, len);
-        }
-        else {
-            // 收到的数据包太小，可能是原始音频数据
-            ESP_LOGD(TAG, "收到原始音频数据: %d bytes", len);
-            esp_err_t ret = audio_player_play_stream(recv_buffer, len);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "播放原始音频数据失败: %s", esp_err_to_name(ret));
-            }
-        }
+        // 放入抖动缓冲并补充播放任务的环形缓冲，不等待 I2S
+        audio_stream_receive(recv_buffer, len);
     }
 
     ESP_LOGI(TAG, "音频接收任务结束");
@@ -250,9 +313,187 @@ static void close_audio_socket(void)
     }
 }
 
+/**
+ * @brief 发送一个UDP包（由多个分散的数据段组成），协议栈缓冲区满时退避重试
+ *
+ * @param dest 目标地址
+ * @param iov 数据段数组
+ * @param iovcnt 数据段数量
+ * @return ssize_t 发送的字节数，失败返回-1
+ */
+static ssize_t send_packet_with_retry(const struct sockaddr_in* dest, struct iovec* iov, int iovcnt)
+{
+    struct msghdr msg = {
+        .msg_name = (void*)dest,
+        .msg_namelen = sizeof(struct sockaddr_in),
+        .msg_iov = iov,
+        .msg_iovlen = iovcnt,
+    };
+
+    for (int retry = 0;; retry++) {
+        ssize_t sent = sendmsg(s_udp_socket, &msg, 0);
+        if (sent >= 0) {
+            return sent;
+        }
+        s_send_errors++;
+        if (errno != ENOMEM || retry >= UDP_SEND_RETRY_MAX) {
+            return sent;
+        }
+        // lwIP发送缓冲区已满，等待协议栈排空后重试
+        udp_pacer_backoff(&s_pacer, UDP_SEND_BACKOFF_US);
+    }
+}
+
+/**
+ * @brief 把一个包（已编码的包头 + 负载）发送给一组目标
+ *
+ * 零拷贝模式下每个目标复用同一组数据段（包头 + 指向帧缓冲的负载），
+ * 否则负载只拷贝一次到栈上的发送缓冲区，再依次发给每个目标。
+ *
+ * @param dests 目标列表
+ * @param header 包头
+ * @param header_size 包头长度
+ * @param payload 负载
+ * @param payload_size 负载长度
+ * @param busy_cycles 累加发送耗费的CPU周期
+ * @return int 发送成功的目标个数
+ */
+static int send_packet_to_dests(const stream_dest_list_t* dests, const uint8_t* header, size_t header_size, const uint8_t* payload, size_t payload_size, uint64_t* busy_cycles)
+{
+    size_t packet_size = header_size + payload_size;
+    int delivered = 0;
+
+    uint32_t start_cycles = esp_cpu_get_cycle_count();
+#if CONFIG_UDP_CAMERA_ZERO_COPY
+    struct iovec iov[2] = {
+        {.iov_base = (void*)header, .iov_len = header_size},
+        {.iov_base = (void*)payload, .iov_len = payload_size},
+    };
+    int iovcnt = 2;
+#else
+    uint8_t packet[MAX_UDP_PACKET_SIZE];
+    memcpy(packet, header, header_size);
+    memcpy(packet + header_size, payload, payload_size);
+    struct iovec iov[1] = {
+        {.iov_base = packet, .iov_len = packet_size},
+    };
+    int iovcnt = 1;
+#endif
+    *busy_cycles += (uint32_t)(esp_cpu_get_cycle_count() - start_cycles);
+
+    for (uint32_t i = 0; i < dests->count; i++) {
+        // 按令牌桶节拍放行，每个目标都占用一份空口时间
+        udp_pacer_wait(&s_pacer, packet_size);
+
+        start_cycles = esp_cpu_get_cycle_count();
+        ssize_t sent = send_packet_with_retry(&dests->addr[i], iov, iovcnt);
+        *busy_cycles += (uint32_t)(esp_cpu_get_cycle_count() - start_cycles);
+
+        stream_dest_account(dests->slot[i], sent, errno);
+        if (sent >= 0) {
+            delivered++;
+        }
+    }
+
+    return delivered;
+}
+
+/**
+ * @brief 编码包头并把一个图像分包发送给一组目标
+ *
+ * 包头只编码一次，可能被发送任务和重传任务同时调用，编码缓冲区放在调用者栈上。
+ *
+ * @param dests 目标列表
+ * @param chunk 分包描述
+ * @param payload 负载
+ * @param payload_size 负载长度
+ * @param busy_cycles 累加发送耗费的CPU周期
+ * @return int 发送成功的目标个数；包头编码失败时返回 -1，不发送该分包（不是套接字错误，调用者继续发送后续分包）
+ */
+static int send_image_chunk(const stream_dest_list_t* dests, const image_proto_chunk_t* chunk, const uint8_t* payload, size_t payload_size, uint64_t* busy_cycles)
+{
+    uint8_t header[IMAGE_PROTO_V2_HEADER_SIZE];
+    size_t header_size = image_proto_header_size(chunk->version);
+
+    uint32_t start_cycles = esp_cpu_get_cycle_count();
+    esp_err_t err = image_proto_encode_header(chunk, payload, payload_size, header);
+    *busy_cycles += (uint32_t)(esp_cpu_get_cycle_count() - start_cycles);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "图像包头编码失败 (帧 %lu, 分包 %lu/%lu): %s", (unsigned long)chunk->frame_seq, (unsigned long)chunk->chunk_id,
+                 (unsigned long)chunk->total_chunks, esp_err_to_name(err));
+        return -1;
+    }
+
+    return send_packet_to_dests(dests, header, header_size, payload, payload_size, busy_cycles);
+}
+
+/**
+ * @brief 按 RFC 2435 把一帧JPEG的扫描数据分包，以RTP发送给一组目标
+ *
+ * 负载直接指向帧缓冲中的扫描数据，只有包头（含每帧一次的量化表）在栈上生成。
+ *
+ * @param fb 相机帧缓冲
+ * @param dests 目标列表
+ * @return esp_err_t
+ */
+static esp_err_t send_rtp_frame(camera_fb_t* fb, const stream_dest_list_t* dests)
+{
+    rtp_jpeg_frame_t frame;
+    esp_err_t err = rtp_jpeg_parse(fb->buf, fb->len, &frame);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "JPEG无法按RFC 2435分包: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    uint32_t rtp_timestamp = rtp_jpeg_timestamp(&s_rtp_session, (uint64_t)fb->timestamp.tv_sec * 1000000ULL + fb->timestamp.tv_usec);
+    uint8_t header[RTP_JPEG_MAX_HEADER_SIZE];
+    size_t offset = 0;
+    uint32_t packets = 0;
+
+    int64_t start_us = esp_timer_get_time();
+    uint64_t busy_cycles = 0;
+
+    while (offset < frame.scan_len) {
+        size_t header_size = rtp_jpeg_header_size(&frame, offset);
+        size_t max_payload = MAX_UDP_PACKET_SIZE - header_size;
+        size_t remaining = frame.scan_len - offset;
+        size_t payload_size = (remaining > max_payload) ? max_payload : remaining;
+
+        uint32_t start_cycles = esp_cpu_get_cycle_count();
+        rtp_jpeg_encode_header(&s_rtp_session, &frame, rtp_timestamp, offset, payload_size, header);
+        busy_cycles += (uint32_t)(esp_cpu_get_cycle_count() - start_cycles);
+
+        if (send_packet_to_dests(dests, header, header_size, frame.scan + offset, payload_size, &busy_cycles) == 0) {
+            ESP_LOGE(TAG, "发送RTP包失败: errno %d", errno);
+            close_udp_socket();
+            return ESP_FAIL;
+        }
+
+        offset += payload_size;
+        packets++;
+    }
+
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    s_frame_cycles = (uint32_t)busy_cycles;
+    ESP_LOGI(TAG,
+             "RTP帧发送完成 (时间戳 %lu)，扫描数据 %lu / %lu bytes, %lu 包, 目标 %lu 个, %llu bytes/s, 每帧发送CPU周期 %llu",
+             (unsigned long)rtp_timestamp,
+             (unsigned long)frame.scan_len,
+             (unsigned long)fb->len,
+             (unsigned long)packets,
+             (unsigned long)dests->count,
+             (unsigned long long)(elapsed_us > 0 ? (uint64_t)frame.scan_len * 1000000ULL / elapsed_us : 0),
+             (unsigned long long)busy_cycles);
+
+    return ESP_OK;
+}
+
 /**
  * @brief 发送图像通过UDP（复用socket）
  *
+ * 开启FEC时（仅v2协议），每 s_fec_group_size 个数据包后追加一个XOR校验包。
+ * RTP/JPEG 输出格式下按 RFC 2435 分包，不使用FEC与重传。
+ *
  * @param fb 相机帧缓冲
  * @return esp_err_t
  */
@@ -263,87 +504,457 @@ esp_err_t send_image_via_udp(camera_fb_t* fb)
         return ESP_FAIL;
     }
 
+    // 每帧取一次目标快照，发送过程中修改目标表不影响本帧
+    stream_dest_list_t dests;
+    stream_dest_snapshot(&dests);
+    if (dests.count == 0) {
+        ESP_LOGD(TAG, "目标表为空，跳过本帧");
+        return ESP_ERR_NOT_FOUND;
+    }
+    for (uint32_t i = 0; i < dests.count; i++) {
+        stream_dest_account_frame(dests.slot[i]);
+    }
+    if (dests.multicast_ttl != 0 && dests.multicast_ttl != s_multicast_ttl) {
+        uint8_t ttl = dests.multicast_ttl;
+        if (setsockopt(s_udp_socket, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0) {
+            ESP_LOGW(TAG, "设置组播TTL失败: errno %d", errno);
+        }
+        s_multicast_ttl = ttl;
+    }
+
+    if (s_stream_format == UDP_CAMERA_FORMAT_RTP_JPEG) {
+        return send_rtp_frame(fb, &dests);
+    }
+
+    uint8_t version = s_proto_version;
+    size_t max_payload = MAX_UDP_PACKET_SIZE - image_proto_header_size(version);
+    uint32_t fec_group = (version == IMAGE_PROTO_VERSION) ? s_fec_group_size : 0;
+
     size_t total_size = fb->len;
     size_t bytes_sent = 0;
     uint32_t chunk_idx = 0;
-    uint32_t total_chunks = (total_size + sizeof(((udp_image_chunk_t*)0)->data) - 1) / sizeof(((udp_image_chunk_t*)0)->data);
+    uint32_t total_chunks = (total_size + max_payload - 1) / max_payload;
+    uint32_t parity_sent = 0;
 
-    ESP_LOGI(TAG, "开始发送图像，大小: %lu bytes, 分 %lu 包", (unsigned long)total_size, (unsigned long)total_chunks);
+    image_proto_chunk_t chunk = {
+        .version = version,
+        .frame_seq = s_frame_seq++,
+        .timestamp_us = (uint64_t)fb->timestamp.tv_sec * 1000000ULL + fb->timestamp.tv_usec,
+        .image_size = total_size,
+        .total_chunks = total_chunks,
+    };
 
-    // 使用静态变量避免栈上分配大数组
-    static udp_image_chunk_t chunk;
+    ESP_LOGI(TAG, "开始发送图像 #%lu (协议v%d)，大小: %lu bytes, 分 %lu 包, 目标 %lu 个", (unsigned long)chunk.frame_seq, version, (unsigned long)total_size, (unsigned long)total_chunks,
+             (unsigned long)dests.count);
 
-    while (bytes_sent < total_size) {
-        chunk.chunk_id = htonl(chunk_idx);
-        chunk.total_chunks = htonl(total_chunks);
-        chunk.image_size = htonl(total_size);
+    int64_t start_us = esp_timer_get_time();
+    uint32_t start_cycles = esp_cpu_get_cycle_count();
+    uint64_t busy_cycles = 0;
+
+    // 校验包累加缓冲区放在内部RAM中
+    static uint8_t parity[IMAGE_PROTO_V2_PAYLOAD_SIZE];
 
+    while (bytes_sent < total_size) {
         // 计算当前包的数据大小
         size_t remaining = total_size - bytes_sent;
-        size_t copy_size = (remaining > sizeof(chunk.data)) ? sizeof(chunk.data) : remaining;
-
-        memcpy(chunk.data, fb->buf + bytes_sent, copy_size);
-
-        // 发送包（使用复用的socket和目标地址）
-        ssize_t sent = sendto(s_udp_socket, &chunk, sizeof(uint32_t) * 3 + copy_size, 0, (struct sockaddr*)&s_dest_addr, sizeof(struct sockaddr_in));
+        size_t payload_size = (remaining > max_payload) ? max_payload : remaining;
+        const uint8_t* payload = fb->buf + bytes_sent;
+
+        chunk.chunk_id = chunk_idx;
+        chunk.offset = bytes_sent;
+        chunk.flags = IMAGE_PROTO_FLAG_KEYFRAME;
+        if (chunk_idx == 0) {
+            chunk.flags |= IMAGE_PROTO_FLAG_FIRST;
+        }
+        if (chunk_idx == total_chunks - 1) {
+            chunk.flags |= IMAGE_PROTO_FLAG_LAST;
+        }
 
-        if (sent < 0) {
+        // 所有目标都发送失败才放弃本帧，单个目标不可达不影响其他目标
+        if (send_image_chunk(&dests, &chunk, payload, payload_size, &busy_cycles) == 0) {
             ESP_LOGE(TAG, "发送UDP包失败: errno %d", errno);
             // 发送失败时关闭socket，下次重新初始化
             close_udp_socket();
             return ESP_FAIL;
         }
 
-        bytes_sent += copy_size;
-        chunk_idx++;
+        if (fec_group > 0) {
+            uint32_t group = chunk_idx / fec_group;
+            if (chunk_idx % fec_group == 0) {
+                memset(parity, 0, sizeof(parity));
+            }
+            image_fec_xor(parity, payload, payload_size);
+
+            // 分组结束（或整帧结束）时发送校验包
+            if ((chunk_idx + 1) % fec_group == 0 || chunk_idx == total_chunks - 1) {
+                image_proto_chunk_t parity_chunk = chunk;
+                parity_chunk.flags = IMAGE_PROTO_FLAG_KEYFRAME | IMAGE_PROTO_FLAG_PARITY;
+                parity_chunk.chunk_id = group;
+                parity_chunk.offset = fec_group;
+                size_t parity_len = image_fec_parity_len(total_size, max_payload, group, fec_group);
+                if (send_image_chunk(&dests, &parity_chunk, parity, parity_len, &busy_cycles) == 0) {
+                    ESP_LOGE(TAG, "发送FEC校验包失败: errno %d", errno);
+                    close_udp_socket();
+                    return ESP_FAIL;
+                }
+                parity_sent++;
+            }
+        }
 
-        // 优化：减少延迟，提高传输速度
-        vTaskDelay(pdMS_TO_TICKS(5));
+        bytes_sent += payload_size;
+        chunk_idx++;
     }
 
-    ESP_LOGI(TAG, "图像发送完成，共 %lu bytes", (unsigned long)total_size);
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    uint32_t total_cycles = esp_cpu_get_cycle_count() - start_cycles;
+    s_frame_cycles = (uint32_t)busy_cycles;
+
+    udp_pacer_stats_t stats;
+    udp_pacer_get_stats(&s_pacer, &stats);
+    ESP_LOGI(TAG,
+             "图像发送完成，共 %lu bytes, 校验包 %lu 个, 目标码率 %lu kbit/s, 实际码率 %lu kbit/s",
+             (unsigned long)total_size,
+             (unsigned long)parity_sent,
+             (unsigned long)(stats.target_bps / 1000),
+             (unsigned long)(stats.achieved_bps / 1000));
+    ESP_LOGI(TAG,
+             "发送路径(%s): %llu bytes/s, 每帧发送CPU周期 %llu, 总周期(含节拍等待) %lu",
+             UDP_SEND_PATH_NAME,
+             (unsigned long long)(elapsed_us > 0 ? (uint64_t)total_size * 1000000ULL / elapsed_us : 0),
+             (unsigned long long)busy_cycles,
+             (unsigned long)total_cycles);
 
     return ESP_OK;
 }
 
 /**
- * @brief 捕获图像并通过UDP发送
+ * @brief 发送一帧并释放引用：成功的v2帧把引用交给重传环，否则直接释放
  *
+ * @param frame 帧引用（调用后所有权转移）
  * @return esp_err_t
  */
-esp_err_t capture_and_send_udp()
+static esp_err_t send_and_release_frame(frame_ref_t* frame)
 {
-    // 捕获图像
-    camera_fb_t* fb = esp_camera_fb_get();
-    if (!fb) {
-        ESP_LOGE(TAG, "获取相机帧失败");
-        return ESP_FAIL;
+    bool retransmittable = (s_stream_format == UDP_CAMERA_FORMAT_IMAGE_PROTO);
+    uint8_t version = s_proto_version;
+    uint32_t frame_seq = s_frame_seq;  // send_image_via_udp() 为本帧分配的序号
+    esp_err_t result = send_image_via_udp(frame->fb);
+
+    if (result == ESP_OK && retransmittable && version == IMAGE_PROTO_VERSION) {
+        // 交给重传环保存（按引用，不拷贝），淘汰时由重传环释放
+        retransmit_entry_t entry = {
+            .frame_seq = frame_seq,
+            .version = version,
+            .timestamp_us = frame->timestamp_us,
+            .sent_us = esp_timer_get_time(),
+            .frame = frame,
+        };
+        retransmit_ring_push(&entry);
+    }
+    else {
+        // 释放引用，没有其他消费者持有时归还帧缓冲
+        frame_broker_release(frame);
     }
 
-    esp_err_t result = send_image_via_udp(fb);
+    return result;
+}
 
-    // 释放帧缓冲
-    esp_camera_fb_return(fb);
+/**
+ * @brief 把一帧的观测结果交给码率控制器，需要调整时登记新参数
+ *
+ * @param frame_bytes 帧大小
+ * @param send_us 发送耗时
+ * @param send_errors 本帧发送中的 socket 错误次数
+ */
+static void abr_observe_frame(uint32_t frame_bytes, uint32_t send_us, uint32_t send_errors)
+{
+    if (!s_abr_enabled || !s_abr_initialized) {
+        return;
+    }
 
-    return result;
+    bitrate_ctrl_sample_t sample = {
+        .frame_bytes = frame_bytes,
+        .send_us = send_us,
+        .send_errors = send_errors,
+        .loss_permille = (esp_timer_get_time() - s_report_time_us < ABR_REPORT_TIMEOUT_US) ? s_report_loss_permille : 0,
+        .fps = current_fps,
+    };
+    bitrate_ctrl_setting_t setting;
+    if (bitrate_ctrl_observe(&s_bitrate_ctrl, &sample, &setting)) {
+        ESP_LOGI(TAG, "码率调整: 质量 %d, 分辨率档位 %d (估算 %lu bit/s, 平均帧 %lu bytes)", setting.quality, setting.level, (unsigned long)s_bitrate_ctrl.stats.demand_bps,
+                 (unsigned long)s_bitrate_ctrl.stats.avg_frame_bytes);
+        taskENTER_CRITICAL(&s_abr_lock);
+        s_abr_pending = setting;
+        s_abr_pending_valid = true;
+        taskEXIT_CRITICAL(&s_abr_lock);
+    }
 }
 
 /**
- * @brief 计算并打印帧率
+ * @brief 在采集任务中把登记的编码参数写入传感器（两帧之间，不与取帧并发）
  */
-void update_and_print_fps()
+static void abr_apply_pending(void)
+{
+    taskENTER_CRITICAL(&s_abr_lock);
+    bool valid = s_abr_pending_valid;
+    bitrate_ctrl_setting_t setting = s_abr_pending;
+    s_abr_pending_valid = false;
+    taskEXIT_CRITICAL(&s_abr_lock);
+    if (!valid) {
+        return;
+    }
+
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (sensor == NULL) {
+        return;
+    }
+    if (sensor->status.framesize != s_abr_framesizes[setting.level] && sensor->set_framesize(sensor, s_abr_framesizes[setting.level]) != 0) {
+        ESP_LOGW(TAG, "设置分辨率失败: %d", s_abr_framesizes[setting.level]);
+    }
+    if (sensor->status.quality != setting.quality && sensor->set_quality(sensor, setting.quality) != 0) {
+        ESP_LOGW(TAG, "设置JPEG质量失败: %d", setting.quality);
+    }
+}
+
+/**
+ * @brief 累加阶段耗时（指数滑动平均，权重 1/8）
+ */
+static void pipeline_account(uint32_t* avg_us, uint32_t* max_us, uint32_t sample_us)
+{
+    *avg_us = (*avg_us == 0) ? sample_us : (*avg_us * 7 + sample_us) / 8;
+    if (sample_us > *max_us) {
+        *max_us = sample_us;
+    }
+}
+
+/**
+ * @brief 处理NACK：从重传环中重发丢失的包
+ *
+ * @param nack 重传请求
+ * @param source 请求方地址，重传包直接发回请求方
+ */
+static void handle_nack(const image_proto_nack_t* nack, const struct sockaddr_in* source)
+{
+    uint32_t requested = 0;
+    for (uint16_t w = 0; w < nack->words; w++) {
+        requested += __builtin_popcount(nack->bitmap[w]);
+    }
+
+    retransmit_entry_t held;
+    if (!retransmit_ring_acquire(nack->frame_seq, &held)) {
+        retransmit_ring_record(0, requested, 0);
+        ESP_LOGD(TAG, "NACK 帧 #%lu 已不在重传环中", (unsigned long)nack->frame_seq);
+        return;
+    }
+
+    // 只持有帧引用而不持有环的锁，重传期间发送任务仍可向环中放入新帧
+    const retransmit_entry_t* entry = &held;
+    size_t image_size = entry->frame->len;
+    size_t max_payload = MAX_UDP_PACKET_SIZE - image_proto_header_size(entry->version);
+    uint32_t total_chunks = (image_size + max_payload - 1) / max_payload;
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint64_t busy_cycles = 0;
+    stream_dest_list_t requester = {
+        .count = 1,
+        .addr = {*source},
+        .slot = {STREAM_DEST_NO_SLOT},
+    };
+
+    image_proto_chunk_t chunk = {
+        .version = entry->version,
+        .frame_seq = entry->frame_seq,
+        .timestamp_us = entry->timestamp_us,
+        .image_size = image_size,
+        .total_chunks = total_chunks,
+    };
+
+    for (uint32_t bit = 0; bit < (uint32_t)nack->words * 32; bit++) {
+        if ((nack->bitmap[bit / 32] & (1u << (bit % 32))) == 0) {
+            continue;
+        }
+        uint32_t chunk_id = nack->base_chunk + bit;
+        if (chunk_id >= total_chunks) {
+            misses++;
+            continue;
+        }
+
+        size_t offset = chunk_id * max_payload;
+        size_t payload_size = (image_size - offset > max_payload) ? max_payload : image_size - offset;
+        chunk.chunk_id = chunk_id;
+        chunk.offset = offset;
+        chunk.flags = IMAGE_PROTO_FLAG_KEYFRAME | IMAGE_PROTO_FLAG_RETRANSMIT;
+        if (chunk_id == 0) {
+            chunk.flags |= IMAGE_PROTO_FLAG_FIRST;
+        }
+        if (chunk_id == total_chunks - 1) {
+            chunk.flags |= IMAGE_PROTO_FLAG_LAST;
+        }
+
+        if (send_image_chunk(&requester, &chunk, entry->frame->data + offset, payload_size, &busy_cycles) <= 0) {
+            ESP_LOGW(TAG, "重传包失败: errno %d", errno);
+            misses++;
+            continue;
+        }
+        hits++;
+    }
+
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - entry->sent_us);
+    frame_broker_release(held.frame);
+    retransmit_ring_record(hits, misses, latency_us);
+
+    ESP_LOGI(TAG, "NACK 帧 #%lu: 重传 %lu 包, 未命中 %lu 包, 附加延迟 %lu us", (unsigned long)nack->frame_seq, (unsigned long)hits, (unsigned long)misses, (unsigned long)latency_us);
+}
+
+/**
+ * @brief 处理目标表修改请求
+ *
+ * @param dest 修改请求
+ */
+static void handle_dest_request(const image_proto_dest_t* dest)
+{
+    esp_err_t err;
+    switch (dest->op) {
+        case IMAGE_PROTO_DEST_ADD:
+            err = stream_dest_add(dest->ip, dest->port);
+            break;
+        case IMAGE_PROTO_DEST_REMOVE:
+            err = stream_dest_remove(dest->ip, dest->port);
+            break;
+        default:
+            err = stream_dest_clear();
+            break;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "目标表修改失败 (op %d): %s", dest->op, esp_err_to_name(err));
+    }
+}
+
+/**
+ * @brief 处理相机参数修改请求（需要重新初始化驱动时本任务会等待数秒，期间不处理NACK）
+ */
+static void handle_camera_request(const image_proto_camera_t* camera)
 {
-    uint32_t current_time = esp_timer_get_time() / 1000;  // 转换为毫秒
+    camera_ctrl_change_t changes[IMAGE_PROTO_CAMERA_MAX_PARAMS];
+    for (uint8_t i = 0; i < camera->count; i++) {
+        changes[i].param = (camera_ctrl_param_t)camera->params[i].param;
+        changes[i].value = camera->params[i].value;
+    }
+    esp_err_t err = camera_ctrl_set(changes, camera->count);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "相机参数修改失败 (%u 个参数): %s", camera->count, esp_err_to_name(err));
+    }
+}
 
-    frame_count++;
+/**
+ * @brief 控制报文接收任务：监听图像socket上接收端发回的NACK
+ *
+ * @param pvParameters 参数
+ */
+static void udp_control_task(void* pvParameters)
+{
+    uint8_t recv_buffer[128];
+    struct sockaddr_in source_addr;
 
-    // 每秒计算一次帧率
-    if (current_time - last_fps_time >= 1000) {
-        current_fps = (float)frame_count * 1000.0f / (current_time - last_fps_time);
-        ESP_LOGI(TAG, "帧率: %f FPS, 总帧数: %lu", current_fps, (unsigned long)frame_count);
+    ESP_LOGI(TAG, "控制报文接收任务启动，监听端口: %d", CONFIG_UDP_CAMERA_CONTROL_PORT);
 
-        frame_count = 0;
-        last_fps_time = current_time;
+    while (s_udp_task_running) {
+        int sock = s_udp_socket;
+        if (sock < 0) {
+            // socket正在重建
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        socklen_t addr_len = sizeof(source_addr);
+        int len = recvfrom(sock, recv_buffer, sizeof(recv_buffer), 0, (struct sockaddr*)&source_addr, &addr_len);
+        if (len < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                vTaskDelay(pdMS_TO_TICKS(100));  // 错误后短暂延迟
+            }
+            continue;  // 超时，继续循环
+        }
+
+        uint8_t type;
+        if (image_proto_decode_ctrl(recv_buffer, len, &type) != ESP_OK) {
+            ESP_LOGD(TAG, "忽略未知控制报文: %d bytes", len);
+            continue;
+        }
+
+        if (type == IMAGE_PROTO_CTRL_NACK) {
+            image_proto_nack_t nack;
+            if (image_proto_decode_nack(recv_buffer, len, &nack) != ESP_OK) {
+                continue;
+            }
+            // 重传包发往请求方：只应答接收端，否则伪造源地址的NACK可以让设备向任意主机发送整帧数据
+            if (!stream_dest_is_receiver(&source_addr)) {
+                s_nack_rejected++;
+                ESP_LOGD(TAG, "忽略来自非接收端 %s:%d 的NACK", inet_ntoa(source_addr.sin_addr), ntohs(source_addr.sin_port));
+                continue;
+            }
+            handle_nack(&nack, &source_addr);
+        }
+        else if (type == IMAGE_PROTO_CTRL_DEST) {
+            image_proto_dest_t dest;
+            if (image_proto_decode_dest(recv_buffer, len, &dest) == ESP_OK) {
+                handle_dest_request(&dest);
+            }
+        }
+        else if (type == IMAGE_PROTO_CTRL_REPORT) {
+            image_proto_report_t report;
+            if (image_proto_decode_report(recv_buffer, len, &report) == ESP_OK) {
+                // 组播模式下接收报告同时登记活跃接收端，之后才应答它的NACK
+                stream_dest_note_receiver(&source_addr);
+                if (!stream_dest_is_receiver(&source_addr)) {
+                    continue;
+                }
+                s_report_loss_permille = report.loss_permille;
+                s_report_time_us = esp_timer_get_time();
+                ESP_LOGD(TAG, "接收报告: 帧 %lu, 丢包率 %u‰", (unsigned long)report.frame_seq, report.loss_permille);
+            }
+        }
+        else if (type == IMAGE_PROTO_CTRL_CAMERA) {
+            image_proto_camera_t camera;
+            if (image_proto_decode_camera(recv_buffer, len, &camera) == ESP_OK) {
+                handle_camera_request(&camera);
+            }
+        }
+#if CONFIG_EVENT_CLIP
+        else if (type == IMAGE_PROTO_CTRL_CLIP) {
+            image_proto_clip_t clip;
+            if (image_proto_decode_clip(recv_buffer, len, &clip) == ESP_OK) {
+                // 片段发往请求方的 TCP 端口，端口为 0 时使用默认接收端
+                struct sockaddr_in receiver = source_addr;
+                receiver.sin_port = htons(clip.port);
+                event_clip_trigger(clip.port != 0 ? &receiver : NULL, (uint32_t)clip.post_seconds * 1000, EVENT_CLIP_SOURCE_UDP);
+            }
+        }
+#endif
+    }
+
+    ESP_LOGI(TAG, "控制报文接收任务结束");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 记录一帧并更新滑动窗口帧率与抖动，每秒打印一次
+ */
+void update_and_print_fps()
+{
+    int64_t now = esp_timer_get_time();
+
+    fps_estimator_update(&s_fps_estimator, now);
+    current_fps = fps_estimator_fps(&s_fps_estimator);
+
+    if (now - s_last_fps_log_us >= 1000000) {
+        frame_governor_stats_t gov = {0};
+        if (s_governor_initialized) {
+            frame_governor_get_stats(&s_governor, &gov);
+        }
+        ESP_LOGI(TAG, "帧率: %.2f FPS (目标 %lu), 抖动: %lu 微秒, 错过截止: %lu, 调度延迟: 平均 %lu / 最大 %lu 微秒, 总帧数: %lu", current_fps, (unsigned long)gov.target_fps,
+                 (unsigned long)fps_estimator_jitter_us(&s_fps_estimator), (unsigned long)gov.missed, (unsigned long)gov.late_avg_us, (unsigned long)gov.late_max_us,
+                 (unsigned long)s_fps_estimator.total);
+        s_last_fps_log_us = now;
     }
 }
 
@@ -362,60 +973,390 @@ float get_current_fps(void)
  */
 uint32_t get_total_frames(void)
 {
-    return frame_count;
+    return s_fps_estimator.total;
 }
 
 /**
- * @brief UDP图像传输任务
+ * @brief 图像采集任务：取帧后包装为引用计数的句柄，发布到最新帧槽与各订阅者的队列
  *
  * @param pvParameters 参数
  */
-void udp_camera_task(void* pvParameters)
+static void camera_capture_task(void* pvParameters)
+{
+    while (s_udp_task_running) {
+        // 暂停期间相机驱动可能被重新初始化，不取帧也不修改传感器
+        if (s_capture_pause) {
+            s_capture_parked = true;
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        // 按绝对截止时间等待，采集与入队耗时已计入本周期
+        frame_governor_wait(&s_governor);
+        abr_apply_pending();
+
+        int64_t start_time = esp_timer_get_time();
+        camera_fb_t* fb = esp_camera_fb_get();
+        uint32_t capture_time = (uint32_t)(esp_timer_get_time() - start_time);
+
+        if (!fb) {
+            ESP_LOGE(TAG, "获取相机帧失败");
+            s_pipeline_stats.capture_failures++;
+            continue;
+        }
+        // 停止过程中取到的帧直接归还，避免发送任务清空队列后再被压入
+        if (!s_udp_task_running) {
+            esp_camera_fb_return(fb);
+            break;
+        }
+
+        s_pipeline_stats.captured++;
+        pipeline_account(&s_pipeline_stats.capture_avg_us, &s_pipeline_stats.capture_max_us, capture_time);
+        frame_ref_t* frame = frame_broker_wrap(fb);
+        if (frame == NULL) {
+            ESP_LOGE(TAG, "帧句柄耗尽，丢弃本帧");
+            esp_camera_fb_return(fb);
+            continue;
+        }
+        // 各消费者共享同一块帧缓冲：最新帧槽（HTTP/RTSP）与订阅者队列各持有一个引用，
+        // 队列满时按订阅者的策略丢帧；采集任务释放自己的引用后，最后一个消费者用完时归还驱动
+        frame_slot_publish(frame);
+        frame_broker_publish(frame);
+        frame_broker_release(frame);
+    }
+
+    s_capture_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 切换采集帧率：静止时降到空闲帧率，运动或门控关闭时恢复
+ */
+static void set_capture_idle(bool idle)
 {
-    // 优化：减少延迟到1秒，提高帧率
-    const uint32_t capture_interval_ms = 1000;  // 改为1秒间隔
+    if (CONFIG_MOTION_GATE_IDLE_FPS == 0 || (s_target_fps != 0 && CONFIG_MOTION_GATE_IDLE_FPS >= s_target_fps)) {
+        idle = false;
+    }
+    if (idle == s_capture_idle || !s_governor_initialized) {
+        return;
+    }
+    s_capture_idle = idle;
+    frame_governor_set_fps(&s_governor, idle ? CONFIG_MOTION_GATE_IDLE_FPS : s_target_fps);
+    ESP_LOGI(TAG, "运动门控: %s，采集帧率 %lu", idle ? "画面静止" : "检测到运动", (unsigned long)(idle ? CONFIG_MOTION_GATE_IDLE_FPS : s_target_fps));
+}
+
+/**
+ * @brief 按最新的运动检测结果判定本帧是否发送
+ * @return 应发送时返回 true
+ */
+static bool motion_gate_admit(const frame_ref_t* frame)
+{
+    motion_gate_sample_t sample = {0};
+    motion_stage_state_t state;
+    if (motion_stage_get_state(&state)) {
+        sample.valid = true;
+        sample.motion = state.result.motion;
+        sample.score = state.result.score;
+        sample.result_us = state.updated_us;
+    }
+
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_gate_lock);
+    motion_gate_decision_t decision = motion_gate_decide(&s_motion_gate, now, &sample, frame->len);
+    bool active = now < s_motion_gate.holdoff_until_us;
+    bool enabled = s_motion_gate.config.enabled;
+    taskEXIT_CRITICAL(&s_gate_lock);
+
+    // 结果不可用 (UNGATED) 时也恢复全速采集，避免检测停止后一直停在空闲帧率
+    set_capture_idle(enabled && !active && (decision == MOTION_GATE_SUPPRESS || decision == MOTION_GATE_SEND_KEEPALIVE));
+    return decision != MOTION_GATE_SUPPRESS;
+}
 
+/**
+ * @brief UDP图像发送任务：从订阅队列取帧并发送
+ *
+ * @param pvParameters 参数
+ */
+void udp_camera_task(void* pvParameters)
+{
     s_udp_task_running = true;
 
     // 初始化音频接收socket
     if (init_audio_socket() != ESP_OK) {
         ESP_LOGE(TAG, "音频socket初始化失败");
     }
+    else if (audio_stream_init() != ESP_OK) {
+        ESP_LOGE(TAG, "语音下行初始化失败");
+    }
     else {
         // 启动音频接收任务
-        xTaskCreate(audio_receive_task, "audio_receive_task", 4096, NULL, 3, NULL);
+        xTaskCreate(audio_receive_task, "audio_receive_task", AUDIO_RECEIVE_STACK, NULL, 3, NULL);
+    }
+
+    // 提前创建图像socket，使控制端口在第一帧发出前就可接收NACK
+    if (init_udp_socket_once() == ESP_OK) {
+        xTaskCreate(udp_control_task, "udp_control_task", 6144, NULL, 4, NULL);
+    }
+
+    // 采集任务绑定到另一个核心，与发送并行
+    if (xTaskCreatePinnedToCore(camera_capture_task, "camera_capture_task", 4096, NULL, 5, &s_capture_task_handle, UDP_CAMERA_CAPTURE_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "创建采集任务失败");
+        s_capture_task_handle = NULL;
+        s_udp_task_running = false;
     }
 
     while (s_udp_task_running) {
+        frame_ref_t* frame = frame_broker_pop(s_udp_sub, pdMS_TO_TICKS(100));
+        if (frame == NULL) {
+            continue;
+        }
+        if (!motion_gate_admit(frame)) {
+            frame_broker_release(frame);
+            continue;
+        }
+
+        s_pipeline_stats.send_in_flight = 1;
+        uint32_t frame_bytes = frame->len;
+        uint32_t errors_before = s_send_errors;
+        s_frame_cycles = 0;
         uint64_t start_time = esp_timer_get_time();
+        esp_err_t result = send_and_release_frame(frame);
+        uint32_t send_time = (uint32_t)(esp_timer_get_time() - start_time);
+        s_pipeline_stats.send_in_flight = 0;
+        abr_observe_frame(frame_bytes, send_time, s_send_errors - errors_before);
 
-        ESP_LOGI(TAG, "捕获并发送图像...");
-        esp_err_t result = capture_and_send_udp();
         if (result == ESP_OK) {
-            ESP_LOGI(TAG, "图像发送成功");
+            s_pipeline_stats.sent++;
+            s_pipeline_stats.bytes_sent += frame_bytes;
+            s_pipeline_stats.cycles_per_frame =
+                (s_pipeline_stats.cycles_per_frame == 0) ? s_frame_cycles : (uint32_t)((s_pipeline_stats.cycles_per_frame * 7ULL + s_frame_cycles) / 8);
+            s_send_cycles += s_frame_cycles;
+            ESP_LOGI(TAG, "图像发送成功, 耗时: %lu 微秒", (unsigned long)send_time);
         }
         else {
+            s_pipeline_stats.send_failures++;
             ESP_LOGE(TAG, "图像发送失败");
         }
-
-        uint64_t end_time = esp_timer_get_time();
-        uint64_t capture_time = end_time - start_time;
-
-        // 打印捕获时间
-        ESP_LOGI(TAG, "图像捕获耗时: %llu 微秒", capture_time);
+        pipeline_account(&s_pipeline_stats.send_avg_us, &s_pipeline_stats.send_max_us, send_time);
 
         // 更新并打印帧率
         update_and_print_fps();
+    }
 
-        // 优化：减少延迟时间
-        vTaskDelay(pdMS_TO_TICKS(capture_interval_ms));
+    // 等待采集任务退出后再清空队列，释放剩余的帧引用
+    while (s_capture_task_handle != NULL) {
+        vTaskDelay(pdMS_TO_TICKS(10));
     }
+    frame_broker_flush(s_udp_sub);
+    set_capture_idle(false);
 
     s_udp_task_running = false;
     s_udp_task_handle = NULL;
     vTaskDelete(NULL);
 }
 
+/**
+ * @brief 设置图像发送的目标码率和突发大小
+ */
+void udp_camera_set_bitrate(uint32_t target_bps, uint32_t burst_bytes)
+{
+    if (!s_pacer_initialized) {
+        return;
+    }
+    udp_pacer_set_rate(&s_pacer, target_bps, burst_bytes);
+}
+
+/**
+ * @brief 设置图像传输协议版本
+ */
+esp_err_t udp_camera_set_protocol_version(uint8_t version)
+{
+    if (version != 1 && version != IMAGE_PROTO_VERSION) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_proto_version = version;
+    ESP_LOGI(TAG, "图像协议切换为 v%d", version);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取当前图像传输协议版本
+ */
+uint8_t udp_camera_get_protocol_version(void)
+{
+    return s_proto_version;
+}
+
+/**
+ * @brief 切换图像输出格式
+ */
+esp_err_t udp_camera_set_stream_format(udp_camera_stream_format_t format)
+{
+    if (format != UDP_CAMERA_FORMAT_IMAGE_PROTO && format != UDP_CAMERA_FORMAT_RTP_JPEG) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_stream_format = format;
+    ESP_LOGI(TAG, "输出格式切换为 %s", format == UDP_CAMERA_FORMAT_RTP_JPEG ? "RTP/JPEG" : "图像分包协议");
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取当前图像输出格式
+ */
+udp_camera_stream_format_t udp_camera_get_stream_format(void)
+{
+    return s_stream_format;
+}
+
+/**
+ * @brief 生成RTP/JPEG流的SDP描述
+ */
+size_t udp_camera_get_sdp(char* out, size_t size)
+{
+    if (out == NULL || size == 0) {
+        return 0;
+    }
+
+    stream_dest_list_t dests;
+    stream_dest_snapshot(&dests);
+    if (dests.count == 0) {
+        return 0;
+    }
+
+    char addr[16];
+    inet_ntoa_r(dests.addr[0].sin_addr, addr, sizeof(addr));
+    return rtp_jpeg_build_sdp(out, size, addr, ntohs(dests.addr[0].sin_port), dests.multicast_ttl, s_rtp_session.ssrc);
+}
+
+/**
+ * @brief 设置FEC分组大小
+ */
+esp_err_t udp_camera_set_fec_group_size(uint8_t group_size)
+{
+    if (group_size > IMAGE_FEC_MAX_GROUP_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_fec_group_size = group_size;
+    ESP_LOGI(TAG, "FEC分组大小设置为 %d (0 表示关闭)", group_size);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取FEC分组大小
+ */
+uint8_t udp_camera_get_fec_group_size(void)
+{
+    return s_fec_group_size;
+}
+
+/**
+ * @brief 获取NACK重传统计信息
+ */
+void udp_camera_get_retransmit_stats(retransmit_stats_t* stats)
+{
+    retransmit_ring_get_stats(stats);
+    stats->rejected = s_nack_rejected;
+}
+
+/**
+ * @brief 获取发送节拍器统计信息
+ */
+void udp_camera_get_pacer_stats(udp_pacer_stats_t* stats)
+{
+    if (!s_pacer_initialized || stats == NULL) {
+        return;
+    }
+    udp_pacer_get_stats(&s_pacer, stats);
+}
+
+/**
+ * @brief 设置目标帧率
+ */
+void udp_camera_set_target_fps(uint32_t fps)
+{
+    if (!s_governor_initialized) {
+        return;
+    }
+    s_target_fps = fps;
+    if (!s_capture_idle) {
+        frame_governor_set_fps(&s_governor, fps);
+    }
+    if (s_abr_initialized) {
+        bitrate_ctrl_set_target(&s_bitrate_ctrl, s_bitrate_ctrl.config.target_bps, fps);
+    }
+}
+
+/**
+ * @brief 开关自适应码率控制
+ */
+void udp_camera_set_adaptive_bitrate(bool enable, uint32_t target_bps)
+{
+    s_abr_enabled = enable;
+    if (s_abr_initialized && target_bps > 0) {
+        bitrate_ctrl_set_target(&s_bitrate_ctrl, target_bps, s_bitrate_ctrl.config.target_fps);
+    }
+    ESP_LOGI(TAG, "自适应码率%s, 目标 %lu bit/s", enable ? "开启" : "关闭", (unsigned long)(s_abr_initialized ? s_bitrate_ctrl.config.target_bps : 0));
+}
+
+/**
+ * @brief 获取自适应码率控制是否开启及其目标码率
+ */
+bool udp_camera_get_adaptive_bitrate(uint32_t* target_bps)
+{
+    if (target_bps != NULL) {
+        *target_bps = s_abr_initialized ? s_bitrate_ctrl.config.target_bps : 0;
+    }
+    return s_abr_enabled;
+}
+
+/**
+ * @brief 获取自适应码率统计信息
+ */
+void udp_camera_get_bitrate_stats(bitrate_ctrl_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (!s_abr_initialized) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    bitrate_ctrl_get_stats(&s_bitrate_ctrl, stats);
+}
+
+/**
+ * @brief 获取帧率调速统计信息
+ */
+void udp_camera_get_frame_timing(udp_camera_frame_timing_t* timing)
+{
+    if (timing == NULL) {
+        return;
+    }
+    memset(timing, 0, sizeof(*timing));
+    if (s_governor_initialized) {
+        frame_governor_get_stats(&s_governor, &timing->governor);
+    }
+    timing->fps = fps_estimator_fps(&s_fps_estimator);
+    timing->jitter_us = fps_estimator_jitter_us(&s_fps_estimator);
+}
+
+/**
+ * @brief 获取采集/发送流水线统计信息
+ */
+void udp_camera_get_pipeline_stats(udp_camera_pipeline_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    *stats = s_pipeline_stats;
+    frame_broker_sub_stats_t sub;
+    frame_broker_get_sub_stats(s_udp_sub, &sub);
+    stats->queue = sub.queue;
+    int64_t elapsed_us = esp_timer_get_time() - s_pipeline_start_us;
+    if (elapsed_us > 0) {
+        stats->cpu_permille = (uint16_t)(s_send_cycles * 1000 / ((uint64_t)elapsed_us * esp_rom_get_cpu_ticks_per_us()));
+    }
+}
+
 /**
  * @brief 停止UDP图像传输
  */
@@ -425,6 +1366,96 @@ void stop_udp_camera(void)
     s_udp_task_running = false;
     close_udp_socket();
     close_audio_socket();
+    // 归还重传环持有的帧缓冲
+    retransmit_ring_clear();
+    camera_httpd_stop();
+    rtsp_server_stop();
+}
+
+/**
+ * @brief 暂停采集，必要时等待全部帧缓冲归还驱动
+ */
+esp_err_t udp_camera_pause_capture(bool release_frames, TickType_t timeout)
+{
+    TickType_t start = xTaskGetTickCount();
+    s_capture_pause = true;
+    while (s_capture_task_handle != NULL && !s_capture_parked) {
+        if (xTaskGetTickCount() - start >= timeout) {
+            udp_camera_resume_capture();
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (!release_frames) {
+        return ESP_OK;
+    }
+
+    // 重传环与最新帧槽不会自行释放帧，订阅者处理完队列中的帧后即归还；
+    // 发送任务可能把队列中剩余的帧再放入重传环，因此每轮都清空
+    frame_broker_stats_t stats;
+    for (;;) {
+        retransmit_ring_clear();
+        frame_slot_clear();
+        frame_broker_get_stats(&stats);
+        if (stats.in_use == 0) {
+            return ESP_OK;
+        }
+        if (xTaskGetTickCount() - start >= timeout) {
+            ESP_LOGW(TAG, "等待帧缓冲归还超时，仍有 %lu 帧在用", (unsigned long)stats.in_use);
+            udp_camera_resume_capture();
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+/**
+ * @brief 恢复采集
+ */
+void udp_camera_resume_capture(void)
+{
+    s_capture_parked = false;
+    s_capture_pause = false;
+}
+
+/**
+ * @brief 修改运动门控配置
+ */
+void udp_camera_set_motion_gate(const motion_gate_config_t* config)
+{
+    if (config == NULL || !s_motion_gate_initialized) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_gate_lock);
+    motion_gate_configure(&s_motion_gate, config);
+    taskEXIT_CRITICAL(&s_gate_lock);
+    ESP_LOGI(TAG, "运动门控%s: 阈值 %u‰, 保活 %lu ms, 保持 %lu ms", config->enabled ? "开启" : "关闭", config->score_threshold, (unsigned long)config->keepalive_ms,
+             (unsigned long)config->holdoff_ms);
+}
+
+/**
+ * @brief 获取运动门控配置与统计信息
+ */
+void udp_camera_get_motion_gate(motion_gate_config_t* config, motion_gate_stats_t* stats)
+{
+    if (!s_motion_gate_initialized) {
+        if (config != NULL) {
+            memset(config, 0, sizeof(*config));
+        }
+        if (stats != NULL) {
+            memset(stats, 0, sizeof(*stats));
+        }
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_gate_lock);
+    if (config != NULL) {
+        *config = s_motion_gate.config;
+    }
+    if (stats != NULL) {
+        motion_gate_get_stats(&s_motion_gate, now, stats);
+    }
+    taskEXIT_CRITICAL(&s_gate_lock);
 }
 
 /**
@@ -449,11 +1480,122 @@ void restart_udp_camera(void)
 void start_udp_camera()
 {
     // 初始化帧率统计
-    frame_count = 0;
-    last_fps_time = esp_timer_get_time() / 1000;
+    fps_estimator_reset(&s_fps_estimator);
+    s_last_fps_log_us = esp_timer_get_time();
     current_fps = 0.0f;
+    // 初始化帧率调速器（只初始化一次，重启时保留运行时设置的目标帧率）
+    if (!s_governor_initialized) {
+        if (frame_governor_init(&s_governor, CONFIG_UDP_CAMERA_TARGET_FPS) != ESP_OK) {
+            ESP_LOGW(TAG, "调速定时器不可用，退化为按 tick 延时");
+        }
+        s_governor_initialized = true;
+    }
+    // 初始化运动门控（只初始化一次，重启时保留运行时的配置与统计）
+    if (!s_motion_gate_initialized) {
+        motion_gate_config_t gate_config = {
+            .enabled = CONFIG_MOTION_GATE,
+            .score_threshold = CONFIG_MOTION_GATE_SCORE,
+            .keepalive_ms = CONFIG_MOTION_GATE_KEEPALIVE_MS,
+            .holdoff_ms = CONFIG_MOTION_GATE_HOLDOFF_MS,
+            .stale_ms = 2000,
+        };
+        s_motion_gate_initialized = (motion_gate_init(&s_motion_gate, &gate_config) == ESP_OK);
+    }
+    // 初始化发送节拍器（只初始化一次，重启时保留运行时设置的码率）
+    if (!s_pacer_initialized) {
+        udp_pacer_config_t pacer_config = {
+            .target_bps = CONFIG_UDP_PACER_TARGET_KBPS * 1000,
+            .burst_bytes = CONFIG_UDP_PACER_BURST_BYTES,
+        };
+        if (udp_pacer_init(&s_pacer, &pacer_config) != ESP_OK) {
+            ESP_LOGW(TAG, "节拍定时器不可用，退化为忙等节拍");
+        }
+        s_pacer_initialized = true;
+    }
+    // 初始化重传环（0帧表示关闭NACK重传）
+    retransmit_ring_init(CONFIG_UDP_RETRANSMIT_RING_FRAMES, CONFIG_UDP_RETRANSMIT_RING_BYTES);
+    // 加载目标表（只加载一次，重启时保留运行时的修改与统计）
+    if (!s_dest_initialized) {
+        if (stream_dest_init() != ESP_OK) {
+            ESP_LOGE(TAG, "目标表初始化失败");
+        }
+        s_dest_initialized = true;
+    }
+    // RTP会话的SSRC、序号与时间戳起点取随机数（只初始化一次，重启后接收端仍可继续同一会话）
+    if (!s_rtp_initialized) {
+        rtp_jpeg_session_init(&s_rtp_session, esp_random(), (uint16_t)esp_random(), esp_random());
+        s_rtp_initialized = true;
+    }
+    if (s_stream_format == UDP_CAMERA_FORMAT_RTP_JPEG) {
+        char sdp[256];
+        if (udp_camera_get_sdp(sdp, sizeof(sdp)) > 0) {
+            ESP_LOGI(TAG, "RTP/JPEG 输出，SDP:\n%s", sdp);
+        }
+    }
+    // 帧分发：每个相机帧缓冲对应一个句柄
+    if (frame_broker_init(CAMERA_FB_COUNT) != ESP_OK) {
+        ESP_LOGE(TAG, "帧分发初始化失败");
+        return;
+    }
+#if CONFIG_EVENT_CLIP
+    if (event_clip_init() != ESP_OK) {
+        ESP_LOGE(TAG, "事件片段初始化失败");
+    }
+#endif
+#if CONFIG_MOTION_DETECT
+    if (motion_stage_init() != ESP_OK) {
+        ESP_LOGE(TAG, "运动检测初始化失败");
+    }
+#endif
+#if CONFIG_THUMB_STREAM
+    if (thumb_stream_init() != ESP_OK) {
+        ESP_LOGE(TAG, "缩略图流初始化失败");
+    }
+#endif
+#if CONFIG_CAMERA_HTTP_SERVER || CONFIG_RTSP_SERVER
+    // HTTP MJPEG 与 RTSP 共享的最新帧槽，读者直接引用相机帧缓冲
+    if (frame_slot_init() != ESP_OK) {
+        ESP_LOGE(TAG, "最新帧槽初始化失败，HTTP MJPEG 与 RTSP 不可用");
+    }
+#endif
+    // 启动流媒体HTTP接口（目标表管理、SDP、MJPEG等）
+    camera_httpd_start();
+    rtsp_server_start();
+    // 初始化自适应码率控制器（只初始化一次，重启时保留当前编码参数）
+    if (!s_abr_initialized) {
+        bitrate_ctrl_config_t abr_config = {
+            .target_bps = CONFIG_UDP_PACER_TARGET_KBPS * 1000 * CONFIG_UDP_ABR_TARGET_PCT / 100,
+            .target_fps = CONFIG_UDP_CAMERA_TARGET_FPS,
+            .quality_min = CONFIG_UDP_ABR_QUALITY_MIN,
+            .quality_max = CONFIG_UDP_ABR_QUALITY_MAX,
+            .quality_step = 2,
+            .levels = ABR_LEVEL_LIMIT,
+            .deadband_pct = 15,
+            .confirm_frames = 3,
+            .hold_frames = 10,
+            .loss_high_permille = 50,
+        };
+        bitrate_ctrl_setting_t initial = {.quality = ABR_INITIAL_QUALITY, .level = ABR_INITIAL_LEVEL};
+        if (bitrate_ctrl_init(&s_bitrate_ctrl, &abr_config, &initial) == ESP_OK) {
+            s_abr_initialized = true;
+        }
+        else {
+            ESP_LOGE(TAG, "码率控制器配置无效，关闭自适应码率");
+        }
+    }
+    // 注册UDP发送订阅者（只注册一次，停止时由发送任务清空队列）；发送端落后时丢弃最旧的帧
+    if (s_udp_sub == NULL) {
+        s_udp_sub = frame_broker_subscribe("udp", CONFIG_UDP_CAMERA_FRAME_QUEUE_DEPTH, FRAME_BROKER_DROP_OLDEST);
+        if (s_udp_sub == NULL) {
+            ESP_LOGE(TAG, "帧队列初始化失败");
+            return;
+        }
+    }
+    memset(&s_pipeline_stats, 0, sizeof(s_pipeline_stats));
+    s_send_cycles = 0;
+    s_pipeline_start_us = esp_timer_get_time();
     // 启动呼吸灯表示正常图像发送
     led_set_state(LED_STATE_BREATH);
-    // 增加任务栈大小以处理图像数据
-    xTaskCreate(udp_camera_task, "udp_camera_task", 8192, NULL, 5, &s_udp_task_handle);
+    // 增加任务栈大小以处理图像数据；发送任务与 Wi-Fi/lwIP 同核
+    xTaskCreatePinnedToCore(udp_camera_task, "udp_camera_task", 8192, NULL, 5, &s_udp_task_handle, UDP_CAMERA_SEND_CORE);
 }
\ No newline at end of file
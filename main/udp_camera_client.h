@@ -1,6 +1,55 @@
 #ifndef UDP_CAMERA_CLIENT_H
 #define UDP_CAMERA_CLIENT_H
 
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "udp_pacer.h"
+#include "retransmit_ring.h"
+#include "frame_queue.h"
+#include "frame_governor.h"
+#include "bitrate_ctrl.h"
+#include "motion_gate.h"
+
+/**
+ * @brief 图像输出格式
+ */
+typedef enum {
+    UDP_CAMERA_FORMAT_IMAGE_PROTO = 0,  // 自定义分包协议 (v1/v2，支持FEC与NACK重传)
+    UDP_CAMERA_FORMAT_RTP_JPEG,         // RTP/JPEG (RFC 2435)，可由 ffmpeg/GStreamer 按SDP直接播放
+} udp_camera_stream_format_t;
+
+/**
+ * @brief 采集/发送流水线统计信息
+ */
+typedef struct
+{
+    frame_queue_stats_t queue;  // 采集 -> 发送 帧队列（占用与丢帧）
+    uint32_t captured;          // 采集成功帧数
+    uint32_t capture_failures;  // 采集失败次数
+    uint32_t capture_avg_us;    // 采集耗时（滑动平均）
+    uint32_t capture_max_us;    // 采集耗时最大值
+    uint32_t sent;              // 发送成功帧数
+    uint32_t send_failures;     // 发送失败帧数
+    uint32_t send_in_flight;    // 发送阶段正在处理的帧数 (0/1)
+    uint32_t send_avg_us;       // 发送耗时（滑动平均）
+    uint32_t send_max_us;       // 发送耗时最大值
+    uint64_t bytes_sent;        // 发送成功的图像字节数（不含包头、FEC与重传）
+    uint32_t cycles_per_frame;  // 每帧分包与发送消耗的CPU周期（滑动平均，不含节拍等待）
+    uint16_t cpu_permille;      // 发送占用的CPU（千分比，按单核计），自启动以来
+} udp_camera_pipeline_stats_t;
+
+/**
+ * @brief 帧率与调度统计信息
+ */
+typedef struct
+{
+    frame_governor_stats_t governor;  // 采集调度（目标帧率、错过的截止时间、调度延迟）
+    float fps;                        // 发送帧率（滑动窗口）
+    uint32_t jitter_us;               // 发送帧间隔的标准差
+} udp_camera_frame_timing_t;
+
 /**
  * @brief 启动UDP图像传输
  */
@@ -28,4 +77,142 @@ float get_current_fps(void);
  */
 uint32_t get_total_frames(void);
 
+/**
+ * @brief 设置图像发送的目标码率和突发大小
+ * @param target_bps 目标码率 (bit/s)，0 表示不限速
+ * @param burst_bytes 令牌桶容量 (字节)
+ */
+void udp_camera_set_bitrate(uint32_t target_bps, uint32_t burst_bytes);
+
+/**
+ * @brief 设置图像传输协议版本（1: 兼容旧接收端, 2: 带帧序号/时间戳/CRC的包头）
+ * @param version 协议版本
+ * @return esp_err_t
+ */
+esp_err_t udp_camera_set_protocol_version(uint8_t version);
+
+/**
+ * @brief 获取当前图像传输协议版本
+ * @return 协议版本
+ */
+uint8_t udp_camera_get_protocol_version(void);
+
+/**
+ * @brief 切换图像输出格式，从下一帧开始生效
+ * @param format 输出格式
+ * @return esp_err_t
+ */
+esp_err_t udp_camera_set_stream_format(udp_camera_stream_format_t format);
+
+/**
+ * @brief 获取当前图像输出格式
+ * @return 输出格式
+ */
+udp_camera_stream_format_t udp_camera_get_stream_format(void);
+
+/**
+ * @brief 生成RTP/JPEG流的SDP描述（组播模式为组地址，否则为第一个单播目标）
+ * @param out 输出缓冲区
+ * @param size 缓冲区大小
+ * @return 写入的字节数，没有目标或缓冲区不足时返回 0
+ */
+size_t udp_camera_get_sdp(char* out, size_t size);
+
+/**
+ * @brief 设置FEC分组大小：每 group_size 个数据包附加一个XOR校验包（冗余 1/group_size）
+ *
+ * 仅在v2协议下生效，组内丢失一个包时接收端可恢复。
+ *
+ * @param group_size 分组大小，0 表示关闭FEC
+ * @return esp_err_t
+ */
+esp_err_t udp_camera_set_fec_group_size(uint8_t group_size);
+
+/**
+ * @brief 获取FEC分组大小
+ * @return 分组大小，0 表示关闭
+ */
+uint8_t udp_camera_get_fec_group_size(void);
+
+/**
+ * @brief 获取NACK重传统计信息（命中/未命中包数、附加延迟）
+ * @param stats 输出统计信息
+ */
+void udp_camera_get_retransmit_stats(retransmit_stats_t* stats);
+
+/**
+ * @brief 获取发送节拍器统计信息（目标码率与实际码率）
+ * @param stats 输出统计信息
+ */
+void udp_camera_get_pacer_stats(udp_pacer_stats_t* stats);
+
+/**
+ * @brief 设置目标帧率
+ * @param fps 目标帧率，0 表示尽可能快（受相机出帧速度与帧队列丢帧限制）
+ */
+void udp_camera_set_target_fps(uint32_t fps);
+
+/**
+ * @brief 获取帧率、抖动与错过的截止时间
+ * @param timing 输出统计信息
+ */
+void udp_camera_get_frame_timing(udp_camera_frame_timing_t* timing);
+
+/**
+ * @brief 开关自适应码率控制（根据帧大小、发送耗时、发送错误与接收端丢包报告调整JPEG质量与分辨率）
+ * @param enable 是否开启
+ * @param target_bps 控制器的目标码率 (bit/s)，0 表示保持当前值
+ */
+void udp_camera_set_adaptive_bitrate(bool enable, uint32_t target_bps);
+
+/**
+ * @brief 获取自适应码率控制是否开启及其目标码率
+ * @param target_bps 输出目标码率 (bit/s)，控制器未初始化时为 0，可为 NULL
+ * @return 是否开启
+ */
+bool udp_camera_get_adaptive_bitrate(uint32_t* target_bps);
+
+/**
+ * @brief 获取自适应码率统计信息（当前质量/分辨率档位、估算码率、调整次数）
+ * @param stats 输出统计信息
+ */
+void udp_camera_get_bitrate_stats(bitrate_ctrl_stats_t* stats);
+
+/**
+ * @brief 获取采集/发送流水线统计信息（各阶段占用、丢帧与耗时）
+ * @param stats 输出统计信息
+ */
+void udp_camera_get_pipeline_stats(udp_camera_pipeline_stats_t* stats);
+
+/**
+ * @brief 修改运动门控配置：开启后画面静止时只发送保活帧并把采集降到空闲帧率，检测到运动后在保持期内全速发送
+ * @param config 配置
+ */
+void udp_camera_set_motion_gate(const motion_gate_config_t* config);
+
+/**
+ * @brief 获取运动门控配置与统计信息（发送/抑制的帧数与字节数）
+ * @param config 输出配置，可为 NULL
+ * @param stats 输出统计信息，可为 NULL
+ */
+void udp_camera_get_motion_gate(motion_gate_config_t* config, motion_gate_stats_t* stats);
+
+/**
+ * @brief 暂停采集任务取帧（等待当前一帧采集完成），此后采集任务不再访问相机驱动与传感器
+ *
+ * release_frames 为 true 时还释放重传环与最新帧槽持有的帧，并等待各消费者归还全部帧缓冲，
+ * 成功返回后相机驱动没有在用的帧缓冲，可以安全地重新初始化；socket、HTTP 与 RTSP 服务不受影响。
+ * 采集任务未运行时直接返回（或只等待帧缓冲归还）。
+ *
+ * @param release_frames 是否等待全部帧缓冲归还
+ * @param timeout 最长等待时间
+ * @return esp_err_t 超时返回 ESP_ERR_TIMEOUT（此时已自动恢复采集）
+ */
+esp_err_t udp_camera_pause_capture(bool release_frames, TickType_t timeout);
+
+/**
+ * @brief 恢复 udp_camera_pause_capture() 暂停的采集
+ */
+void udp_camera_resume_capture(void);
+
 #endif /* UDP_CAMERA_CLIENT_H */
\ No newline at end of file
@@ -0,0 +1,203 @@
+/*
+ * udp_pacer.c
+ * 令牌桶发送节拍器实现
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+
+#include "udp_pacer.h"
+
+static const char* TAG = "UDP_PACER";
+
+// 小于该时间的等待直接忙等，避免定时器与任务切换的开销
+#define PACER_SPIN_THRESHOLD_US 50
+// 实际码率统计窗口
+#define PACER_RATE_WINDOW_US 1000000
+
+#define PACER_SCALE 1000000LL  // 令牌余额的放大系数
+
+static void pacer_timer_cb(void* arg)
+{
+    udp_pacer_t* pacer = (udp_pacer_t*)arg;
+    if (pacer->waiter != NULL) {
+        xTaskNotifyGive(pacer->waiter);
+    }
+}
+
+/**
+ * @brief 按经过的时间补充令牌
+ */
+static void pacer_refill(udp_pacer_t* pacer, int64_t now, uint32_t target_bps, uint32_t burst_bytes)
+{
+    int64_t elapsed = now - pacer->last_refill_us;
+    pacer->last_refill_us = now;
+    if (elapsed <= 0) {
+        return;
+    }
+
+    int64_t cap = (int64_t)burst_bytes * 8 * PACER_SCALE;
+    pacer->credit += elapsed * (int64_t)target_bps;
+    if (pacer->credit > cap) {
+        pacer->credit = cap;
+    }
+}
+
+/**
+ * @brief 阻塞调用任务 delay_us 微秒
+ *
+ * 微秒定时器同一时刻只服务一个等待任务，其他并发等待者退化为按 tick 延时。
+ */
+static void pacer_sleep_us(udp_pacer_t* pacer, int64_t delay_us)
+{
+    if (delay_us <= 0) {
+        return;
+    }
+    if (delay_us <= PACER_SPIN_THRESHOLD_US || pacer->timer == NULL) {
+        esp_rom_delay_us((uint32_t)delay_us);
+        return;
+    }
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    taskENTER_CRITICAL(&pacer->lock);
+    bool timer_free = (pacer->waiter == NULL);
+    if (timer_free) {
+        pacer->waiter = self;
+    }
+    taskEXIT_CRITICAL(&pacer->lock);
+
+    if (!timer_free) {
+        vTaskDelay(pdMS_TO_TICKS((delay_us + 999) / 1000) + 1);
+        return;
+    }
+
+    ulTaskNotifyTake(pdTRUE, 0);  // 清除残留的通知
+    if (esp_timer_start_once(pacer->timer, (uint64_t)delay_us) != ESP_OK) {
+        esp_rom_delay_us((uint32_t)delay_us);
+    }
+    else {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+
+    taskENTER_CRITICAL(&pacer->lock);
+    pacer->waiter = NULL;
+    taskEXIT_CRITICAL(&pacer->lock);
+}
+
+esp_err_t udp_pacer_init(udp_pacer_t* pacer, const udp_pacer_config_t* config)
+{
+    if (pacer == NULL || config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(pacer, 0, sizeof(*pacer));
+    pacer->config = *config;
+    portMUX_INITIALIZE(&pacer->lock);
+
+    int64_t now = esp_timer_get_time();
+    pacer->last_refill_us = now;
+    pacer->window_start_us = now;
+    pacer->credit = (int64_t)config->burst_bytes * 8 * PACER_SCALE;  // 初始令牌桶为满
+    pacer->stats.target_bps = config->target_bps;
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = pacer_timer_cb,
+        .arg = pacer,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "udp_pacer",
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &pacer->timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "创建节拍定时器失败: %s", esp_err_to_name(ret));
+        pacer->timer = NULL;
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "节拍器初始化: 目标码率 %lu bit/s, 突发 %lu bytes", (unsigned long)config->target_bps, (unsigned long)config->burst_bytes);
+    return ESP_OK;
+}
+
+void udp_pacer_deinit(udp_pacer_t* pacer)
+{
+    if (pacer == NULL || pacer->timer == NULL) {
+        return;
+    }
+    esp_timer_stop(pacer->timer);
+    esp_timer_delete(pacer->timer);
+    pacer->timer = NULL;
+}
+
+void udp_pacer_set_rate(udp_pacer_t* pacer, uint32_t target_bps, uint32_t burst_bytes)
+{
+    taskENTER_CRITICAL(&pacer->lock);
+    pacer->config.target_bps = target_bps;
+    pacer->config.burst_bytes = burst_bytes;
+    taskEXIT_CRITICAL(&pacer->lock);
+    ESP_LOGI(TAG, "节拍器码率修改为 %lu bit/s, 突发 %lu bytes", (unsigned long)target_bps, (unsigned long)burst_bytes);
+}
+
+void udp_pacer_wait(udp_pacer_t* pacer, size_t bytes)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t wait_us = 0;
+
+    // 在锁内预约令牌（余额可以为负，表示已被预约的未来发送时间），锁外再睡眠，
+    // 因此多个任务（例如正常发送与重传）可以共享同一个令牌桶
+    taskENTER_CRITICAL(&pacer->lock);
+    uint32_t target_bps = pacer->config.target_bps;
+    uint32_t burst_bytes = pacer->config.burst_bytes;
+
+    if (target_bps > 0) {
+        // 单包大于桶容量时按单包大小计算，避免永远等不到令牌
+        if (burst_bytes < bytes) {
+            burst_bytes = bytes;
+        }
+        pacer_refill(pacer, now, target_bps, burst_bytes);
+
+        pacer->credit -= (int64_t)bytes * 8 * PACER_SCALE;
+        if (pacer->credit < 0) {
+            wait_us = (-pacer->credit + target_bps - 1) / target_bps;
+            pacer->stats.wait_count++;
+            pacer->stats.wait_us += wait_us;
+        }
+    }
+    else {
+        pacer->last_refill_us = now;
+        pacer->credit = 0;
+    }
+
+    // 统计实际放行码率
+    pacer->stats.total_bytes += bytes;
+    pacer->window_bytes += bytes;
+    int64_t window = now - pacer->window_start_us;
+    if (window >= PACER_RATE_WINDOW_US) {
+        pacer->stats.achieved_bps = (uint32_t)(pacer->window_bytes * 8 * PACER_SCALE / window);
+        pacer->window_bytes = 0;
+        pacer->window_start_us = now;
+    }
+    pacer->stats.target_bps = target_bps;
+    taskEXIT_CRITICAL(&pacer->lock);
+
+    pacer_sleep_us(pacer, wait_us);
+}
+
+void udp_pacer_backoff(udp_pacer_t* pacer, uint32_t delay_us)
+{
+    pacer_sleep_us(pacer, delay_us);
+}
+
+void udp_pacer_get_stats(udp_pacer_t* pacer, udp_pacer_stats_t* stats)
+{
+    if (pacer == NULL || stats == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&pacer->lock);
+    *stats = pacer->stats;
+    stats->burst_bytes = pacer->config.burst_bytes;
+    taskEXIT_CRITICAL(&pacer->lock);
+}
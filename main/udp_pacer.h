@@ -0,0 +1,112 @@
+/*
+ * udp_pacer.h
+ * 令牌桶发送节拍器 - 按目标码率和突发大小释放UDP数据包
+ */
+
+#ifndef UDP_PACER_H
+#define UDP_PACER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 节拍器配置
+ */
+typedef struct
+{
+    uint32_t target_bps;   // 目标码率 (bit/s)，0 表示不限速
+    uint32_t burst_bytes;  // 令牌桶容量 (字节)，允许的最大突发
+} udp_pacer_config_t;
+
+/**
+ * @brief 节拍器统计信息
+ */
+typedef struct
+{
+    uint32_t target_bps;    // 当前目标码率 (bit/s)
+    uint32_t burst_bytes;   // 当前令牌桶容量 (字节)
+    uint32_t achieved_bps;  // 最近一个统计窗口的实际码率 (bit/s)
+    uint64_t total_bytes;   // 累计放行字节数
+    uint32_t wait_count;    // 因令牌不足而等待的次数
+    uint64_t wait_us;       // 累计等待时间 (微秒)
+} udp_pacer_stats_t;
+
+/**
+ * @brief 节拍器实例（可嵌入到其他结构中，无需动态分配）
+ */
+typedef struct
+{
+    udp_pacer_config_t config;
+    portMUX_TYPE lock;            // 保护令牌余额与统计，允许多个任务共享同一个节拍器
+    int64_t credit;               // 令牌余额，单位: bit * 1e6 (避免整数除法误差)，为负表示已预约
+    int64_t last_refill_us;       // 上次补充令牌的时间
+    int64_t window_start_us;      // 实际码率统计窗口起点
+    uint64_t window_bytes;        // 统计窗口内放行的字节数
+    esp_timer_handle_t timer;     // 微秒级唤醒定时器
+    TaskHandle_t waiter;          // 正在等待令牌的任务
+    udp_pacer_stats_t stats;
+} udp_pacer_t;
+
+/**
+ * @brief 初始化节拍器
+ *
+ * 定时器创建失败时返回错误，但实例仍然可用（退化为忙等节拍）。
+ *
+ * @param pacer 节拍器实例
+ * @param config 初始配置
+ * @return esp_err_t
+ */
+esp_err_t udp_pacer_init(udp_pacer_t* pacer, const udp_pacer_config_t* config);
+
+/**
+ * @brief 释放节拍器占用的定时器
+ * @param pacer 节拍器实例
+ */
+void udp_pacer_deinit(udp_pacer_t* pacer);
+
+/**
+ * @brief 运行时修改目标码率和突发大小
+ * @param pacer 节拍器实例
+ * @param target_bps 目标码率 (bit/s)，0 表示不限速
+ * @param burst_bytes 令牌桶容量 (字节)
+ */
+void udp_pacer_set_rate(udp_pacer_t* pacer, uint32_t target_bps, uint32_t burst_bytes);
+
+/**
+ * @brief 等待足够的令牌后放行一个数据包
+ *
+ * 短等待直接忙等，较长等待通过 esp_timer 在微秒精度上唤醒调用任务，
+ * 不受 FreeRTOS tick 粒度限制。
+ *
+ * @param pacer 节拍器实例
+ * @param bytes 即将发送的字节数
+ */
+void udp_pacer_wait(udp_pacer_t* pacer, size_t bytes);
+
+/**
+ * @brief 让出一段时间（例如协议栈缓冲区满时退避），同样使用微秒定时器
+ * @param pacer 节拍器实例
+ * @param delay_us 退避时间 (微秒)
+ */
+void udp_pacer_backoff(udp_pacer_t* pacer, uint32_t delay_us);
+
+/**
+ * @brief 获取统计信息
+ * @param pacer 节拍器实例
+ * @param stats 输出统计信息
+ */
+void udp_pacer_get_stats(udp_pacer_t* pacer, udp_pacer_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UDP_PACER_H */
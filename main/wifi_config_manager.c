@@ -33,6 +33,7 @@
 #include "udp_camera_client.h"
 #include "esp_task_wdt.h"
 #include "audio_player.h"  // 添加音频播放模块
+#include "event_clip.h"
 
 static const char* TAG = "wifi_config";
 
@@ -773,6 +774,14 @@ static void wifi_config_check_button_task(void* arg)
             }
         }
         else {
+#if CONFIG_EVENT_CLIP
+            // 短按：触发事件片段导出（未在推流时返回错误，忽略）
+            if (!s_provisioning_mode) {
+                ESP_LOGI(TAG, "Short press, triggering event clip");
+                event_clip_trigger(NULL, 0, EVENT_CLIP_SOURCE_BUTTON);
+                continue;
+            }
+#endif
             ESP_LOGI(TAG, "Button released before hold time, ignoring");
         }
     }
@@ -0,0 +1,317 @@
+#!/usr/bin/env python3
+"""
+PC端RTSP脚本客户端（测试用）
+按 OPTIONS -> DESCRIBE -> SETUP -> PLAY 建立会话，接收指定帧数的 RTP/JPEG (RFC 2435)，
+重建为完整的 JPEG 后 TEARDOWN，并报告会话建立耗时、首帧耗时、帧率与丢包。
+可同时打开多个会话测试设备的多会话与每会话码率预算，任一会话失败时返回非 0:
+
+    python rtsp_client.py rtsp://192.168.5.10/ --frames 50
+    python rtsp_client.py rtsp://192.168.5.10/ --tcp --sessions 2 --save-dir rtsp_frames
+"""
+
+import argparse
+import os
+import socket
+import struct
+import sys
+import threading
+import time
+from urllib.parse import urlparse
+
+RTP_HEADER = struct.Struct('!BBHII')
+JPEG_HEADER = struct.Struct('!BBHBBBB')  # type-specific, offset(高8位), offset(低16位), type, Q, width/8, height/8
+
+# RFC 2435 附录 A / JPEG Annex K 的标准哈夫曼表 (bits, values)
+LUM_DC = ([0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0], bytes(range(12)))
+CHR_DC = ([0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0], bytes(range(12)))
+LUM_AC = ([0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d], bytes.fromhex(
+    '01020300041105122131410613516107227114328191a1082342b1c11552d1f0'
+    '2433627282090a161718191a25262728292a3435363738393a43444546474849'
+    '4a535455565758595a636465666768696a737475767778797a83848586878889'
+    '8a92939495969798999aa2a3a4a5a6a7a8a9aab2b3b4b5b6b7b8b9bac2c3c4c5'
+    'c6c7c8c9cad2d3d4d5d6d7d8d9dae1e2e3e4e5e6e7e8e9eaf1f2f3f4f5f6f7f8f9fa'))
+CHR_AC = ([0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77], bytes.fromhex(
+    '000102031104052131061241510761711322328108144291a1b1c109233352f0'
+    '156272d10a162434e125f11718191a262728292a35363738393a434445464748'
+    '494a535455565758595a636465666768696a737475767778797a828384858687'
+    '88898a92939495969798999aa2a3a4a5a6a7a8a9aab2b3b4b5b6b7b8b9bac2c3'
+    'c4c5c6c7c8c9cad2d3d4d5d6d7d8d9dae2e3e4e5e6e7e8e9eaf2f3f4f5f6f7f8f9fa'))
+
+
+def _segment(marker, body):
+    return bytes([0xFF, marker]) + struct.pack('!H', len(body) + 2) + body
+
+
+def build_jpeg_header(jpeg_type, width, height, qtables, restart_interval):
+    """按 RFC 2435 附录 B 由 RTP/JPEG 头重建 JFIF 头"""
+    sampling = 0x21 if (jpeg_type & 0x3F) == 0 else 0x22
+    header = b'\xff\xd8'
+    header += _segment(0xDB, b'\x00' + qtables[:64] + b'\x01' + qtables[64:128])
+    if restart_interval:
+        header += _segment(0xDD, struct.pack('!H', restart_interval))
+    header += _segment(0xC0, struct.pack('!BHHB', 8, height, width, 3) + bytes([1, sampling, 0, 2, 0x11, 1, 3, 0x11, 1]))
+    tables = b''
+    for table_class, (bits, values) in ((0x00, LUM_DC), (0x10, LUM_AC), (0x01, CHR_DC), (0x11, CHR_AC)):
+        tables += bytes([table_class]) + bytes(bits) + values
+    header += _segment(0xC4, tables)
+    header += _segment(0xDA, bytes([3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0]))
+    return header
+
+
+class RtpJpegDepacketizer:
+    """RFC 2435 解包：按时间戳与分片偏移重组一帧，丢包的帧整帧丢弃"""
+
+    def __init__(self):
+        self.timestamp = None
+        self.data = bytearray()
+        self.params = None
+        self.last_seq = None
+        self.lost_packets = 0
+        self.broken_frames = 0
+
+    def feed(self, packet):
+        """处理一个RTP包，帧完整时返回 (rtp时间戳, JPEG)"""
+        if len(packet) < RTP_HEADER.size + JPEG_HEADER.size:
+            return None
+        vpxcc, mpt, seq, timestamp, _ssrc = RTP_HEADER.unpack_from(packet)
+        if vpxcc >> 6 != 2 or (mpt & 0x7F) != 26:
+            return None
+        if self.last_seq is not None and seq != (self.last_seq + 1) & 0xFFFF:
+            self.lost_packets += (seq - self.last_seq - 1) & 0xFFFF
+        self.last_seq = seq
+
+        pos = RTP_HEADER.size
+        _tspec, off_hi, off_lo, jpeg_type, q, width, height = JPEG_HEADER.unpack_from(packet, pos)
+        offset = (off_hi << 16) | off_lo
+        pos += JPEG_HEADER.size
+        restart_interval = 0
+        if jpeg_type >= 64:
+            restart_interval = struct.unpack_from('!H', packet, pos)[0]
+            pos += 4
+
+        if offset == 0:
+            qtables = None
+            if q >= 128:
+                _mbz, precision, length = struct.unpack_from('!BBH', packet, pos)
+                if precision != 0 or length != 128:
+                    raise ValueError('unsupported quantization table header')
+                qtables = packet[pos + 4:pos + 4 + length]
+                pos += 4 + length
+            if qtables is None:
+                raise ValueError('Q < 128 (predefined tables) is not used by the device')
+            self.timestamp = timestamp
+            self.data = bytearray()
+            self.params = (jpeg_type, width * 8, height * 8, qtables, restart_interval)
+        elif timestamp != self.timestamp or offset != len(self.data):
+            # 帧中间丢包，丢弃到下一帧开头
+            if self.timestamp is not None:
+                self.broken_frames += 1
+            self.timestamp = None
+            return None
+
+        if self.timestamp is None:
+            return None
+        self.data += packet[pos:]
+        if mpt & 0x80:
+            self.timestamp = None
+            return timestamp, build_jpeg_header(*self.params) + bytes(self.data) + b'\xff\xd9'
+        return None
+
+
+class RtspSession:
+    def __init__(self, url, use_tcp, frames, save_dir, index, timeout):
+        self.url = url if url.endswith('/') else url + '/'
+        self.use_tcp = use_tcp
+        self.frames_wanted = frames
+        self.save_dir = save_dir
+        self.index = index
+        self.timeout = timeout
+        self.cseq = 0
+        self.session = None
+        self.result = {}
+        self.error = None
+        self.buffer = b''
+
+    def request(self, method, url, headers=None):
+        self.cseq += 1
+        lines = ['%s %s RTSP/1.0' % (method, url), 'CSeq: %d' % self.cseq, 'User-Agent: rtsp_client.py']
+        if self.session:
+            lines.append('Session: %s' % self.session)
+        for key, value in (headers or {}).items():
+            lines.append('%s: %s' % (key, value))
+        self.sock.sendall(('\r\n'.join(lines) + '\r\n\r\n').encode())
+        return self.read_response()
+
+    def read_response(self):
+        while True:
+            # 跳过交织的RTP数据
+            while self.buffer.startswith(b'$') and len(self.buffer) >= 4:
+                length = struct.unpack('!H', self.buffer[2:4])[0]
+                if len(self.buffer) < 4 + length:
+                    break
+                self.buffer = self.buffer[4 + length:]
+            end = self.buffer.find(b'\r\n\r\n')
+            if end >= 0 and not self.buffer.startswith(b'$'):
+                head = self.buffer[:end].decode()
+                lines = head.split('\r\n')
+                headers = {}
+                for line in lines[1:]:
+                    key, _, value = line.partition(':')
+                    headers[key.strip().lower()] = value.strip()
+                length = int(headers.get('content-length', 0))
+                if len(self.buffer) >= end + 4 + length:
+                    body = self.buffer[end + 4:end + 4 + length].decode()
+                    self.buffer = self.buffer[end + 4 + length:]
+                    status = int(lines[0].split()[1])
+                    # 会话已满时设备在读请求前直接回 453，不带 CSeq
+                    if status < 400 and headers.get('cseq') != str(self.cseq):
+                        raise RuntimeError('CSeq mismatch: %s' % headers.get('cseq'))
+                    return status, headers, body
+            data = self.sock.recv(4096)
+            if not data:
+                raise RuntimeError('connection closed')
+            self.buffer += data
+
+    def read_interleaved(self, channel):
+        """读取一个交织数据包"""
+        while True:
+            if len(self.buffer) >= 4 and self.buffer.startswith(b'$'):
+                length = struct.unpack('!H', self.buffer[2:4])[0]
+                if len(self.buffer) >= 4 + length:
+                    packet_channel = self.buffer[1]
+                    packet = self.buffer[4:4 + length]
+                    self.buffer = self.buffer[4 + length:]
+                    if packet_channel == channel:
+                        return packet
+                    continue
+            elif self.buffer and not self.buffer.startswith(b'$'):
+                raise RuntimeError('unexpected RTSP data while playing')
+            data = self.sock.recv(65536)
+            if not data:
+                raise RuntimeError('connection closed')
+            self.buffer += data
+
+    def run(self):
+        try:
+            self._run()
+        except Exception as exc:  # noqa: BLE001 - 报告给主线程
+            self.error = str(exc)
+
+    def _run(self):
+        parsed = urlparse(self.url)
+        host, port = parsed.hostname, parsed.port or 554
+        start = time.monotonic()
+        self.sock = socket.create_connection((host, port), timeout=self.timeout)
+
+        status, headers, _ = self.request('OPTIONS', self.url)
+        if status != 200 or 'PLAY' not in headers.get('public', ''):
+            raise RuntimeError('OPTIONS failed: %d' % status)
+
+        status, headers, sdp = self.request('DESCRIBE', self.url, {'Accept': 'application/sdp'})
+        if status != 200 or 'rtpmap:26 JPEG/90000' not in sdp:
+            raise RuntimeError('DESCRIBE failed or unexpected SDP: %d' % status)
+        base = headers.get('content-base', self.url)
+        control = 'track1'
+        for line in sdp.splitlines():
+            if line.startswith('a=control:') and line != 'a=control:*':
+                control = line[len('a=control:'):]
+        track_url = control if control.startswith('rtsp://') else base + control
+
+        udp_sock = None
+        if self.use_tcp:
+            transport = 'RTP/AVP/TCP;unicast;interleaved=0-1'
+        else:
+            udp_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            udp_sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+            udp_sock.bind(('0.0.0.0', 0))
+            udp_sock.settimeout(self.timeout)
+            rtp_port = udp_sock.getsockname()[1]
+            transport = 'RTP/AVP;unicast;client_port=%d-%d' % (rtp_port, rtp_port + 1)
+        status, headers, _ = self.request('SETUP', track_url, {'Transport': transport})
+        if status != 200:
+            raise RuntimeError('SETUP failed: %d' % status)
+        self.session = headers['session'].split(';')[0]
+
+        status, headers, _ = self.request('PLAY', base, {'Range': 'npt=0.000-'})
+        if status != 200:
+            raise RuntimeError('PLAY failed: %d' % status)
+        setup_time = time.monotonic() - start
+
+        depacketizer = RtpJpegDepacketizer()
+        frames = []
+        first_frame_time = None
+        while len(frames) < self.frames_wanted:
+            if self.use_tcp:
+                packet = self.read_interleaved(0)
+            else:
+                packet = udp_sock.recv(2048)
+            frame = depacketizer.feed(packet)
+            if frame is None:
+                continue
+            if first_frame_time is None:
+                first_frame_time = time.monotonic() - start
+            frames.append(frame)
+            if self.save_dir:
+                path = os.path.join(self.save_dir, 'session%d_%04d.jpg' % (self.index, len(frames)))
+                with open(path, 'wb') as f:
+                    f.write(frame[1])
+        elapsed = time.monotonic() - start - first_frame_time
+
+        self.request('TEARDOWN', base)
+        self.sock.close()
+        if udp_sock:
+            udp_sock.close()
+
+        for _, jpeg in frames:
+            if not jpeg.startswith(b'\xff\xd8') or not jpeg.endswith(b'\xff\xd9'):
+                raise RuntimeError('reconstructed frame is not a JPEG')
+        timestamps = [t for t, _ in frames]
+        if any(((b - a) & 0xFFFFFFFF) == 0 or ((b - a) & 0xFFFFFFFF) > 0x7FFFFFFF for a, b in zip(timestamps, timestamps[1:])):
+            raise RuntimeError('RTP timestamps are not increasing')
+
+        self.result = {
+            'setup_ms': setup_time * 1000,
+            'first_frame_ms': first_frame_time * 1000,
+            'fps': (len(frames) - 1) / elapsed if elapsed > 0 else 0.0,
+            'frames': len(frames),
+            'lost_packets': depacketizer.lost_packets,
+            'broken_frames': depacketizer.broken_frames,
+            'avg_frame_bytes': sum(len(j) for _, j in frames) / len(frames),
+        }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="RTSP脚本客户端：建立会话、接收并校验 RTP/JPEG 帧")
+    parser.add_argument("url", help="RTSP地址，例如 rtsp://192.168.5.10/")
+    parser.add_argument("--tcp", action="store_true", help="使用 RTSP 连接上的 TCP 交织传输（默认 RTP over UDP）")
+    parser.add_argument("--frames", type=int, default=30, help="每个会话接收的帧数")
+    parser.add_argument("--sessions", type=int, default=1, help="同时打开的会话数")
+    parser.add_argument("--timeout", type=float, default=10.0, help="socket 超时 (秒)")
+    parser.add_argument("--save-dir", help="保存重建的 JPEG 帧")
+    args = parser.parse_args()
+
+    if args.save_dir:
+        os.makedirs(args.save_dir, exist_ok=True)
+
+    sessions = [RtspSession(args.url, args.tcp, args.frames, args.save_dir, i, args.timeout) for i in range(args.sessions)]
+    threads = [threading.Thread(target=s.run) for s in sessions]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    failed = False
+    for i, s in enumerate(sessions):
+        if s.error:
+            failed = True
+            print("会话 %d 失败: %s" % (i, s.error))
+            continue
+        r = s.result
+        print("会话 %d: 建立 %.1f ms, 首帧 %.1f ms, %d 帧, %.2f FPS, 平均帧 %.0f bytes, 丢包 %d, 不完整帧 %d" % (
+            i, r['setup_ms'], r['first_frame_ms'], r['frames'], r['fps'], r['avg_frame_bytes'],
+            r['lost_packets'], r['broken_frames']))
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,362 @@
+/*
+ * audio_vectors.h
+ * mu-law 与 IMA-ADPCM 参考向量，由 gen_audio_vectors.py 用 audio_sender.py 的编码器生成，不要手工修改
+ */
+
+#ifndef AUDIO_VECTORS_H
+#define AUDIO_VECTORS_H
+
+#include <stdint.h>
+
+#define VECTOR_FRAME 320        // 每个包的样本数
+#define VECTOR_PACKETS 3
+#define VECTOR_SAMPLES 960
+#define VECTOR_ADPCM_PACKET 164  // 每个 ADPCM 包的字节数（含包头）
+
+static const int16_t s_vector_input[960] = {
+    658, 4842, 9404, 11477, 12895, 12617, 11317, 9283, 8336, 6960, 5292, 7108,
+    8559, 8973, 11465, 11051, 11070, 8764, 3478, -292, -5134, -9036, -12522, -15372,
+    -15706, -13447, -11968, -8812, -6136, -5381, -4571, -5974, -6793, -8892, -8327, -7743,
+    -6950, -3003, 340, 6171, 9976, 13550, 15263, 16732, 15873, 13015, 10726, 6603,
+    4765, 3764, 3667, 5182, 4846, 6141, 5686, 4753, 3022, -873, -6228, -10016,
+    -14235, -16789, -17053, -15856, -14564, -11569, -8399, -4440, -2539, -2287, -1347, -3129,
+    -3601, -3629, -3562, -696, 2280, 5288, 10248, 14146, 16401, 18121, 18118, 14897,
+    12254, 7873, 3930, 2184, -578, -901, -446, 1020, 1449, 1591, -437, -2478,
+    -6219, -9887, -13411, -16995, -17674, -17694, -15880, -12782, -7670, -4745, -37, 2133,
+    3108, 3032, 2197, 1607, 475, 964, 3334, 6480, 9018, 12736, 15661, 18038,
+    16792, 15099, 12086, 8460, 4756, -8, -3289, -4894, -5607, -5033, -4189, -3538,
+    -3299, -4384, -6067, -8693, -11600, -14548, -16725, -16784, -14717, -13274, -8151, -3343,
+    -43, 4273, 7428, 7515, 8796, 7737, 6031, 5075, 5439, 5873, 7560, 10013,
+    12924, 14703, 16029, 15353, 12079, 8116, 4241, -2067, -5561, -9492, -10254, -10551,
+    -10476, -8774, -7157, -6455, -5649, -6437, -8406, -11332, -12710, -14281, -13739, -11956,
+    -8315, -3828, 1056, 6049, 9257, 12571, 13526, 12377, 9835, 8149, 6797, 5873,
+    5593, 6834, 8346, 10082, 12454, 11805, 10779, 6324, 3145, -1873, -6714, -10668,
+    -12975, -14868, -14497, -11934, -9683, -7787, -6048, -4890, -5697, -6688, -7564, -8509,
+    -9947, -8512, -6544, -2531, 2778, 6789, 11081, 14037, 16154, 15767, 14034, 11383,
+    9380, 6839, 4183, 3812, 3881, 5297, 7252, 7531, 6922, 5024, 1061, -3070,
+    -7285, -12412, -15490, -17290, -17104, -15143, -12615, -9552, -6161, -4167, -1845, -2106,
+    -2132, -4123, -5042, -4703, -3466, -884, 3865, 7089, 10876, 14819, 17068, 17621,
+    16749, 14533, 10912, 7471, 3888, 894, -47, -232, 362, 1270, 1984, 1542,
+    -809, -4281, -7604, -11372, -14290, -16755, -17630, -17271, -14928, -11014, -7204, -2763,
+    52, 1813, 1945, 1652, 1410, 896, 892, 1724, 4088, 7251, 11015, 14090,
+    16249, 16942, 16507, 14359, 11505, 6186, 3355, -350, -3931, -4542, -4823, -5075,
+    -3073, -2327, -3191, -4862, -6181, -9087, -12355, -15052, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, -32768, -32768, -32768, -32768,
+    -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768,
+    -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768,
+    -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768,
+    -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768,
+    -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 27716, 21213, -11480, -30000, -11480, 21213, 27716, 0, -27716, -21213, 11480,
+    30000, 11480, -21213, -27716, 0, 27716, 21213, -11480, -30000, -11480, 21213, 27716,
+    0, -27716, -21213, 11480, 30000, 11480, -21213, -27716, 0, 27716, 21213, -11480,
+    -30000, -11480, 21213, 27716, 0, -27716, -21213, 11480, 30000, 11480, -21213, -27716,
+    0, 27716, 21213, -11480, -30000, -11480, 21213, 27716, 0, -27716, -21213, 11480,
+    30000, 11480, -21213, -27716, 0, 27716, 21213, -11480, -30000, -11480, 21213, 27716,
+    0, -27716, -21213, 11480, 30000, 11480, -21213, -27716, 0, 27716, 21213, -11480,
+    -30000, -11480, 21213, 27716, 0, -27716, -21213, 11480, 30000, 11480, -21213, -27716,
+    0, 27716, 21213, -11480, -30000, -11480, 21213, 27716, 0, -27716, -21213, 11480,
+    30000, 11480, -21213, -27716, 0, 27716, 21213, -11480, -30000, -11480, 21213, 27716,
+    0, -27716, -21213, 11480, 30000, 11480, -21213, -27716, 0, 27716, 21213, -11480,
+    -30000, -11480, 21213, 27716, 0, -27716, -21213, 11480, 30000, 11480, -21213, -27716,
+    0, 27716, 21213, -11480, -30000, -11480, 21213, 27716, 0, -27716, -21213, 11480,
+    30000, 11480, -21213, -27716, -91, -18, -128, -142, 130, 66, -91, 64,
+    -71, 112, 122, 162, -11, -120, -58, 65, 29, -53, -117, -55,
+    96, -128, -5, 112, -192, -162, -77, 47, -198, -74, 60, 195,
+    48, 192, 48, -129, 75, 173, -83, 107, -21, -151, 109, 126,
+    132, -143, -25, 120, 174, -109, 138, 109, 192, -84, 96, -97,
+    -25, -111, 107, 15, -82, 184, -70, 43, -5, 86, -169, 39,
+    76, -14, -43, -99, 40, 178, 141, 177, -75, 131, -116, 74,
+    191, -199, -57, 144, -130, 85, -163, 58, 70, 70, 183, 116,
+    -75, 176, 31, 198, 120, -39, 94, -102, -113, -200, -11, 108,
+    195, 43, 117, -178, -135, 140, -118, -25, 135, -58, 16, -104,
+    129, -137, -82, 22, 118, -49, 196, 165, -98, 44, -84, -89,
+    -63, 22, -123, 57, 88, 182, 108, -82, 168, 66, -141, -59,
+    -143, 169, -195, -136, -17, 170, 93, 11, -128, 68, -199, -18,
+    120, -105, 10, 72, -52, 145, -130, -68, -163, -94, -149, 194,
+    21, -46, -125, 107, -35, 170, -151, -81, 7, -78, -118, 113,
+    54, -142, 183, -184, -152, 116, -59, 13, 22, 67, 40, -150,
+    -56, -14, 175, 107, 109, 22, 0, -1, -119, -126, -48, -152,
+    40, -196, 187, -128, -192, 95, 195, 131, 26, 123, -184, -70,
+    -164, 142, -108, 105, -54, 4, -113, -9, -138, 95, 197, 103,
+    -72, -139, 130, -18, 182, 63, -33, 186, -71, 148, 128, 90,
+    163, 72, -20, 138, -29, -126, 143, 86, -79, -133, -127, 169,
+    -83, 15, -4, 8, 95, -147, 18, -69, 5, -175, -43, 3,
+    -95, -7, -141, -59, -134, -103, 36, 123, -34, -120, 193, 124,
+    89, -187, -89, 169, -113, 100, -38, 129, -158, 145, -114, -151,
+    85, 81, 191, 101, -82, 145, -84, -100, 169, -21, 62, 91,
+    25, -76, 123, 26, 190, -77, 47, -50, 147, 98, -97, 72,
+    6, -200, -174, 141, -34, -130, -135, -104, 4, -116, -93, -55,
+};
+
+static const uint8_t s_vector_mulaw[960] = {
+    215, 172, 157, 153, 150, 151, 153, 157, 159, 164, 170, 163, 159, 158, 153, 154,
+    154, 158, 179, 101, 43, 30, 23, 17, 17, 21, 24, 30, 39, 42, 45, 40,
+    36, 30, 31, 33, 36, 55, 226, 167, 156, 149, 145, 143, 144, 150, 154, 165,
+    172, 177, 178, 171, 172, 167, 169, 172, 183, 80, 39, 28, 19, 15, 15, 16,
+    19, 25, 31, 46, 59, 61, 72, 54, 50, 50, 51, 86, 189, 170, 155, 148,
+    143, 142, 142, 146, 151, 160, 176, 189, 89, 79, 93, 205, 199, 197, 94, 59,
+    39, 28, 21, 15, 14, 14, 16, 22, 33, 44, 122, 190, 182, 183, 189, 196,
+    221, 206, 180, 166, 158, 150, 145, 142, 143, 146, 152, 159, 172, 126, 53, 44,
+    41, 43, 47, 51, 53, 46, 39, 30, 25, 19, 15, 15, 18, 21, 31, 52,
+    122, 174, 162, 162, 158, 161, 167, 171, 170, 168, 161, 156, 150, 147, 144, 145,
+    152, 159, 174, 62, 41, 29, 27, 27, 27, 30, 35, 38, 41, 38, 31, 25,
+    22, 19, 20, 24, 31, 49, 205, 167, 157, 151, 149, 151, 156, 159, 164, 168,
+    169, 164, 159, 156, 151, 152, 154, 166, 182, 64, 37, 26, 22, 18, 19, 24,
+    28, 33, 39, 44, 41, 37, 33, 31, 28, 31, 37, 59, 185, 164, 154, 148,
+    144, 144, 148, 153, 157, 164, 175, 177, 176, 170, 163, 162, 164, 171, 205, 54,
+    35, 23, 17, 14, 15, 18, 23, 29, 39, 47, 65, 62, 62, 47, 43, 45,
+    51, 80, 176, 163, 154, 146, 143, 142, 143, 147, 154, 162, 176, 207, 121, 105,
+    225, 202, 191, 197, 82, 46, 33, 25, 19, 15, 14, 15, 18, 26, 35, 57,
+    248, 193, 191, 196, 199, 207, 207, 194, 175, 163, 154, 148, 144, 143, 143, 147,
+    153, 167, 180, 97, 48, 45, 44, 43, 54, 60, 54, 44, 39, 29, 23, 18,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 132, 139, 25, 2, 25, 139, 132, 255, 4, 11, 153, 130, 153, 11, 4,
+    255, 132, 139, 25, 2, 25, 139, 132, 255, 4, 11, 153, 130, 153, 11, 4,
+    255, 132, 139, 25, 2, 25, 139, 132, 255, 4, 11, 153, 130, 153, 11, 4,
+    255, 132, 139, 25, 2, 25, 139, 132, 255, 4, 11, 153, 130, 153, 11, 4,
+    255, 132, 139, 25, 2, 25, 139, 132, 255, 4, 11, 153, 130, 153, 11, 4,
+    255, 132, 139, 25, 2, 25, 139, 132, 255, 4, 11, 153, 130, 153, 11, 4,
+    255, 132, 139, 25, 2, 25, 139, 132, 255, 4, 11, 153, 130, 153, 11, 4,
+    255, 132, 139, 25, 2, 25, 139, 132, 255, 4, 11, 153, 130, 153, 11, 4,
+    255, 132, 139, 25, 2, 25, 139, 132, 255, 4, 11, 153, 130, 153, 11, 4,
+    255, 132, 139, 25, 2, 25, 139, 132, 255, 4, 11, 153, 130, 153, 11, 4,
+    116, 125, 111, 110, 239, 247, 116, 247, 118, 241, 240, 237, 126, 112, 120, 247,
+    251, 120, 112, 120, 243, 111, 126, 241, 107, 109, 117, 249, 107, 118, 247, 235,
+    249, 235, 249, 111, 246, 236, 117, 242, 124, 110, 241, 239, 239, 110, 124, 240,
+    236, 113, 239, 241, 235, 116, 243, 115, 124, 113, 242, 253, 117, 236, 118, 250,
+    126, 244, 109, 250, 245, 125, 122, 115, 250, 236, 238, 236, 118, 239, 112, 246,
+    235, 107, 120, 238, 111, 244, 109, 248, 246, 246, 236, 240, 118, 236, 251, 235,
+    240, 122, 243, 114, 113, 107, 126, 241, 235, 250, 240, 108, 111, 238, 112, 124,
+    239, 120, 253, 114, 239, 111, 117, 252, 240, 121, 235, 237, 115, 249, 116, 116,
+    119, 252, 112, 248, 244, 236, 241, 117, 237, 247, 110, 120, 110, 237, 107, 111,
+    125, 237, 243, 254, 111, 246, 107, 125, 240, 114, 254, 246, 120, 238, 111, 118,
+    109, 115, 110, 235, 252, 121, 111, 242, 123, 237, 110, 117, 254, 117, 112, 241,
+    248, 110, 236, 108, 110, 240, 120, 253, 252, 247, 250, 110, 120, 125, 236, 242,
+    241, 252, 255, 127, 112, 111, 121, 110, 250, 107, 236, 111, 107, 243, 235, 239,
+    252, 240, 108, 118, 109, 238, 113, 242, 120, 254, 113, 126, 111, 243, 235, 242,
+    118, 111, 239, 125, 236, 247, 123, 236, 118, 238, 239, 244, 237, 246, 124, 239,
+    123, 111, 238, 244, 117, 111, 111, 237, 117, 253, 126, 254, 243, 110, 253, 118,
+    254, 108, 122, 255, 115, 126, 110, 120, 111, 114, 250, 240, 123, 112, 235, 239,
+    244, 108, 116, 237, 113, 242, 122, 239, 109, 238, 113, 110, 244, 245, 235, 242,
+    117, 238, 116, 114, 237, 124, 247, 244, 252, 117, 240, 252, 235, 117, 249, 121,
+    238, 243, 115, 246, 254, 107, 108, 238, 123, 111, 111, 114, 254, 112, 115, 120,
+};
+
+static const int16_t s_vector_mulaw_decoded[960] = {
+    652, 4860, 9340, 11388, 12924, 12412, 11388, 9340, 8316, 6908, 5372, 7164,
+    8316, 8828, 11388, 10876, 10876, 8828, 3516, -292, -5116, -8828, -12412, -15484,
+    -15484, -13436, -11900, -8828, -6140, -5372, -4604, -5884, -6908, -8828, -8316, -7676,
+    -6908, -3004, 340, 6140, 9852, 13436, 15484, 16764, 15996, 12924, 10876, 6652,
+    4860, 3772, 3644, 5116, 4860, 6140, 5628, 4860, 3004, -876, -6140, -9852,
+    -14460, -16764, -16764, -15996, -14460, -11388, -8316, -4348, -2492, -2236, -1372, -3132,
+    -3644, -3644, -3516, -684, 2236, 5372, 10364, 13948, 16764, 17788, 17788, 14972,
+    12412, 7932, 3900, 2236, -588, -924, -460, 1052, 1436, 1564, -428, -2492,
+    -6140, -9852, -13436, -16764, -17788, -17788, -15996, -12924, -7676, -4860, -40, 2108,
+    3132, 3004, 2236, 1628, 460, 988, 3388, 6396, 8828, 12924, 15484, 17788,
+    16764, 14972, 11900, 8316, 4860, -8, -3260, -4860, -5628, -5116, -4092, -3516,
+    -3260, -4348, -6140, -8828, -11388, -14460, -16764, -16764, -14972, -13436, -8316, -3388,
+    -40, 4348, 7420, 7420, 8828, 7676, 6140, 5116, 5372, 5884, 7676, 9852,
+    12924, 14460, 15996, 15484, 11900, 8316, 4348, -2108, -5628, -9340, -10364, -10364,
+    -10364, -8828, -7164, -6396, -5628, -6396, -8316, -11388, -12924, -14460, -13948, -11900,
+    -8316, -3772, 1052, 6140, 9340, 12412, 13436, 12412, 9852, 8316, 6908, 5884,
+    5628, 6908, 8316, 9852, 12412, 11900, 10876, 6396, 3132, -1884, -6652, -10876,
+    -12924, -14972, -14460, -11900, -9852, -7676, -6140, -4860, -5628, -6652, -7676, -8316,
+    -9852, -8316, -6652, -2492, 2748, 6908, 10876, 13948, 15996, 15996, 13948, 11388,
+    9340, 6908, 4092, 3772, 3900, 5372, 7164, 7420, 6908, 5116, 1052, -3132,
+    -7164, -12412, -15484, -17788, -16764, -14972, -12412, -9340, -6140, -4092, -1820, -2108,
+    -2108, -4092, -5116, -4604, -3516, -876, 3900, 7164, 10876, 14972, 16764, 17788,
+    16764, 14460, 10876, 7420, 3900, 924, -48, -228, 356, 1244, 1980, 1564,
+    -812, -4348, -7676, -11388, -14460, -16764, -17788, -16764, -14972, -10876, -7164, -2748,
+    56, 1820, 1980, 1628, 1436, 924, 924, 1756, 4092, 7164, 10876, 13948,
+    15996, 16764, 16764, 14460, 11388, 6140, 3388, -356, -3900, -4604, -4860, -5116,
+    -3132, -2364, -3132, -4860, -6140, -9340, -12412, -14972, 32124, 32124, 32124, 32124,
+    32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124,
+    32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124,
+    32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124,
+    32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124,
+    32124, 32124, 32124, 32124, 32124, 32124, 32124, 32124, -32124, -32124, -32124, -32124,
+    -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124,
+    -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124,
+    -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124,
+    -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124,
+    -32124, -32124, -32124, -32124, -32124, -32124, -32124, -32124, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 28028, 20860, -11388, -30076, -11388, 20860, 28028, 0, -28028, -20860, 11388,
+    30076, 11388, -20860, -28028, 0, 28028, 20860, -11388, -30076, -11388, 20860, 28028,
+    0, -28028, -20860, 11388, 30076, 11388, -20860, -28028, 0, 28028, 20860, -11388,
+    -30076, -11388, 20860, 28028, 0, -28028, -20860, 11388, 30076, 11388, -20860, -28028,
+    0, 28028, 20860, -11388, -30076, -11388, 20860, 28028, 0, -28028, -20860, 11388,
+    30076, 11388, -20860, -28028, 0, 28028, 20860, -11388, -30076, -11388, 20860, 28028,
+    0, -28028, -20860, 11388, 30076, 11388, -20860, -28028, 0, 28028, 20860, -11388,
+    -30076, -11388, 20860, 28028, 0, -28028, -20860, 11388, 30076, 11388, -20860, -28028,
+    0, 28028, 20860, -11388, -30076, -11388, 20860, 28028, 0, -28028, -20860, 11388,
+    30076, 11388, -20860, -28028, 0, 28028, 20860, -11388, -30076, -11388, 20860, 28028,
+    0, -28028, -20860, 11388, 30076, 11388, -20860, -28028, 0, 28028, 20860, -11388,
+    -30076, -11388, 20860, 28028, 0, -28028, -20860, 11388, 30076, 11388, -20860, -28028,
+    0, 28028, 20860, -11388, -30076, -11388, 20860, 28028, 0, -28028, -20860, 11388,
+    30076, 11388, -20860, -28028, -88, -16, -132, -148, 132, 64, -88, 64,
+    -72, 112, 120, 164, -8, -120, -56, 64, 32, -56, -120, -56,
+    96, -132, -8, 112, -196, -164, -80, 48, -196, -72, 64, 196,
+    48, 196, 48, -132, 72, 180, -80, 104, -24, -148, 112, 132,
+    132, -148, -24, 120, 180, -112, 132, 112, 196, -88, 96, -96,
+    -24, -112, 104, 16, -80, 180, -72, 40, -8, 88, -164, 40,
+    80, -16, -40, -96, 40, 180, 148, 180, -72, 132, -120, 72,
+    196, -196, -56, 148, -132, 88, -164, 56, 72, 72, 180, 120,
+    -72, 180, 32, 196, 120, -40, 96, -104, -112, -196, -8, 112,
+    196, 40, 120, -180, -132, 148, -120, -24, 132, -56, 16, -104,
+    132, -132, -80, 24, 120, -48, 196, 164, -96, 48, -88, -88,
+    -64, 24, -120, 56, 88, 180, 112, -80, 164, 64, -148, -56,
+    -148, 164, -196, -132, -16, 164, 96, 8, -132, 72, -196, -16,
+    120, -104, 8, 72, -56, 148, -132, -72, -164, -96, -148, 196,
+    24, -48, -132, 104, -32, 164, -148, -80, 8, -80, -120, 112,
+    56, -148, 180, -180, -148, 120, -56, 16, 24, 64, 40, -148,
+    -56, -16, 180, 104, 112, 24, 0, 0, -120, -132, -48, -148,
+    40, -196, 180, -132, -196, 96, 196, 132, 24, 120, -180, -72,
+    -164, 148, -112, 104, -56, 8, -112, -8, -132, 96, 196, 104,
+    -72, -132, 132, -16, 180, 64, -32, 180, -72, 148, 132, 88,
+    164, 72, -24, 132, -32, -132, 148, 88, -80, -132, -132, 164,
+    -80, 16, -8, 8, 96, -148, 16, -72, 8, -180, -40, 0,
+    -96, -8, -148, -56, -132, -104, 40, 120, -32, -120, 196, 132,
+    88, -180, -88, 164, -112, 104, -40, 132, -164, 148, -112, -148,
+    88, 80, 196, 104, -80, 148, -88, -104, 164, -24, 64, 88,
+    24, -80, 120, 24, 196, -80, 48, -48, 148, 96, -96, 72,
+    8, -196, -180, 148, -32, -132, -132, -104, 8, -120, -96, -56,
+};
+
+static const uint8_t s_vector_adpcm[492] = {
+    0, 0, 0, 0, 119, 119, 119, 119, 147, 42, 2, 133, 192, 175, 187, 171,
+    40, 66, 3, 161, 185, 16, 114, 70, 18, 17, 184, 202, 153, 40, 24, 152,
+    251, 174, 170, 0, 49, 83, 1, 144, 9, 88, 67, 37, 18, 184, 219, 155,
+    139, 32, 0, 203, 190, 172, 9, 65, 37, 35, 128, 136, 9, 99, 66, 35,
+    169, 204, 219, 154, 8, 1, 144, 202, 188, 11, 35, 87, 49, 130, 145, 153,
+    1, 66, 51, 146, 191, 220, 170, 136, 16, 17, 144, 218, 169, 33, 70, 67,
+    50, 144, 170, 153, 40, 51, 149, 249, 203, 172, 153, 32, 33, 18, 168, 153,
+    59, 117, 52, 35, 130, 186, 202, 139, 56, 3, 217, 206, 203, 154, 32, 50,
+    36, 130, 176, 9, 82, 39, 51, 17, 169, 189, 203, 136, 16, 145, 235, 203,
+    171, 136, 99, 67, 18, 8, 136, 24, 68, 36, 18, 184, 252, 169, 138, 136,
+    2, 168, 218, 187, 197, 236, 62, 0, 119, 23, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 255, 255, 255, 207, 128, 8, 136, 128, 8, 136,
+    128, 8, 136, 128, 8, 136, 128, 8, 136, 128, 8, 136, 128, 8, 136, 128,
+    8, 136, 128, 8, 119, 119, 119, 8, 8, 128, 8, 128, 128, 8, 128, 8,
+    8, 128, 8, 128, 128, 8, 8, 128, 112, 247, 15, 39, 188, 80, 162, 141,
+    67, 200, 42, 4, 187, 96, 161, 140, 67, 185, 59, 5, 187, 96, 145, 141,
+    67, 185, 59, 5, 187, 96, 161, 140, 67, 185, 59, 5, 187, 96, 145, 141,
+    67, 185, 59, 5, 187, 96, 161, 140, 67, 185, 59, 5, 187, 96, 145, 141,
+    67, 185, 59, 5, 187, 80, 162, 140, 51, 232, 25, 5, 203, 49, 179, 141,
+    51, 232, 25, 5, 203, 49, 179, 141, 159, 78, 87, 0, 131, 128, 128, 128,
+    128, 128, 128, 0, 136, 128, 128, 0, 136, 0, 136, 0, 8, 136, 129, 8,
+    136, 1, 168, 17, 192, 131, 193, 178, 145, 148, 90, 27, 24, 60, 144, 137,
+    51, 8, 47, 60, 241, 17, 42, 59, 128, 146, 76, 58, 185, 194, 152, 36,
+    177, 242, 72, 27, 178, 161, 197, 17, 160, 132, 44, 10, 16, 75, 32, 202,
+    149, 27, 105, 12, 33, 153, 57, 45, 194, 17, 58, 13, 25, 104, 153, 56,
+    58, 14, 145, 72, 169, 197, 32, 9, 0, 184, 17, 148, 160, 136, 139, 195,
+    198, 182, 56, 129, 42, 30, 73, 42, 10, 25, 90, 145, 155, 150, 162, 73,
+    43, 144, 162, 74, 187, 135, 138, 104, 10, 8, 193, 146, 177, 3, 42, 44,
+    26, 36, 172, 135, 200, 49, 60, 42, 76, 139, 3, 145, 76, 139, 164, 1,
+    153, 164, 211, 145, 131, 60, 217, 80, 138, 8, 162, 0,
+};
+
+static const int16_t s_vector_adpcm_decoded[960] = {
+    11, 41, 104, 240, 533, 1164, 2521, 5431, 8340, 7206, 5489, 7050,
+    8470, 8728, 11309, 10966, 11278, 8722, 3569, -114, -4801, -9061, -12935, -15451,
+    -15908, -13830, -11940, -8848, -5939, -5561, -4531, -6092, -6944, -8751, -8517, -7878,
+    -6908, -4264, 650, 6677, 10729, 12938, 14946, 16771, 16218, 12696, 10409, 6667,
+    5158, 3786, 3371, 5261, 4918, 5854, 5570, 4796, 3154, -45, -5992, -10044,
+    -13727, -17075, -16467, -15914, -14405, -11203, -8294, -4136, -2476, -1973, -1516, -2762,
+    -3896, -3553, -3865, -741, 2168, 5570, 10602, 13950, 16993, 18653, 18150, 14948,
+    12039, 7881, 4007, 2498, -704, -1119, -741, 976, 1288, 1572, -235, -2347,
+    -6039, -9561, -13678, -16445, -17954, -17497, -16251, -12849, -7817, -4469, -209, 2558,
+    3061, 2604, 2189, 1811, 781, 1093, 3081, 6438, 8725, 12467, 15989, 18276,
+    17030, 15140, 12048, 8306, 4784, -248, -3596, -5421, -5974, -5471, -4099, -3684,
+    -3306, -4336, -5897, -8453, -11545, -14454, -17100, -16757, -14572, -13152, -9279, -3191,
+    -760, 4396, 7744, 7136, 8796, 7287, 5915, 4669, 5803, 6146, 7707, 10263,
+    12667, 14852, 16272, 15498, 11978, 8456, 4339, -1749, -5801, -9484, -10153, -10761,
+    -10208, -8699, -7327, -6081, -5703, -6733, -8294, -11418, -12664, -14554, -13524, -11963,
+    -8271, -3742, 518, 5499, 8847, 13107, 13660, 12151, 9864, 7786, 6652, 5622,
+    5310, 6730, 8537, 10179, 12525, 11589, 10737, 6864, 2990, -1539, -7018, -10701,
+    -12709, -14534, -13981, -11465, -10093, -8015, -6125, -5095, -5407, -6827, -7601, -8304,
+    -9796, -8438, -6499, -2626, 2355, 7042, 11302, 14069, 16585, 16128, 14050, 11404,
+    9687, 6876, 4230, 3887, 3575, 5563, 7370, 7604, 6965, 4831, 1139, -3390,
+    -7650, -12631, -15979, -17804, -17251, -14735, -12448, -9539, -6137, -3850, -1772, -2150,
+    -1807, -3992, -4844, -4586, -3413, -1067, 3617, 6965, 11225, 15099, 16608, 17980,
+    16734, 14844, 11065, 7543, 4341, 599, 96, -361, 54, 1188, 2218, 1282,
+    -706, -4063, -7265, -11007, -14529, -16816, -17231, -17609, -15205, -11145, -7271, -2742,
+    301, 1961, 1458, 1915, 1500, 1122, 779, 1715, 4271, 7363, 11105, 13621,
+    15908, 17154, 16776, 14372, 11561, 5891, 3460, -223, -3571, -4179, -4732, -5235,
+    -2948, -2533, -2911, -4628, -6189, -9313, -12222, -14868, -9715, 1335, 25024, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32547, 32074, 31054, 28869,
+    24185, 14140, -7396, -32768, -29044, -32429, -32768, -29970, -32513, -32768, -30666, -32577,
+    -32768, -31189, -32624, -32768, -31582, -32660, -32768, -31877, -32687, -32768, -32099, -32707,
+    -32768, -32265, -32722, -32768, -32390, -32733, -32768, -32484, -32742, -32768, -32555, -32749,
+    -32768, -32608, -32753, -32768, -32648, -32757, -32768, -32678, -32760, -32768, -32700, -32761,
+    -32768, -32717, -32763, -32768, -32730, -32764, -32768, -32740, -32349, -31508, -29704, -25831,
+    -17529, 269, -2274, 38, -2064, -153, 1584, 5, -1430, -125, 1061, -17,
+    963, 72, -738, -2, 667, 59, -494, 9, -448, -33, 345, 2,
+    -310, -26, 232, -2, 211, 17, -159, 1, -144, -12, 108, -1,
+    98, 1455, 4365, -1871, -15243, -13332, 12727, 31348, 877, -27792, -24068, 13174,
+    32767, 14146, -23096, -27191, -1122, 29349, 25254, -8264, -28742, -10121, 20350, 24445,
+    -1624, -25323, -22246, 14129, 26415, 7794, -22677, -26772, -703, 29768, 17482, -8587,
+    -32286, -10743, 20036, 24131, -1938, -25637, -22560, 13815, 26101, 14929, -22313, -26408,
+    -339, 30132, 17846, -8223, -31922, -10379, 20400, 24495, -1574, -25273, -22196, 14179,
+    26465, 7844, -22627, -26722, -653, 29818, 17532, -8537, -32236, -10693, 20086, 24181,
+    -1888, -25587, -22510, 13865, 26151, 14979, -22263, -26358, -289, 30182, 17896, -8173,
+    -31872, -10329, 20450, 24545, -1524, -25223, -22146, 14229, 26515, 7894, -22577, -26672,
+    -603, 29868, 17582, -8487, -32186, -10643, 20136, 24231, -1838, -25537, -22460, 13915,
+    26201, 15029, -22213, -26308, -239, 30232, 17946, -8123, -31822, -10279, 20500, 24595,
+    -1474, -25173, -22096, 8683, 29161, 10540, -19931, -24026, 2043, 25742, 22665, -13710,
+    -25996, -14824, 22418, 26513, 444, -30027, -17741, 8328, 32027, 10484, -20295, -24390,
+    1679, 25378, 22301, -14074, -26360, -15188, 22054, 26149, 80, -30391, -18105, 7964,
+    31663, 10120, -20659, -24754, 1315, -2070, 1007, -1791, 752, -1560, 542, -1369,
+    368, -1211, 224, -1081, 105, -973, 7, 898, 88, -648, 21, -587,
+    -34, -537, -80, 335, -43, -386, -74, 210, -48, -282, -69, 125,
+    -51, 109, -36, -168, 192, 83, -16, 74, -8, -82, 122, 183,
+    127, -128, 10, 136, 174, -139, 155, 117, 220, -64, 127, -115,
+    -21, -106, 129, 35, -108, 179, -88, 15, -16, 69, -166, 54,
+    82, 4, -66, -87, 49, 172, 156, 170, -29, 114, -121, 99,
+    184, -207, -39, 114, -117, 93, -174, 68, 99, 71, 201, 131,
+    -63, 172, 15, 215, 137, -28, 79, -97, -120, -184, -8, 110,
+    174, 38, 126, -117, -151, 133, -134, -31, 126, -74, 4, -114,
+    123, -161, -47, 56, 87, -56, 179, 148, -110, 63, -94, -66,
+    -40, 30, -120, 56, 79, 186, 89, -71, 166, 72, -128, -50,
+    -120, 160, -185, -139, -13, 178, 75, -19, -104, 78, -182, -9,
+    148, -110, -7, 87, -56, 126, -134, -100, -194, -109, -135, 173,
+    47, -67, -101, 119, -24, 158, -150, -108, 6, -97, -128, 130,
+    27, -130, 185, -194, -143, 88, -38, 0, 34, 65, 37, -145,
+    -75, -11, 165, 95, 116, 19, 2, -14, -116, -129, -45, -144,
+    29, -184, 189, -168, -214, 80, 194, 160, 3, 146, -193, -55,
+    -181, 164, -67, 143, -48, -14, -108, -23, -153, 107, 210, 116,
+    -84, -162, 146, 20, 211, 38, -56, 202, -40, 117, 145, 67,
+    185, 78, -19, 141, -9, -145, 121, 83, -90, -121, -149, 190,
+    -41, 1, -37, -3, 91, -167, 6, -88, -3, -185, -20, 1,
+    -96, -8, -154, -57, -145, -97, 35, 123, -23, -120, 146, 108,
+    74, -210, -96, 146, -138, 129, -44, 113, -145, 168, -126, -164,
+    78, 109, 194, 116, -97, 161, -81, -112, 146, -27, 67, 95,
+    17, -53, 141, 11, 176, -61, 33, -52, 130, 107, -87, 95,
+    25, -212, -181, 134, -76, -114, -148, -117, 26, -104, -81, -60,
+};
+
+#endif /* AUDIO_VECTORS_H */
@@ -0,0 +1,128 @@
+/*
+ * fuzz_jpeg_dc.c
+ * JPEG 直流分量解码 (user-018) 的模糊测试
+ *
+ * LLVMFuzzerTestOneInput 可直接用于 libFuzzer（clang，cmake -DJPEG_DC_LIBFUZZER=ON）；
+ * 默认构建为独立程序：用 libjpeg 生成不同采样方式与重启间隔的种子，随机翻转位、改写字节、
+ * 截断与复制片段后逐个输入，作为 ctest 用例运行。编译器支持时与 jpeg_dc.c 一起启用 ASan/UBSan。
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "jpeg_dc.h"
+#include "test_util.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    static jpeg_dc_t dec;
+    jpeg_dc_info_t info;
+    if (jpeg_dc_parse(&dec, data, size, &info) != ESP_OK) {
+        return 0;
+    }
+
+    // 解析成功时尺寸须自洽，输出缓冲区按 jpeg_dc_output_size() 恰好分配，越界写由 ASan 发现
+    if (info.width != (info.image_width + 7) / 8 || info.height != (info.image_height + 7) / 8 || (info.components != 1 && info.components != 3)) {
+        abort();
+    }
+    for (int format = JPEG_DC_GRAY; format <= JPEG_DC_YUV; format++) {
+        size_t out_size = jpeg_dc_output_size(&info, (jpeg_dc_format_t)format);
+        uint8_t* out = malloc(out_size > 0 ? out_size : 1);
+        if (out == NULL) {
+            return 0;
+        }
+        jpeg_dc_decode(&dec, (jpeg_dc_format_t)format, out, out_size);
+        free(out);
+    }
+    return 0;
+}
+
+#ifndef JPEG_DC_LIBFUZZER
+
+#include "jpeg_util.h"
+
+#define ITERATIONS 30000
+
+static void mutate(uint8_t* buf, size_t* len, const uint8_t* seed, size_t seed_len, uint32_t* state)
+{
+    memcpy(buf, seed, seed_len);
+    *len = seed_len;
+    uint32_t edits = 1 + test_rand(state) % 8;
+    for (uint32_t e = 0; e < edits && *len > 0; e++) {
+        size_t pos = test_rand(state) % *len;
+        switch (test_rand(state) % 6) {
+            case 0:
+                buf[pos] ^= (uint8_t)(1u << (test_rand(state) % 8));
+                break;
+            case 1:
+                buf[pos] = (uint8_t)test_rand(state);
+                break;
+            case 2:
+                buf[pos] = test_rand(state) & 1 ? 0xFF : 0x00;  // 伪造标记或清零长度字段
+                break;
+            case 3:
+                *len = pos;  // 截断
+                break;
+            case 4: {
+                // 把一段数据复制到另一处，制造重复的段与错位的熵编码数据
+                size_t src = test_rand(state) % *len;
+                size_t n = 1 + test_rand(state) % 64;
+                n = src + n > *len ? *len - src : n;
+                n = pos + n > *len ? *len - pos : n;
+                memmove(buf + pos, buf + src, n);
+                break;
+            }
+            default:
+                if (pos + 1 < *len) {
+                    buf[pos] = 0xFF;
+                    buf[pos + 1] = (uint8_t)(0xC0 + test_rand(state) % 0x40);  // 随机标记
+                }
+                break;
+        }
+    }
+}
+
+int main(void)
+{
+    const jpeg_util_params_t seeds[] = {
+        {.width = 64, .height = 48, .quality = 50, .h_samp = 2, .v_samp = 1, .seed = 1},
+        {.width = 40, .height = 24, .quality = 90, .h_samp = 2, .v_samp = 2, .restart_interval = 1, .seed = 2},
+        {.width = 17, .height = 9, .quality = 10, .h_samp = 1, .v_samp = 1, .restart_interval = 3, .seed = 3},
+        {.width = 32, .height = 32, .quality = 75, .grayscale = true, .restart_interval = 2, .seed = 4},
+    };
+    const size_t seed_count = sizeof(seeds) / sizeof(seeds[0]);
+    uint8_t* jpegs[sizeof(seeds) / sizeof(seeds[0])];
+    size_t lens[sizeof(seeds) / sizeof(seeds[0])];
+    size_t max_len = 0;
+    for (size_t i = 0; i < seed_count; i++) {
+        jpegs[i] = jpeg_util_encode(&seeds[i], &lens[i]);
+        CHECK(jpegs[i] != NULL);
+        if (jpegs[i] == NULL) {
+            return TEST_RESULT();
+        }
+        max_len = lens[i] > max_len ? lens[i] : max_len;
+        LLVMFuzzerTestOneInput(jpegs[i], lens[i]);
+    }
+
+    uint8_t* work = malloc(max_len);
+    uint32_t state = 18;
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        size_t i = n % seed_count;
+        size_t len;
+        mutate(work, &len, jpegs[i], lens[i], &state);
+        // 复制到恰好 len 字节的缓冲区，越界读由 ASan 发现
+        uint8_t* input = malloc(len > 0 ? len : 1);
+        memcpy(input, work, len);
+        LLVMFuzzerTestOneInput(input, len);
+        free(input);
+    }
+    printf("%u 个变异输入\n", (unsigned)ITERATIONS);
+
+    free(work);
+    for (size_t i = 0; i < seed_count; i++) {
+        free(jpegs[i]);
+    }
+    return TEST_RESULT();
+}
+
+#endif /* JPEG_DC_LIBFUZZER */
@@ -0,0 +1,96 @@
+"""
+生成 audio_vectors.h：用 audio_sender.py 的编码器产生 mu-law 与 IMA-ADPCM 参考向量
+
+    python test/gen_audio_vectors.py > test/audio_vectors.h
+
+输入信号为两个正弦的叠加、削顶的满幅方波与静音，覆盖 mu-law 的全部段与 ADPCM 步长的大幅变化。
+期望输出：mu-law 按 G.711 的公式解码；ADPCM 取编码器逐样本重建的预测值（与解码器的计算相同）。
+"""
+
+import math
+import os
+import random
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import audio_sender  # noqa: E402
+
+FRAME = 320
+PACKETS = 3
+
+
+def signal():
+    random.seed(24)
+    samples = [int(12000 * math.sin(2 * math.pi * 440 * i / 16000) + 6000 * math.sin(2 * math.pi * 1234 * i / 16000)) + random.randint(-800, 800)
+               for i in range(FRAME)]
+    samples += [32767] * 60 + [-32768] * 60 + [0] * 40 + [int(30000 * math.sin(2 * math.pi * 3000 * i / 16000)) for i in range(FRAME - 160)]
+    samples += [random.randint(-200, 200) for _ in range(FRAME)]
+    return [max(-32768, min(32767, s)) for s in samples]
+
+
+def mulaw_decode(byte):
+    u = ~byte & 0xFF
+    t = (((u & 0x0F) << 3) + 0x84) << ((u & 0x70) >> 4)
+    return 0x84 - t if u & 0x80 else t - 0x84
+
+
+def adpcm_packets(samples):
+    encoder = audio_sender.AdpcmEncoder()
+    packets = []
+    decoded = []
+    for offset in range(0, len(samples), FRAME):
+        chunk = samples[offset:offset + FRAME]
+        start = (encoder.predictor, encoder.index)
+        # 逐样本编码并记录重建值，再从包开头的状态重新编码整包，得到与 audio_sender.py 相同的载荷
+        for s in chunk:
+            encoder.encode_sample(s)
+            decoded.append(encoder.predictor)
+        encoder.predictor, encoder.index = start
+        packets.append(encoder.encode(chunk))
+    return packets, decoded
+
+
+def array(ctype, name, values, per_line=16):
+    lines = ['static const %s %s[%d] = {' % (ctype, name, len(values))]
+    for i in range(0, len(values), per_line):
+        lines.append('    ' + ', '.join(str(v) for v in values[i:i + per_line]) + ',')
+    lines.append('};')
+    return '\n'.join(lines)
+
+
+def main():
+    samples = signal()
+    mulaw = audio_sender.encode_mulaw(samples)
+    packets, adpcm_decoded = adpcm_packets(samples)
+    adpcm = b''.join(packets)
+
+    print('/*')
+    print(' * audio_vectors.h')
+    print(' * mu-law 与 IMA-ADPCM 参考向量，由 gen_audio_vectors.py 用 audio_sender.py 的编码器生成，不要手工修改')
+    print(' */')
+    print()
+    print('#ifndef AUDIO_VECTORS_H')
+    print('#define AUDIO_VECTORS_H')
+    print()
+    print('#include <stdint.h>')
+    print()
+    print('#define VECTOR_FRAME %d        // 每个包的样本数' % FRAME)
+    print('#define VECTOR_PACKETS %d' % PACKETS)
+    print('#define VECTOR_SAMPLES %d' % len(samples))
+    print('#define VECTOR_ADPCM_PACKET %d  // 每个 ADPCM 包的字节数（含包头）' % len(packets[0]))
+    print()
+    print(array('int16_t', 's_vector_input', samples, 12))
+    print()
+    print(array('uint8_t', 's_vector_mulaw', list(mulaw)))
+    print()
+    print(array('int16_t', 's_vector_mulaw_decoded', [mulaw_decode(b) for b in mulaw], 12))
+    print()
+    print(array('uint8_t', 's_vector_adpcm', list(adpcm)))
+    print()
+    print(array('int16_t', 's_vector_adpcm_decoded', adpcm_decoded, 12))
+    print()
+    print('#endif /* AUDIO_VECTORS_H */')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,8 @@
+#pragma once
+// 主机端测试用：所有内存能力都由 malloc 提供
+#include <stdlib.h>
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define heap_caps_malloc(size, caps) ((void)(caps), malloc(size))
+#define heap_caps_free(ptr) free(ptr)
@@ -0,0 +1,4 @@
+#pragma once
+// 主机端测试用：时钟由测试提供
+#include <stdint.h>
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,17 @@
+#pragma once
+// 主机端测试用：单线程调用，临界区为空操作
+#include <stdint.h>
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+typedef void* TaskHandle_t;
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portENTER_CRITICAL(lock) ((void)(lock))
+#define portEXIT_CRITICAL(lock) ((void)(lock))
+#define taskENTER_CRITICAL(lock) ((void)(lock))
+#define taskEXIT_CRITICAL(lock) ((void)(lock))
+#define xPortGetCoreID() 0
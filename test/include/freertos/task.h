@@ -0,0 +1,7 @@
+#pragma once
+// 主机端测试用：不创建任务，只返回非空句柄；任务函数不运行，由测试直接驱动被测模块
+#include "freertos/FreeRTOS.h"
+#define xTaskCreate(fn, name, stack, arg, prio, handle) ((void)(fn), *(handle) = (TaskHandle_t)(uintptr_t)1, pdPASS)
+static inline void xTaskNotifyGive(TaskHandle_t task) { (void)task; }
+static inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) { (void)clear; (void)ticks; return 0; }
+static inline void vTaskDelay(TickType_t ticks) { (void)ticks; }
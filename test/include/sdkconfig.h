@@ -0,0 +1,2 @@
+#pragma once
+// 主机端测试用：配置项由 CMake 以编译定义传入（如 CONFIG_AUDIO_OPUS）
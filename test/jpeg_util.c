@@ -0,0 +1,219 @@
+/*
+ * jpeg_util.c
+ * 用 libjpeg 生成与解码测试用的 JPEG
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <jpeglib.h>
+
+#include "jpeg_util.h"
+
+typedef struct
+{
+    struct jpeg_error_mgr mgr;
+    jmp_buf jump;
+} error_ctx_t;
+
+static void on_error(j_common_ptr cinfo)
+{
+    longjmp(((error_ctx_t*)cinfo->err)->jump, 1);
+}
+
+// 损坏的数据只产生警告时 libjpeg 仍会输出图像，这里当作错误
+static void on_message(j_common_ptr cinfo, int level)
+{
+    if (level < 0) {
+        longjmp(((error_ctx_t*)cinfo->err)->jump, 1);
+    }
+}
+
+uint8_t* jpeg_util_encode(const jpeg_util_params_t* params, size_t* len)
+{
+    int components = params->grayscale ? 1 : 3;
+    uint8_t* pixels = malloc((size_t)params->width * params->height * components);
+    if (pixels == NULL) {
+        return NULL;
+    }
+    uint32_t seed = params->seed | 1;
+    for (uint32_t y = 0; y < params->height; y++) {
+        for (uint32_t x = 0; x < params->width; x++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            uint8_t* p = pixels + ((size_t)y * params->width + x) * components;
+            uint8_t block = (uint8_t)(((x / 24) ^ (y / 16)) & 1 ? 200 : 40);
+            p[0] = (uint8_t)((x * 255 / params->width + block + (seed & 0x1F)) / 2);
+            if (components == 3) {
+                p[1] = (uint8_t)(y * 255 / params->height);
+                p[2] = (uint8_t)(block ^ (seed >> 8 & 0x3F));
+            }
+        }
+    }
+
+    struct jpeg_compress_struct cinfo;
+    error_ctx_t err;
+    unsigned char* out = NULL;
+    unsigned long out_len = 0;
+    cinfo.err = jpeg_std_error(&err.mgr);
+    err.mgr.error_exit = on_error;
+    if (setjmp(err.jump)) {
+        jpeg_destroy_compress(&cinfo);
+        free(pixels);
+        free(out);
+        return NULL;
+    }
+
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, &out, &out_len);
+    cinfo.image_width = params->width;
+    cinfo.image_height = params->height;
+    cinfo.input_components = components;
+    cinfo.in_color_space = params->grayscale ? JCS_GRAYSCALE : JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, params->quality, TRUE);
+    cinfo.optimize_coding = FALSE;  // 使用 Annex K 标准哈夫曼表
+    cinfo.restart_interval = params->restart_interval;
+    if (!params->grayscale) {
+        cinfo.comp_info[0].h_samp_factor = params->h_samp;
+        cinfo.comp_info[0].v_samp_factor = params->v_samp;
+    }
+    if (params->progressive) {
+        jpeg_simple_progression(&cinfo);
+    }
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < cinfo.image_height) {
+        JSAMPROW row = pixels + (size_t)cinfo.next_scanline * params->width * components;
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    free(pixels);
+
+    *len = out_len;
+    return out;
+}
+
+uint8_t* jpeg_util_decode(const uint8_t* jpeg, size_t len, uint32_t* width, uint32_t* height, int* components)
+{
+    struct jpeg_decompress_struct cinfo;
+    error_ctx_t err;
+    uint8_t* pixels = NULL;
+    cinfo.err = jpeg_std_error(&err.mgr);
+    err.mgr.error_exit = on_error;
+    err.mgr.emit_message = on_message;
+    if (setjmp(err.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        free(pixels);
+        return NULL;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, jpeg, len);
+    jpeg_read_header(&cinfo, TRUE);
+    jpeg_start_decompress(&cinfo);
+    size_t stride = (size_t)cinfo.output_width * cinfo.output_components;
+    pixels = malloc(stride * cinfo.output_height);
+    if (pixels == NULL) {
+        jpeg_destroy_decompress(&cinfo);
+        return NULL;
+    }
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = pixels + cinfo.output_scanline * stride;
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_decompress(&cinfo);
+
+    *width = cinfo.output_width;
+    *height = cinfo.output_height;
+    *components = cinfo.output_components;
+    jpeg_destroy_decompress(&cinfo);
+    return pixels;
+}
+
+uint8_t* jpeg_util_decode_luma_1_8(const uint8_t* jpeg, size_t len, uint32_t* width, uint32_t* height)
+{
+    struct jpeg_decompress_struct cinfo;
+    error_ctx_t err;
+    uint8_t* pixels = NULL;
+    cinfo.err = jpeg_std_error(&err.mgr);
+    err.mgr.error_exit = on_error;
+    err.mgr.emit_message = on_message;
+    if (setjmp(err.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        free(pixels);
+        return NULL;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, jpeg, len);
+    jpeg_read_header(&cinfo, TRUE);
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = 8;
+    cinfo.out_color_space = JCS_GRAYSCALE;  // 直接取 Y 分量，不做颜色转换
+    jpeg_start_decompress(&cinfo);
+    pixels = malloc((size_t)cinfo.output_width * cinfo.output_height);
+    if (pixels == NULL) {
+        jpeg_destroy_decompress(&cinfo);
+        return NULL;
+    }
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = pixels + (size_t)cinfo.output_scanline * cinfo.output_width;
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_decompress(&cinfo);
+
+    *width = cinfo.output_width;
+    *height = cinfo.output_height;
+    jpeg_destroy_decompress(&cinfo);
+    return pixels;
+}
+
+uint8_t* jpeg_util_dc_planes(const uint8_t* jpeg, size_t len, size_t* size)
+{
+    struct jpeg_decompress_struct cinfo;
+    error_ctx_t err;
+    uint8_t* planes = NULL;
+    cinfo.err = jpeg_std_error(&err.mgr);
+    err.mgr.error_exit = on_error;
+    err.mgr.emit_message = on_message;
+    if (setjmp(err.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        free(planes);
+        return NULL;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, jpeg, len);
+    jpeg_read_header(&cinfo, TRUE);
+    jvirt_barray_ptr* coefs = jpeg_read_coefficients(&cinfo);
+
+    size_t total = 0;
+    for (int ci = 0; ci < cinfo.num_components; ci++) {
+        total += (size_t)cinfo.comp_info[ci].width_in_blocks * cinfo.comp_info[ci].height_in_blocks;
+    }
+    planes = malloc(total);
+    if (planes == NULL) {
+        jpeg_destroy_decompress(&cinfo);
+        return NULL;
+    }
+
+    uint8_t* out = planes;
+    for (int ci = 0; ci < cinfo.num_components; ci++) {
+        jpeg_component_info* comp = &cinfo.comp_info[ci];
+        int32_t q = comp->quant_table->quantval[0];
+        for (JDIMENSION by = 0; by < comp->height_in_blocks; by++) {
+            JBLOCKARRAY row = (*cinfo.mem->access_virt_barray)((j_common_ptr)&cinfo, coefs[ci], by, 1, FALSE);
+            for (JDIMENSION bx = 0; bx < comp->width_in_blocks; bx++) {
+                int32_t pixel = 128 + ((row[0][bx][0] * q + 4) >> 3);
+                *out++ = (uint8_t)(pixel < 0 ? 0 : (pixel > 255 ? 255 : pixel));
+            }
+        }
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+
+    *size = total;
+    return planes;
+}
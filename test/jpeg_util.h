@@ -0,0 +1,69 @@
+/*
+ * jpeg_util.h
+ * 用 libjpeg 生成与解码测试用的 JPEG（主机端测试的辅助函数）
+ */
+
+#ifndef JPEG_UTIL_H
+#define JPEG_UTIL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @brief 编码参数
+ */
+typedef struct
+{
+    uint32_t width;
+    uint32_t height;
+    int quality;               // libjpeg 质量 1-100
+    uint8_t h_samp;            // 亮度水平采样因子: 2 (4:2:x) 或 1 (4:4:4)
+    uint8_t v_samp;            // 亮度垂直采样因子: 2 (4:2:0) 或 1 (4:2:2)
+    uint16_t restart_interval; // 重启间隔 (MCU)，0 表示没有
+    bool progressive;          // 渐进式
+    bool grayscale;            // 单分量
+    uint32_t seed;             // 图案随机种子
+} jpeg_util_params_t;
+
+/**
+ * @brief 按参数生成带渐变、色块与噪声的测试图像并编码，使用 Annex K 标准哈夫曼表
+ * @param params 编码参数
+ * @param len 输出 JPEG 长度
+ * @return JPEG 数据 (malloc，调用者 free)，失败返回 NULL
+ */
+uint8_t* jpeg_util_encode(const jpeg_util_params_t* params, size_t* len);
+
+/**
+ * @brief 解码为 RGB（或灰度）像素
+ * @param jpeg JPEG 数据
+ * @param len 长度
+ * @param width 输出宽度
+ * @param height 输出高度
+ * @param components 输出每像素分量数
+ * @return 像素 (malloc，调用者 free)，解码出错（含警告）返回 NULL
+ */
+uint8_t* jpeg_util_decode(const uint8_t* jpeg, size_t len, uint32_t* width, uint32_t* height, int* components);
+
+/**
+ * @brief 用 libjpeg 的 1/8 缩放解码取得亮度平面（每块由 1x1 IDCT 得到）
+ * @param jpeg JPEG 数据
+ * @param len 长度
+ * @param width 输出宽度
+ * @param height 输出高度
+ * @return 亮度平面 (malloc，调用者 free)，失败返回 NULL
+ */
+uint8_t* jpeg_util_decode_luma_1_8(const uint8_t* jpeg, size_t len, uint32_t* width, uint32_t* height);
+
+/**
+ * @brief 用 libjpeg 读出各分量的直流系数，按 jpeg_dc 的 YUV 布局生成参考缩略图
+ *
+ * 各分量平面为该分量的块网格尺寸，依次排列；像素值为 128 + 反量化直流值 / 8（四舍五入并截断到 0-255）。
+ * @param jpeg JPEG 数据
+ * @param len 长度
+ * @param size 输出字节数
+ * @return 缩略图 (malloc，调用者 free)，失败返回 NULL
+ */
+uint8_t* jpeg_util_dc_planes(const uint8_t* jpeg, size_t len, size_t* size);
+
+#endif /* JPEG_UTIL_H */
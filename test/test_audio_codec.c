@@ -0,0 +1,148 @@
+/*
+ * test_audio_codec.c
+ * 语音下行载荷解码 (user-024) 的参考向量测试与基准
+ *
+ * audio_vectors.h 由 gen_audio_vectors.py 用 audio_sender.py 的编码器生成：设备端解码须与
+ * G.711 公式及编码器的重建值逐样本相同，ADPCM 每个包单独解码（丢包后的下一个包不受影响）。
+ * 另外检查 mu-law 全部 256 个码字、畸形载荷被拒绝，并测量解码 1 秒语音的耗时。
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "audio_codec.h"
+#include "audio_vectors.h"
+#include "test_util.h"
+
+#define BENCH_ROUNDS 2000
+
+static double snr_db(const int16_t* ref, const int16_t* out, size_t count)
+{
+    double signal = 0;
+    double noise = 0;
+    for (size_t i = 0; i < count; i++) {
+        double e = (double)out[i] - ref[i];
+        signal += (double)ref[i] * ref[i];
+        noise += e * e;
+    }
+    return noise == 0 ? INFINITY : 10 * log10(signal / noise);
+}
+
+static void test_mulaw(void)
+{
+    int16_t out[VECTOR_SAMPLES];
+    CHECK_EQ(audio_codec_samples(AUDIO_CODEC_MULAW, VECTOR_SAMPLES), VECTOR_SAMPLES);
+    CHECK_EQ(audio_codec_decode(AUDIO_CODEC_MULAW, s_vector_mulaw, VECTOR_SAMPLES, out), VECTOR_SAMPLES);
+    CHECK(memcmp(out, s_vector_mulaw_decoded, sizeof(out)) == 0);
+    printf("mu-law: 信噪比 %.1f dB\n", snr_db(s_vector_input, out, VECTOR_SAMPLES));
+    CHECK(snr_db(s_vector_input, out, VECTOR_SAMPLES) > 30);
+
+    // 全部码字：G.711 公式，0xFF 与 0x7F 都是 0，0x00 与 0x80 为正负满幅
+    for (int x = 0; x < 256; x++) {
+        uint8_t u = (uint8_t)~x;
+        int t = (((u & 0x0F) << 3) + 0x84) << ((u & 0x70) >> 4);
+        int16_t expected = (int16_t)((u & 0x80) ? 0x84 - t : t - 0x84);
+        uint8_t in = (uint8_t)x;
+        int16_t decoded;
+        audio_mulaw_decode(&in, &decoded, 1);
+        CHECK_EQ(decoded, expected);
+    }
+    uint8_t edges[4] = {0xFF, 0x7F, 0x00, 0x80};
+    int16_t edge_out[4];
+    audio_mulaw_decode(edges, edge_out, 4);
+    CHECK_EQ(edge_out[0], 0);
+    CHECK_EQ(edge_out[1], 0);
+    CHECK_EQ(edge_out[2], -32124);
+    CHECK_EQ(edge_out[3], 32124);
+}
+
+static void test_adpcm(void)
+{
+    int16_t out[VECTOR_SAMPLES];
+    CHECK_EQ(audio_codec_samples(AUDIO_CODEC_ADPCM, VECTOR_ADPCM_PACKET), VECTOR_FRAME);
+
+    // 按包倒序解码，确认每个包只依赖自己的包头
+    for (int p = VECTOR_PACKETS - 1; p >= 0; p--) {
+        const uint8_t* packet = s_vector_adpcm + p * VECTOR_ADPCM_PACKET;
+        CHECK_EQ(audio_codec_decode(AUDIO_CODEC_ADPCM, packet, VECTOR_ADPCM_PACKET, out + p * VECTOR_FRAME), VECTOR_FRAME);
+    }
+    CHECK(memcmp(out, s_vector_adpcm_decoded, sizeof(out)) == 0);
+    for (size_t i = 0; i < VECTOR_SAMPLES; i++) {
+        if (out[i] != s_vector_adpcm_decoded[i]) {
+            fprintf(stderr, "ADPCM 样本 %zu: %d != %d\n", i, out[i], s_vector_adpcm_decoded[i]);
+            break;
+        }
+    }
+    // 满幅方波处步长来不及跟上，整体信噪比低于 mu-law；语音段单独计算
+    printf("IMA-ADPCM: 信噪比 %.1f dB（第一个包 %.1f dB）\n", snr_db(s_vector_input, out, VECTOR_SAMPLES), snr_db(s_vector_input, out, VECTOR_FRAME));
+    CHECK(snr_db(s_vector_input, out, VECTOR_FRAME) > 15);
+}
+
+static void test_rejected(void)
+{
+    int16_t out[VECTOR_FRAME];
+    uint8_t packet[VECTOR_ADPCM_PACKET];
+    memcpy(packet, s_vector_adpcm, sizeof(packet));
+
+    // 步长索引超出 0-88、只有包头或不完整的包头
+    packet[2] = 89;
+    CHECK_EQ(audio_adpcm_decode(packet, sizeof(packet), out), 0);
+    packet[2] = 88;
+    CHECK_EQ(audio_adpcm_decode(packet, sizeof(packet), out), VECTOR_FRAME);
+    CHECK_EQ(audio_adpcm_decode(packet, AUDIO_ADPCM_HEADER, out), 0);
+    CHECK_EQ(audio_adpcm_decode(packet, AUDIO_ADPCM_HEADER - 1, out), 0);
+    CHECK_EQ(audio_codec_samples(AUDIO_CODEC_ADPCM, AUDIO_ADPCM_HEADER - 1), 0);
+
+    // 步长索引 88 时满幅的码字也不会溢出
+    memset(packet + AUDIO_ADPCM_HEADER, 0x77, sizeof(packet) - AUDIO_ADPCM_HEADER);
+    packet[0] = 0x7F;
+    packet[1] = 0xFF;
+    CHECK_EQ(audio_adpcm_decode(packet, sizeof(packet), out), VECTOR_FRAME);
+    CHECK_EQ(out[VECTOR_FRAME - 1], 32767);
+    memset(packet + AUDIO_ADPCM_HEADER, 0xFF, sizeof(packet) - AUDIO_ADPCM_HEADER);
+    CHECK_EQ(audio_adpcm_decode(packet, sizeof(packet), out), VECTOR_FRAME);
+    CHECK_EQ(out[VECTOR_FRAME - 1], -32768);
+
+    // 未知编码与 Opus（由 audio_opus 解码）
+    CHECK_EQ(audio_codec_samples(AUDIO_CODEC_COUNT, 100), 0);
+    CHECK_EQ(audio_codec_decode(AUDIO_CODEC_COUNT, packet, 100, out), 0);
+    CHECK_EQ(audio_codec_samples(AUDIO_CODEC_OPUS, 100), 0);
+    CHECK_EQ(audio_codec_decode(AUDIO_CODEC_OPUS, packet, 100, out), 0);
+    CHECK(audio_codec_name(AUDIO_CODEC_COUNT) != NULL);
+}
+
+static void bench(void)
+{
+    // 16 kHz 1 秒 = 50 个 320 样本的包，重复使用参考向量的包
+    static int16_t out[VECTOR_FRAME];
+    const struct
+    {
+        const char* name;
+        uint8_t codec;
+        const uint8_t* data;
+        size_t len;
+    } cases[] = {
+        {"mu-law", AUDIO_CODEC_MULAW, s_vector_mulaw, VECTOR_FRAME},
+        {"IMA-ADPCM", AUDIO_CODEC_ADPCM, s_vector_adpcm, VECTOR_ADPCM_PACKET},
+        {"PCM8", AUDIO_CODEC_PCM8, s_vector_mulaw, VECTOR_FRAME},
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        uint64_t start = test_now_ns();
+        for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+            for (uint32_t p = 0; p < 50; p++) {
+                audio_codec_decode(cases[c].codec, cases[c].data, cases[c].len, out);
+                __asm__ volatile("" : : "r"(out) : "memory");
+            }
+        }
+        printf("%s: 解码 1 秒语音 %.2f us\n", cases[c].name, (test_now_ns() - start) / 1000.0 / BENCH_ROUNDS);
+    }
+}
+
+int main(void)
+{
+    test_mulaw();
+    test_adpcm();
+    test_rejected();
+    bench();
+    return TEST_RESULT();
+}
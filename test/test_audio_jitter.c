@@ -0,0 +1,335 @@
+/*
+ * test_audio_jitter.c
+ * 音频抖动缓冲与丢包隐藏 (user-021) 的测试
+ *
+ * 按 20 ms 一个包发送，到达时间 = 发送时间 + 随机抖动（由此产生乱序），可加入丢包与重复包；
+ * 播放方按 audio_stream.c 的方式在上一段播完时取下一段。配置与 audio_stream.c 的 Kconfig 默认值相同。
+ * 检查按序播出、数据不被混淆、每个发出的包都有去向（播放、迟到、挤出或主动丢弃）、丢失的包被隐藏；
+ * 丢包隐藏检查基音周期估计、隐藏前后波形连续、长时间丢包衰减到静音。
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "audio_jitter.h"
+#include "test_util.h"
+
+#define RATE 16000
+#define SLOTS 16
+#define MAX_PAYLOAD 1400
+#define MIN_DEPTH_MS 60
+#define MAX_DEPTH_MS 400
+#define IDLE_MS 1000
+
+static uint8_t s_storage[SLOTS * MAX_PAYLOAD];
+
+typedef struct
+{
+    int64_t t;
+    uint32_t seq;
+} arrival_t;
+
+typedef struct
+{
+    uint32_t sent;         // 发出的包数（不含重复）
+    uint32_t delivered;    // 到达的不同包数
+    uint32_t duplicates;   // 发出的重复包数
+    uint32_t played;
+    uint32_t concealed;
+    uint32_t underruns;
+    uint32_t max_gap;      // 连续隐藏的最大包数
+    audio_jitter_stats_t stats;
+} outcome_t;
+
+static int compare_arrival(const void* a, const void* b)
+{
+    const arrival_t* x = a;
+    const arrival_t* y = b;
+    return x->t < y->t ? -1 : x->t > y->t;
+}
+
+/**
+ * @brief 发送 count 个包，抖动在 [0, jitter_ms) 内均匀分布，loss_pct% 丢失，dup_pct% 重复
+ *
+ * 首尾两个包不丢，丢失的包都在中间；最后一个包带 last 标记，与发送端结束一段语音时相同。
+ */
+static void run(outcome_t* out, uint32_t count, uint16_t samples, uint32_t jitter_ms, uint32_t loss_pct, uint32_t dup_pct, uint32_t seed)
+{
+    memset(out, 0, sizeof(*out));
+    audio_jitter_t jb;
+    audio_jitter_config_t config = {
+        .capacity = SLOTS,
+        .max_payload = MAX_PAYLOAD,
+        .sample_rate = RATE,
+        .min_depth_ms = MIN_DEPTH_MS,
+        .max_depth_ms = MAX_DEPTH_MS,
+        .idle_ms = IDLE_MS,
+    };
+    CHECK_EQ(audio_jitter_init(&jb, &config, s_storage), ESP_OK);
+
+    arrival_t* arrivals = calloc(count * 2, sizeof(arrival_t));
+    uint32_t n = 0;
+    int64_t packet_us = (int64_t)samples * 1000000 / RATE;
+    for (uint32_t i = 0; i < count; i++) {
+        out->sent++;
+        if (test_rand(&seed) % 100 < loss_pct && i > 0 && i + 1 < count) {
+            continue;
+        }
+        out->delivered++;
+        arrivals[n].t = 10000 + i * packet_us + (jitter_ms > 0 ? test_rand(&seed) % (jitter_ms * 1000) : 0);
+        arrivals[n++].seq = i;
+        if (test_rand(&seed) % 100 < dup_pct) {
+            arrivals[n].t = arrivals[n - 1].t + test_rand(&seed) % 5000;
+            arrivals[n++].seq = i;
+            out->duplicates++;
+        }
+    }
+    qsort(arrivals, n, sizeof(arrival_t), compare_arrival);
+
+    uint8_t payload[MAX_PAYLOAD];
+    int64_t play_at = 0;
+    uint32_t next = 0;
+    bool have_last = false;
+    uint32_t last_seq = 0;
+    uint32_t gap = 0;
+    int64_t end_us = 10000 + (int64_t)(count + 50) * packet_us + 2000000;
+    for (int64_t now = 0; now < end_us; now += 1000) {
+        while (next < n && arrivals[next].t <= now) {
+            // 载荷内容由序号决定，取出时核对
+            audio_jitter_packet_t packet = {
+                .seq = arrivals[next].seq,
+                .timestamp = arrivals[next].seq * samples,
+                .samples = samples,
+                .len = samples < MAX_PAYLOAD ? samples : MAX_PAYLOAD,
+                .last = arrivals[next].seq + 1 == count,
+                .data = payload,
+            };
+            memset(payload, (int)(packet.seq * 7 & 0xFF), packet.len);
+            audio_jitter_put(&jb, &packet, now);
+            next++;
+        }
+        while (play_at <= now) {
+            audio_jitter_packet_t packet;
+            audio_jitter_result_t result = audio_jitter_get(&jb, now, &packet);
+            if (result == AUDIO_JITTER_EMPTY || result == AUDIO_JITTER_UNDERRUN) {
+                out->underruns += result == AUDIO_JITTER_UNDERRUN;
+                play_at = now + 1000;
+                break;
+            }
+            if (have_last) {
+                CHECK((int32_t)(packet.seq - last_seq) >= 1);
+            }
+            if (result == AUDIO_JITTER_PACKET) {
+                CHECK(packet.data != NULL && packet.data[0] == (uint8_t)(packet.seq * 7) && packet.data[packet.len - 1] == (uint8_t)(packet.seq * 7));
+                out->played++;
+                gap = 0;
+            }
+            else {
+                CHECK(packet.data == NULL);
+                CHECK(packet.samples > 0);
+                out->concealed++;
+                gap++;
+                out->max_gap = gap > out->max_gap ? gap : out->max_gap;
+            }
+            have_last = true;
+            last_seq = packet.seq;
+            play_at = (play_at < now ? now : play_at) + (int64_t)packet.samples * 1000000 / RATE;
+        }
+    }
+    free(arrivals);
+    audio_jitter_get_stats(&jb, &out->stats);
+}
+
+static void print_outcome(const char* name, const outcome_t* out)
+{
+    const audio_jitter_stats_t* s = &out->stats;
+    printf("%s: 发出 %u 到达 %u, 播放 %u 隐藏 %u 欠载 %u | 迟到 %lu 重复 %lu 挤出 %lu 丢弃 %lu, 目标 %lu ms 抖动 %lu ms\n", name, (unsigned)out->sent,
+           (unsigned)out->delivered, (unsigned)out->played, (unsigned)out->concealed, (unsigned)out->underruns, (unsigned long)s->late,
+           (unsigned long)s->duplicate, (unsigned long)s->overflow, (unsigned long)s->dropped, (unsigned long)s->target_ms, (unsigned long)s->jitter_ms);
+}
+
+/**
+ * @brief 每个到达的包都有去向：播放、迟到、挤出或为降低延迟主动丢弃；播放后才到达的重复包计为迟到
+ */
+static void check_accounted(const outcome_t* out)
+{
+    const audio_jitter_stats_t* s = &out->stats;
+    CHECK_EQ(out->played + s->late + s->overflow + s->dropped, out->delivered + out->duplicates - s->duplicate);
+    CHECK_EQ(s->lost, out->concealed);
+    CHECK_EQ(s->underruns, out->underruns);
+    CHECK_EQ(s->depth, 0);
+}
+
+static void test_clean(void)
+{
+    outcome_t out;
+    run(&out, 200, 320, 0, 0, 0, 1);
+    print_outcome("无抖动", &out);
+    check_accounted(&out);
+    CHECK_EQ(out.played, 200);
+    CHECK_EQ(out.concealed, 0);
+    CHECK_EQ(out.underruns, 0);
+    CHECK_EQ(out.stats.streams, 1);
+}
+
+static void test_reorder(void)
+{
+    // 抖动小于目标深度：乱序全部被重排，不丢包
+    outcome_t out;
+    run(&out, 300, 320, 40, 0, 0, 2);
+    print_outcome("抖动 40 ms", &out);
+    check_accounted(&out);
+    CHECK_EQ(out.played, 300);
+    CHECK_EQ(out.concealed, 0);
+    CHECK_EQ(out.stats.late, 0);
+
+    // 抖动超过最小深度：目标深度随抖动估计增大，迟到的包很少；没有网络丢包，隐藏的都是迟到、挤出或丢弃的包
+    run(&out, 500, 320, 150, 0, 0, 3);
+    print_outcome("抖动 150 ms", &out);
+    check_accounted(&out);
+    CHECK(out.stats.target_ms > MIN_DEPTH_MS);
+    CHECK(out.stats.target_ms <= MAX_DEPTH_MS);
+    CHECK(out.played >= 500 * 95 / 100);
+    CHECK(out.concealed <= out.stats.late + out.stats.overflow + out.stats.dropped);
+}
+
+static void test_loss(void)
+{
+    // 随机丢包：丢失的包在播放时被逐个隐藏，之后的包照常播放
+    outcome_t out;
+    run(&out, 500, 320, 10, 5, 0, 4);
+    print_outcome("丢包 5%", &out);
+    check_accounted(&out);
+    CHECK_EQ(out.played, out.delivered);
+    CHECK_EQ(out.concealed, out.sent - out.delivered);
+
+    run(&out, 500, 320, 40, 20, 0, 5);
+    print_outcome("丢包 20% 抖动 40 ms", &out);
+    check_accounted(&out);
+    CHECK_EQ(out.played + out.concealed, 500 - out.stats.dropped);
+    CHECK(out.max_gap >= 2);
+}
+
+static void test_duplicates(void)
+{
+    outcome_t out;
+    run(&out, 300, 320, 20, 0, 10, 6);
+    print_outcome("重复 10%", &out);
+    check_accounted(&out);
+    CHECK(out.duplicates > 0);
+    // 重复包在原包播放前到达计为重复，播放后到达计为迟到
+    CHECK_EQ(out.stats.duplicate + out.stats.late, out.duplicates);
+    CHECK_EQ(out.played, 300);
+}
+
+static void test_large_packets(void)
+{
+    // 旧版发送端的 1388 样本大包：缓冲以时长而不是包数计算深度
+    outcome_t out;
+    run(&out, 100, 1388, 50, 3, 0, 7);
+    print_outcome("1388 样本的包", &out);
+    check_accounted(&out);
+    CHECK(out.played >= out.delivered - 1);
+}
+
+static void test_rejected(void)
+{
+    audio_jitter_t jb;
+    audio_jitter_config_t config = {.capacity = 1, .max_payload = MAX_PAYLOAD, .sample_rate = RATE, .min_depth_ms = MIN_DEPTH_MS, .max_depth_ms = MAX_DEPTH_MS};
+    CHECK_EQ(audio_jitter_init(&jb, &config, s_storage), ESP_ERR_INVALID_ARG);
+    config.capacity = AUDIO_JITTER_MAX_SLOTS + 1;
+    CHECK_EQ(audio_jitter_init(&jb, &config, s_storage), ESP_ERR_INVALID_ARG);
+    config.capacity = SLOTS;
+    CHECK_EQ(audio_jitter_init(&jb, &config, NULL), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(audio_jitter_init(&jb, &config, s_storage), ESP_OK);
+
+    // 超过 max_payload 的包不保存
+    static uint8_t big[MAX_PAYLOAD + 1];
+    audio_jitter_packet_t packet = {.seq = 0, .samples = 320, .len = sizeof(big), .data = big};
+    CHECK(!audio_jitter_put(&jb, &packet, 0));
+    packet.len = 10;
+    CHECK(audio_jitter_put(&jb, &packet, 0));
+    CHECK(!audio_jitter_put(&jb, &packet, 1000));  // 重复
+
+    // peek 不取出
+    audio_jitter_packet_t peeked;
+    CHECK(audio_jitter_peek(&jb, 0, &peeked));
+    CHECK_EQ(peeked.len, 10);
+    CHECK(!audio_jitter_peek(&jb, 1, &peeked));
+    audio_jitter_stats_t stats;
+    audio_jitter_get_stats(&jb, &stats);
+    CHECK_EQ(stats.depth, 1);
+    CHECK_EQ(stats.duplicate, 1);
+}
+
+/**
+ * @brief 200 Hz 正弦波，每 10 帧丢失 2 帧（20 ms 一帧）
+ */
+static void test_plc(void)
+{
+    audio_plc_t plc;
+    audio_plc_init(&plc, RATE);
+    int16_t buf[320];
+    double phase = 0;
+    int16_t prev = 0;
+    int max_step = 0;
+    for (int f = 0; f < 50; f++) {
+        for (int i = 0; i < 320; i++) {
+            buf[i] = (int16_t)(8000 * sin(phase));
+            phase += 2 * M_PI * 200 / RATE;
+        }
+        if (f % 10 == 5 || f % 10 == 6) {
+            audio_plc_conceal(&plc, buf, 320);
+        }
+        else {
+            audio_plc_good(&plc, buf, 320);
+        }
+        for (int i = 0; i < 320; i++) {
+            int step = abs(buf[i] - prev);
+            max_step = step > max_step ? step : max_step;
+            prev = buf[i];
+        }
+    }
+    // 正弦波相邻样本的最大差约 628；隐藏的起止处不应出现明显的跳变
+    printf("丢包隐藏: 周期 %u, 隐藏 %lu 次 %llu 样本, 最大相邻差 %d\n", plc.period, (unsigned long)plc.events, (unsigned long long)plc.concealed_samples, max_step);
+    CHECK(plc.period >= 78 && plc.period <= 82);
+    CHECK_EQ(plc.events, 5);  // 连续两帧的丢失为一次隐藏
+    CHECK_EQ(plc.concealed_samples, 5 * 2 * 320);
+    CHECK(max_step < 2000);
+
+    // 长时间丢包：保持约 10 ms 后在 50 ms 内衰减到静音
+    int16_t tail[RATE / 10];
+    audio_plc_conceal(&plc, tail, sizeof(tail) / sizeof(tail[0]));
+    int peak_early = 0;
+    int peak_late = 0;
+    for (int i = 0; i < RATE / 100; i++) {
+        peak_early = abs(tail[i]) > peak_early ? abs(tail[i]) : peak_early;
+    }
+    for (int i = RATE * 6 / 100; i < RATE / 10; i++) {
+        peak_late = abs(tail[i]) > peak_late ? abs(tail[i]) : peak_late;
+    }
+    CHECK(peak_early > 6000);
+    CHECK_EQ(peak_late, 0);
+
+    // 新的流：历史已清除，隐藏输出静音，不延续上一段语音
+    audio_plc_reset(&plc);
+    audio_plc_conceal(&plc, buf, 320);
+    int peak = 0;
+    for (int i = 0; i < 320; i++) {
+        peak = abs(buf[i]) > peak ? abs(buf[i]) : peak;
+    }
+    CHECK_EQ(peak, 0);
+}
+
+int main(void)
+{
+    test_clean();
+    test_reorder();
+    test_loss();
+    test_duplicates();
+    test_large_packets();
+    test_rejected();
+    test_plc();
+    return TEST_RESULT();
+}
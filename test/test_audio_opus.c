@@ -0,0 +1,174 @@
+/*
+ * test_audio_opus.c
+ * 语音下行 Opus 解码 (user-025) 的回归测试
+ *
+ * audio_opus.c 按两种配置编译：CONFIG_AUDIO_OPUS 关闭（默认）时所有函数返回失败；
+ * 打开时链接 libopus，用与 audio_sender.py 相同的编码参数（VOIP、16 kbit/s、带内 FEC、预期丢包 10%）
+ * 生成 20 ms 的包，检查正常解码、用后一个包的 FEC 恢复丢失的帧、没有后续包时的丢包隐藏、
+ * 隐藏样本数按 2.5 ms 取整、畸形包与统计信息。
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+#include "audio_opus.h"
+#include "test_util.h"
+
+#define RATE 16000
+#define FRAME 320
+
+#if CONFIG_AUDIO_OPUS
+
+#include <opus.h>
+
+#define PACKETS 50
+#define MAX_PACKET 400
+
+static uint8_t s_packets[PACKETS][MAX_PACKET];
+static int s_lens[PACKETS];
+static int16_t s_input[PACKETS * FRAME];
+
+static double rms(const int16_t* pcm, size_t count)
+{
+    double sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += (double)pcm[i] * pcm[i];
+    }
+    return sqrt(sum / count);
+}
+
+/**
+ * @brief 基频 150 Hz 带谐波、幅度缓慢起伏的类语音信号
+ */
+static void encode_packets(void)
+{
+    for (size_t i = 0; i < PACKETS * FRAME; i++) {
+        double t = (double)i / RATE;
+        double envelope = 0.6 + 0.4 * sin(2 * M_PI * 2 * t);
+        double v = sin(2 * M_PI * 150 * t) + 0.5 * sin(2 * M_PI * 300 * t) + 0.25 * sin(2 * M_PI * 450 * t);
+        s_input[i] = (int16_t)(6000 * envelope * v);
+    }
+
+    int err;
+    OpusEncoder* enc = opus_encoder_create(RATE, 1, OPUS_APPLICATION_VOIP, &err);
+    CHECK_EQ(err, OPUS_OK);
+    opus_encoder_ctl(enc, OPUS_SET_BITRATE(16000));
+    opus_encoder_ctl(enc, OPUS_SET_INBAND_FEC(1));
+    opus_encoder_ctl(enc, OPUS_SET_PACKET_LOSS_PERC(10));
+    for (int p = 0; p < PACKETS; p++) {
+        s_lens[p] = opus_encode(enc, s_input + p * FRAME, FRAME, s_packets[p], MAX_PACKET);
+        CHECK(s_lens[p] > 0);
+    }
+    opus_encoder_destroy(enc);
+}
+
+static void test_decode(void)
+{
+    CHECK_EQ(audio_opus_init(RATE), ESP_OK);
+    CHECK_EQ(audio_opus_init(RATE), ESP_OK);  // 已创建时直接返回
+    CHECK(audio_opus_available());
+
+    static int16_t out[PACKETS * FRAME];
+    for (int p = 0; p < PACKETS; p++) {
+        CHECK_EQ(audio_opus_samples(s_packets[p], s_lens[p]), FRAME);
+        CHECK_EQ(audio_opus_decode(s_packets[p], s_lens[p], out + p * FRAME, FRAME), FRAME);
+    }
+    // 编码有延迟且有损，只比较起始之后的能量
+    double in_rms = rms(s_input + 10 * FRAME, 40 * FRAME);
+    double out_rms = rms(out + 10 * FRAME, 40 * FRAME);
+    printf("Opus 16 kbit/s: 平均包长 %d 字节, 输入 RMS %.0f 输出 RMS %.0f\n", s_lens[PACKETS / 2], in_rms, out_rms);
+    CHECK(out_rms > in_rms * 0.7 && out_rms < in_rms * 1.3);
+
+    audio_opus_stats_t stats;
+    audio_opus_get_stats(&stats);
+    CHECK(stats.enabled);
+    CHECK(stats.state_bytes > 0);
+    CHECK_EQ(stats.frames, PACKETS);
+    CHECK_EQ(stats.errors, 0);
+}
+
+static void test_conceal(void)
+{
+    static int16_t out[FRAME * 2];
+    audio_opus_reset();
+    audio_opus_stats_t before;
+    audio_opus_get_stats(&before);
+
+    // 第 20 帧丢失、第 21 帧已到达：用 21 帧的 FEC 数据恢复，再正常解码 21 帧
+    for (int p = 0; p < 20; p++) {
+        CHECK_EQ(audio_opus_decode(s_packets[p], s_lens[p], out, FRAME), FRAME);
+    }
+    CHECK_EQ(audio_opus_conceal(s_packets[21], s_lens[21], out, FRAME, FRAME), FRAME);
+    double fec_rms = rms(out, FRAME);
+    CHECK_EQ(audio_opus_decode(s_packets[21], s_lens[21], out, FRAME), FRAME);
+
+    // 第 22 帧丢失且后续的包还没到：解码器隐藏
+    CHECK_EQ(audio_opus_conceal(NULL, 0, out, FRAME, FRAME), FRAME);
+    double plc_rms = rms(out, FRAME);
+    printf("FEC 恢复帧 RMS %.0f, 丢包隐藏帧 RMS %.0f\n", fec_rms, plc_rms);
+    CHECK(fec_rms > 1000);
+    CHECK(plc_rms > 100);
+
+    // 样本数向上取整到 2.5 ms (40 样本)，且不超过缓冲区容量
+    CHECK_EQ(audio_opus_conceal(NULL, 0, out, 100, FRAME * 2), 120);
+    CHECK_EQ(audio_opus_conceal(NULL, 0, out, FRAME, 300), 280);
+
+    audio_opus_stats_t after;
+    audio_opus_get_stats(&after);
+    CHECK_EQ(after.fec - before.fec, 1);
+    CHECK_EQ(after.plc - before.plc, 3);
+    CHECK_EQ(after.frames - before.frames, 21);
+}
+
+static void test_invalid(void)
+{
+    static int16_t out[FRAME];
+    // TOC 为 code 3 而帧数为 0 的包无效
+    const uint8_t bad[2] = {0x03, 0x00};
+    audio_opus_stats_t before;
+    audio_opus_get_stats(&before);
+    CHECK_EQ(audio_opus_samples(bad, sizeof(bad)), 0);
+    CHECK_EQ(audio_opus_decode(bad, sizeof(bad), out, FRAME), 0);
+    CHECK_EQ(audio_opus_samples(NULL, 0), 0);
+    // 输出缓冲区放不下整帧
+    CHECK_EQ(audio_opus_decode(s_packets[0], s_lens[0], out, FRAME / 2), 0);
+    audio_opus_stats_t after;
+    audio_opus_get_stats(&after);
+    CHECK_EQ(after.errors - before.errors, 2);
+}
+
+int main(void)
+{
+    encode_packets();
+    test_decode();
+    test_conceal();
+    test_invalid();
+    return TEST_RESULT();
+}
+
+#else
+
+int main(void)
+{
+    // 默认配置：解码器不可用，Opus 包在解析时被丢弃
+    int16_t out[FRAME];
+    const uint8_t packet[4] = {0x08, 0x01, 0x02, 0x03};
+    CHECK_EQ(audio_opus_init(RATE), ESP_ERR_NOT_SUPPORTED);
+    CHECK(!audio_opus_available());
+    CHECK_EQ(audio_opus_samples(packet, sizeof(packet)), 0);
+    CHECK_EQ(audio_opus_decode(packet, sizeof(packet), out, FRAME), 0);
+    CHECK_EQ(audio_opus_conceal(packet, sizeof(packet), out, FRAME, FRAME), 0);
+    CHECK_EQ(audio_opus_conceal(NULL, 0, out, FRAME, FRAME), 0);
+    audio_opus_reset();
+
+    audio_opus_stats_t stats;
+    memset(&stats, 0xFF, sizeof(stats));
+    audio_opus_get_stats(&stats);
+    CHECK(!stats.enabled);
+    CHECK_EQ(stats.frames, 0);
+    CHECK_EQ(stats.state_bytes, 0);
+    return TEST_RESULT();
+}
+
+#endif /* CONFIG_AUDIO_OPUS */
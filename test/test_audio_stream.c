@@ -0,0 +1,133 @@
+/*
+ * test_audio_stream.c
+ * 语音下行数据报分类 (user-025) 的测试
+ *
+ * 以默认配置（CONFIG_AUDIO_OPUS 关闭）编译 audio_stream.c，FreeRTOS 与定时器用 include/ 中的桩，不启动播放任务。
+ * 以 "AU" 与版本开头但包头无效的数据报（Opus 包、未知编码、样本数不符、只有包头）必须计入 invalid 丢弃，
+ * 不进入抖动缓冲，也不退回旧格式或原始 PCM 播放；有效的编码包、旧格式包与原始 PCM 照常放入。
+ */
+
+#include <string.h>
+
+#include "audio_stream.h"
+#include "audio_player.h"
+#include "test_util.h"
+
+#define FRAME 320
+
+static int64_t s_now_us = 0;
+
+int64_t esp_timer_get_time(void)
+{
+    return s_now_us;
+}
+
+esp_err_t audio_player_write_pcm16(const int16_t* samples, size_t count, uint32_t timeout_ms)
+{
+    (void)samples;
+    (void)count;
+    (void)timeout_ms;
+    return ESP_OK;
+}
+
+/**
+ * @brief 写入编码包头，返回包头长度
+ */
+static size_t v2_header(uint8_t* buf, uint8_t codec, uint16_t samples, uint32_t seq)
+{
+    uint32_t ts = seq * FRAME;
+    const uint8_t header[16] = {
+        'A', 'U', 1, codec, 0, 0, (uint8_t)(samples >> 8), (uint8_t)samples,
+        (uint8_t)(seq >> 24), (uint8_t)(seq >> 16), (uint8_t)(seq >> 8), (uint8_t)seq,
+        (uint8_t)(ts >> 24), (uint8_t)(ts >> 16), (uint8_t)(ts >> 8), (uint8_t)ts,
+    };
+    memcpy(buf, header, sizeof(header));
+    return sizeof(header);
+}
+
+static void receive(const uint8_t* data, size_t len, audio_stream_stats_t* stats)
+{
+    s_now_us += 20000;
+    audio_stream_receive(data, len);
+    audio_stream_get_stats(stats);
+}
+
+static void test_rejected(void)
+{
+    uint8_t buf[1400];
+    audio_stream_stats_t stats;
+
+    // Opus 包：TOC 0x08 (SILK 窄带 20 ms，单帧)，Opus 关闭时样本数无从得知
+    size_t n = v2_header(buf, AUDIO_CODEC_OPUS, FRAME, 0);
+    memset(buf + n, 0x5A, 40);
+    buf[n] = 0x08;
+    receive(buf, n + 40, &stats);
+    CHECK_EQ(stats.invalid, 1);
+    CHECK_EQ(stats.jitter.received, 0);
+    CHECK_EQ(stats.raw, 0);
+    CHECK_EQ(stats.codec_packets[AUDIO_CODEC_PCM8], 0);
+    CHECK_EQ(stats.codec_packets[AUDIO_CODEC_OPUS], 0);
+
+    // 未知编码
+    n = v2_header(buf, AUDIO_CODEC_COUNT, FRAME, 1);
+    memset(buf + n, 0x80, FRAME);
+    receive(buf, n + FRAME, &stats);
+    CHECK_EQ(stats.invalid, 2);
+
+    // mu-law 的样本数与载荷长度不符
+    n = v2_header(buf, AUDIO_CODEC_MULAW, FRAME + 1, 2);
+    receive(buf, n + FRAME, &stats);
+    CHECK_EQ(stats.invalid, 3);
+
+    // 保留字段不为 0
+    n = v2_header(buf, AUDIO_CODEC_MULAW, FRAME, 3);
+    buf[5] = 1;
+    receive(buf, n + FRAME, &stats);
+    CHECK_EQ(stats.invalid, 4);
+
+    // 只有包头、只有 magic 与版本
+    n = v2_header(buf, AUDIO_CODEC_MULAW, FRAME, 4);
+    receive(buf, n, &stats);
+    receive(buf, 3, &stats);
+    CHECK_EQ(stats.invalid, 6);
+
+    CHECK_EQ(stats.datagrams, 6);
+    CHECK_EQ(stats.jitter.received, 0);
+    CHECK_EQ(stats.raw, 0);
+    for (int c = 0; c < AUDIO_CODEC_COUNT; c++) {
+        CHECK_EQ(stats.codec_packets[c], 0);
+    }
+}
+
+static void test_accepted(void)
+{
+    uint8_t buf[1400];
+    audio_stream_stats_t before;
+    audio_stream_stats_t stats;
+    audio_stream_get_stats(&before);
+
+    // 有效的 mu-law 编码包
+    size_t n = v2_header(buf, AUDIO_CODEC_MULAW, FRAME, 10);
+    memset(buf + n, 0xFF, FRAME);
+    receive(buf, n + FRAME, &stats);
+    CHECK_EQ(stats.codec_packets[AUDIO_CODEC_MULAW], 1);
+    CHECK_EQ(stats.jitter.received - before.jitter.received, 1);
+
+    // "AU" 之后的版本不是 1：不是编码包，按原始 PCM 播放
+    n = v2_header(buf, AUDIO_CODEC_MULAW, FRAME, 11);
+    buf[2] = 2;
+    receive(buf, n + FRAME, &stats);
+    CHECK_EQ(stats.raw, 1);
+
+    CHECK_EQ(stats.invalid, before.invalid);
+    CHECK_EQ(stats.codec_packets[AUDIO_CODEC_PCM8], 1);
+    CHECK_EQ(stats.jitter.received - before.jitter.received, 2);
+}
+
+int main(void)
+{
+    CHECK_EQ(audio_stream_init(), ESP_OK);
+    test_rejected();
+    test_accepted();
+    return TEST_RESULT();
+}
@@ -0,0 +1,201 @@
+/*
+ * test_bitrate_replay.c
+ * 自适应码率控制 (user-008) 的回放测试
+ *
+ * 用简单的场景与链路模型逐帧驱动 bitrate_ctrl：帧大小按分辨率档位的像素数与 JPEG 质量估算，
+ * 发送耗时按链路带宽计算，链路跟不上时按超出部分报告丢包。配置与 udp_camera_client.c 相同。
+ * 检查码率收敛到目标死区内、链路变差时尽快降码率、恢复后回到目标且不来回振荡。
+ */
+
+#include <string.h>
+
+#include "bitrate_ctrl.h"
+#include "test_util.h"
+
+#define FPS 15
+#define LEVELS 6
+#define QUALITY_MIN 8
+#define QUALITY_MAX 40
+
+// QQVGA, HQVGA, QVGA, CIF, HVGA, VGA
+static const uint32_t s_pixels[LEVELS] = {160 * 120, 240 * 176, 320 * 240, 400 * 296, 480 * 320, 640 * 480};
+
+typedef struct
+{
+    bitrate_ctrl_t ctrl;
+    bitrate_ctrl_setting_t setting;
+    uint32_t link_bps;    // 链路带宽
+    uint32_t seed;
+    uint32_t changes;     // 参数调整次数
+    uint32_t reversals;   // 调整方向反转次数
+    int last_direction;
+    uint32_t demand_bps;  // 本帧的实际码率
+} sim_t;
+
+/**
+ * @brief 场景模型：每像素比特数约为 12 / quality，带 ±10% 的场景波动
+ */
+static uint32_t frame_bytes(sim_t* sim)
+{
+    uint32_t bits = (uint32_t)((uint64_t)s_pixels[sim->setting.level] * 12 / sim->setting.quality);
+    uint32_t jitter = 90 + test_rand(&sim->seed) % 21;
+    return bits * jitter / 100 / 8;
+}
+
+static void sim_init(sim_t* sim, uint32_t target_bps, uint32_t link_bps, uint8_t quality, uint8_t level)
+{
+    memset(sim, 0, sizeof(*sim));
+    bitrate_ctrl_config_t config = {
+        .target_bps = target_bps,
+        .target_fps = FPS,
+        .quality_min = QUALITY_MIN,
+        .quality_max = QUALITY_MAX,
+        .quality_step = 2,
+        .levels = LEVELS,
+        .deadband_pct = 15,
+        .confirm_frames = 3,
+        .hold_frames = 10,
+        .loss_high_permille = 50,
+    };
+    bitrate_ctrl_setting_t initial = {.quality = quality, .level = level};
+    CHECK_EQ(bitrate_ctrl_init(&sim->ctrl, &config, &initial), ESP_OK);
+    sim->setting = sim->ctrl.setting;
+    sim->link_bps = link_bps;
+    sim->seed = 2024;
+}
+
+static void sim_run(sim_t* sim, uint32_t frames)
+{
+    for (uint32_t n = 0; n < frames; n++) {
+        uint32_t bytes = frame_bytes(sim);
+        sim->demand_bps = bytes * 8 * FPS;
+        bitrate_ctrl_sample_t sample = {
+            .frame_bytes = bytes,
+            .send_us = (uint32_t)((uint64_t)bytes * 8 * 1000000 / sim->link_bps),
+            .fps = FPS,
+        };
+        if (sim->demand_bps > sim->link_bps) {
+            sample.loss_permille = (uint16_t)((uint64_t)(sim->demand_bps - sim->link_bps) * 1000 / sim->demand_bps);
+        }
+
+        bitrate_ctrl_setting_t before = sim->setting;
+        if (bitrate_ctrl_observe(&sim->ctrl, &sample, &sim->setting)) {
+            // 质量数值变大或分辨率变低为降码率
+            int direction = (sim->setting.level < before.level || (sim->setting.level == before.level && sim->setting.quality > before.quality)) ? -1 : 1;
+            if (sim->last_direction != 0 && direction != sim->last_direction) {
+                sim->reversals++;
+            }
+            sim->last_direction = direction;
+            sim->changes++;
+        }
+    }
+}
+
+/**
+ * @brief 连续运行 frames 帧，返回码率落在 [low%, high%] * target 之外的帧数
+ */
+static uint32_t sim_outside(sim_t* sim, uint32_t frames, uint32_t target_bps, uint32_t low_pct, uint32_t high_pct)
+{
+    uint32_t outside = 0;
+    for (uint32_t n = 0; n < frames; n++) {
+        sim_run(sim, 1);
+        uint64_t demand = (uint64_t)sim->demand_bps * 100;
+        if (demand < (uint64_t)target_bps * low_pct || demand > (uint64_t)target_bps * high_pct) {
+            outside++;
+        }
+    }
+    return outside;
+}
+
+static void print_state(const char* phase, sim_t* sim)
+{
+    bitrate_ctrl_stats_t stats;
+    bitrate_ctrl_get_stats(&sim->ctrl, &stats);
+    printf("%s: 档位 %u 质量 %2u, 估算 %7lu bit/s, 降 %lu 次 升 %lu 次, 拥塞帧 %lu, 反转 %lu\n", phase, stats.setting.level, stats.setting.quality,
+           (unsigned long)stats.demand_bps, (unsigned long)stats.steps_down, (unsigned long)stats.steps_up, (unsigned long)stats.congestion_frames,
+           (unsigned long)sim->reversals);
+}
+
+static void test_converge_and_recover(void)
+{
+    const uint32_t target = 2000000;
+    sim_t sim;
+    sim_init(&sim, target, 6000000, QUALITY_MIN, LEVELS - 1);
+
+    // 从 VGA 最好画质 (约 7 Mbit/s，超过链路带宽) 开始，收敛到目标附近后保持稳定且不再拥塞
+    sim_run(&sim, 300);
+    print_state("收敛", &sim);
+    uint32_t changes = sim.changes;
+    uint32_t congested_before = sim.ctrl.stats.congestion_frames;
+    CHECK(sim_outside(&sim, 150, target, 70, 130) < 15);
+    CHECK(sim.changes - changes <= 2);
+    CHECK_EQ(sim.ctrl.stats.congestion_frames, congested_before);
+
+    // 链路降到 1 Mbit/s：丢包报告触发快速降码率，1 秒左右后不再拥塞
+    sim.link_bps = 1000000;
+    congested_before = sim.ctrl.stats.congestion_frames;
+    sim_run(&sim, 90);
+    print_state("链路变差", &sim);
+    CHECK(sim.ctrl.stats.congestion_frames > congested_before);
+    congested_before = sim.ctrl.stats.congestion_frames;
+    sim_run(&sim, 60);
+    CHECK(sim.ctrl.stats.congestion_frames - congested_before < 10);
+    CHECK(sim.demand_bps < sim.link_bps);
+
+    // 链路恢复：回到目标附近，整个过程中方向反转次数有限
+    sim.link_bps = 6000000;
+    sim_run(&sim, 400);
+    print_state("链路恢复", &sim);
+    CHECK(sim_outside(&sim, 150, target, 70, 130) < 15);
+    CHECK(sim.reversals <= 6);
+}
+
+static void test_target_change(void)
+{
+    sim_t sim;
+    sim_init(&sim, 4000000, 20000000, 20, 2);
+    sim_run(&sim, 400);
+    print_state("目标 4 Mbit/s", &sim);
+    CHECK(sim_outside(&sim, 100, 4000000, 70, 130) < 10);
+    uint8_t level_high = sim.setting.level;
+
+    // 运行时降低目标码率 (udp_camera_set_adaptive_bitrate)
+    bitrate_ctrl_set_target(&sim.ctrl, 300000, FPS);
+    sim_run(&sim, 600);
+    print_state("目标 300 kbit/s", &sim);
+    CHECK(sim_outside(&sim, 100, 300000, 70, 130) < 10);
+    CHECK(sim.setting.level < level_high);
+}
+
+static void test_limits(void)
+{
+    // 链路太差时停在最低档位最差画质，不越界
+    sim_t sim;
+    sim_init(&sim, 100000, 50000, QUALITY_MIN, LEVELS - 1);
+    sim_run(&sim, 1000);
+    CHECK_EQ(sim.setting.level, 0);
+    CHECK_EQ(sim.setting.quality, QUALITY_MAX);
+
+    // 带宽充足时停在最高档位最好画质
+    sim_init(&sim, 100000000, 100000000, QUALITY_MAX, 0);
+    sim_run(&sim, 1000);
+    CHECK_EQ(sim.setting.level, LEVELS - 1);
+    CHECK_EQ(sim.setting.quality, QUALITY_MIN);
+
+    bitrate_ctrl_t ctrl;
+    bitrate_ctrl_config_t config = {.quality_min = 40, .quality_max = 8, .quality_step = 2, .levels = 1};
+    bitrate_ctrl_setting_t initial = {.quality = 10};
+    CHECK_EQ(bitrate_ctrl_init(&ctrl, &config, &initial), ESP_ERR_INVALID_ARG);
+    config.quality_min = 8;
+    config.quality_max = 40;
+    config.levels = 0;
+    CHECK_EQ(bitrate_ctrl_init(&ctrl, &config, &initial), ESP_ERR_INVALID_ARG);
+}
+
+int main(void)
+{
+    test_converge_and_recover();
+    test_target_change();
+    test_limits();
+    return TEST_RESULT();
+}
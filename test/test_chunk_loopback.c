@@ -0,0 +1,202 @@
+/*
+ * test_chunk_loopback.c
+ * 零拷贝分包发送 (user-002) 的回环测试
+ *
+ * 按 send_image_via_udp() 的方式把一帧切成 v1/v2 分包，包头与指向帧缓冲的负载作为两个数据段
+ * 用 sendmsg() 发到 127.0.0.1，接收端解码后按偏移重组，必须与原图逐字节一致；
+ * 同时与先拷贝成整包再发送的路径比较包内容，并打印两条路径每帧的发送耗时、吞吐量 (字节/秒)、CPU 时间与周期数。
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "image_proto.h"
+#include "test_util.h"
+
+#define FRAME_SIZE 60000
+#define BENCH_FRAMES 200
+
+static int s_tx = -1;
+static int s_rx = -1;
+static struct sockaddr_in s_rx_addr;
+
+static void open_loopback(void)
+{
+    s_rx = socket(AF_INET, SOCK_DGRAM, 0);
+    s_tx = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&s_rx_addr, 0, sizeof(s_rx_addr));
+    s_rx_addr.sin_family = AF_INET;
+    s_rx_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(s_rx_addr);
+    int rcvbuf = 4 * 1024 * 1024;
+    setsockopt(s_rx, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    CHECK(bind(s_rx, (struct sockaddr*)&s_rx_addr, sizeof(s_rx_addr)) == 0);
+    CHECK(getsockname(s_rx, (struct sockaddr*)&s_rx_addr, &addr_len) == 0);
+}
+
+/**
+ * @brief 发送一个分包：零拷贝为两个数据段，否则先拷贝成整包
+ */
+static ssize_t send_chunk(const uint8_t* header, size_t header_size, const uint8_t* payload, size_t payload_size, bool zero_copy)
+{
+    uint8_t packet[IMAGE_PROTO_MAX_PACKET_SIZE];
+    struct iovec iov[2];
+    int iovcnt;
+    if (zero_copy) {
+        iov[0] = (struct iovec){.iov_base = (void*)header, .iov_len = header_size};
+        iov[1] = (struct iovec){.iov_base = (void*)payload, .iov_len = payload_size};
+        iovcnt = 2;
+    }
+    else {
+        memcpy(packet, header, header_size);
+        memcpy(packet + header_size, payload, payload_size);
+        iov[0] = (struct iovec){.iov_base = packet, .iov_len = header_size + payload_size};
+        iovcnt = 1;
+    }
+    struct msghdr msg = {
+        .msg_name = &s_rx_addr,
+        .msg_namelen = sizeof(s_rx_addr),
+        .msg_iov = iov,
+        .msg_iovlen = iovcnt,
+    };
+    return sendmsg(s_tx, &msg, 0);
+}
+
+/**
+ * @brief 按 send_image_via_udp() 的分包方式发送一帧，返回包数
+ */
+static uint32_t send_frame(const uint8_t* image, size_t size, uint8_t version, uint32_t frame_seq, bool zero_copy)
+{
+    size_t max_payload = IMAGE_PROTO_MAX_PACKET_SIZE - image_proto_header_size(version);
+    uint32_t total_chunks = (size + max_payload - 1) / max_payload;
+    image_proto_chunk_t chunk = {
+        .version = version,
+        .frame_seq = frame_seq,
+        .timestamp_us = 1234567890123ULL,
+        .image_size = size,
+        .total_chunks = total_chunks,
+    };
+    uint8_t header[IMAGE_PROTO_V2_HEADER_SIZE];
+
+    for (uint32_t i = 0; i < total_chunks; i++) {
+        size_t offset = (size_t)i * max_payload;
+        size_t payload_size = size - offset > max_payload ? max_payload : size - offset;
+        chunk.chunk_id = i;
+        chunk.offset = offset;
+        chunk.flags = IMAGE_PROTO_FLAG_KEYFRAME | (i == 0 ? IMAGE_PROTO_FLAG_FIRST : 0) | (i == total_chunks - 1 ? IMAGE_PROTO_FLAG_LAST : 0);
+        CHECK_EQ(image_proto_encode_header(&chunk, image + offset, payload_size, header), ESP_OK);
+        CHECK_EQ(send_chunk(header, image_proto_header_size(version), image + offset, payload_size, zero_copy),
+                 (ssize_t)(image_proto_header_size(version) + payload_size));
+    }
+    return total_chunks;
+}
+
+/**
+ * @brief 接收 packets 个包并重组，返回收到的包的原始字节（用于比较两条发送路径）
+ */
+static void receive_frame(uint8_t* image, size_t size, uint8_t version, uint32_t frame_seq, uint32_t packets, uint8_t* raw)
+{
+    uint8_t packet[IMAGE_PROTO_MAX_PACKET_SIZE];
+    size_t received = 0;
+    for (uint32_t i = 0; i < packets; i++) {
+        ssize_t len = recv(s_rx, packet, sizeof(packet), 0);
+        CHECK(len > 0);
+        if (len <= 0) {
+            return;
+        }
+        if (raw != NULL) {
+            memcpy(raw + (size_t)i * IMAGE_PROTO_MAX_PACKET_SIZE, packet, (size_t)len);
+        }
+
+        image_proto_chunk_t chunk;
+        const uint8_t* payload;
+        size_t payload_len;
+        CHECK_EQ(image_proto_decode(packet, (size_t)len, &chunk, &payload, &payload_len), ESP_OK);
+        CHECK_EQ(chunk.version, version);
+        CHECK_EQ(chunk.image_size, size);
+        CHECK_EQ(chunk.chunk_id, i);
+        CHECK_EQ(chunk.total_chunks, packets);
+        if (version == IMAGE_PROTO_VERSION) {
+            CHECK_EQ(chunk.frame_seq, frame_seq);
+            CHECK_EQ(chunk.timestamp_us, 1234567890123ULL);
+            CHECK_EQ((chunk.flags & IMAGE_PROTO_FLAG_FIRST) != 0, i == 0);
+            CHECK_EQ((chunk.flags & IMAGE_PROTO_FLAG_LAST) != 0, i == packets - 1);
+        }
+        CHECK(chunk.offset + payload_len <= size);
+        if (chunk.offset + payload_len <= size) {
+            memcpy(image + chunk.offset, payload, payload_len);
+            received += payload_len;
+        }
+    }
+    CHECK_EQ(received, size);
+}
+
+static void test_roundtrip(uint8_t version)
+{
+    uint8_t* image = malloc(FRAME_SIZE);
+    uint8_t* out = calloc(1, FRAME_SIZE);
+    uint32_t packets_max = FRAME_SIZE / (IMAGE_PROTO_MAX_PACKET_SIZE - IMAGE_PROTO_V2_HEADER_SIZE) + 1;
+    uint8_t* raw_zero_copy = calloc(packets_max, IMAGE_PROTO_MAX_PACKET_SIZE);
+    uint8_t* raw_copy = calloc(packets_max, IMAGE_PROTO_MAX_PACKET_SIZE);
+    test_fill(image, FRAME_SIZE, 0x1234u + version);
+
+    // 帧长不是负载的整数倍，最后一包较短
+    size_t size = FRAME_SIZE - 77;
+    uint32_t packets = send_frame(image, size, version, 7, true);
+    receive_frame(out, size, version, 7, packets, raw_zero_copy);
+    CHECK(memcmp(image, out, size) == 0);
+
+    CHECK_EQ(send_frame(image, size, version, 7, false), packets);
+    receive_frame(out, size, version, 7, packets, raw_copy);
+    CHECK(memcmp(raw_zero_copy, raw_copy, (size_t)packets * IMAGE_PROTO_MAX_PACKET_SIZE) == 0);
+
+    free(image);
+    free(out);
+    free(raw_zero_copy);
+    free(raw_copy);
+}
+
+static void bench(void)
+{
+    uint8_t* image = malloc(FRAME_SIZE);
+    uint8_t* out = malloc(FRAME_SIZE);
+    test_fill(image, FRAME_SIZE, 99);
+
+    // 只计发送：吞吐量按帧字节数除以发送耗时，CPU 时间与周期数按帧平均
+    for (int zero_copy = 1; zero_copy >= 0; zero_copy--) {
+        uint64_t elapsed = 0;
+        uint64_t cpu = 0;
+        uint64_t cycles = 0;
+        for (uint32_t n = 0; n < BENCH_FRAMES; n++) {
+            uint64_t start = test_now_ns();
+            uint64_t cpu_start = test_cpu_ns();
+            uint64_t cycles_start = test_cycles();
+            uint32_t packets = send_frame(image, FRAME_SIZE, IMAGE_PROTO_VERSION, n, zero_copy);
+            cycles += test_cycles() - cycles_start;
+            cpu += test_cpu_ns() - cpu_start;
+            elapsed += test_now_ns() - start;
+            receive_frame(out, FRAME_SIZE, IMAGE_PROTO_VERSION, n, packets, NULL);
+        }
+        double bytes_per_s = (double)FRAME_SIZE * BENCH_FRAMES / (elapsed / 1e9);
+        printf("%s: 每帧 (%d 字节) 发送 %.1f us, %.1f MB/s, CPU %.1f us, %.0f 周期\n", zero_copy ? "sendmsg 零拷贝" : "拷贝整包", FRAME_SIZE,
+               elapsed / 1000.0 / BENCH_FRAMES, bytes_per_s / 1e6, cpu / 1000.0 / BENCH_FRAMES, (double)cycles / BENCH_FRAMES);
+    }
+
+    free(image);
+    free(out);
+}
+
+int main(void)
+{
+    open_loopback();
+    test_roundtrip(1);
+    test_roundtrip(IMAGE_PROTO_VERSION);
+    bench();
+    close(s_tx);
+    close(s_rx);
+    return TEST_RESULT();
+}
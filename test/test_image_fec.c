@@ -0,0 +1,208 @@
+/*
+ * test_image_fec.c
+ * XOR 校验包 (user-004) 的丢包注入测试
+ *
+ * 按 send_image_via_udp() 的方式生成每组的校验包，逐个丢弃组内的数据包后用 image_fec_recover() 恢复，
+ * 再按 1%、5%、10% 的随机丢包率统计完整帧的比例；校验包与数据包以同样的概率丢失，丢了校验包的组无法恢复。
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "image_proto.h"
+#include "image_fec.h"
+#include "test_util.h"
+
+#define IMAGE_SIZE 50001
+#define CHUNK_PAYLOAD IMAGE_PROTO_V2_PAYLOAD_SIZE
+#define TOTAL_CHUNKS ((IMAGE_SIZE + CHUNK_PAYLOAD - 1) / CHUNK_PAYLOAD)
+#define MAX_GROUPS TOTAL_CHUNKS
+
+static uint8_t s_image[IMAGE_SIZE];
+static uint8_t s_rebuilt[IMAGE_SIZE];
+static uint8_t s_parity[MAX_GROUPS][CHUNK_PAYLOAD];
+static size_t s_parity_len[MAX_GROUPS];
+static bool s_received[TOTAL_CHUNKS];
+
+static size_t chunk_len(uint32_t chunk)
+{
+    size_t offset = (size_t)chunk * CHUNK_PAYLOAD;
+    return IMAGE_SIZE - offset > CHUNK_PAYLOAD ? CHUNK_PAYLOAD : IMAGE_SIZE - offset;
+}
+
+/**
+ * @brief 与发送端相同：组内数据包异或累加，分组结束或整帧结束时得到校验包
+ */
+static uint32_t build_parity(uint32_t group_size)
+{
+    uint32_t groups = 0;
+    for (uint32_t i = 0; i < TOTAL_CHUNKS; i++) {
+        uint32_t group = i / group_size;
+        if (i % group_size == 0) {
+            memset(s_parity[group], 0, CHUNK_PAYLOAD);
+        }
+        image_fec_xor(s_parity[group], s_image + (size_t)i * CHUNK_PAYLOAD, chunk_len(i));
+        if ((i + 1) % group_size == 0 || i == TOTAL_CHUNKS - 1) {
+            s_parity_len[group] = image_fec_parity_len(IMAGE_SIZE, CHUNK_PAYLOAD, group, group_size);
+            groups++;
+        }
+    }
+    return groups;
+}
+
+/**
+ * @brief 按丢包掩码重组一帧，返回恢复后是否完整
+ * @param lost 各数据包是否丢失
+ * @param parity_lost 各组的校验包是否丢失，NULL 表示全部收到
+ */
+static bool receive_with_loss(const bool* lost, const bool* parity_lost, uint32_t group_size, uint32_t groups)
+{
+    memset(s_rebuilt, 0, sizeof(s_rebuilt));
+    for (uint32_t i = 0; i < TOTAL_CHUNKS; i++) {
+        s_received[i] = !lost[i];
+        if (s_received[i]) {
+            memcpy(s_rebuilt + (size_t)i * CHUNK_PAYLOAD, s_image + (size_t)i * CHUNK_PAYLOAD, chunk_len(i));
+        }
+    }
+
+    bool complete = true;
+    for (uint32_t group = 0; group < groups; group++) {
+        uint32_t first = image_fec_group_first(group, group_size);
+        uint32_t missing = 0;
+        for (uint32_t i = first; i < first + group_size && i < TOTAL_CHUNKS; i++) {
+            missing += lost[i] ? 1 : 0;
+        }
+        if (parity_lost != NULL && parity_lost[group]) {
+            // 没有校验包，组内缺包无法恢复
+            complete &= missing == 0;
+            continue;
+        }
+
+        uint32_t recovered = UINT32_MAX;
+        esp_err_t err = image_fec_recover(s_rebuilt, IMAGE_SIZE, CHUNK_PAYLOAD, s_received, group, group_size, s_parity[group], s_parity_len[group], &recovered);
+        if (missing == 0) {
+            CHECK_EQ(err, ESP_ERR_NOT_FOUND);
+        }
+        else if (missing == 1) {
+            CHECK_EQ(err, ESP_OK);
+            CHECK(recovered >= first && recovered < first + group_size && lost[recovered]);
+        }
+        else {
+            CHECK_EQ(err, ESP_ERR_NOT_SUPPORTED);
+            complete = false;
+        }
+    }
+
+    if (complete) {
+        CHECK(memcmp(s_rebuilt, s_image, IMAGE_SIZE) == 0);
+        for (uint32_t i = 0; i < TOTAL_CHUNKS; i++) {
+            CHECK(s_received[i]);
+        }
+    }
+    return complete;
+}
+
+static void test_single_loss(uint32_t group_size)
+{
+    uint32_t groups = build_parity(group_size);
+    CHECK_EQ(groups, (TOTAL_CHUNKS + group_size - 1) / group_size);
+
+    // 最后一组较短，校验长度为组内最长的包
+    uint32_t last_first = image_fec_group_first(groups - 1, group_size);
+    CHECK_EQ(s_parity_len[groups - 1], chunk_len(last_first));
+
+    bool lost[TOTAL_CHUNKS];
+    memset(lost, 0, sizeof(lost));
+    CHECK(receive_with_loss(lost, NULL, group_size, groups));
+
+    // 每个数据包单独丢失都能恢复
+    for (uint32_t i = 0; i < TOTAL_CHUNKS; i++) {
+        memset(lost, 0, sizeof(lost));
+        lost[i] = true;
+        CHECK(receive_with_loss(lost, NULL, group_size, groups));
+    }
+
+    // 每组各丢一个包（组内位置轮换）也能全部恢复
+    memset(lost, 0, sizeof(lost));
+    for (uint32_t group = 0; group < groups; group++) {
+        uint32_t first = image_fec_group_first(group, group_size);
+        uint32_t i = first + group % group_size;
+        lost[i < TOTAL_CHUNKS ? i : first] = true;
+    }
+    CHECK(receive_with_loss(lost, NULL, group_size, groups));
+
+    // 校验包丢失：组内没有缺包时仍完整，缺一个包就无法恢复
+    bool parity_lost[MAX_GROUPS];
+    memset(parity_lost, 0, sizeof(parity_lost));
+    parity_lost[0] = true;
+    memset(lost, 0, sizeof(lost));
+    CHECK(receive_with_loss(lost, parity_lost, group_size, groups));
+    lost[0] = true;
+    CHECK(!receive_with_loss(lost, parity_lost, group_size, groups));
+
+    // 同组丢两个包无法恢复
+    if (group_size >= 2) {
+        memset(lost, 0, sizeof(lost));
+        lost[0] = true;
+        lost[1] = true;
+        CHECK(!receive_with_loss(lost, NULL, group_size, groups));
+    }
+}
+
+static void test_invalid(void)
+{
+    build_parity(4);
+    memset(s_received, 1, sizeof(s_received));
+    s_received[1] = false;
+    CHECK_EQ(image_fec_recover(s_rebuilt, IMAGE_SIZE, CHUNK_PAYLOAD, s_received, 0, 4, s_parity[0], s_parity_len[0] - 1, NULL), ESP_ERR_INVALID_SIZE);
+    CHECK_EQ(image_fec_recover(s_rebuilt, IMAGE_SIZE, CHUNK_PAYLOAD, s_received, 0, 0, s_parity[0], s_parity_len[0], NULL), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(image_fec_parity_len(IMAGE_SIZE, CHUNK_PAYLOAD, MAX_GROUPS, 4), 0);
+}
+
+/**
+ * @brief 随机丢包下整帧可用的比例（有无 FEC 对比），校验包同样按丢包率丢失
+ */
+static void report_random_loss(uint32_t group_size, uint32_t loss_permille)
+{
+    uint32_t groups = build_parity(group_size);
+    uint32_t seed = 0xC0FFEEu + loss_permille;
+    uint32_t frames = 2000;
+    uint32_t complete_raw = 0;
+    uint32_t complete_fec = 0;
+    uint32_t parity_dropped = 0;
+    bool lost[TOTAL_CHUNKS];
+    bool parity_lost[MAX_GROUPS];
+    for (uint32_t n = 0; n < frames; n++) {
+        bool any = false;
+        for (uint32_t i = 0; i < TOTAL_CHUNKS; i++) {
+            lost[i] = test_rand(&seed) % 1000 < loss_permille;
+            any |= lost[i];
+        }
+        for (uint32_t group = 0; group < groups; group++) {
+            parity_lost[group] = test_rand(&seed) % 1000 < loss_permille;
+            parity_dropped += parity_lost[group] ? 1 : 0;
+        }
+        complete_raw += any ? 0 : 1;
+        complete_fec += receive_with_loss(lost, parity_lost, group_size, groups) ? 1 : 0;
+    }
+    printf("丢包率 %3lu‰, 分组 %2lu (冗余 %4.1f%%, 丢失校验包 %5.2f%%): 完整帧 %5.1f%% -> %5.1f%%\n", (unsigned long)loss_permille,
+           (unsigned long)group_size, 100.0 * groups / TOTAL_CHUNKS, 100.0 * parity_dropped / ((double)groups * frames), 100.0 * complete_raw / frames,
+           100.0 * complete_fec / frames);
+    CHECK(complete_fec >= complete_raw);
+}
+
+int main(void)
+{
+    test_fill(s_image, IMAGE_SIZE, 0xFEC);
+    const uint32_t group_sizes[] = {1, 2, 3, 4, 8, 16, IMAGE_FEC_MAX_GROUP_SIZE};
+    for (size_t i = 0; i < sizeof(group_sizes) / sizeof(group_sizes[0]); i++) {
+        test_single_loss(group_sizes[i]);
+    }
+    test_invalid();
+    const uint32_t losses[] = {10, 50, 100};
+    for (size_t i = 0; i < sizeof(losses) / sizeof(losses[0]); i++) {
+        report_random_loss(4, losses[i]);
+        report_random_loss(8, losses[i]);
+    }
+    return TEST_RESULT();
+}
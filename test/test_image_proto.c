@@ -0,0 +1,168 @@
+/*
+ * test_image_proto.c
+ * v2 图像协议 (user-003) 的CRC32与包头往返测试
+ */
+
+#include <string.h>
+
+#include "image_proto.h"
+#include "test_util.h"
+
+static void test_crc32(void)
+{
+    // IEEE 802.3 标准校验值，与 zlib.crc32(b"123456789") 一致
+    const uint8_t check[] = "123456789";
+    CHECK_EQ(image_proto_crc32(0, check, 9), 0xCBF43926u);
+    CHECK_EQ(image_proto_crc32(0, NULL, 0), 0);
+
+    // 分段累加与一次计算结果相同
+    uint8_t data[3000];
+    test_fill(data, sizeof(data), 3);
+    uint32_t whole = image_proto_crc32(0, data, sizeof(data));
+    for (size_t split = 0; split <= sizeof(data); split += 331) {
+        CHECK_EQ(image_proto_crc32(image_proto_crc32(0, data, split), data + split, sizeof(data) - split), whole);
+    }
+}
+
+static void test_v2_roundtrip(void)
+{
+    uint8_t packet[IMAGE_PROTO_MAX_PACKET_SIZE];
+    uint8_t* payload = packet + IMAGE_PROTO_V2_HEADER_SIZE;
+    size_t payload_len = IMAGE_PROTO_V2_PAYLOAD_SIZE - 5;
+    test_fill(payload, payload_len, 7);
+
+    image_proto_chunk_t chunk = {
+        .version = IMAGE_PROTO_VERSION,
+        .flags = IMAGE_PROTO_FLAG_FIRST | IMAGE_PROTO_FLAG_KEYFRAME | IMAGE_PROTO_FLAG_RETRANSMIT,
+        .frame_seq = 0xDEADBEEFu,
+        .timestamp_us = 0x0123456789ABCDEFULL,
+        .offset = 0x00ABCDEFu,
+        .image_size = 0x01020304u,
+        .chunk_id = 0xFFFE,
+        .total_chunks = 0xFFFF,
+    };
+    CHECK_EQ(image_proto_header_size(IMAGE_PROTO_VERSION), IMAGE_PROTO_V2_HEADER_SIZE);
+    CHECK_EQ(image_proto_encode_header(&chunk, payload, payload_len, packet), ESP_OK);
+
+    image_proto_chunk_t decoded;
+    const uint8_t* out_payload;
+    size_t out_len;
+    size_t len = IMAGE_PROTO_V2_HEADER_SIZE + payload_len;
+    CHECK_EQ(image_proto_decode(packet, len, &decoded, &out_payload, &out_len), ESP_OK);
+    CHECK_EQ(decoded.version, chunk.version);
+    CHECK_EQ(decoded.flags, chunk.flags);
+    CHECK_EQ(decoded.frame_seq, chunk.frame_seq);
+    CHECK_EQ(decoded.timestamp_us, chunk.timestamp_us);
+    CHECK_EQ(decoded.offset, chunk.offset);
+    CHECK_EQ(decoded.image_size, chunk.image_size);
+    CHECK_EQ(decoded.chunk_id, chunk.chunk_id);
+    CHECK_EQ(decoded.total_chunks, chunk.total_chunks);
+    CHECK(out_payload == payload);
+    CHECK_EQ(out_len, payload_len);
+
+    // 包头与负载中任意一位翻转都由CRC发现
+    for (size_t bit = 0; bit < len * 8; bit += 7) {
+        packet[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        esp_err_t err = image_proto_decode(packet, len, &decoded, &out_payload, &out_len);
+        // 翻转魔数或版本时按 v1 包头或版本错误处理，其余位置必须是CRC错误
+        if (bit < 24) {
+            CHECK(err != ESP_OK || decoded.version == 1);
+        }
+        else {
+            CHECK_EQ(err, ESP_ERR_INVALID_CRC);
+        }
+        packet[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+    }
+
+    // 截断的包
+    CHECK_EQ(image_proto_decode(packet, len - 1, &decoded, &out_payload, &out_len), ESP_ERR_INVALID_CRC);
+    CHECK_EQ(image_proto_decode(packet, IMAGE_PROTO_V2_HEADER_SIZE - 1, &decoded, &out_payload, &out_len), ESP_ERR_INVALID_SIZE);
+
+    // 未知版本
+    packet[2] = IMAGE_PROTO_VERSION + 1;
+    CHECK_EQ(image_proto_decode(packet, len, &decoded, &out_payload, &out_len), ESP_ERR_INVALID_VERSION);
+
+    // 空负载
+    CHECK_EQ(image_proto_encode_header(&chunk, NULL, 0, packet), ESP_OK);
+    CHECK_EQ(image_proto_decode(packet, IMAGE_PROTO_V2_HEADER_SIZE, &decoded, &out_payload, &out_len), ESP_OK);
+    CHECK_EQ(out_len, 0);
+
+    // 16 位包序号放不下时拒绝编码
+    chunk.chunk_id = 0x10000;
+    CHECK_EQ(image_proto_encode_header(&chunk, payload, payload_len, packet), ESP_ERR_INVALID_ARG);
+    chunk.chunk_id = 0;
+    chunk.total_chunks = 0x10000;
+    CHECK_EQ(image_proto_encode_header(&chunk, payload, payload_len, packet), ESP_ERR_INVALID_ARG);
+    chunk.total_chunks = 1;
+    chunk.version = 3;
+    CHECK_EQ(image_proto_encode_header(&chunk, payload, payload_len, packet), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(image_proto_encode_header(&chunk, NULL, 1, packet), ESP_ERR_INVALID_ARG);
+}
+
+static void test_v1_roundtrip(void)
+{
+    uint8_t packet[IMAGE_PROTO_MAX_PACKET_SIZE];
+    image_proto_chunk_t chunk = {.version = 1, .chunk_id = 5, .total_chunks = 9, .image_size = 12000};
+    CHECK_EQ(image_proto_header_size(1), IMAGE_PROTO_V1_HEADER_SIZE);
+    CHECK_EQ(image_proto_encode_header(&chunk, packet + IMAGE_PROTO_V1_HEADER_SIZE, 100, packet), ESP_OK);
+
+    image_proto_chunk_t decoded;
+    const uint8_t* payload;
+    size_t payload_len;
+    CHECK_EQ(image_proto_decode(packet, IMAGE_PROTO_V1_HEADER_SIZE + 100, &decoded, &payload, &payload_len), ESP_OK);
+    CHECK_EQ(decoded.version, 1);
+    CHECK_EQ(decoded.chunk_id, 5);
+    CHECK_EQ(decoded.total_chunks, 9);
+    CHECK_EQ(decoded.image_size, 12000);
+    CHECK_EQ(decoded.offset, 5 * IMAGE_PROTO_V1_PAYLOAD_SIZE);
+    CHECK_EQ(payload_len, 100);
+    CHECK_EQ(image_proto_decode(packet, IMAGE_PROTO_V1_HEADER_SIZE - 1, &decoded, &payload, &payload_len), ESP_ERR_INVALID_SIZE);
+}
+
+static void test_ctrl(void)
+{
+    uint8_t packet[64];
+    image_proto_report_t report = {.frame_seq = 42, .loss_permille = 17};
+    CHECK_EQ(image_proto_encode_report(&report, packet, sizeof(packet)), ESP_OK);
+    image_proto_report_t decoded_report;
+    CHECK_EQ(image_proto_decode_report(packet, IMAGE_PROTO_REPORT_SIZE, &decoded_report), ESP_OK);
+    CHECK_EQ(decoded_report.frame_seq, 42);
+    CHECK_EQ(decoded_report.loss_permille, 17);
+    CHECK_EQ(image_proto_decode_report(packet, IMAGE_PROTO_REPORT_SIZE - 1, &decoded_report), ESP_ERR_INVALID_SIZE);
+    CHECK_EQ(image_proto_encode_report(&report, packet, IMAGE_PROTO_REPORT_SIZE - 1), ESP_ERR_INVALID_SIZE);
+
+    // 控制报文不能被当作图像包，图像包也不能被当作控制报文
+    uint8_t type;
+    CHECK_EQ(image_proto_decode_ctrl(packet, IMAGE_PROTO_REPORT_SIZE, &type), ESP_OK);
+    CHECK_EQ(type, IMAGE_PROTO_CTRL_REPORT);
+    image_proto_dest_t dest;
+    CHECK_EQ(image_proto_decode_dest(packet, IMAGE_PROTO_REPORT_SIZE, &dest), ESP_ERR_INVALID_ARG);
+    packet[0] = 0x45;
+    packet[1] = 0x43;
+    CHECK_EQ(image_proto_decode_ctrl(packet, IMAGE_PROTO_REPORT_SIZE, &type), ESP_ERR_INVALID_VERSION);
+
+    const uint8_t dest_packet[] = {0x45, 0x4B, 2, IMAGE_PROTO_CTRL_DEST, IMAGE_PROTO_DEST_ADD, 0, 0x1F, 0x90, 192, 168, 1, 10};
+    CHECK_EQ(image_proto_decode_dest(dest_packet, sizeof(dest_packet), &dest), ESP_OK);
+    CHECK_EQ(dest.op, IMAGE_PROTO_DEST_ADD);
+    CHECK_EQ(dest.port, 8080);
+    CHECK(memcmp(&dest.ip, dest_packet + 8, 4) == 0);
+
+    const uint8_t camera_packet[] = {0x45, 0x4B, 2, IMAGE_PROTO_CTRL_CAMERA, 2, 0, 0, 1, 0, 0, 0, 12, 0, 2, 0xFF, 0xFF, 0xFF, 0xFE};
+    image_proto_camera_t camera;
+    CHECK_EQ(image_proto_decode_camera(camera_packet, sizeof(camera_packet), &camera), ESP_OK);
+    CHECK_EQ(camera.count, 2);
+    CHECK_EQ(camera.params[0].param, 1);
+    CHECK_EQ(camera.params[0].value, 12);
+    CHECK_EQ(camera.params[1].param, 2);
+    CHECK_EQ(camera.params[1].value, -2);
+    CHECK_EQ(image_proto_decode_camera(camera_packet, sizeof(camera_packet) - 1, &camera), ESP_ERR_INVALID_SIZE);
+}
+
+int main(void)
+{
+    test_crc32();
+    test_v2_roundtrip();
+    test_v1_roundtrip();
+    test_ctrl();
+    return TEST_RESULT();
+}
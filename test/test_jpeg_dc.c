@@ -0,0 +1,193 @@
+/*
+ * test_jpeg_dc.c
+ * JPEG 直流分量解码 (user-018) 与 libjpeg 的对照测试与基准
+ *
+ * 用 libjpeg 按不同尺寸、采样方式、质量与重启间隔编码测试图像，检查：
+ * jpeg_dc 的尺寸信息与 libjpeg 一致；YUV 输出与 libjpeg 读出的直流系数逐字节相同；
+ * 亮度平面与 libjpeg 1/8 缩放解码（1x1 IDCT）逐字节相同；不支持的编码与截断的数据被拒绝。
+ * 最后对比 jpeg_dc 与 libjpeg 1/8 缩放解码 VGA 图像的耗时。
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "jpeg_dc.h"
+#include "jpeg_util.h"
+#include "test_util.h"
+
+#define BENCH_ROUNDS 200
+
+typedef struct
+{
+    uint16_t width;
+    uint16_t height;
+    uint8_t h_samp;    // 0 表示灰度
+    uint8_t v_samp;
+    int quality;
+    uint16_t restart;
+} case_t;
+
+static const case_t s_cases[] = {
+    {640, 480, 2, 1, 12, 0},    // 相机默认：VGA 4:2:2
+    {640, 480, 2, 2, 50, 0},
+    {640, 480, 1, 1, 90, 0},
+    {320, 240, 2, 1, 95, 1},    // 每个 MCU 一个重启标记
+    {320, 240, 2, 2, 30, 7},
+    {176, 144, 2, 1, 5, 3},
+    {100, 75, 2, 2, 60, 0},     // 不足一个 MCU 的边缘
+    {100, 75, 2, 1, 60, 5},
+    {33, 17, 1, 1, 80, 2},
+    {8, 8, 2, 2, 50, 0},
+    {1600, 1200, 2, 1, 12, 0},  // UXGA
+    {640, 480, 0, 0, 50, 0},    // 灰度
+    {99, 41, 0, 0, 70, 4},
+};
+
+static uint8_t* encode_case(const case_t* c, size_t* len)
+{
+    jpeg_util_params_t params = {
+        .width = c->width,
+        .height = c->height,
+        .quality = c->quality,
+        .h_samp = c->h_samp,
+        .v_samp = c->v_samp,
+        .restart_interval = c->restart,
+        .grayscale = c->h_samp == 0,
+        .seed = (uint32_t)c->width * c->height + c->quality,
+    };
+    uint8_t* jpeg = jpeg_util_encode(&params, len);
+    CHECK(jpeg != NULL);
+    return jpeg;
+}
+
+static void test_against_libjpeg(void)
+{
+    jpeg_dc_t dec;
+    for (size_t i = 0; i < sizeof(s_cases) / sizeof(s_cases[0]); i++) {
+        const case_t* c = &s_cases[i];
+        size_t len;
+        uint8_t* jpeg = encode_case(c, &len);
+        if (jpeg == NULL) {
+            continue;
+        }
+
+        jpeg_dc_info_t info;
+        CHECK_EQ(jpeg_dc_parse(&dec, jpeg, len, &info), ESP_OK);
+        CHECK_EQ(info.image_width, c->width);
+        CHECK_EQ(info.image_height, c->height);
+        CHECK_EQ(info.width, (c->width + 7) / 8);
+        CHECK_EQ(info.height, (c->height + 7) / 8);
+        CHECK_EQ(info.components, c->h_samp == 0 ? 1 : 3);
+
+        // YUV：与 libjpeg 读出的直流系数逐字节相同
+        size_t ref_size;
+        uint8_t* ref = jpeg_util_dc_planes(jpeg, len, &ref_size);
+        CHECK(ref != NULL);
+        size_t size = jpeg_dc_output_size(&info, JPEG_DC_YUV);
+        CHECK_EQ(size, ref_size);
+        uint8_t* yuv = malloc(size);
+        CHECK_EQ(jpeg_dc_decode(&dec, JPEG_DC_YUV, yuv, size), ESP_OK);
+        CHECK(ref != NULL && size == ref_size && memcmp(yuv, ref, size) == 0);
+
+        // 亮度：与 libjpeg 的 1/8 缩放解码逐字节相同
+        uint32_t width;
+        uint32_t height;
+        uint8_t* luma = jpeg_util_decode_luma_1_8(jpeg, len, &width, &height);
+        CHECK(luma != NULL);
+        CHECK_EQ(width, info.width);
+        CHECK_EQ(height, info.height);
+        uint8_t* gray = malloc(jpeg_dc_output_size(&info, JPEG_DC_GRAY));
+        CHECK_EQ(jpeg_dc_decode(&dec, JPEG_DC_GRAY, gray, jpeg_dc_output_size(&info, JPEG_DC_GRAY)), ESP_OK);
+        CHECK(luma != NULL && memcmp(gray, luma, (size_t)info.width * info.height) == 0);
+        CHECK(memcmp(gray, yuv, (size_t)info.width * info.height) == 0);
+
+        // 输出缓冲区不足
+        CHECK_EQ(jpeg_dc_decode(&dec, JPEG_DC_YUV, yuv, size - 1), ESP_ERR_INVALID_ARG);
+
+        free(gray);
+        free(luma);
+        free(yuv);
+        free(ref);
+        free(jpeg);
+    }
+}
+
+static void test_rejected(void)
+{
+    jpeg_dc_t dec;
+    jpeg_dc_info_t info;
+
+    // 渐进式
+    jpeg_util_params_t params = {.width = 64, .height = 48, .quality = 50, .h_samp = 2, .v_samp = 1, .progressive = true, .seed = 1};
+    size_t len;
+    uint8_t* jpeg = jpeg_util_encode(&params, &len);
+    CHECK(jpeg != NULL);
+    CHECK_EQ(jpeg_dc_parse(&dec, jpeg, len, &info), ESP_ERR_NOT_SUPPORTED);
+    free(jpeg);
+
+    // 头部截断返回 INVALID_SIZE；熵编码数据截断时解码失败或以填充位补齐，但不越界
+    const case_t c = {320, 240, 2, 1, 50, 4};
+    jpeg = encode_case(&c, &len);
+    size_t header_len = 0;
+    for (size_t i = 0; i + 1 < len; i++) {
+        if (jpeg[i] == 0xFF && jpeg[i + 1] == 0xDA) {
+            header_len = i;
+            break;
+        }
+    }
+    CHECK(header_len > 0);
+    for (size_t cut = 0; cut < header_len; cut += 7) {
+        CHECK_EQ(jpeg_dc_parse(&dec, jpeg, cut, &info), ESP_ERR_INVALID_SIZE);
+    }
+    uint32_t failed = 0;
+    uint8_t out[40 * 30 * 2];
+    for (size_t cut = header_len + 20; cut < len; cut += len / 16) {
+        CHECK_EQ(jpeg_dc_parse(&dec, jpeg, cut, &info), ESP_OK);
+        failed += jpeg_dc_decode(&dec, JPEG_DC_YUV, out, sizeof(out)) != ESP_OK;
+    }
+    CHECK(failed > 0);
+
+    CHECK_EQ(jpeg_dc_parse(&dec, jpeg, len, &info), ESP_OK);
+    CHECK_EQ(jpeg_dc_decode(NULL, JPEG_DC_GRAY, out, sizeof(out)), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(jpeg_dc_decode(&dec, JPEG_DC_GRAY, NULL, sizeof(out)), ESP_ERR_INVALID_ARG);
+    free(jpeg);
+}
+
+static void bench(void)
+{
+    const case_t c = {640, 480, 2, 1, 12, 0};
+    size_t len;
+    uint8_t* jpeg = encode_case(&c, &len);
+    if (jpeg == NULL) {
+        return;
+    }
+
+    jpeg_dc_t dec;
+    jpeg_dc_info_t info;
+    static uint8_t out[80 * 60 * 2];
+    uint64_t start = test_now_ns();
+    for (uint32_t n = 0; n < BENCH_ROUNDS; n++) {
+        jpeg_dc_parse(&dec, jpeg, len, &info);
+        jpeg_dc_decode(&dec, JPEG_DC_GRAY, out, sizeof(out));
+    }
+    uint64_t dc_ns = (test_now_ns() - start) / BENCH_ROUNDS;
+
+    start = test_now_ns();
+    for (uint32_t n = 0; n < BENCH_ROUNDS; n++) {
+        uint32_t width;
+        uint32_t height;
+        free(jpeg_util_decode_luma_1_8(jpeg, len, &width, &height));
+    }
+    uint64_t libjpeg_ns = (test_now_ns() - start) / BENCH_ROUNDS;
+
+    printf("VGA 4:2:2 质量 %d (%zu 字节) 亮度缩略图: jpeg_dc %.1f us, libjpeg 1/8 缩放 %.1f us\n", c.quality, len, dc_ns / 1000.0, libjpeg_ns / 1000.0);
+    free(jpeg);
+}
+
+int main(void)
+{
+    test_against_libjpeg();
+    test_rejected();
+    bench();
+    return TEST_RESULT();
+}
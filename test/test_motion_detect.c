@@ -0,0 +1,349 @@
+/*
+ * test_motion_detect.c
+ * 运动检测 (user-016) 的合成帧测试与 SAD 基准
+ *
+ * SWAR 版 motion_detect_block_sad 与逐像素参考实现逐块对照（含 0/255 极值与非对齐的行间距）；
+ * 再用合成的亮度平面驱动检测器：只有噪声、移动的方块、两个物体、全局亮度变化、
+ * 停留的物体并入背景、小于 min_region_blocks 的物体。配置与 motion_stage.c 相同。
+ * 以 MOTION_DETECT_SCALAR 编译的 test_motion_detect_scalar 运行同样的测试，基准结果可直接对比。
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "motion_detect.h"
+#include "test_util.h"
+
+#define WIDTH 160
+#define HEIGHT 120
+#define BLOCK 8
+#define BENCH_FRAMES 2000
+
+#ifdef MOTION_DETECT_SCALAR
+#define SAD_IMPL "标量"
+#else
+#define SAD_IMPL "SWAR"
+#endif
+
+static uint8_t s_background[WIDTH * HEIGHT];
+static uint8_t s_frame[WIDTH * HEIGHT];
+static motion_detect_t s_md;
+
+typedef struct
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t size;
+    uint8_t value;
+} square_t;
+
+static uint32_t reference_sad(const uint8_t* a, const uint8_t* b, uint32_t stride, uint32_t block)
+{
+    uint32_t sad = 0;
+    for (uint32_t y = 0; y < block; y++) {
+        for (uint32_t x = 0; x < block; x++) {
+            sad += (uint32_t)abs((int)a[y * stride + x] - (int)b[y * stride + x]);
+        }
+    }
+    return sad;
+}
+
+static void test_sad(void)
+{
+    static uint8_t a[32 * 20 + 4];
+    static uint8_t b[32 * 20 + 4];
+    uint32_t seed = 16;
+
+    // 随机数据：所有块边长、非 4 倍数的行间距与非对齐的起始地址
+    for (uint32_t round = 0; round < 2000; round++) {
+        test_fill(a, sizeof(a), test_rand(&seed));
+        test_fill(b, sizeof(b), test_rand(&seed));
+        uint32_t block = 4 * (1 + round % 4);
+        uint32_t stride = block + round % 7;
+        uint32_t shift = round % 4;
+        CHECK_EQ(motion_detect_block_sad(a + shift, b + (3 - shift), stride, block), reference_sad(a + shift, b + (3 - shift), stride, block));
+    }
+
+    // 极值：每字节差 255 时各累加通道最满；逐字节交替的正负差检验借位不跨字节
+    uint32_t strides[] = {16, 17, 19, 32};
+    for (uint32_t s = 0; s < sizeof(strides) / sizeof(strides[0]); s++) {
+        for (uint32_t block = 4; block <= 16; block += 4) {
+            memset(a, 0, sizeof(a));
+            memset(b, 255, sizeof(b));
+            CHECK_EQ(motion_detect_block_sad(a + 1, b, strides[s], block), 255 * block * block);
+            CHECK_EQ(motion_detect_block_sad(b, a + 3, strides[s], block), 255 * block * block);
+            for (size_t i = 0; i < sizeof(a); i++) {
+                a[i] = (i & 1) ? 0 : 255;
+                b[i] = (i & 1) ? 255 : (uint8_t)(i % 3);
+            }
+            CHECK_EQ(motion_detect_block_sad(a + 2, b + 1, strides[s], block), reference_sad(a + 2, b + 1, strides[s], block));
+            CHECK_EQ(motion_detect_block_sad(a, a, strides[s], block), 0);
+        }
+    }
+}
+
+/**
+ * @brief 生成一帧：横向渐变背景、±noise 的噪声、加上亮度偏移 bias 后画出各方块
+ */
+static void render(uint32_t* seed, uint8_t noise, int bias, const square_t* squares, uint32_t count)
+{
+    for (uint32_t y = 0; y < HEIGHT; y++) {
+        for (uint32_t x = 0; x < WIDTH; x++) {
+            int v = 60 + (int)(x * 80 / WIDTH) + (int)(y * 20 / HEIGHT) + bias;
+            if (noise > 0) {
+                v += (int)(test_rand(seed) % (2u * noise + 1)) - noise;
+            }
+            s_frame[y * WIDTH + x] = (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        for (uint32_t y = squares[i].y; y < (uint32_t)squares[i].y + squares[i].size && y < HEIGHT; y++) {
+            memset(s_frame + y * WIDTH + squares[i].x, squares[i].value, squares[i].size);
+        }
+    }
+}
+
+static void detector_init(void)
+{
+    motion_detect_config_t config = {
+        .width = WIDTH,
+        .height = HEIGHT,
+        .block = BLOCK,
+        .pixel_threshold = 12,
+        .learn_shift = 3,
+        .motion_learn_shift = 6,
+        .global_permille = 600,
+        .min_region_blocks = 2,
+    };
+    CHECK_EQ(motion_detect_init(&s_md, &config, s_background), ESP_OK);
+}
+
+/**
+ * @brief 区域须覆盖方块，右、上、下三边超出不到一块，左边最多超出 trail 个像素
+ */
+static bool region_covers(const motion_region_t* region, const square_t* square, uint32_t trail)
+{
+    return region->x <= square->x && region->x + trail + BLOCK > square->x && region->y <= square->y && region->y + BLOCK > square->y &&
+           region->x + region->w >= square->x + square->size && region->x + region->w < square->x + square->size + BLOCK &&
+           region->y + region->h >= square->y + square->size && region->y + region->h < square->y + square->size + BLOCK;
+}
+
+static bool region_matches(const motion_region_t* region, const square_t* square)
+{
+    return region_covers(region, square, 0);
+}
+
+static void test_noise_only(void)
+{
+    detector_init();
+    uint32_t seed = 1;
+    motion_detect_result_t result;
+    uint32_t motion = 0;
+    for (uint32_t n = 0; n < 200; n++) {
+        render(&seed, 8, 0, NULL, 0);
+        motion_detect_process(&s_md, s_frame, &result);
+        motion += result.motion || result.global_change;
+    }
+    CHECK_EQ(motion, 0);
+    CHECK_EQ(s_md.stats.frames, 200);
+    CHECK_EQ(s_md.stats.motion_frames, 0);
+}
+
+static void test_moving_square(void)
+{
+    detector_init();
+    uint32_t seed = 2;
+    motion_detect_result_t result;
+    render(&seed, 4, 0, NULL, 0);
+    motion_detect_process(&s_md, s_frame, &result);
+    CHECK(!result.motion);
+
+    // 24x24 的亮方块每帧右移 3 像素，每帧都应检测到唯一一个覆盖它的区域。
+    // 运动块的背景更新慢，刚离开的位置背景已被拉向方块，左侧留下不超过 4 块的拖影
+    for (uint32_t n = 0; n < 40; n++) {
+        square_t square = {.x = (uint16_t)(5 + n * 3), .y = 45, .size = 24, .value = 230};
+        render(&seed, 4, 0, &square, 1);
+        motion_detect_process(&s_md, s_frame, &result);
+        CHECK(result.motion);
+        CHECK_EQ(result.region_count, 1);
+        CHECK(region_covers(&result.regions[0], &square, 4 * BLOCK));
+        CHECK(result.level > 12);
+    }
+    CHECK_EQ(s_md.stats.motion_frames, 40);
+
+    // 方块离开后拖影很快消失
+    uint32_t ghost_frames = 0;
+    for (uint32_t n = 0; n < 30; n++) {
+        render(&seed, 4, 0, NULL, 0);
+        motion_detect_process(&s_md, s_frame, &result);
+        ghost_frames += result.motion;
+    }
+    CHECK(ghost_frames < 10);
+    CHECK(!result.motion);
+    printf("方块离开后拖影持续 %u 帧\n", (unsigned)ghost_frames);
+}
+
+static void test_two_objects(void)
+{
+    detector_init();
+    uint32_t seed = 3;
+    motion_detect_result_t result;
+    render(&seed, 4, 0, NULL, 0);
+    motion_detect_process(&s_md, s_frame, &result);
+
+    square_t squares[2] = {
+        {.x = 10, .y = 10, .size = 32, .value = 240},
+        {.x = 100, .y = 70, .size = 20, .value = 10},
+    };
+    render(&seed, 4, 0, squares, 2);
+    motion_detect_process(&s_md, s_frame, &result);
+    CHECK(result.motion);
+    CHECK_EQ(result.region_count, 2);
+    // 不超过 MOTION_DETECT_MAX_REGIONS 时区域按扫描顺序输出
+    CHECK(region_matches(&result.regions[0], &squares[0]));
+    CHECK(region_matches(&result.regions[1], &squares[1]));
+    CHECK_EQ(result.motion_blocks, result.regions[0].blocks + result.regions[1].blocks);
+    CHECK_EQ(result.score, result.motion_blocks * 1000 / ((WIDTH / BLOCK) * (HEIGHT / BLOCK)));
+}
+
+static void test_global_change(void)
+{
+    detector_init();
+    uint32_t seed = 4;
+    motion_detect_result_t result;
+    render(&seed, 4, 0, NULL, 0);
+    motion_detect_process(&s_md, s_frame, &result);
+
+    // 开灯：整幅画面变亮，背景重建，不报告运动；下一帧也不应有运动
+    render(&seed, 4, 60, NULL, 0);
+    motion_detect_process(&s_md, s_frame, &result);
+    CHECK(result.global_change);
+    CHECK(!result.motion);
+    CHECK_EQ(s_md.stats.global_changes, 1);
+    render(&seed, 4, 60, NULL, 0);
+    motion_detect_process(&s_md, s_frame, &result);
+    CHECK(!result.global_change);
+    CHECK(!result.motion);
+
+    // 缓慢变暗：每帧 1 级，由静止块的背景更新跟上
+    for (int bias = 60; bias >= 0; bias--) {
+        render(&seed, 4, bias, NULL, 0);
+        motion_detect_process(&s_md, s_frame, &result);
+        CHECK(!result.motion && !result.global_change);
+    }
+}
+
+static void test_stationary_absorbed(void)
+{
+    detector_init();
+    uint32_t seed = 5;
+    motion_detect_result_t result;
+    render(&seed, 4, 0, NULL, 0);
+    motion_detect_process(&s_md, s_frame, &result);
+
+    // 放下的物体起初报告运动，按 motion_learn_shift 约 80 帧后并入背景
+    square_t square = {.x = 60, .y = 40, .size = 24, .value = 220};
+    uint32_t first_quiet = 0;
+    for (uint32_t n = 1; n <= 300; n++) {
+        render(&seed, 4, 0, &square, 1);
+        motion_detect_process(&s_md, s_frame, &result);
+        if (n <= 30) {
+            CHECK(result.motion);
+        }
+        if (!result.motion && first_quiet == 0) {
+            first_quiet = n;
+        }
+    }
+    CHECK(first_quiet > 30);
+    CHECK(!result.motion);
+    printf("停留的物体 %u 帧后并入背景\n", (unsigned)first_quiet);
+
+    // 物体移走后露出的原背景又会被报告，随后同样恢复
+    render(&seed, 4, 0, NULL, 0);
+    motion_detect_process(&s_md, s_frame, &result);
+    CHECK(result.motion);
+}
+
+static void test_small_object(void)
+{
+    detector_init();
+    uint32_t seed = 6;
+    motion_detect_result_t result;
+    render(&seed, 4, 0, NULL, 0);
+    motion_detect_process(&s_md, s_frame, &result);
+
+    // 恰好一块的物体少于 min_region_blocks，视为噪声；两块则报告
+    square_t square = {.x = 8 * BLOCK, .y = 5 * BLOCK, .size = BLOCK, .value = 250};
+    render(&seed, 4, 0, &square, 1);
+    motion_detect_process(&s_md, s_frame, &result);
+    CHECK(!result.motion);
+    CHECK_EQ(result.region_count, 0);
+
+    square_t pair[2] = {square, {.x = 9 * BLOCK, .y = 5 * BLOCK, .size = BLOCK, .value = 250}};
+    render(&seed, 4, 0, pair, 2);
+    motion_detect_process(&s_md, s_frame, &result);
+    CHECK(result.motion);
+    CHECK_EQ(result.region_count, 1);
+    CHECK_EQ(result.regions[0].blocks, 2);
+    CHECK_EQ(result.regions[0].w, 2 * BLOCK);
+}
+
+static void test_invalid_config(void)
+{
+    motion_detect_t md;
+    motion_detect_config_t config = {.width = WIDTH, .height = HEIGHT, .block = 6};
+    CHECK_EQ(motion_detect_init(&md, &config, s_background), ESP_ERR_INVALID_ARG);
+    config.block = 20;
+    CHECK_EQ(motion_detect_init(&md, &config, s_background), ESP_ERR_INVALID_ARG);
+    config.block = 4;  // 40 * 30 = 1200 块，恰好不超限
+    CHECK_EQ(motion_detect_init(&md, &config, s_background), ESP_OK);
+    config.height = HEIGHT + 4;
+    CHECK_EQ(motion_detect_init(&md, &config, s_background), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(motion_detect_init(&md, &config, NULL), ESP_ERR_INVALID_ARG);
+}
+
+static void bench(void)
+{
+    static uint8_t other[WIDTH * HEIGHT];
+    test_fill(s_frame, sizeof(s_frame), 7);
+    test_fill(other, sizeof(other), 8);
+
+    for (uint32_t block = 4; block <= 16; block *= 2) {
+        volatile uint32_t sink = 0;
+        uint64_t start = test_now_ns();
+        for (uint32_t n = 0; n < BENCH_FRAMES; n++) {
+            for (uint32_t y = 0; y + block <= HEIGHT; y += block) {
+                for (uint32_t x = 0; x + block <= WIDTH; x += block) {
+                    sink += motion_detect_block_sad(s_frame + y * WIDTH + x, other + y * WIDTH + x, WIDTH, block);
+                }
+            }
+        }
+        uint64_t elapsed = test_now_ns() - start;
+        (void)sink;
+        printf(SAD_IMPL " SAD %ux%u 块, %ux%u 整帧: %.1f us/帧\n", (unsigned)block, (unsigned)block, WIDTH, HEIGHT, elapsed / 1000.0 / BENCH_FRAMES);
+    }
+
+    detector_init();
+    motion_detect_result_t result;
+    uint32_t seed = 9;
+    render(&seed, 4, 0, NULL, 0);
+    uint64_t start = test_now_ns();
+    for (uint32_t n = 0; n < BENCH_FRAMES; n++) {
+        motion_detect_process(&s_md, s_frame, &result);
+    }
+    printf(SAD_IMPL " motion_detect_process %ux%u 块 %u: %.1f us/帧\n", WIDTH, HEIGHT, BLOCK, (test_now_ns() - start) / 1000.0 / BENCH_FRAMES);
+}
+
+int main(void)
+{
+    test_sad();
+    test_noise_only();
+    test_moving_square();
+    test_two_objects();
+    test_global_change();
+    test_stationary_absorbed();
+    test_small_object();
+    test_invalid_config();
+    bench();
+    return TEST_RESULT();
+}
@@ -0,0 +1,252 @@
+/*
+ * test_motion_gate.c
+ * 运动门控发送 (user-017) 的回放测试
+ *
+ * 用一段 10 分钟的场景记录（运动事件的起止时间）回放：检测结果比帧晚一帧产生，运动时评分 40，
+ * 静止时评分在门限以下抖动；采集帧率与 motion_gate_admit() 相同，静止且不在保持期时降到空闲帧率。
+ * 配置取 Kconfig 默认值。检查运动开始后很快恢复发送、运动期间与保持期内不丢帧、
+ * 静止时只按保活间隔发送并统计带宽节省；检测停止后结果过期时不再门控。
+ */
+
+#include <string.h>
+
+#include "motion_gate.h"
+#include "test_util.h"
+
+#define FPS 15
+#define IDLE_FPS 2
+#define SCORE_THRESHOLD 5
+#define KEEPALIVE_MS 10000
+#define HOLDOFF_MS 3000
+#define STALE_MS 2000
+#define DURATION_S 600
+#define MOTION_BYTES 30000
+#define STATIC_BYTES 25000
+
+typedef struct
+{
+    uint32_t start_ms;
+    uint32_t end_ms;
+} event_t;
+
+// 短暂经过、持续活动、间隔很近的两次运动
+static const event_t s_events[] = {
+    {30000, 31000},
+    {120000, 180000},
+    {300000, 304000},
+    {305500, 309000},
+    {450000, 450400},
+};
+
+#define EVENT_COUNT (sizeof(s_events) / sizeof(s_events[0]))
+
+typedef struct
+{
+    motion_gate_t gate;
+    uint32_t seed;
+    int64_t now_us;
+    int64_t detector_stop_us;  // 检测停止的时间，之后结果不再更新
+    motion_gate_sample_t sample;
+    bool idle;                 // 采集是否处于空闲帧率
+    int64_t last_sent_us;
+    int64_t max_static_gap_us;  // 静止时相邻两次发送的最大间隔
+    int64_t max_onset_us;       // 运动开始到第一次发送的最大延迟
+    uint32_t missed;            // 运动期间或保持期内未发送的帧
+    uint32_t frames;
+    uint64_t ungated_bytes;     // 不门控时全速发送的字节数
+} sim_t;
+
+static const event_t* event_at(int64_t t_us)
+{
+    for (uint32_t i = 0; i < EVENT_COUNT; i++) {
+        if (t_us >= (int64_t)s_events[i].start_ms * 1000 && t_us < (int64_t)s_events[i].end_ms * 1000) {
+            return &s_events[i];
+        }
+    }
+    return NULL;
+}
+
+static void sim_init(sim_t* sim, bool enabled)
+{
+    memset(sim, 0, sizeof(*sim));
+    motion_gate_config_t config = {
+        .enabled = enabled,
+        .score_threshold = SCORE_THRESHOLD,
+        .keepalive_ms = KEEPALIVE_MS,
+        .holdoff_ms = HOLDOFF_MS,
+        .stale_ms = STALE_MS,
+    };
+    CHECK_EQ(motion_gate_init(&sim->gate, &config), ESP_OK);
+    sim->seed = 17;
+    sim->detector_stop_us = INT64_MAX;
+}
+
+/**
+ * @brief 运行到 end_us，每帧先判定再用本帧的检测结果更新 sample（结果晚一帧）
+ */
+static void sim_run(sim_t* sim, int64_t end_us)
+{
+    const event_t* last_event = NULL;
+    int64_t onset_us = -1;
+    while (sim->now_us < end_us) {
+        const event_t* event = event_at(sim->now_us);
+        uint32_t bytes = event != NULL ? MOTION_BYTES : STATIC_BYTES;
+        sim->frames++;
+
+        motion_gate_decision_t decision = motion_gate_decide(&sim->gate, sim->now_us, &sim->sample, bytes);
+        bool sent = decision != MOTION_GATE_SUPPRESS;
+        bool active = sim->now_us < sim->gate.holdoff_until_us;
+
+        if (event != NULL && event != last_event) {
+            onset_us = (int64_t)event->start_ms * 1000;
+        }
+        last_event = event != NULL ? event : last_event;
+        if (sent && onset_us >= 0) {
+            int64_t delay = sim->now_us - onset_us;
+            sim->max_onset_us = delay > sim->max_onset_us ? delay : sim->max_onset_us;
+            onset_us = -1;
+        }
+        if (!sent && (active || (event != NULL && sim->now_us - (int64_t)event->start_ms * 1000 >= 1000000 / IDLE_FPS + 1000000 / FPS))) {
+            sim->missed++;
+        }
+        if (sent) {
+            if (event == NULL && !active && sim->last_sent_us > 0) {
+                int64_t gap = sim->now_us - sim->last_sent_us;
+                sim->max_static_gap_us = gap > sim->max_static_gap_us ? gap : sim->max_static_gap_us;
+            }
+            sim->last_sent_us = sim->now_us;
+        }
+
+        // 与 motion_gate_admit() 相同：静止且只发保活帧时降低采集帧率
+        sim->idle = sim->gate.config.enabled && !active && (decision == MOTION_GATE_SUPPRESS || decision == MOTION_GATE_SEND_KEEPALIVE);
+        int64_t step_us = 1000000 / (sim->idle ? IDLE_FPS : FPS);
+        sim->ungated_bytes += ((uint64_t)bytes * step_us * FPS + 500000) / 1000000;  // 同一时段全速发送的字节数
+
+        if (sim->now_us < sim->detector_stop_us) {
+            sim->sample.valid = true;
+            sim->sample.motion = event != NULL || test_rand(&sim->seed) % 4 == 0;
+            sim->sample.score = event != NULL ? 40 : (uint16_t)(test_rand(&sim->seed) % SCORE_THRESHOLD);
+            sim->sample.result_us = sim->now_us;
+        }
+        sim->now_us += step_us;
+    }
+}
+
+static void test_replay(void)
+{
+    sim_t sim;
+    sim_init(&sim, true);
+    sim_run(&sim, (int64_t)DURATION_S * 1000000);
+
+    motion_gate_stats_t stats;
+    motion_gate_get_stats(&sim.gate, sim.now_us, &stats);
+    printf("%u 帧: 运动 %lu, 保持 %lu, 保活 %lu, 未门控 %lu, 抑制 %lu\n", (unsigned)sim.frames, (unsigned long)stats.sent_motion,
+           (unsigned long)stats.sent_holdoff, (unsigned long)stats.sent_keepalive, (unsigned long)stats.sent_ungated, (unsigned long)stats.suppressed);
+    printf("发送 %.1f MB，相对全速发送 %.1f MB 节省 %.1f%%；运动开始后最长 %lld ms 发出第一帧，静止时最大发送间隔 %lld ms\n",
+           stats.bytes_sent / 1e6, sim.ungated_bytes / 1e6, 100.0 - 100.0 * stats.bytes_sent / sim.ungated_bytes, (long long)(sim.max_onset_us / 1000),
+           (long long)(sim.max_static_gap_us / 1000));
+
+    CHECK_EQ(stats.sent_motion + stats.sent_holdoff + stats.sent_keepalive + stats.sent_ungated + stats.suppressed, sim.frames);
+    CHECK_EQ(stats.sent_ungated, 1);  // 只有第一帧还没有检测结果
+    CHECK(stats.sent_keepalive > 0);
+    CHECK_EQ(sim.missed, 0);
+    // 空闲帧率下的下一帧即可看到运动，再晚一帧得到检测结果
+    CHECK(sim.max_onset_us <= 1000000 / IDLE_FPS + 1000000 / FPS);
+    CHECK(sim.max_static_gap_us <= (int64_t)KEEPALIVE_MS * 1000 + 1000000 / IDLE_FPS);
+    CHECK(stats.bytes_sent * 100 < sim.ungated_bytes * 20);
+    CHECK(!stats.active);
+}
+
+static void test_disabled(void)
+{
+    // 关闭门控时每帧都以未门控发送，全速采集
+    sim_t sim;
+    sim_init(&sim, false);
+    sim_run(&sim, 60 * 1000000LL);
+    motion_gate_stats_t stats;
+    motion_gate_get_stats(&sim.gate, sim.now_us, &stats);
+    CHECK_EQ(stats.sent_ungated, sim.frames);
+    CHECK(sim.frames >= 60 * FPS);
+    CHECK_EQ(stats.suppressed, 0);
+
+    // 运行时打开：保持期与保活计时从此刻开始生效
+    motion_gate_config_t config = sim.gate.config;
+    config.enabled = true;
+    motion_gate_configure(&sim.gate, &config);
+    sim_run(&sim, 130 * 1000000LL);
+    motion_gate_get_stats(&sim.gate, sim.now_us, &stats);
+    CHECK(stats.suppressed > 0);
+    CHECK(stats.sent_motion > 0);  // 120 s 开始的运动事件
+}
+
+static void test_stale(void)
+{
+    // 检测在静止期间停止：结果过期前继续门控，之后不再门控并恢复全速采集
+    sim_t sim;
+    sim_init(&sim, true);
+    sim.detector_stop_us = 60 * 1000000LL;
+    sim_run(&sim, 60 * 1000000LL);
+    motion_gate_stats_t before;
+    motion_gate_get_stats(&sim.gate, sim.now_us, &before);
+    CHECK(before.suppressed > 0);
+    CHECK_EQ(before.sent_ungated, 1);
+
+    sim_run(&sim, 70 * 1000000LL);
+    motion_gate_stats_t after;
+    motion_gate_get_stats(&sim.gate, sim.now_us, &after);
+    CHECK(after.suppressed - before.suppressed <= STALE_MS * IDLE_FPS / 1000 + 1);
+    CHECK(after.sent_ungated > 1);
+    CHECK(!sim.idle);
+
+    // 没有检测结果
+    CHECK_EQ(motion_gate_decide(&sim.gate, sim.now_us, NULL, 100), MOTION_GATE_SEND_UNGATED);
+    motion_gate_sample_t invalid = {.valid = false, .motion = true, .score = 100, .result_us = sim.now_us};
+    CHECK_EQ(motion_gate_decide(&sim.gate, sim.now_us, &invalid, 100), MOTION_GATE_SEND_UNGATED);
+}
+
+static void test_holdoff(void)
+{
+    motion_gate_t gate;
+    motion_gate_config_t config = {.enabled = true, .score_threshold = SCORE_THRESHOLD, .keepalive_ms = KEEPALIVE_MS, .holdoff_ms = HOLDOFF_MS, .stale_ms = 60000};
+    CHECK_EQ(motion_gate_init(&gate, &config), ESP_OK);
+
+    // 第一帧总是发送；低于门限的运动不触发
+    motion_gate_sample_t sample = {.valid = true, .motion = true, .score = SCORE_THRESHOLD - 1, .result_us = 0};
+    CHECK_EQ(motion_gate_decide(&gate, 0, &sample, 1), MOTION_GATE_SEND_KEEPALIVE);
+    CHECK_EQ(motion_gate_decide(&gate, 100000, &sample, 1), MOTION_GATE_SUPPRESS);
+
+    // 保持期从结果产生的时间算起，同一个旧结果不会延长保持期
+    sample.score = SCORE_THRESHOLD;
+    sample.result_us = 1000000;
+    CHECK_EQ(motion_gate_decide(&gate, 1000000, &sample, 1), MOTION_GATE_SEND_MOTION);
+    sample.motion = false;
+    CHECK_EQ(motion_gate_decide(&gate, 1000000 + HOLDOFF_MS * 1000LL - 1, &sample, 1), MOTION_GATE_SEND_HOLDOFF);
+    CHECK_EQ(motion_gate_decide(&gate, 1000000 + HOLDOFF_MS * 1000LL, &sample, 1), MOTION_GATE_SUPPRESS);
+    sample.motion = true;
+    sample.result_us = 1000000;
+    CHECK_EQ(motion_gate_decide(&gate, 5000000, &sample, 1), MOTION_GATE_SEND_MOTION);
+    CHECK(gate.holdoff_until_us == 1000000 + HOLDOFF_MS * 1000LL);
+
+    // 静止时距上次发送满保活间隔才再发送
+    sample = (motion_gate_sample_t){.valid = true, .result_us = 5000000};
+    CHECK_EQ(motion_gate_decide(&gate, 5000000 + (int64_t)KEEPALIVE_MS * 1000 - 1, &sample, 1), MOTION_GATE_SUPPRESS);
+    CHECK_EQ(motion_gate_decide(&gate, 5000000 + (int64_t)KEEPALIVE_MS * 1000, &sample, 1), MOTION_GATE_SEND_KEEPALIVE);
+
+    config.keepalive_ms = 0;
+    CHECK_EQ(motion_gate_init(&gate, &config), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(motion_gate_init(NULL, &config), ESP_ERR_INVALID_ARG);
+    config.keepalive_ms = KEEPALIVE_MS;
+    CHECK_EQ(motion_gate_init(&gate, &config), ESP_OK);
+    config.keepalive_ms = 0;
+    motion_gate_configure(&gate, &config);
+    CHECK_EQ(gate.config.keepalive_ms, 1);
+}
+
+int main(void)
+{
+    test_replay();
+    test_disabled();
+    test_stale();
+    test_holdoff();
+    return TEST_RESULT();
+}
@@ -0,0 +1,250 @@
+/*
+ * test_nack_loopback.c
+ * NACK 选择性重传 (user-005) 的回环测试
+ *
+ * 设备端与接收端是 127.0.0.1 上的两个UDP socket。设备端发送一帧时按固定模式丢包，
+ * 接收端按 udp_image_receiver.py 的方式生成NACK位图（每个NACK最多覆盖 256 个包，最多请求 3 次），
+ * 设备端按 handle_nack() 的方式逐位重传，接收端必须重组出完整的帧。
+ * 另外检查畸形NACK被拒绝、不在重传环中的帧计为未命中。
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "image_proto.h"
+#include "test_util.h"
+
+#define IMAGE_SIZE 400000  // 超过 256 个包，需要多轮NACK
+#define MAX_PAYLOAD IMAGE_PROTO_V2_PAYLOAD_SIZE
+#define TOTAL_CHUNKS ((IMAGE_SIZE + MAX_PAYLOAD - 1) / MAX_PAYLOAD)
+#define NACK_MAX_TRIES 3
+#define FRAME_SEQ 1000
+
+static int s_device = -1;
+static int s_receiver = -1;
+static struct sockaddr_in s_device_addr;
+static struct sockaddr_in s_receiver_addr;
+
+static uint8_t s_image[IMAGE_SIZE];
+static uint8_t s_rebuilt[IMAGE_SIZE];
+static bool s_have[TOTAL_CHUNKS];
+static uint32_t s_hits;
+static uint32_t s_misses;
+
+static int open_socket(struct sockaddr_in* addr)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(*addr);
+    int rcvbuf = 4 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    struct timeval timeout = {.tv_sec = 1};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    CHECK(bind(sock, (struct sockaddr*)addr, sizeof(*addr)) == 0);
+    CHECK(getsockname(sock, (struct sockaddr*)addr, &len) == 0);
+    return sock;
+}
+
+static void device_send_chunk(uint32_t chunk_id, uint8_t extra_flags)
+{
+    size_t offset = (size_t)chunk_id * MAX_PAYLOAD;
+    size_t payload_size = IMAGE_SIZE - offset > MAX_PAYLOAD ? MAX_PAYLOAD : IMAGE_SIZE - offset;
+    image_proto_chunk_t chunk = {
+        .version = IMAGE_PROTO_VERSION,
+        .flags = IMAGE_PROTO_FLAG_KEYFRAME | extra_flags | (chunk_id == 0 ? IMAGE_PROTO_FLAG_FIRST : 0) | (chunk_id == TOTAL_CHUNKS - 1 ? IMAGE_PROTO_FLAG_LAST : 0),
+        .frame_seq = FRAME_SEQ,
+        .image_size = IMAGE_SIZE,
+        .chunk_id = chunk_id,
+        .total_chunks = TOTAL_CHUNKS,
+        .offset = offset,
+    };
+    uint8_t packet[IMAGE_PROTO_MAX_PACKET_SIZE];
+    CHECK_EQ(image_proto_encode_header(&chunk, s_image + offset, payload_size, packet), ESP_OK);
+    memcpy(packet + IMAGE_PROTO_V2_HEADER_SIZE, s_image + offset, payload_size);
+    sendto(s_device, packet, IMAGE_PROTO_V2_HEADER_SIZE + payload_size, 0, (struct sockaddr*)&s_receiver_addr, sizeof(s_receiver_addr));
+}
+
+/**
+ * @brief 与 handle_nack() 相同：重传环中只有 FRAME_SEQ 一帧，逐位重传，越界的包序号计为未命中
+ * @return 重传的包数，NACK 无效时返回 -1
+ */
+static int device_handle_ctrl(const uint8_t* packet, size_t len)
+{
+    uint8_t type;
+    image_proto_nack_t nack;
+    if (image_proto_decode_ctrl(packet, len, &type) != ESP_OK || type != IMAGE_PROTO_CTRL_NACK || image_proto_decode_nack(packet, len, &nack) != ESP_OK) {
+        return -1;
+    }
+
+    uint32_t requested = 0;
+    for (uint16_t w = 0; w < nack.words; w++) {
+        requested += __builtin_popcount(nack.bitmap[w]);
+    }
+    if (nack.frame_seq != FRAME_SEQ) {
+        s_misses += requested;
+        return 0;
+    }
+
+    int sent = 0;
+    for (uint32_t bit = 0; bit < (uint32_t)nack.words * 32; bit++) {
+        if ((nack.bitmap[bit / 32] & (1u << (bit % 32))) == 0) {
+            continue;
+        }
+        uint32_t chunk_id = nack.base_chunk + bit;
+        if (chunk_id >= TOTAL_CHUNKS) {
+            s_misses++;
+            continue;
+        }
+        device_send_chunk(chunk_id, IMAGE_PROTO_FLAG_RETRANSMIT);
+        s_hits++;
+        sent++;
+    }
+    return sent;
+}
+
+/**
+ * @brief 接收端收取 count 个图像包并放入重组缓冲区，返回其中的重传包个数
+ */
+static uint32_t receiver_collect(uint32_t count)
+{
+    uint32_t retransmitted = 0;
+    uint8_t packet[IMAGE_PROTO_MAX_PACKET_SIZE];
+    for (uint32_t i = 0; i < count; i++) {
+        ssize_t len = recv(s_receiver, packet, sizeof(packet), 0);
+        CHECK(len > 0);
+        if (len <= 0) {
+            break;
+        }
+        image_proto_chunk_t chunk;
+        const uint8_t* payload;
+        size_t payload_len;
+        CHECK_EQ(image_proto_decode(packet, (size_t)len, &chunk, &payload, &payload_len), ESP_OK);
+        CHECK_EQ(chunk.frame_seq, FRAME_SEQ);
+        if (chunk.chunk_id < TOTAL_CHUNKS && chunk.offset + payload_len <= IMAGE_SIZE) {
+            memcpy(s_rebuilt + chunk.offset, payload, payload_len);
+            s_have[chunk.chunk_id] = true;
+        }
+        retransmitted += (chunk.flags & IMAGE_PROTO_FLAG_RETRANSMIT) ? 1 : 0;
+    }
+    return retransmitted;
+}
+
+/**
+ * @brief 按 udp_image_receiver.py 的 send_nacks() 生成一个NACK，没有缺包时返回 false
+ */
+static bool receiver_build_nack(image_proto_nack_t* nack)
+{
+    memset(nack, 0, sizeof(*nack));
+    nack->frame_seq = FRAME_SEQ;
+    int32_t base = -1;
+    for (uint32_t i = 0; i < TOTAL_CHUNKS; i++) {
+        if (s_have[i]) {
+            continue;
+        }
+        if (base < 0) {
+            base = (int32_t)i;
+        }
+        uint32_t bit = i - (uint32_t)base;
+        if (bit >= IMAGE_PROTO_NACK_MAX_WORDS * 32) {
+            break;
+        }
+        nack->bitmap[bit / 32] |= 1u << (bit % 32);
+        nack->words = (uint16_t)(bit / 32 + 1);
+    }
+    nack->base_chunk = (uint16_t)base;
+    return base >= 0;
+}
+
+static void test_recovery(void)
+{
+    test_fill(s_image, IMAGE_SIZE, 5);
+    memset(s_have, 0, sizeof(s_have));
+
+    // 约 7% 的包丢失，包括首包、末包与跨越 256 包窗口的连续丢包
+    uint32_t sent = 0;
+    uint32_t seed = 77;
+    for (uint32_t i = 0; i < TOTAL_CHUNKS; i++) {
+        bool lost = i == 0 || i == TOTAL_CHUNKS - 1 || (i >= 250 && i < 262) || test_rand(&seed) % 100 < 5;
+        if (!lost) {
+            device_send_chunk(i, 0);
+            sent++;
+        }
+    }
+    CHECK_EQ(receiver_collect(sent), 0);
+
+    uint32_t rounds = 0;
+    image_proto_nack_t nack;
+    while (receiver_build_nack(&nack) && rounds < NACK_MAX_TRIES) {
+        uint8_t packet[64];
+        size_t len;
+        CHECK_EQ(image_proto_encode_nack(&nack, packet, sizeof(packet), &len), ESP_OK);
+        sendto(s_receiver, packet, len, 0, (struct sockaddr*)&s_device_addr, sizeof(s_device_addr));
+
+        uint8_t received[64];
+        ssize_t got = recv(s_device, received, sizeof(received), 0);
+        CHECK_EQ(got, (ssize_t)len);
+        int retransmitted = device_handle_ctrl(received, (size_t)got);
+        CHECK(retransmitted > 0);
+        CHECK_EQ(receiver_collect((uint32_t)retransmitted), (uint32_t)retransmitted);
+        rounds++;
+    }
+
+    CHECK(!receiver_build_nack(&nack));
+    CHECK(memcmp(s_rebuilt, s_image, IMAGE_SIZE) == 0);
+    CHECK_EQ(s_hits, TOTAL_CHUNKS - sent);
+    CHECK_EQ(s_misses, 0);
+    printf("%u 包中丢失 %u 包，%u 轮NACK后全部恢复\n", (unsigned)TOTAL_CHUNKS, (unsigned)(TOTAL_CHUNKS - sent), (unsigned)rounds);
+}
+
+static void test_rejected(void)
+{
+    uint8_t packet[64];
+    size_t len;
+    image_proto_nack_t nack = {.frame_seq = FRAME_SEQ, .base_chunk = 0, .words = 2, .bitmap = {1, 1}};
+    CHECK_EQ(image_proto_encode_nack(&nack, packet, sizeof(packet), &len), ESP_OK);
+
+    // 截断的位图、words 为 0 或超过上限、类型不对、魔数不对
+    CHECK_EQ(device_handle_ctrl(packet, len - 1), -1);
+    packet[11] = 0;
+    CHECK_EQ(device_handle_ctrl(packet, len), -1);
+    packet[11] = IMAGE_PROTO_NACK_MAX_WORDS + 1;
+    CHECK_EQ(device_handle_ctrl(packet, sizeof(packet)), -1);
+    packet[11] = 2;
+    packet[3] = IMAGE_PROTO_CTRL_REPORT;
+    CHECK_EQ(device_handle_ctrl(packet, len), -1);
+    packet[3] = IMAGE_PROTO_CTRL_NACK;
+    packet[0] = 0;
+    CHECK_EQ(device_handle_ctrl(packet, len), -1);
+
+    nack.words = 0;
+    CHECK_EQ(image_proto_encode_nack(&nack, packet, sizeof(packet), &len), ESP_ERR_INVALID_ARG);
+    nack.words = IMAGE_PROTO_NACK_MAX_WORDS;
+    CHECK_EQ(image_proto_encode_nack(&nack, packet, 12 + IMAGE_PROTO_NACK_MAX_WORDS * 4 - 1, &len), ESP_ERR_INVALID_SIZE);
+
+    // 已被淘汰的帧与越界的包序号计为未命中，不发送任何包
+    s_misses = 0;
+    nack = (image_proto_nack_t){.frame_seq = FRAME_SEQ - 1, .base_chunk = 0, .words = 1, .bitmap = {0x7}};
+    CHECK_EQ(image_proto_encode_nack(&nack, packet, sizeof(packet), &len), ESP_OK);
+    CHECK_EQ(device_handle_ctrl(packet, len), 0);
+    CHECK_EQ(s_misses, 3);
+    nack = (image_proto_nack_t){.frame_seq = FRAME_SEQ, .base_chunk = TOTAL_CHUNKS, .words = 1, .bitmap = {0x3}};
+    CHECK_EQ(image_proto_encode_nack(&nack, packet, sizeof(packet), &len), ESP_OK);
+    CHECK_EQ(device_handle_ctrl(packet, len), 0);
+    CHECK_EQ(s_misses, 5);
+}
+
+int main(void)
+{
+    s_device = open_socket(&s_device_addr);
+    s_receiver = open_socket(&s_receiver_addr);
+    test_recovery();
+    test_rejected();
+    close(s_device);
+    close(s_receiver);
+    return TEST_RESULT();
+}
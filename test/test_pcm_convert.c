@@ -0,0 +1,108 @@
+/*
+ * test_pcm_convert.c
+ * 8-bit 转 16-bit PCM (user-023) 的对照测试与基准
+ *
+ * 逐样本、查表与 32 位字实现对全部 256 个取值、各种输入/输出对齐与长度逐个对照 (x - 128) * 256，
+ * 并检查不写出范围。基准为 1388 样本的包与 64K 样本的大块；
+ * 主机上的数字只反映 x86 与编译器自动向量化的情况，Xtensa 上的相对快慢需在设备上测量。
+ */
+
+#include <string.h>
+
+#include "pcm_convert.h"
+#include "test_util.h"
+
+#define MAX_SAMPLES 4096
+#define GUARD 8
+#define BENCH_BYTES (64 * 1024 * 1024)
+
+typedef void (*convert_fn)(const uint8_t* in, int16_t* out, size_t count);
+
+typedef struct
+{
+    const char* name;
+    convert_fn fn;
+} impl_t;
+
+static const impl_t s_impls[] = {
+    {"逐样本", pcm_u8_to_s16_scalar},
+    {"查表", pcm_u8_to_s16_lut},
+    {"32 位字", pcm_u8_to_s16_word},
+    {"默认", pcm_u8_to_s16},
+};
+
+#define IMPL_COUNT (sizeof(s_impls) / sizeof(s_impls[0]))
+
+static uint8_t s_in[MAX_SAMPLES + 4];
+static int16_t s_out[MAX_SAMPLES + 2 + GUARD];
+
+static void test_all_values(void)
+{
+    for (int x = 0; x < 256; x++) {
+        s_in[x] = (uint8_t)x;
+    }
+    for (size_t k = 0; k < IMPL_COUNT; k++) {
+        s_impls[k].fn(s_in, s_out, 256);
+        for (int x = 0; x < 256; x++) {
+            CHECK_EQ(s_out[x], (x - 128) * 256);
+        }
+    }
+}
+
+static void test_alignment(void)
+{
+    static int16_t expected[MAX_SAMPLES];
+    test_fill(s_in, sizeof(s_in), 23);
+
+    // 输入偏移 0-3 字节，输出偏移 0 或 1 个样本（后者不是 4 字节对齐），长度覆盖各种余数
+    for (size_t k = 0; k < IMPL_COUNT; k++) {
+        for (size_t in_off = 0; in_off < 4; in_off++) {
+            for (size_t out_off = 0; out_off < 2; out_off++) {
+                for (size_t count = 0; count < 70; count++) {
+                    memset(s_out, 0x5A, sizeof(s_out));
+                    s_impls[k].fn(s_in + in_off, s_out + out_off, count);
+                    pcm_u8_to_s16_scalar(s_in + in_off, expected, count);
+                    CHECK(memcmp(s_out + out_off, expected, count * sizeof(int16_t)) == 0);
+                    // 前后的哨兵不被改写
+                    CHECK(out_off == 0 || s_out[0] == 0x5A5A);
+                    for (size_t g = 0; g < GUARD; g++) {
+                        CHECK_EQ(s_out[out_off + count + g], 0x5A5A);
+                    }
+                }
+            }
+        }
+        s_impls[k].fn(s_in + 1, s_out, MAX_SAMPLES);
+        pcm_u8_to_s16_scalar(s_in + 1, expected, MAX_SAMPLES);
+        CHECK(memcmp(s_out, expected, sizeof(expected)) == 0);
+    }
+}
+
+static void bench(void)
+{
+    static uint8_t in[64 * 1024];
+    static int16_t out[64 * 1024];
+    test_fill(in, sizeof(in), 5);
+
+    const size_t sizes[] = {1388, sizeof(in)};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t count = sizes[s];
+        size_t rounds = BENCH_BYTES / count;
+        for (size_t k = 0; k < IMPL_COUNT; k++) {
+            uint64_t start = test_now_ns();
+            for (size_t r = 0; r < rounds; r++) {
+                s_impls[k].fn(in, out, count);
+                __asm__ volatile("" : : "r"(out) : "memory");  // 防止编译器省略重复的转换
+            }
+            double ns = (double)(test_now_ns() - start) / ((double)rounds * count);
+            printf("%zu 样本 %s: %.3f ns/样本\n", count, s_impls[k].name, ns);
+        }
+    }
+}
+
+int main(void)
+{
+    test_all_values();
+    test_alignment();
+    bench();
+    return TEST_RESULT();
+}
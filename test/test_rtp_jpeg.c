@@ -0,0 +1,306 @@
+/*
+ * test_rtp_jpeg.c
+ * RTP/JPEG 分包 (user-011) 的分包与重组测试
+ *
+ * 用 libjpeg 生成 4:2:0 / 4:2:2、带与不带重启标记的 JPEG，按 send_rtp_frame() 的方式分包，
+ * 接收端按 RFC 2435 附录 B 用包头中的量化表与 Annex K 标准哈夫曼表重建 JPEG，
+ * 解码结果必须与直接解码原图逐像素一致。另外检查不支持的 JPEG 被 rtp_jpeg_parse() 拒绝。
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "rtp_jpeg.h"
+#include "jpeg_util.h"
+#include "test_util.h"
+
+#define MAX_PACKET 1400
+
+// RFC 2435 附录 A / JPEG Annex K 的标准哈夫曼表
+static const uint8_t s_lum_dc_bits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t s_chr_dc_bits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+static const uint8_t s_dc_vals[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+static const uint8_t s_lum_ac_bits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+static const uint8_t s_lum_ac_vals[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08,
+    0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0, 0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+    0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6,
+    0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa,
+};
+static const uint8_t s_chr_ac_bits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+static const uint8_t s_chr_ac_vals[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91,
+    0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0, 0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+    0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4,
+    0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa,
+};
+
+/**
+ * @brief 接收端的重组状态
+ */
+typedef struct
+{
+    uint8_t packets[512][MAX_PACKET];
+    size_t lens[512];
+    uint32_t count;
+} capture_t;
+
+static capture_t s_capture;
+
+static uint32_t get_u16(const uint8_t* p)
+{
+    return (uint32_t)(p[0] << 8 | p[1]);
+}
+
+static uint32_t get_u24(const uint8_t* p)
+{
+    return (uint32_t)(p[0] << 16 | p[1] << 8 | p[2]);
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static uint8_t* put_segment(uint8_t* p, uint8_t marker, const uint8_t* body, size_t len)
+{
+    *p++ = 0xFF;
+    *p++ = marker;
+    *p++ = (uint8_t)((len + 2) >> 8);
+    *p++ = (uint8_t)(len + 2);
+    memcpy(p, body, len);
+    return p + len;
+}
+
+static uint8_t* put_dht(uint8_t* p, uint8_t table_class, const uint8_t* bits, const uint8_t* vals, size_t nvals)
+{
+    uint8_t body[1 + 16 + 162];
+    body[0] = table_class;
+    memcpy(body + 1, bits, 16);
+    memcpy(body + 17, vals, nvals);
+    return put_segment(p, 0xC4, body, 17 + nvals);
+}
+
+/**
+ * @brief 按 send_rtp_frame() 的方式把一帧分包到 s_capture
+ */
+static void packetize(rtp_jpeg_session_t* session, const rtp_jpeg_frame_t* frame, uint32_t timestamp)
+{
+    s_capture.count = 0;
+    size_t offset = 0;
+    while (offset < frame->scan_len) {
+        size_t header_size = rtp_jpeg_header_size(frame, offset);
+        size_t max_payload = MAX_PACKET - header_size;
+        size_t payload = frame->scan_len - offset > max_payload ? max_payload : frame->scan_len - offset;
+        uint8_t* packet = s_capture.packets[s_capture.count];
+        CHECK_EQ(rtp_jpeg_encode_header(session, frame, timestamp, offset, payload, packet), header_size);
+        memcpy(packet + header_size, frame->scan + offset, payload);
+        s_capture.lens[s_capture.count++] = header_size + payload;
+        offset += payload;
+    }
+}
+
+/**
+ * @brief 按 RFC 2435 附录 B 重组 JPEG，同时检查各包头字段
+ * @return 重组出的 JPEG (malloc)，失败返回 NULL
+ */
+static uint8_t* depacketize(uint16_t first_seq, uint32_t timestamp, uint32_t ssrc, size_t* out_len)
+{
+    uint8_t* jpeg = malloc(1024 + s_capture.count * MAX_PACKET);
+    uint8_t* scan = malloc(s_capture.count * MAX_PACKET);
+    uint8_t qtables[128];
+    uint32_t type = 0, width = 0, height = 0, restart = 0;
+    size_t scan_len = 0;
+    bool have_qtables = false;
+
+    for (uint32_t i = 0; i < s_capture.count; i++) {
+        const uint8_t* p = s_capture.packets[i];
+        size_t len = s_capture.lens[i];
+        bool last = i == s_capture.count - 1;
+        CHECK_EQ(p[0], 0x80);
+        CHECK_EQ(p[1], (last ? 0x80 : 0) | RTP_JPEG_PAYLOAD_TYPE);
+        CHECK_EQ(get_u16(p + 2), (uint16_t)(first_seq + i));
+        CHECK_EQ(get_u32(p + 4), timestamp);
+        CHECK_EQ(get_u32(p + 8), ssrc);
+        p += RTP_JPEG_RTP_HEADER_SIZE;
+
+        uint32_t offset = get_u24(p + 1);
+        CHECK_EQ(offset, scan_len);
+        type = p[4];
+        CHECK_EQ(p[5], 255);
+        width = p[6] * 8u;
+        height = p[7] * 8u;
+        p += RTP_JPEG_MAIN_HEADER_SIZE;
+        if (type >= 64) {
+            restart = get_u16(p);
+            CHECK_EQ(get_u16(p + 2), 0xFFFF);
+            p += RTP_JPEG_RESTART_HEADER_SIZE;
+        }
+        if (offset == 0) {
+            CHECK_EQ(get_u16(p + 2), 128);
+            memcpy(qtables, p + 4, 128);
+            have_qtables = true;
+            p += RTP_JPEG_QTABLE_HEADER_SIZE + 128;
+        }
+        size_t payload = len - (size_t)(p - s_capture.packets[i]);
+        memcpy(scan + scan_len, p, payload);
+        scan_len += payload;
+    }
+    CHECK(have_qtables);
+
+    uint8_t* q = jpeg;
+    *q++ = 0xFF;
+    *q++ = 0xD8;
+    uint8_t dqt[130];
+    dqt[0] = 0;
+    memcpy(dqt + 1, qtables, 64);
+    dqt[65] = 1;
+    memcpy(dqt + 66, qtables + 64, 64);
+    q = put_segment(q, 0xDB, dqt, sizeof(dqt));
+    if (restart != 0) {
+        uint8_t dri[2] = {(uint8_t)(restart >> 8), (uint8_t)restart};
+        q = put_segment(q, 0xDD, dri, sizeof(dri));
+    }
+    uint8_t sof[15] = {8, (uint8_t)(height >> 8), (uint8_t)height, (uint8_t)(width >> 8), (uint8_t)width, 3,
+                       1, (type & 63) == 0 ? 0x21 : 0x22, 0, 2, 0x11, 1, 3, 0x11, 1};
+    q = put_segment(q, 0xC0, sof, sizeof(sof));
+    q = put_dht(q, 0x00, s_lum_dc_bits, s_dc_vals, sizeof(s_dc_vals));
+    q = put_dht(q, 0x10, s_lum_ac_bits, s_lum_ac_vals, sizeof(s_lum_ac_vals));
+    q = put_dht(q, 0x01, s_chr_dc_bits, s_dc_vals, sizeof(s_dc_vals));
+    q = put_dht(q, 0x11, s_chr_ac_bits, s_chr_ac_vals, sizeof(s_chr_ac_vals));
+    const uint8_t sos[10] = {3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0};
+    q = put_segment(q, 0xDA, sos, sizeof(sos));
+    memcpy(q, scan, scan_len);
+    q += scan_len;
+    *q++ = 0xFF;
+    *q++ = 0xD9;
+
+    free(scan);
+    *out_len = (size_t)(q - jpeg);
+    return jpeg;
+}
+
+static void test_roundtrip(uint32_t width, uint32_t height, uint8_t v_samp, uint16_t restart, int quality)
+{
+    jpeg_util_params_t params = {.width = width, .height = height, .quality = quality, .h_samp = 2, .v_samp = v_samp, .restart_interval = restart, .seed = width};
+    size_t len;
+    uint8_t* jpeg = jpeg_util_encode(&params, &len);
+    CHECK(jpeg != NULL);
+    if (jpeg == NULL) {
+        return;
+    }
+
+    // 相机帧缓冲末尾可能有对齐填充
+    uint8_t* padded = calloc(1, len + 37);
+    memcpy(padded, jpeg, len);
+
+    rtp_jpeg_frame_t frame;
+    CHECK_EQ(rtp_jpeg_parse(padded, len + 37, &frame), ESP_OK);
+    CHECK_EQ(frame.type, (v_samp == 2 ? 1 : 0) + (restart ? 64 : 0));
+    CHECK_EQ(frame.width * 8u, width);
+    CHECK_EQ(frame.height * 8u, height);
+    CHECK_EQ(frame.restart_interval, restart);
+    CHECK(frame.scan > padded && frame.scan + frame.scan_len + 2 == padded + len);
+
+    rtp_jpeg_session_t session;
+    rtp_jpeg_session_init(&session, 0x11223344u, 0xFFF0, 1000);
+    uint32_t timestamp = rtp_jpeg_timestamp(&session, 2000000);
+    CHECK_EQ(timestamp, 1000 + 2 * RTP_JPEG_CLOCK_RATE);
+    packetize(&session, &frame, timestamp);
+
+    size_t rebuilt_len;
+    uint8_t* rebuilt = depacketize(0xFFF0, timestamp, 0x11223344u, &rebuilt_len);
+
+    uint32_t w1, h1, w2, h2;
+    int c1, c2;
+    uint8_t* expected = jpeg_util_decode(jpeg, len, &w1, &h1, &c1);
+    uint8_t* actual = jpeg_util_decode(rebuilt, rebuilt_len, &w2, &h2, &c2);
+    CHECK(expected != NULL && actual != NULL);
+    if (expected != NULL && actual != NULL) {
+        CHECK_EQ(w1, w2);
+        CHECK_EQ(h1, h2);
+        CHECK(memcmp(expected, actual, (size_t)w1 * h1 * c1) == 0);
+    }
+    printf("%ux%u 4:2:%d 重启间隔 %u: %zu 字节扫描数据, %u 包\n", (unsigned)width, (unsigned)height, v_samp == 2 ? 0 : 2, (unsigned)restart, frame.scan_len,
+           (unsigned)s_capture.count);
+
+    free(expected);
+    free(actual);
+    free(rebuilt);
+    free(padded);
+    free(jpeg);
+}
+
+static void expect_unsupported(jpeg_util_params_t params, esp_err_t expected)
+{
+    size_t len;
+    uint8_t* jpeg = jpeg_util_encode(&params, &len);
+    CHECK(jpeg != NULL);
+    rtp_jpeg_frame_t frame;
+    CHECK_EQ(rtp_jpeg_parse(jpeg, len, &frame), expected);
+    free(jpeg);
+}
+
+static void test_rejected(void)
+{
+    jpeg_util_params_t base = {.width = 64, .height = 48, .quality = 80, .h_samp = 2, .v_samp = 1};
+
+    jpeg_util_params_t params = base;
+    params.width = 100;  // 不是 8 的倍数
+    expect_unsupported(params, ESP_ERR_NOT_SUPPORTED);
+    params = base;
+    params.height = 60;
+    expect_unsupported(params, ESP_ERR_NOT_SUPPORTED);
+    params = base;
+    params.width = 2048;  // 超过 255 * 8
+    expect_unsupported(params, ESP_ERR_NOT_SUPPORTED);
+    params = base;
+    params.progressive = true;
+    expect_unsupported(params, ESP_ERR_NOT_SUPPORTED);
+    params = base;
+    params.h_samp = 1;  // 4:4:4
+    expect_unsupported(params, ESP_ERR_NOT_SUPPORTED);
+    params = base;
+    params.grayscale = true;
+    expect_unsupported(params, ESP_ERR_NOT_SUPPORTED);
+
+    // 截断与非 JPEG 数据
+    size_t len;
+    uint8_t* jpeg = jpeg_util_encode(&base, &len);
+    rtp_jpeg_frame_t frame;
+    CHECK_EQ(rtp_jpeg_parse(jpeg, len - 2, &frame), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(rtp_jpeg_parse(jpeg, 200, &frame), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(rtp_jpeg_parse(jpeg + 2, len - 2, &frame), ESP_ERR_INVALID_ARG);
+    free(jpeg);
+}
+
+static void test_sdp(void)
+{
+    char sdp[256];
+    size_t n = rtp_jpeg_build_sdp(sdp, sizeof(sdp), "239.255.0.1", 5004, 4, 42);
+    CHECK(n > 0 && n == strlen(sdp));
+    CHECK(strstr(sdp, "c=IN IP4 239.255.0.1/4\r\n") != NULL);
+    CHECK(strstr(sdp, "m=video 5004 RTP/AVP 26\r\n") != NULL);
+    CHECK(strstr(sdp, "a=rtpmap:26 JPEG/90000\r\n") != NULL);
+    n = rtp_jpeg_build_sdp(sdp, sizeof(sdp), "192.168.1.10", 5004, 0, 42);
+    CHECK(strstr(sdp, "c=IN IP4 192.168.1.10\r\n") != NULL);
+    CHECK_EQ(rtp_jpeg_build_sdp(sdp, 32, "192.168.1.10", 5004, 0, 42), 0);
+}
+
+int main(void)
+{
+    test_roundtrip(320, 240, 1, 0, 80);   // QVGA 4:2:2，esp32-camera 的默认输出
+    test_roundtrip(640, 480, 2, 0, 90);   // VGA 4:2:0
+    test_roundtrip(800, 600, 1, 4, 60);   // SVGA 带重启标记
+    test_roundtrip(1600, 1200, 2, 10, 50);
+    test_roundtrip(240, 176, 1, 0, 95);   // HQVGA，宽高不是 16 的倍数
+    test_rejected();
+    test_sdp();
+    return TEST_RESULT();
+}
@@ -0,0 +1,87 @@
+/*
+ * test_util.h
+ * 主机端测试的断言与辅助函数
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+
+static int s_test_failures = 0;
+
+// 断言失败时打印位置并继续，main 结尾用 TEST_RESULT() 返回
+#define CHECK(cond)                                                           \
+    do {                                                                      \
+        if (!(cond)) {                                                        \
+            fprintf(stderr, "%s:%d: CHECK(%s) 失败\n", __FILE__, __LINE__, #cond); \
+            s_test_failures++;                                                \
+        }                                                                     \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                                              \
+    do {                                                                                                            \
+        long long _a = (long long)(a);                                                                              \
+        long long _b = (long long)(b);                                                                              \
+        if (_a != _b) {                                                                                             \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) 失败: %lld != %lld\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+            s_test_failures++;                                                                                      \
+        }                                                                                                           \
+    } while (0)
+
+#define TEST_RESULT()                                                  \
+    (s_test_failures == 0 ? (printf("通过\n"), 0)                      \
+                          : (fprintf(stderr, "%d 项失败\n", s_test_failures), 1))
+
+/**
+ * @brief 可复现的伪随机数 (xorshift32)
+ */
+static inline uint32_t test_rand(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static inline void test_fill(uint8_t* buf, size_t len, uint32_t seed)
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)test_rand(&seed);
+    }
+}
+
+/**
+ * @brief 单调时钟 (纳秒)，用于基准测试
+ */
+static inline uint64_t test_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// 进程占用的 CPU 时间（含系统调用在内核中的时间）
+static inline uint64_t test_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// 时间戳计数器的周期数，不支持的架构返回 0
+static inline uint64_t test_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+#endif /* TEST_UTIL_H */
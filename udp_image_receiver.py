@@ -9,6 +9,9 @@ import socket
 import struct
 import time
 import os
+import argparse
+import zlib
+from collections import deque
 from datetime import datetime
 
 # UDP配置
@@ -24,9 +27,46 @@ BUFFER_SIZE = 65535  # 最大缓冲区大小
 
 CHUNK_HEADER_SIZE = 12  # 3个uint32_t = 12字节
 
+# v2 包头 (与 main/image_proto.h 一致，网络字节序，共32字节)
+# uint16 magic "EC", uint8 version, uint8 flags, uint32 frame_seq,
+# uint64 timestamp_us, uint32 offset, uint32 image_size,
+# uint16 chunk_id, uint16 total_chunks, uint32 crc32
+V2_MAGIC = b'EC'
+V2_HEADER = struct.Struct('!2sBBIQIIHHI')
+V2_FLAG_FIRST = 0x01
+V2_FLAG_LAST = 0x02
+V2_FLAG_KEYFRAME = 0x04
+V2_FLAG_PARITY = 0x08      # FEC校验包: chunk_id 为组号, offset 为分组大小
+V2_FLAG_RETRANSMIT = 0x10  # 应答NACK的重传包
+V2_CHUNK_PAYLOAD = 1400 - V2_HEADER.size  # 每个数据包的最大负载
+V2_MAX_PENDING_FRAMES = 8  # 同时重组的最大帧数，超出时丢弃最旧的帧
+
+# NACK 控制报文 (与 main/image_proto.h 一致)，发回设备的控制端口（即图像包的源端口）
+# uint16 magic "EK", uint8 version, uint8 type, uint32 frame_seq,
+# uint16 base_chunk, uint16 words, uint32 bitmap[words]
+CTRL_MAGIC = b'EK'
+CTRL_NACK = 0x01
+NACK_MAX_WORDS = 8
+NACK_DELAY = 0.05          # 帧开始接收后等待多久才请求重传 (秒)
+NACK_MAX_TRIES = 3         # 每帧最多请求重传的次数
+
+# 接收报告: uint16 magic "EK", uint8 version, uint8 type, uint32 frame_seq,
+# uint16 loss_permille, uint16 reserved；设备的自适应码率控制器据此降低码率
+CTRL_REPORT = 0x02
+REPORT_INTERVAL = 1.0      # 报告间隔 (秒)
+
+# 目标表修改: uint16 magic "EK", uint8 version, uint8 type, uint8 op, uint8 reserved,
+# uint16 port, uint32 ip；发往设备的控制端口，使设备把图像发到本机
+CTRL_DEST = 0x03
+DEST_ADD = 0x01
+DEVICE_CONTROL_PORT = 8082  # 与 CONFIG_UDP_CAMERA_CONTROL_PORT 一致
+
 class ImageReceiver:
-    def __init__(self, save_dir="received_images"):
+    def __init__(self, save_dir="received_images", port=UDP_PORT, multicast_group=None, iface="0.0.0.0"):
         self.save_dir = save_dir
+        self.port = port
+        self.multicast_group = multicast_group  # 组播模式：加入该组接收
+        self.iface = iface                      # 加入组播组使用的本地接口地址
         self.socket = None
         self.current_image = None
         self.expected_chunks = 0
@@ -34,21 +74,62 @@ class ImageReceiver:
         self.total_size = 0
         self.chunk_data = {}
         self.last_image_time = 0
+        # v2: 按帧序号分别重组，乱序或交错到达的包不会拼错帧
+        self.pending_frames = {}
+        self.crc_errors = 0
+        self.fec_recovered = 0
+        self.completed_frames = deque(maxlen=64)
+        # 接收报告：统计窗口内应收包数与首次即收到的包数（不含FEC恢复与重传）
+        self.report_addr = None
+        self.report_frame_seq = 0
+        self.report_expected = 0
+        self.report_received = 0
+        self.last_report = time.time()
         
         # 创建保存目录
         os.makedirs(save_dir, exist_ok=True)
         
         print(f"UDP图像接收器启动")
-        print(f"监听地址: {UDP_IP}:{UDP_PORT}")
+        if multicast_group:
+            print(f"组播组: {multicast_group}:{port} (接口 {iface})")
+        else:
+            print(f"监听地址: {UDP_IP}:{port}")
         print(f"保存目录: {save_dir}")
     
-    def start(self):
+    def register(self, device_ip):
+        """请求设备把本机加入图像目标表"""
+        probe = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        probe.connect((device_ip, DEVICE_CONTROL_PORT))
+        local_ip = probe.getsockname()[0]  # 通往设备的本机地址
+        probe.close()
+
+        packet = struct.pack('!2sBBBBH4s', CTRL_MAGIC, 2, CTRL_DEST, DEST_ADD, 0,
+                             self.port, socket.inet_aton(local_ip))
+        self.socket.sendto(packet, (device_ip, DEVICE_CONTROL_PORT))
+        print(f"已请求设备 {device_ip} 发送图像到 {local_ip}:{self.port}")
+
+    def open_socket(self):
+        """创建接收socket；组播模式下允许多个接收端共用端口并加入组播组"""
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        if self.multicast_group:
+            sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+            if hasattr(socket, 'SO_REUSEPORT'):
+                sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEPORT, 1)
+            sock.bind(('', self.port))
+            mreq = socket.inet_aton(self.multicast_group) + socket.inet_aton(self.iface)
+            sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+        else:
+            sock.bind((UDP_IP, self.port))
+        return sock
+
+    def start(self, device_ip=None):
         """启动UDP服务器"""
         try:
             # 创建UDP套接字
-            self.socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-            self.socket.bind((UDP_IP, UDP_PORT))
-            self.socket.settimeout(30.0)  # 30秒超时
+            self.socket = self.open_socket()
+            self.socket.settimeout(NACK_DELAY)  # 短超时，以便及时发出NACK
+            if device_ip:
+                self.register(device_ip)
             
             print("等待ESP32图像数据...")
             
@@ -59,7 +140,8 @@ class ImageReceiver:
                     self.process_packet(data, addr)
                     
                 except socket.timeout:
-                    print("接收超时，继续等待...")
+                    self.send_nacks()
+                    self.send_report()
                     continue
                     
         except Exception as e:
@@ -74,6 +156,12 @@ class ImageReceiver:
             print(f"警告: 接收到无效数据包，长度: {len(data)}")
             return
         
+        if data[:2] == V2_MAGIC:
+            self.process_packet_v2(data, addr)
+            self.send_nacks()
+            self.send_report()
+            return
+
         try:
             # 解析包头
             chunk_id = struct.unpack_from('!I', data, 0)[0]
@@ -94,6 +182,184 @@ class ImageReceiver:
         except struct.error as e:
             print(f"解析数据包错误: {e}")
     
+    def process_packet_v2(self, data, addr):
+        """处理 v2 协议数据包"""
+        if len(data) < V2_HEADER.size:
+            print(f"警告: v2 包过短，长度: {len(data)}")
+            return
+
+        (_, version, flags, frame_seq, timestamp_us, offset,
+         image_size, chunk_id, total_chunks, crc) = V2_HEADER.unpack_from(data, 0)
+        if version != 2:
+            print(f"警告: 不支持的协议版本 {version}")
+            return
+
+        # 校验CRC：包头中的CRC字段按0参与计算
+        header = bytearray(data[:V2_HEADER.size])
+        header[28:32] = b'\x00\x00\x00\x00'
+        if zlib.crc32(data[V2_HEADER.size:], zlib.crc32(header)) != crc:
+            self.crc_errors += 1
+            print(f"警告: 帧 {frame_seq} 包 {chunk_id} CRC 校验失败 (累计 {self.crc_errors})")
+            return
+
+        payload = data[V2_HEADER.size:]
+        if not (flags & V2_FLAG_PARITY) and offset + len(payload) > image_size:
+            print(f"警告: 帧 {frame_seq} 包 {chunk_id} 超出图像范围")
+            return
+
+        if frame_seq in self.completed_frames:
+            return  # 已完成帧的迟到包或多余的校验包
+
+        frame = self.pending_frames.get(frame_seq)
+        if frame is None:
+            # 丢弃最旧的未完成帧
+            while len(self.pending_frames) >= V2_MAX_PENDING_FRAMES:
+                oldest = min(self.pending_frames)
+                lost = self.pending_frames.pop(oldest)
+                self.account_frame(lost)
+                print(f"丢弃未完成的帧 {oldest}，已接收 {len(lost['chunks'])}/{lost['total']} 包")
+            frame = {'size': image_size, 'total': total_chunks, 'timestamp_us': timestamp_us,
+                     'data': bytearray(image_size), 'chunks': set(), 'parity': {},
+                     'addr': addr, 'first_seen': time.time(), 'last_nack': 0.0, 'nacks': 0,
+                     'first_try': 0}
+            self.pending_frames[frame_seq] = frame
+
+        if flags & V2_FLAG_PARITY:
+            # offset 字段携带分组大小
+            frame['parity'][chunk_id] = (offset, payload)
+        elif chunk_id in frame['chunks']:
+            return
+        else:
+            frame['data'][offset:offset + len(payload)] = payload
+            frame['chunks'].add(chunk_id)
+            if not (flags & V2_FLAG_RETRANSMIT):
+                frame['first_try'] += 1
+        self.report_addr = addr
+        self.report_frame_seq = frame_seq
+
+        if frame['parity']:
+            self.fec_recover(frame_seq, frame)
+
+        if len(frame['chunks']) >= frame['total']:
+            del self.pending_frames[frame_seq]
+            self.completed_frames.append(frame_seq)
+            self.account_frame(frame)
+            print(f"帧 {frame_seq} 接收完成: {frame['total']} 包, 采集时间戳 {frame['timestamp_us']} us")
+            self.save_image(bytes(frame['data']))
+
+    def send_nacks(self):
+        """对接收超时的帧，向设备发送缺失包的NACK位图"""
+        if self.socket is None:
+            return
+        now = time.time()
+        for frame_seq, frame in self.pending_frames.items():
+            if frame['addr'] is None or frame['nacks'] >= NACK_MAX_TRIES:
+                continue
+            if now - frame['first_seen'] < NACK_DELAY or now - frame['last_nack'] < NACK_DELAY:
+                continue
+
+            missing = [i for i in range(frame['total']) if i not in frame['chunks']]
+            if not missing:
+                continue
+            base = missing[0]
+            words = [0] * NACK_MAX_WORDS
+            for i in missing:
+                bit = i - base
+                if bit >= NACK_MAX_WORDS * 32:
+                    break
+                words[bit // 32] |= 1 << (bit % 32)
+            while words and words[-1] == 0:
+                words.pop()
+
+            packet = struct.pack(f'!2sBBIHH{len(words)}I', CTRL_MAGIC, 2, CTRL_NACK,
+                                 frame_seq, base, len(words), *words)
+            self.socket.sendto(packet, frame['addr'])
+            frame['last_nack'] = now
+            frame['nacks'] += 1
+            print(f"帧 {frame_seq} 请求重传 {len(missing)} 包 (第 {frame['nacks']} 次)")
+
+    def account_frame(self, frame):
+        """帧完成或被丢弃时计入丢包统计"""
+        self.report_expected += frame['total']
+        self.report_received += min(frame['first_try'], frame['total'])
+
+    def send_report(self):
+        """定期向设备报告丢包率（FEC与重传恢复之前）"""
+        now = time.time()
+        if self.socket is None or self.report_addr is None or now - self.last_report < REPORT_INTERVAL:
+            return
+        self.last_report = now
+        if self.report_expected == 0:
+            if self.multicast_group:
+                # 组播模式下设备只应答最近发过报告的接收端的NACK，没有完成的帧时也要报告以保持登记
+                packet = struct.pack('!2sBBIHH', CTRL_MAGIC, 2, CTRL_REPORT, self.report_frame_seq, 0, 0)
+                self.socket.sendto(packet, self.report_addr)
+            return
+        loss = (self.report_expected - self.report_received) * 1000 // self.report_expected
+        packet = struct.pack('!2sBBIHH', CTRL_MAGIC, 2, CTRL_REPORT, self.report_frame_seq, loss, 0)
+        self.socket.sendto(packet, self.report_addr)
+        if loss > 0:
+            print(f"接收报告: 丢包率 {loss / 10:.1f}% ({self.report_received}/{self.report_expected} 包)")
+        self.report_expected = 0
+        self.report_received = 0
+
+    def fec_recover(self, frame_seq, frame):
+        """用XOR校验包恢复组内唯一丢失的数据包（与 main/image_fec.c 一致）"""
+        size = frame['size']
+        for group, (group_size, parity) in list(frame['parity'].items()):
+            first = group * group_size
+            end = min(first + group_size, frame['total'])
+            missing = [i for i in range(first, end) if i not in frame['chunks']]
+            if len(missing) > 1:
+                continue
+            del frame['parity'][group]
+            if not missing:
+                continue
+
+            lost = missing[0]
+            lost_len = min(V2_CHUNK_PAYLOAD, size - lost * V2_CHUNK_PAYLOAD)
+            block = bytearray(parity[:lost_len])
+            for i in range(first, end):
+                if i == lost:
+                    continue
+                start = i * V2_CHUNK_PAYLOAD
+                other = frame['data'][start:start + min(lost_len, V2_CHUNK_PAYLOAD, size - start)]
+                for k, b in enumerate(other):
+                    block[k] ^= b
+            start = lost * V2_CHUNK_PAYLOAD
+            frame['data'][start:start + lost_len] = block
+            frame['chunks'].add(lost)
+            self.fec_recovered += 1
+            print(f"帧 {frame_seq} 通过FEC恢复了包 {lost} (累计 {self.fec_recovered})")
+
+    def save_image(self, image):
+        """保存一幅完整图像"""
+        if len(image) < 4:
+            print("错误: 图像数据过小")
+            return
+
+        # 检查JPEG文件头 (FF D8 FF)
+        if image[0] != 0xFF or image[1] != 0xD8:
+            print("警告: 图像数据可能不是有效的JPEG格式")
+
+        # 生成文件名
+        timestamp = datetime.now().strftime("%Y%m%d_%H%M%S_%f")
+        filename = f"image_{timestamp}.jpg"
+        filepath = os.path.join(self.save_dir, filename)
+
+        # 保存图像
+        with open(filepath, 'wb') as f:
+            f.write(image)
+
+        print(f"图像保存成功: {filepath} ({len(image)} 字节)")
+
+        # 计算接收间隔
+        current_time = time.time()
+        if self.last_image_time > 0:
+            interval = current_time - self.last_image_time
+            print(f"图像间隔: {interval:.1f} 秒")
+        self.last_image_time = current_time
+
     def start_new_image(self, total_chunks, image_size):
         """开始接收新图像"""
         # 如果有未完成的图像，丢弃它
@@ -142,32 +408,7 @@ class ImageReceiver:
             if len(self.current_image) != self.total_size:
                 print(f"警告: 图像大小不匹配，期望: {self.total_size}, 实际: {len(self.current_image)}")
             
-            # 检查是否为有效的JPEG数据
-            if len(self.current_image) < 4:
-                print("错误: 图像数据过小")
-                return
-            
-            # 检查JPEG文件头 (FF D8 FF)
-            if self.current_image[0] != 0xFF or self.current_image[1] != 0xD8:
-                print("警告: 图像数据可能不是有效的JPEG格式")
-            
-            # 生成文件名
-            timestamp = datetime.now().strftime("%Y%m%d_%H%M%S")
-            filename = f"image_{timestamp}.jpg"
-            filepath = os.path.join(self.save_dir, filename)
-            
-            # 保存图像
-            with open(filepath, 'wb') as f:
-                f.write(self.current_image)
-            
-            print(f"图像保存成功: {filepath} ({len(self.current_image)} 字节)")
-            
-            # 计算接收间隔
-            current_time = time.time()
-            if self.last_image_time > 0:
-                interval = current_time - self.last_image_time
-                print(f"图像间隔: {interval:.1f} 秒")
-            self.last_image_time = current_time
+            self.save_image(bytes(self.current_image))
             
         except Exception as e:
             print(f"保存图像错误: {e}")
@@ -184,10 +425,18 @@ def main():
     print("ESP32 UDP图像接收器")
     print("=" * 40)
     
-    receiver = ImageReceiver()
+    parser = argparse.ArgumentParser(description="ESP32 UDP图像接收器")
+    parser.add_argument("device", nargs="?", help="设备IP，启动时请求设备把本机加入单播目标表")
+    parser.add_argument("--port", type=int, default=UDP_PORT, help="接收端口 (组播模式下为组播端口)")
+    parser.add_argument("--multicast", metavar="GROUP", help="组播模式：加入该组播组接收，例如 239.255.0.1")
+    parser.add_argument("--iface", default="0.0.0.0", help="加入组播组使用的本地接口地址 (回环测试用 127.0.0.1)")
+    parser.add_argument("--save-dir", default="received_images", help="图像保存目录")
+    args = parser.parse_args()
+
+    receiver = ImageReceiver(args.save_dir, args.port, args.multicast, args.iface)
     
     try:
-        receiver.start()
+        receiver.start(None if args.multicast else args.device)
     except KeyboardInterrupt:
         print("\n程序被用户中断")
     except Exception as e:
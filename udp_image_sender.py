@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""
+PC端图像发送器（测试用）
+按 v2 协议 (与 main/image_proto.h 一致) 把 JPEG 文件分包发送到单播或组播地址，
+用于在没有设备时测试接收端，例如回环组播:
+
+    python udp_image_receiver.py --multicast 239.255.0.1 --port 5000 --iface 127.0.0.1
+    python udp_image_sender.py photo.jpg --dest 239.255.0.1:5000 --iface 127.0.0.1
+"""
+
+import argparse
+import socket
+import struct
+import time
+import zlib
+
+V2_HEADER = struct.Struct('!2sBBIQIIHHI')
+V2_FLAG_FIRST = 0x01
+V2_FLAG_LAST = 0x02
+V2_FLAG_KEYFRAME = 0x04
+V2_CHUNK_PAYLOAD = 1400 - V2_HEADER.size
+
+
+def build_packets(image, frame_seq, timestamp_us):
+    """把一幅图像分成 v2 数据包"""
+    total = (len(image) + V2_CHUNK_PAYLOAD - 1) // V2_CHUNK_PAYLOAD
+    packets = []
+    for chunk_id in range(total):
+        offset = chunk_id * V2_CHUNK_PAYLOAD
+        payload = image[offset:offset + V2_CHUNK_PAYLOAD]
+        flags = V2_FLAG_KEYFRAME
+        if chunk_id == 0:
+            flags |= V2_FLAG_FIRST
+        if chunk_id == total - 1:
+            flags |= V2_FLAG_LAST
+        header = V2_HEADER.pack(b'EC', 2, flags, frame_seq, timestamp_us, offset,
+                                len(image), chunk_id, total, 0)
+        crc = zlib.crc32(payload, zlib.crc32(header))
+        packets.append(header[:28] + struct.pack('!I', crc) + payload)
+    return packets
+
+
+def main():
+    parser = argparse.ArgumentParser(description="按 v2 协议发送 JPEG 文件（测试接收端用）")
+    parser.add_argument("files", nargs="+", help="要发送的 JPEG 文件")
+    parser.add_argument("--dest", default="127.0.0.1:8080", help="目标地址 host:port，可以是组播组")
+    parser.add_argument("--iface", help="组播发送接口地址 (回环测试用 127.0.0.1)")
+    parser.add_argument("--ttl", type=int, default=1, help="组播TTL")
+    parser.add_argument("--fps", type=float, default=2.0, help="发送帧率")
+    parser.add_argument("--loop", type=int, default=1, help="重复发送的轮数")
+    args = parser.parse_args()
+
+    host, port = args.dest.rsplit(':', 1)
+    dest = (host, int(port))
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, args.ttl)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_LOOP, 1)
+    if args.iface:
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_IF, socket.inet_aton(args.iface))
+
+    images = []
+    for path in args.files:
+        with open(path, 'rb') as f:
+            images.append(f.read())
+
+    frame_seq = 0
+    for _ in range(args.loop):
+        for image in images:
+            for packet in build_packets(image, frame_seq, int(time.time() * 1000000)):
+                sock.sendto(packet, dest)
+            print(f"帧 {frame_seq} 已发送到 {dest[0]}:{dest[1]}: {len(image)} bytes")
+            frame_seq += 1
+            time.sleep(1.0 / args.fps)
+
+    sock.close()
+
+
+if __name__ == "__main__":
+    main()
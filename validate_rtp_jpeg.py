@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+PC端 RTP/JPEG 输出验证脚本（测试用）
+把本机加入设备的目标表，取 /stream.sdp 交给 ffmpeg 解码指定时长，解码报错或没有解出帧时返回非 0:
+
+    python validate_rtp_jpeg.py 192.168.5.10 --switch --seconds 10
+    python validate_rtp_jpeg.py 192.168.5.10 --port 5004 --keep-sdp stream.sdp
+
+--switch 先通过 POST /api/streams 把主图像流切换为 RTP/JPEG，结束后恢复原格式。
+设备只按 RFC 2435 type 0/1 (4:2:2 / 4:2:0，带重启标记时 +64) 发送，接收端按 Annex K 标准哈夫曼表重建 JPEG 头，
+宽高须为 8 的倍数且不超过 2040；不满足时设备跳过该帧，这里表现为没有解出帧。
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import urllib.error
+import urllib.request
+
+
+def http_request(device, port, path, body=None, timeout=10.0):
+    url = "http://%s:%d%s" % (device, port, path)
+    data = json.dumps(body).encode() if body is not None else None
+    request = urllib.request.Request(url, data=data, headers={'Content-Type': 'application/json'} if data else {})
+    try:
+        with urllib.request.urlopen(request, timeout=timeout) as response:
+            return response.read()
+    except urllib.error.HTTPError as e:
+        raise OSError("%s 返回 HTTP %d: %s" % (path, e.code, e.read().decode(errors='replace')))
+
+
+def api(device, port, path, body=None):
+    result = json.loads(http_request(device, port, path, body))
+    if not result.get('success'):
+        raise OSError("%s 失败: %s" % (path, result.get('message', result)))
+    return result
+
+
+def local_ip(device):
+    """本机到设备的出口地址"""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    try:
+        sock.connect((device, 80))
+        return sock.getsockname()[0]
+    finally:
+        sock.close()
+
+
+def run_ffmpeg(ffmpeg, sdp_path, seconds):
+    """解码 seconds 秒，返回 (解出的帧数, 错误输出行)"""
+    cmd = [ffmpeg, '-hide_banner', '-nostdin', '-loglevel', 'error', '-protocol_whitelist', 'file,udp,rtp',
+           '-f', 'sdp', '-i', sdp_path, '-t', str(seconds), '-progress', 'pipe:1', '-f', 'null', '-']
+    try:
+        proc = subprocess.run(cmd, capture_output=True, text=True, timeout=seconds + 30)
+    except subprocess.TimeoutExpired:
+        return 0, ["ffmpeg 超时（没有收到 RTP 包？）"]
+    frames = [int(n) for n in re.findall(r'^frame=(\d+)', proc.stdout, re.MULTILINE)]
+    errors = [line for line in proc.stderr.splitlines() if line.strip()]
+    if proc.returncode != 0 and not errors:
+        errors.append("ffmpeg 退出码 %d" % proc.returncode)
+    return (frames[-1] if frames else 0), errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="RTP/JPEG 输出验证：用 ffmpeg 按设备的 SDP 解码并检查错误")
+    parser.add_argument("device", help="设备IP")
+    parser.add_argument("--http-port", type=int, default=80, help="设备的 HTTP 端口")
+    parser.add_argument("--port", type=int, default=5004, help="本机接收 RTP 的端口（偶数，RTCP 占用 +1）")
+    parser.add_argument("--seconds", type=int, default=10, help="解码时长（秒）")
+    parser.add_argument("--switch", action="store_true", help="先把主图像流切换为 RTP/JPEG，结束后恢复")
+    parser.add_argument("--ffmpeg", default="ffmpeg", help="ffmpeg 可执行文件")
+    parser.add_argument("--keep-sdp", help="把 SDP 另存到该路径")
+    args = parser.parse_args()
+
+    if args.port % 2 != 0:
+        print("失败: RTP 端口须为偶数")
+        return 1
+    ffmpeg = shutil.which(args.ffmpeg)
+    if ffmpeg is None:
+        print("失败: 找不到 %s（Windows 可先运行 download_ffmpeg.py）" % args.ffmpeg)
+        return 1
+
+    previous_format = None
+    added = False
+    ip = None
+    sdp_path = None
+    try:
+        ip = local_ip(args.device)
+        if args.switch:
+            previous_format = api(args.device, args.http_port, "/api/streams")['main'].get('format', 'image')
+            api(args.device, args.http_port, "/api/streams", {'main': {'format': 'rtp'}})
+        api(args.device, args.http_port, "/api/destinations", {'action': 'add', 'ip': ip, 'port': args.port})
+        added = True
+
+        sdp = http_request(args.device, args.http_port, "/stream.sdp").decode()
+        # SDP 描述的是目标表中的第一个目标，端口不同时改为本机端口（ffmpeg 按 m= 行的端口监听）
+        sdp = re.sub(r'^m=video \d+', 'm=video %d' % args.port, sdp, flags=re.MULTILINE)
+        with tempfile.NamedTemporaryFile('w', suffix='.sdp', delete=False) as f:
+            f.write(sdp)
+            sdp_path = f.name
+        if args.keep_sdp:
+            shutil.copyfile(sdp_path, args.keep_sdp)
+
+        print("在 %s:%d 接收，用 ffmpeg 解码 %d 秒..." % (ip, args.port, args.seconds))
+        frames, errors = run_ffmpeg(ffmpeg, sdp_path, args.seconds)
+    except (ValueError, KeyError, OSError) as e:
+        print("失败: %s" % e)
+        return 1
+    finally:
+        if sdp_path is not None:
+            os.unlink(sdp_path)
+        try:
+            if added:
+                api(args.device, args.http_port, "/api/destinations", {'action': 'remove', 'ip': ip, 'port': args.port})
+            if previous_format is not None and previous_format != 'rtp':
+                api(args.device, args.http_port, "/api/streams", {'main': {'format': previous_format}})
+        except OSError as e:
+            print("恢复设备设置失败: %s" % e)
+
+    for line in errors[:20]:
+        print("  ffmpeg: %s" % line)
+    if len(errors) > 20:
+        print("  ... 共 %d 行错误" % len(errors))
+    print("解出 %d 帧 (%.1f fps), 解码错误 %d 行" % (frames, frames / args.seconds if args.seconds else 0, len(errors)))
+    return 0 if frames > 0 and not errors else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())